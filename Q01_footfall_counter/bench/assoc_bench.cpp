@@ -0,0 +1,138 @@
+/***********************************************************************************************************************
+* File Name    : assoc_bench.cpp
+* Description  : Host microbenchmark of the detection to track association. Compares the IoU gated LAPJV used by
+*                both trackers with a single dense LAPJV over the whole IoU matrix on synthetic crowded scenes.
+*                Usage: assoc_bench [repeats]
+***********************************************************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+#include "lapjv.h"
+
+/* Capture resolution of the application */
+#define SCENE_W     (640.0f)
+#define SCENE_H     (480.0f)
+
+struct Box {
+    float x, y, w, h;
+};
+
+static float iou(const Box& a, const Box& b)
+{
+    float w = std::min(a.x + a.w, b.x + b.w) - std::max(a.x, b.x);
+    float h = std::min(a.y + a.h, b.y + b.h) - std::max(a.y, b.y);
+    if (w <= 0 || h <= 0)
+    {
+        return 0.0f;
+    }
+    float inter = w * h;
+    return inter / (a.w * a.h + b.w * b.h - inter);
+}
+
+/* People scattered over the frame, tracks are the same boxes moved by a few pixels, with some births and deaths */
+static void make_scene(int people, std::mt19937& rng, std::vector<float>& iou_matrix, int& rows, int& cols)
+{
+    /* Person size shrinks with the crowd so that the frame stays plausible */
+    const float h = std::max(24.0f, std::min(160.0f, 1.6f * SCENE_H / std::sqrt((float)people)));
+    const float w = 0.45f * h;
+    std::uniform_real_distribution<float> px(0.0f, SCENE_W - w), py(0.0f, SCENE_H - h);
+    std::normal_distribution<float> jitter(0.0f, 0.08f * w);
+    std::bernoulli_distribution keep(0.95);
+
+    std::vector<Box> dets, trks;
+    for (int i = 0; i < people; i++)
+    {
+        Box b = { px(rng), py(rng), w, h };
+        if (keep(rng))
+        {
+            dets.push_back(b);
+        }
+        if (keep(rng))
+        {
+            trks.push_back({ b.x + jitter(rng), b.y + jitter(rng), w, h });
+        }
+    }
+    rows = dets.size();
+    cols = trks.size();
+    iou_matrix.resize((size_t)rows * cols);
+    for (int r = 0; r < rows; r++)
+    {
+        for (int c = 0; c < cols; c++)
+        {
+            iou_matrix[(size_t)r * cols + c] = iou(dets[r], trks[c]);
+        }
+    }
+}
+
+static float dense_associate(LapJV& lap, const std::vector<float>& iou_matrix, int rows, int cols,
+                             float min_iou, std::vector<float>& cost, std::vector<int>& sol)
+{
+    const int n = std::max(rows, cols);
+    cost.assign((size_t)n * n, 1.0f);
+    for (int r = 0; r < rows; r++)
+    {
+        for (int c = 0; c < cols; c++)
+        {
+            cost[(size_t)r * n + c] = 1.0f - iou_matrix[(size_t)r * cols + c];
+        }
+    }
+    sol.resize(n);
+    lap.Solve(n, cost.data(), sol.data());
+    float total = 0.0f;
+    for (int r = 0; r < rows; r++)
+    {
+        if (sol[r] < cols && iou_matrix[(size_t)r * cols + sol[r]] >= min_iou)
+        {
+            total += iou_matrix[(size_t)r * cols + sol[r]];
+        }
+    }
+    return total;
+}
+
+int main(int argc, char **argv)
+{
+    const int repeats = (argc > 1) ? atoi(argv[1]) : 200;
+    const int crowds[] = { 10, 50, 100, 200, 500 };
+    const float min_iou = 0.3f;
+    std::mt19937 rng(7);
+    LapJV lap;
+    std::vector<float> iou_matrix, cost;
+    std::vector<int> sol;
+    std::vector<std::pair<int, int>> matches;
+
+    printf("  people   dets x trks   gated us   dense us   matched   total IoU gated/dense\n");
+    for (int people : crowds)
+    {
+        int rows = 0, cols = 0;
+        make_scene(people, rng, iou_matrix, rows, cols);
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < repeats; k++)
+        {
+            lap.AssociateIou(iou_matrix.data(), rows, cols, min_iou, matches);
+        }
+        const double gated_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / repeats;
+        float gated_total = 0.0f;
+        for (const auto& m : matches)
+        {
+            gated_total += iou_matrix[(size_t)m.first * cols + m.second];
+        }
+
+        float dense_total = 0.0f;
+        t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < repeats; k++)
+        {
+            dense_total = dense_associate(lap, iou_matrix, rows, cols, min_iou, cost, sol);
+        }
+        const double dense_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / repeats;
+
+        printf("  %6d   %4d x %4d   %8.1f   %8.1f   %7zu   %.3f / %.3f\n",
+               people, rows, cols, gated_us, dense_us, matches.size(), gated_total, dense_total);
+    }
+    return 0;
+}
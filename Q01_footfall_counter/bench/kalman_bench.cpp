@@ -0,0 +1,178 @@
+/***********************************************************************************************************************
+* File Name    : kalman_bench.cpp
+* Description  : Host microbenchmark of FixedKalmanFilter against the Eigen KalmanFilter (V2L tracker) and
+*                cv::KalmanFilter (V2H tracker) on the same synthetic box tracks.
+*                Usage: kalman_bench [tracks] [frames]
+***********************************************************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "fixed_kalman_filter.h"
+#include "kalman_filter.h"
+#ifdef BENCH_WITH_OPENCV
+#include <opencv2/video/tracking.hpp>
+#endif
+
+/* Same tuning as Track (V2L, 8 states) */
+static const float kP0[8] = {10, 10, 10, 10, 10000, 10000, 10000, 10000};
+static const float kQ[8]  = {1, 1, 1, 1, 0.01, 0.01, 0.0001, 0.0001};
+static const float kR[4]  = {1, 1, 10, 10};
+
+/* Observation of one track per frame: box drifting at constant speed plus detector noise */
+static std::vector<float> make_observations(int tracks, int frames)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> pos(50.0f, 600.0f);
+    std::uniform_real_distribution<float> vel(-3.0f, 3.0f);
+    std::normal_distribution<float> noise(0.0f, 2.0f);
+    std::vector<float> z((size_t)tracks * frames * 4);
+    for (int t = 0; t < tracks; t++)
+    {
+        float cx = pos(rng), cy = pos(rng), w = 40.0f + pos(rng) / 10.0f, h = 2.0f * w;
+        float vx = vel(rng), vy = vel(rng);
+        for (int f = 0; f < frames; f++)
+        {
+            float* o = &z[((size_t)f * tracks + t) * 4];
+            o[0] = cx + vx * f + noise(rng);
+            o[1] = cy + vy * f + noise(rng);
+            o[2] = w + noise(rng);
+            o[3] = h + noise(rng);
+        }
+    }
+    return z;
+}
+
+static double elapsed_us(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static KalmanFilter make_eigen_filter(const float* z)
+{
+    KalmanFilter kf(8, 4);
+    kf.F_ = Eigen::MatrixXd::Identity(8, 8);
+    kf.H_ = Eigen::MatrixXd::Zero(4, 8);
+    kf.P_ = Eigen::MatrixXd::Zero(8, 8);
+    kf.Q_ = Eigen::MatrixXd::Zero(8, 8);
+    kf.R_ = Eigen::MatrixXd::Zero(4, 4);
+    for (int i = 0; i < 8; i++)
+    {
+        kf.P_(i, i) = kP0[i];
+        kf.Q_(i, i) = kQ[i];
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        kf.F_(i, i + 4) = 1;
+        kf.H_(i, i) = 1;
+        kf.R_(i, i) = kR[i];
+        kf.x_(i) = z[i];
+    }
+    return kf;
+}
+
+static FixedKalmanFilter<8, 4> make_fixed_filter(const float* z)
+{
+    FixedKalmanFilter<8, 4> kf;
+    std::copy(kQ, kQ + 8, kf.q_);
+    std::copy(kR, kR + 4, kf.r_);
+    kf.Init(z, kP0);
+    return kf;
+}
+
+#ifdef BENCH_WITH_OPENCV
+static cv::KalmanFilter make_cv_filter(const float* z)
+{
+    cv::KalmanFilter kf(8, 4);
+    cv::setIdentity(kf.transitionMatrix);
+    for (int i = 0; i < 4; i++)
+    {
+        kf.transitionMatrix.at<float>(i, i + 4) = 1;
+        kf.measurementMatrix.at<float>(i, i) = 1;
+        kf.measurementNoiseCov.at<float>(i, i) = kR[i];
+        kf.statePost.at<float>(i, 0) = z[i];
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        kf.errorCovPost.at<float>(i, i) = kP0[i];
+        kf.processNoiseCov.at<float>(i, i) = kQ[i];
+    }
+    return kf;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    const int tracks = (argc > 1) ? atoi(argv[1]) : 100;
+    const int frames = (argc > 2) ? atoi(argv[2]) : 1000;
+    const std::vector<float> z = make_observations(tracks, frames);
+    const double steps = (double)tracks * (frames - 1);
+
+    std::vector<KalmanFilter> eigen_kf;
+    std::vector<FixedKalmanFilter<8, 4>> fixed_kf;
+    for (int t = 0; t < tracks; t++)
+    {
+        eigen_kf.push_back(make_eigen_filter(&z[(size_t)t * 4]));
+        fixed_kf.push_back(make_fixed_filter(&z[(size_t)t * 4]));
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int f = 1; f < frames; f++)
+    {
+        for (int t = 0; t < tracks; t++)
+        {
+            const float* o = &z[((size_t)f * tracks + t) * 4];
+            eigen_kf[t].Predict();
+            eigen_kf[t].Update(Eigen::Vector4d(o[0], o[1], o[2], o[3]));
+        }
+    }
+    const double eigen_us = elapsed_us(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    for (int f = 1; f < frames; f++)
+    {
+        for (int t = 0; t < tracks; t++)
+        {
+            fixed_kf[t].Predict();
+            fixed_kf[t].Update(&z[((size_t)f * tracks + t) * 4]);
+        }
+    }
+    const double fixed_us = elapsed_us(t0);
+
+    /* Both filters see the same data, the float result should track the double one */
+    double max_diff = 0.0;
+    for (int t = 0; t < tracks; t++)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            max_diff = std::max(max_diff, std::fabs(eigen_kf[t].x_(i) - fixed_kf[t].x_[i]));
+        }
+    }
+
+    printf("[INFO] %d tracks x %d frames, predict+update per track step\n", tracks, frames);
+    printf("  Eigen KalmanFilter(8,4)   : %8.3f us/step\n", eigen_us / steps);
+#ifdef BENCH_WITH_OPENCV
+    std::vector<cv::KalmanFilter> cv_kf;
+    for (int t = 0; t < tracks; t++)
+    {
+        cv_kf.push_back(make_cv_filter(&z[(size_t)t * 4]));
+    }
+    t0 = std::chrono::steady_clock::now();
+    for (int f = 1; f < frames; f++)
+    {
+        for (int t = 0; t < tracks; t++)
+        {
+            const float* o = &z[((size_t)f * tracks + t) * 4];
+            cv_kf[t].predict();
+            cv_kf[t].correct(cv::Mat(4, 1, CV_32F, const_cast<float*>(o)));
+        }
+    }
+    printf("  cv::KalmanFilter(8,4)     : %8.3f us/step\n", elapsed_us(t0) / steps);
+#endif
+    printf("  FixedKalmanFilter<8,4>    : %8.3f us/step (%.1fx vs Eigen)\n", fixed_us / steps, eigen_us / fixed_us);
+    printf("  max |x_eigen - x_fixed|   : %g\n", max_diff);
+    return 0;
+}
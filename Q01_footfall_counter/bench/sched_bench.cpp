@@ -0,0 +1,156 @@
+/***********************************************************************************************************************
+* File Name    : sched_bench.cpp
+* Description  : Host benchmark of the frame time jitter of a pipeline thread under CPU load. A frame thread wakes up
+*                every period, runs a fixed amount of work and records its frame time, while load threads keep every
+*                CPU busy. The run is repeated with the thread settings of the [thread] section of config.ini:
+*                    default : no settings, every thread on every CPU with SCHED_OTHER
+*                    pinned  : frame thread on one CPU, load threads on the others
+*                    rt      : pinned, and the frame thread with SCHED_FIFO (needs CAP_SYS_NICE or RLIMIT_RTPRIO,
+*                              otherwise a warning is printed and the run is the same as pinned)
+*                With a single CPU the load thread stays on the CPU of the frame thread, so pinned says nothing there.
+*                Usage: sched_bench [frames] [period_us] [work_us] [cpu]
+***********************************************************************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <unordered_map>
+#include <vector>
+#include "thread_sched.h"
+
+static std::atomic<bool> load_running;
+
+static void busy(int64_t us)
+{
+    auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+    volatile uint64_t x = 0;
+    while (std::chrono::steady_clock::now() < end)
+    {
+        for (int i = 0; i < 1000; i++)
+        {
+            x = x * 6364136223846793005ULL + 1;
+        }
+    }
+}
+
+static void *load_thread(void *)
+{
+    while (load_running.load(std::memory_order_relaxed))
+    {
+        busy(1000);
+    }
+    return NULL;
+}
+
+struct FrameArgs
+{
+    int frames;
+    int64_t period_us;
+    int64_t work_us;
+    /* wake up to end of work of each frame [us] */
+    std::vector<double> frame_us;
+};
+
+static void *frame_thread(void *arg)
+{
+    FrameArgs *a = (FrameArgs *)arg;
+    timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    for (int i = 0; i < a->frames; i++)
+    {
+        next.tv_nsec += a->period_us * 1000;
+        while (next.tv_nsec >= 1000000000L)
+        {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        busy(a->work_us);
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        /* frame time is counted from the planned wake up, so late wake ups are part of it */
+        a->frame_us.push_back((now.tv_sec - next.tv_sec) * 1e6 + (now.tv_nsec - next.tv_nsec) / 1e3);
+    }
+    return NULL;
+}
+
+static double percentile(std::vector<double> v, double p)
+{
+    std::sort(v.begin(), v.end());
+    size_t i = std::min(v.size() - 1, (size_t)(p / 100.0 * v.size()));
+    return v[i];
+}
+
+static void run(const char *name, const ThreadSchedConfig& sched, int frames, int64_t period_us, int64_t work_us)
+{
+    int num_cpu = (int)std::thread::hardware_concurrency();
+    std::vector<pthread_t> loads(num_cpu);
+    load_running.store(true);
+    for (pthread_t& t : loads)
+    {
+        pthread_create(&t, NULL, load_thread, NULL);
+        sched.apply(t, "load");
+    }
+
+    FrameArgs args = { frames, period_us, work_us, {} };
+    args.frame_us.reserve(frames);
+    pthread_t frame;
+    pthread_create(&frame, NULL, frame_thread, &args);
+    sched.apply(frame, "frame");
+    pthread_join(frame, NULL);
+
+    load_running.store(false);
+    for (pthread_t& t : loads)
+    {
+        pthread_join(t, NULL);
+    }
+
+    const std::vector<double>& f = args.frame_us;
+    printf("%-8s p50 %8.1f  p99 %8.1f  p99.9 %8.1f  max %9.1f us  over period %5.2f %%\n", name,
+           percentile(f, 50), percentile(f, 99), percentile(f, 99.9), *std::max_element(f.begin(), f.end()),
+           100.0 * std::count_if(f.begin(), f.end(), [&](double x) { return x > period_us; }) / f.size());
+}
+
+int main(int argc, char **argv)
+{
+    int frames = (argc > 1) ? std::atoi(argv[1]) : 2000;
+    int64_t period_us = (argc > 2) ? std::atoll(argv[2]) : 5000;
+    int64_t work_us = (argc > 3) ? std::atoll(argv[3]) : 2000;
+    int num_cpu = (int)std::thread::hardware_concurrency();
+    int cpu = (argc > 4) ? std::atoi(argv[4]) : num_cpu - 1;
+
+    printf("%d frames, period %lld us, work %lld us, %d load threads on %d CPUs, frame thread on CPU %d\n",
+           frames, (long long)period_us, (long long)work_us, num_cpu, num_cpu, cpu);
+
+    std::string others;
+    for (int i = 0; i < num_cpu; i++)
+    {
+        if (i != cpu)
+        {
+            others += (others.empty() ? "" : ",") + std::to_string(i);
+        }
+    }
+
+    ThreadSchedConfig none;
+    run("default", none, frames, period_us, work_us);
+
+    /* as config.ini would give it */
+    std::unordered_map<std::string, std::string> section = {
+        { "frame_cpus", std::to_string(cpu) },
+        { "load_cpus", others.empty() ? std::to_string(cpu) : others },
+    };
+    ThreadSchedConfig pinned;
+    pinned.read(section);
+    run("pinned", pinned, frames, period_us, work_us);
+
+    section["frame_policy"] = "fifo";
+    section["frame_priority"] = "50";
+    ThreadSchedConfig rt;
+    rt.read(section);
+    run("rt", rt, frames, period_us, work_us);
+    return 0;
+}
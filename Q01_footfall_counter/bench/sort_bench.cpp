@@ -0,0 +1,61 @@
+/***********************************************************************************************************************
+* File Name    : sort_bench.cpp
+* Description  : Host microbenchmark of sort::Sort::update (RZ/V2H tracker) with 10, 100 and 500 people walking
+*                across the frame at constant speed.
+*                Usage: sort_bench [frames]
+***********************************************************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "sort.h"
+
+int main(int argc, char **argv)
+{
+    const int frames = (argc > 1) ? atoi(argv[1]) : 300;
+    const int crowds[] = { 10, 100, 500 };
+
+    printf("  tracks   us/frame   reported\n");
+    for (int people : crowds)
+    {
+        sort::Sort mot(1, 3, 0.3f);
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> uni(0.0f, 1.0f);
+        const float h = std::max(24.0f, std::min(160.0f, 1.6f * 480.0f / std::sqrt((float)people)));
+        const float w = 0.45f * h;
+        std::vector<float> x(people), y(people), vx(people), vy(people);
+        for (int i = 0; i < people; i++)
+        {
+            x[i] = uni(rng) * 640.0f;
+            y[i] = uni(rng) * 480.0f;
+            vx[i] = uni(rng) * 2.0f - 1.0f;
+            vy[i] = uni(rng) * 2.0f - 1.0f;
+        }
+
+        double total_us = 0.0;
+        int reported = 0;
+        cv::Mat det(people, 6, CV_32F);
+        for (int f = 0; f < frames; f++)
+        {
+            for (int i = 0; i < people; i++)
+            {
+                float* p = det.ptr<float>(i);
+                p[0] = x[i] + vx[i] * f;
+                p[1] = y[i] + vy[i] * f;
+                p[2] = w;
+                p[3] = h;
+                p[4] = 0.9f;
+                p[5] = 0.0f;
+            }
+            auto t0 = std::chrono::steady_clock::now();
+            cv::Mat tracks = mot.update(det);
+            total_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+            reported = tracks.rows;
+        }
+        printf("  %6d   %8.1f   %8d\n", people, total_us / frames, reported);
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+/***********************************************************************************************************************
+* File Name    : stage_bench.cpp
+* Description  : Host benchmark of the thread hand-off of the V2H application. A capture stage sets a frame flag at the
+*                camera rate, an inference stage picks it up, and then a main stage. Run once with the previous
+*                usleep(WAIT_TIME) polling of std::atomic flags and once with the blocking StageEvent of the stage
+*                graph; prints the capture to main latency and the CPU time spent while the stages are idle.
+*                Usage: stage_bench [frames] [fps]
+***********************************************************************************************************************/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+#include <vector>
+#include "stage_graph.h"
+
+/* Polling period of the application loops */
+#define WAIT_TIME   (1000) /* microseconds */
+
+using Clock = std::chrono::steady_clock;
+
+static double cpu_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void report(const char *name, std::vector<double>& latency_us, double cpu, double wall)
+{
+    std::sort(latency_us.begin(), latency_us.end());
+    double sum = 0.0;
+    for (double v : latency_us)
+    {
+        sum += v;
+    }
+    printf("[INFO] %-8s capture->main latency: mean %7.1f us, p50 %7.1f us, p99 %7.1f us; CPU %5.1f%% of one core\n",
+           name, sum / latency_us.size(), latency_us[latency_us.size() / 2],
+           latency_us[latency_us.size() * 99 / 100], 100.0 * cpu / wall);
+}
+
+/* Previous scheme: every stage polls its flag and sleeps one tick */
+static void run_polling(int frames, int fps)
+{
+    sem_t terminate_req_sem;
+    sem_init(&terminate_req_sem, 0, 1);
+    std::atomic<uint8_t> inference_start(0), img_obj_ready(0);
+    std::vector<Clock::time_point> captured(frames);
+    std::vector<double> latency_us;
+    std::atomic<int> frame(-1);
+
+    std::thread inference([&] {
+        int32_t check = 1;
+        while (sem_getvalue(&terminate_req_sem, &check), 1 == check)
+        {
+            if (inference_start.load())
+            {
+                img_obj_ready.store(1);
+                inference_start.store(0);
+            }
+            usleep(WAIT_TIME);
+        }
+    });
+    std::thread main_stage([&] {
+        int32_t check = 1;
+        while (sem_getvalue(&terminate_req_sem, &check), 1 == check)
+        {
+            if (img_obj_ready.load())
+            {
+                latency_us.push_back(std::chrono::duration<double, std::micro>(
+                    Clock::now() - captured[frame.load()]).count());
+                img_obj_ready.store(0);
+            }
+            usleep(WAIT_TIME);
+        }
+    });
+
+    const double cpu0 = cpu_ms();
+    const auto t0 = Clock::now();
+    for (int f = 0; f < frames; f++)
+    {
+        std::this_thread::sleep_until(t0 + std::chrono::microseconds(1000000LL * f / fps));
+        if (!inference_start.load() && !img_obj_ready.load())
+        {
+            captured[f] = Clock::now();
+            frame.store(f);
+            inference_start.store(1);
+        }
+    }
+    const double wall = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    const double cpu = cpu_ms() - cpu0;
+    sem_trywait(&terminate_req_sem);
+    inference.join();
+    main_stage.join();
+    sem_destroy(&terminate_req_sem);
+    report("polling", latency_us, cpu, wall);
+}
+
+/* Stage graph: every stage blocks on its input event */
+static void run_events(int frames, int fps)
+{
+    sem_t terminate_req_sem;
+    sem_init(&terminate_req_sem, 0, 1);
+    StageGraph stages(&terminate_req_sem);
+    StageEvent inference_start(stages, "inference_start"), img_obj_ready(stages, "img_obj_ready");
+    std::vector<Clock::time_point> captured(frames);
+    std::vector<double> latency_us;
+    std::atomic<int> frame(-1);
+
+    std::thread inference([&] {
+        while (stages.running())
+        {
+            if (inference_start.wait_set())
+            {
+                img_obj_ready.store(1);
+                inference_start.store(0);
+            }
+        }
+    });
+    std::thread main_stage([&] {
+        while (stages.running())
+        {
+            if (img_obj_ready.wait_set())
+            {
+                latency_us.push_back(std::chrono::duration<double, std::micro>(
+                    Clock::now() - captured[frame.load()]).count());
+                img_obj_ready.store(0);
+            }
+        }
+    });
+
+    const double cpu0 = cpu_ms();
+    const auto t0 = Clock::now();
+    for (int f = 0; f < frames; f++)
+    {
+        std::this_thread::sleep_until(t0 + std::chrono::microseconds(1000000LL * f / fps));
+        if (!inference_start.load() && !img_obj_ready.load())
+        {
+            captured[f] = Clock::now();
+            frame.store(f);
+            inference_start.store(1);
+        }
+    }
+    const double wall = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    const double cpu = cpu_ms() - cpu0;
+    stages.shutdown();
+    inference.join();
+    main_stage.join();
+    sem_destroy(&terminate_req_sem);
+    report("events", latency_us, cpu, wall);
+}
+
+int main(int argc, char **argv)
+{
+    const int frames = (argc > 1) ? atoi(argv[1]) : 300;
+    const int fps    = (argc > 2) ? atoi(argv[2]) : 30;
+
+    run_polling(frames, fps);
+    run_events(frames, fps);
+    return 0;
+}
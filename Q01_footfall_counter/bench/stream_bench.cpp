@@ -0,0 +1,115 @@
+/***********************************************************************************************************************
+* File Name    : stream_bench.cpp
+* Description  : Host benchmark of the multi-camera scheduling of rzv_pipeline (stream_scheduler.h). 1 to 4 synthetic
+*                cameras give frames at a fixed rate to one inference thread that takes infer_ms per frame, with
+*                the round robin, weighted (stream 0 has weight 3) and deadline (stream 0 has a 40 ms deadline, the
+*                others 200 ms) policies. Reports the aggregate and per-stream inference rate, the capture to result
+*                latency and the frames replaced before inference.
+*                Usage: stream_bench [seconds] [camera_fps] [infer_ms]
+***********************************************************************************************************************/
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "stream_scheduler.h"
+
+/* VGA YUYV frame */
+using Frame = std::vector<uint8_t>;
+static const size_t FRAME_SIZE = 640 * 480 * 2;
+
+static void camera(StreamScheduler<Frame>& scheduler, int32_t index, double fps, std::atomic<bool>& running)
+{
+    Frame frame(FRAME_SIZE);
+    auto period = std::chrono::microseconds((int64_t)(1e6 / fps));
+    /* the cameras are not in phase */
+    auto next = std::chrono::steady_clock::now() + period * index / 4;
+    while (running.load())
+    {
+        std::this_thread::sleep_until(next);
+        next += period;
+        /* the first push gives back the empty buffer of the slot, the next ones a frame buffer */
+        if (frame.size() != FRAME_SIZE)
+        {
+            frame.resize(FRAME_SIZE);
+        }
+        frame[0] = (uint8_t)index;
+        scheduler.push(index, frame, scheduler.now_ms());
+    }
+}
+
+static void run(int32_t streams, StreamPolicy policy, double seconds, double fps, double infer_ms)
+{
+    StreamScheduler<Frame> scheduler(streams, policy);
+    if (StreamPolicy::WEIGHTED == policy)
+    {
+        scheduler.set_weight(0, 3);
+    }
+    if (StreamPolicy::DEADLINE == policy)
+    {
+        for (int32_t i = 0; i < streams; i++)
+        {
+            scheduler.set_deadline(i, (0 == i) ? 40.0 : 200.0);
+        }
+    }
+
+    std::atomic<bool> running(true);
+    std::thread inference([&] {
+        Frame frame;
+        int32_t index;
+        double capture_ms;
+        while (scheduler.pop(index, frame, capture_ms))
+        {
+            /* pre-process, DRP-AI and post-process of the frame */
+            std::this_thread::sleep_for(std::chrono::microseconds((int64_t)(infer_ms * 1000)));
+            scheduler.complete(index, capture_ms);
+        }
+    });
+    std::vector<std::thread> cameras;
+    for (int32_t i = 0; i < streams; i++)
+    {
+        cameras.emplace_back(camera, std::ref(scheduler), i, fps, std::ref(running));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds((int64_t)(seconds * 1000)));
+    running.store(false);
+    for (std::thread& t : cameras)
+    {
+        t.join();
+    }
+    scheduler.close();
+    inference.join();
+
+    double total = 0;
+    for (int32_t i = 0; i < streams; i++)
+    {
+        total += scheduler.get_stats(i).fps();
+    }
+    printf("%d camera(s) %-11s total %6.1f fps\n", streams, stream_policy_name(policy), total);
+    for (int32_t i = 0; i < streams; i++)
+    {
+        StreamStats st = scheduler.get_stats(i);
+        printf("    stream %d %6.1f fps  latency mean %6.1f max %6.1f ms  dropped %5.1f %%  late %llu\n", i,
+               st.fps(), st.mean_latency(), st.latency_max,
+               (0 < st.pushed) ? 100.0 * st.dropped / st.pushed : 0.0, (unsigned long long)st.late);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = (argc > 1) ? std::atof(argv[1]) : 2.0;
+    double fps = (argc > 2) ? std::atof(argv[2]) : 30.0;
+    double infer_ms = (argc > 3) ? std::atof(argv[3]) : 12.0;
+
+    printf("%.0f s per run, cameras at %.0f fps, %.1f ms per inference (at most %.1f fps)\n",
+           seconds, fps, infer_ms, 1000.0 / infer_ms);
+    for (int32_t streams = 1; streams <= 4; streams++)
+    {
+        for (StreamPolicy policy : { StreamPolicy::ROUND_ROBIN, StreamPolicy::WEIGHTED, StreamPolicy::DEADLINE })
+        {
+            run(streams, policy, seconds, fps, infer_ms);
+        }
+    }
+    return 0;
+}
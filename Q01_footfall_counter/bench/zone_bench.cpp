@@ -0,0 +1,139 @@
+/***********************************************************************************************************************
+* File Name    : zone_bench.cpp
+* Description  : Host microbenchmark of the multi-zone counting engine. Random lines and polygons, tracks doing a
+*                random walk over the frame; checks the preprocessed point in polygon test against a plain crossing
+*                test over all edges, then times one frame of zones x tracks.
+*                Usage: zone_bench [zones] [tracks] [frames]
+***********************************************************************************************************************/
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "zone_counter.h"
+
+/* Capture resolution of the application */
+#define SCENE_W     (640)
+#define SCENE_H     (480)
+
+/* Reference point in polygon, every edge is visited */
+static bool naive_inside(const std::vector<ZonePoint>& pts, ZonePoint p)
+{
+    bool inside = false;
+    const size_t n = pts.size();
+    for (size_t i = 0; i < n; i++)
+    {
+        const ZonePoint& a = pts[i];
+        const ZonePoint& b = pts[(i + 1) % n];
+        if ((a.y > p.y) != (b.y > p.y))
+        {
+            const double x = a.x + (double)(b.x - a.x) * (p.y - a.y) / (b.y - a.y);
+            if (p.x < x)
+            {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+/* Star shaped polygon around a random centre, so that it does not self intersect */
+static std::vector<ZonePoint> make_polygon(std::mt19937& rng)
+{
+    std::uniform_int_distribution<int> vertices(4, 16);
+    std::uniform_real_distribution<float> cx(80.0f, SCENE_W - 80.0f), cy(80.0f, SCENE_H - 80.0f);
+    std::uniform_real_distribution<float> radius(20.0f, 80.0f);
+    const int n = vertices(rng);
+    const float x = cx(rng), y = cy(rng);
+    std::vector<ZonePoint> pts(n);
+    for (int i = 0; i < n; i++)
+    {
+        const float a = 2.0f * (float)M_PI * i / n;
+        const float r = radius(rng);
+        pts[i] = { (int32_t)(x + r * std::cos(a)), (int32_t)(y + r * std::sin(a)) };
+    }
+    return pts;
+}
+
+int main(int argc, char **argv)
+{
+    const int zones  = (argc > 1) ? atoi(argv[1]) : 32;
+    const int tracks = (argc > 2) ? atoi(argv[2]) : 200;
+    const int frames = (argc > 3) ? atoi(argv[3]) : 2000;
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> px(0, SCENE_W - 1), py(0, SCENE_H - 1);
+
+    ZoneCounter counter;
+    for (int z = 0; z < zones; z++)
+    {
+        if (z % 2 == 0)
+        {
+            counter.AddLine("line_" + std::to_string(z), { px(rng), py(rng) }, { px(rng), py(rng) }, 2);
+        }
+        else
+        {
+            counter.AddPolygon("region_" + std::to_string(z), make_polygon(rng), 2);
+        }
+    }
+
+    /* Correctness of the grid and edge tables */
+    long checked = 0, mismatch = 0;
+    for (int z = 0; z < zones; z++)
+    {
+        const Zone& zone = counter.GetZones()[z];
+        if (zone.type != kZonePolygon)
+        {
+            continue;
+        }
+        for (int y = 0; y < SCENE_H; y++)
+        {
+            for (int x = 0; x < SCENE_W; x++)
+            {
+                checked++;
+                mismatch += (counter.Inside(z, { x, y }) != naive_inside(zone.points, { x, y }));
+            }
+        }
+    }
+    printf("[INFO] Point in polygon: %ld points, %ld mismatches\n", checked, mismatch);
+
+    /* Random walk of the tracks */
+    std::normal_distribution<float> step(0.0f, 4.0f);
+    std::vector<float> x(tracks), y(tracks);
+    for (int t = 0; t < tracks; t++)
+    {
+        x[t] = (float)px(rng);
+        y[t] = (float)py(rng);
+    }
+
+    double total_us = 0.0;
+    for (int f = 0; f < frames; f++)
+    {
+        for (int t = 0; t < tracks; t++)
+        {
+            x[t] = std::min((float)SCENE_W - 1, std::max(0.0f, x[t] + step(rng)));
+            y[t] = std::min((float)SCENE_H - 1, std::max(0.0f, y[t] + step(rng)));
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        counter.BeginFrame((int64_t)f * 33);
+        for (int t = 0; t < tracks; t++)
+        {
+            counter.Update(t, { (int32_t)x[t], (int32_t)y[t] });
+        }
+        counter.EndFrame();
+        total_us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    uint64_t cursor = 0;
+    std::vector<ZoneEvent> events;
+    counter.ReadEvents(cursor, events);
+    long crossings = 0;
+    for (const Zone& zone : counter.GetZones())
+    {
+        crossings += zone.count_in + zone.count_out;
+    }
+    printf("[INFO] %d zones x %d tracks: %.2f us/frame, %ld crossings, last %zu events kept\n",
+           zones, tracks, total_us / frames, crossings, events.size());
+    return (mismatch == 0) ? 0 : 1;
+}
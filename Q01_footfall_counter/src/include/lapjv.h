@@ -0,0 +1,51 @@
+/**
+ * @desc:   Jonker-Volgenant linear assignment (LAPJV) on a flat cost array, and
+ *          IoU association gated into independent connected components.
+ *          R. Jonker and A. Volgenant, "A shortest augmenting path algorithm for
+ *          dense and sparse linear assignment problems", Computing 38, 1987.
+ */
+#pragma once
+
+#include <utility>
+#include <vector>
+
+class LapJV {
+public:
+    LapJV() = default;
+    ~LapJV() = default;
+
+    /**
+     * Minimum cost assignment of a square problem
+     * @param n        number of rows and columns
+     * @param cost     n x n costs, row major
+     * @param row_sol  out, assigned column of each row (n values)
+     * @return total cost of the assignment
+     */
+    float Solve(int n, const float *cost, int *row_sol);
+
+    /**
+     * Maximum IoU one to one association between rows and columns.
+     * Only pairs with positive IoU can be matched, so rows and columns are first
+     * split into connected components over those pairs and every component is
+     * solved on its own; most components in a tracking scene are 1x1.
+     * @param iou      rows x cols IoU values, row major
+     * @param rows     number of rows (detections)
+     * @param cols     number of columns (tracks)
+     * @param min_iou  matched pairs below this IoU are dropped
+     * @param matches  out, (row, col) pairs
+     */
+    void AssociateIou(const float *iou, int rows, int cols, float min_iou,
+                      std::vector<std::pair<int, int>> &matches);
+
+private:
+    int FindRoot(int node);
+
+    // LAPJV workspace, reused across calls
+    std::vector<int> col_sol_, free_, col_list_, assign_count_, pred_;
+    std::vector<float> v_, d_;
+
+    // Component workspace: union-find parent over rows then columns,
+    // members of each component bucketed by root
+    std::vector<int> parent_, row_start_, col_start_, cursor_, comp_rows_, comp_cols_, row_sol_;
+    std::vector<float> sub_cost_;
+};
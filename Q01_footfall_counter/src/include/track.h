@@ -1,10 +1,13 @@
 #pragma once
 
 #include <opencv2/core.hpp>
-#include "kalman_filter.h"
+#include "fixed_kalman_filter.h"
 
 class Track {
 public:
+    // state - center_x, center_y, width, height, v_cx, v_cy, v_width, v_height
+    using Filter = FixedKalmanFilter<8, 4>;
+
     // Constructor
     Track();
 
@@ -13,15 +16,17 @@ public:
 
     void Init(const cv::Rect& bbox);
     void Predict();
+    void Coast();
     void Update(const cv::Rect& bbox);
     cv::Rect GetStateAsBbox() const;
     float GetNIS() const;
+    float GetPositionVariance() const;
 
     int coast_cycles_ = 0, hit_streak_ = 0;
 
 private:
-    Eigen::VectorXd ConvertBboxToObservation(const cv::Rect& bbox) const;
-    cv::Rect ConvertStateToBbox(const Eigen::VectorXd &state) const;
+    void ConvertBboxToObservation(const cv::Rect& bbox, float *observation) const;
+    cv::Rect ConvertStateToBbox(const float *state) const;
 
-    KalmanFilter kf_;
+    Filter kf_;
 };
@@ -1,46 +1,112 @@
 #pragma once
 
-#include <map>
+#include <cstdint>
 #include <opencv2/core.hpp>
 
 #include "track.h"
-#include "munkres.h"
+#include "lapjv.h"
 #include "utils.h"
 
+/**
+ * Stable reference to a track. The slot is reused after the track is deleted,
+ * the generation tells a stale handle apart from the new occupant.
+ */
+struct TrackHandle {
+    uint32_t slot;
+    uint32_t generation;
+};
+
+/**
+ * One live track: its display ID, handle and filter state
+ */
+struct TrackEntry {
+    int id;
+    TrackHandle handle;
+    Track track;
+};
+
+/**
+ * Read-only view over the live tracks, valid until the next Tracker::Run
+ */
+class TrackSpan {
+public:
+    TrackSpan(const TrackEntry *data, size_t size) : data_(data), size_(size) {}
+
+    const TrackEntry *begin() const { return data_; }
+    const TrackEntry *end() const { return data_ + size_; }
+    const TrackEntry &operator[](size_t i) const { return data_[i]; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    const TrackEntry *data_;
+    size_t size_;
+};
+
 class Tracker {
 public:
     Tracker();
     ~Tracker() = default;
 
-    static float CalculateIou(const cv::Rect& det, const Track& track);
-
-    static void HungarianMatching(const std::vector<std::vector<float>>& iou_matrix,
-                           size_t nrows, size_t ncols,
-                           std::vector<std::vector<float>>& association);
+    static float CalculateIou(const cv::Rect& det, const cv::Rect& trk);
 
 /**
  * Assigns detections to tracked object (both represented as bounding boxes)
- * Returns 2 lists of matches, unmatched_detections
+ * Fills matched_ with (detection, dense track index) pairs and unmatched_det_
+ * with the remaining detections
  * @param detection
- * @param tracks
- * @param matched
- * @param unmatched_det
  * @param iou_threshold
  */
-    static void AssociateDetectionsToTrackers(const std::vector<cv::Rect>& detection,
-                                       std::map<int, Track>& tracks,
-                                       std::map<int, cv::Rect>& matched,
-                                       std::vector<cv::Rect>& unmatched_det,
+    void AssociateDetectionsToTrackers(const std::vector<cv::Rect>& detection,
                                        float iou_threshold = 0.3);
 
     void Run(const std::vector<cv::Rect>& detections);
 
-    std::map<int, Track> GetTracks();
+    /**
+     * Move every track to the next frame without detections, for frames on
+     * which the detector was skipped
+     */
+    void Coast();
+
+    /**
+     * @return number of tracks that were not matched by the last Run
+     */
+    int GetLostCount() const;
+
+    /**
+     * @return largest centre position variance over the tracks
+     */
+    float GetMaxPositionVariance() const;
+
+    TrackSpan GetTracks() const;
+
+    /**
+     * @param handle
+     * @return the track, or nullptr if it has been deleted since the handle was taken
+     */
+    const Track *Find(TrackHandle handle) const;
 
 private:
-    // Hash-map between ID and corresponding tracker
-    std::map<int, Track> tracks_;
+    TrackHandle Insert(const Track& track);
+    void Erase(size_t dense_index);
+
+    // Generational slot map: tracks are stored densely, slots map a handle to its dense index
+    struct Slot {
+        uint32_t dense_index;
+        uint32_t generation;
+    };
+    std::vector<TrackEntry> tracks_;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_slots_;
 
     // Assigned ID for each bounding box
     int id_;
-};
\ No newline at end of file
+
+    // Assignment solver and per-frame scratch, reused across frames
+    LapJV lap_;
+    std::vector<float> iou_matrix_;
+    std::vector<cv::Rect> track_boxes_;
+    std::vector<std::pair<int, int>> matched_;
+    std::vector<char> det_matched_;
+    std::vector<cv::Rect> unmatched_det_;
+};
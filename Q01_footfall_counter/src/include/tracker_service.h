@@ -0,0 +1,126 @@
+/**
+ * @desc:   Independent tracker instances keyed by stream ID, updated on a
+ *          small worker pool. Updates of one stream run in submission order,
+ *          one at a time; different streams run in parallel.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "tracker.h"
+
+/**
+ * Per stream settings
+ *   kmin    : hits before a track is reported
+ *   conf    : detections below this score are ignored
+ *   classes : class IDs that are tracked, all when empty
+ */
+struct TrackerConfig {
+    int kmin;
+    float conf;
+    std::vector<int> classes;
+};
+
+struct TrackerDetection {
+    cv::Rect box;
+    int class_id;
+    float prob;
+};
+
+struct TrackedObject {
+    int id;
+    cv::Rect box;
+};
+
+/**
+ * Snapshot of a stream after one update
+ */
+struct TrackerResult {
+    // sequence number of the update, as returned by Submit
+    uint64_t seq;
+    // confirmed tracks (kmin hits, not coasting)
+    std::vector<TrackedObject> objects;
+    // tracks that were not matched by the last detection
+    int lost_count;
+    // largest centre position variance over the tracks
+    float max_variance;
+};
+
+class TrackerService {
+public:
+    explicit TrackerService(int workers = 2);
+    ~TrackerService();
+
+    TrackerService(const TrackerService&) = delete;
+    TrackerService& operator=(const TrackerService&) = delete;
+
+    /**
+     * Create the tracker of a stream, or reset it with a new config. A reset
+     * keeps the stream and its sequence numbers, callers blocked in Wait stay valid
+     */
+    void AddStream(int stream, const TrackerConfig& config);
+
+    /**
+     * Queue an update with the detections of a frame
+     * @return sequence number of the update, 0 if the stream does not exist
+     */
+    uint64_t Submit(int stream, const std::vector<TrackerDetection>& detections);
+
+    /**
+     * Queue an update for a frame on which the detector was skipped, the
+     * tracks are moved by prediction only
+     */
+    uint64_t SubmitCoast(int stream);
+
+    /**
+     * Block until update seq of the stream has run, then copy its result
+     * @return false if the stream does not exist or the service is stopping
+     */
+    bool Wait(int stream, uint64_t seq, TrackerResult& result);
+
+    /**
+     * Result of the last update that ran, without waiting
+     */
+    bool Latest(int stream, TrackerResult& result);
+
+    int NumWorkers() const { return (int)workers_.size(); }
+
+private:
+    struct Job {
+        uint64_t seq;
+        bool coast;
+        std::vector<TrackerDetection> detections;
+    };
+
+    struct Stream {
+        TrackerConfig config;
+        Tracker tracker;
+        // pending updates, and whether the stream is in ready_ or held by a worker
+        std::deque<Job> jobs;
+        bool scheduled;
+        uint64_t next_seq;
+        TrackerResult result;
+        // worker scratch
+        std::vector<cv::Rect> boxes;
+    };
+
+    uint64_t Enqueue(int stream, Job&& job);
+    void WorkerLoop();
+    static void Process(Stream& s, const Job& job, TrackerResult& result);
+
+    std::map<int, std::unique_ptr<Stream>> streams_;
+    std::deque<Stream *> ready_;
+    std::mutex mtx_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    bool stop_;
+    std::vector<std::thread> workers_;
+};
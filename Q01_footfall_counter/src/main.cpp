@@ -44,7 +44,10 @@ int32_t main(int32_t argc, char* argv[])
     
 
     g_rc = new RecognizeBase();
-    g_rc->initialize(new TVM_YOLO_DRPAI(MODE_TVM_TINYYOLOV3_DRPAI));    /* MODEL: TINYYOLOV3*/
+    if (0 != g_rc->initialize(new TVM_YOLO_DRPAI(MODE_TVM_TINYYOLOV3_DRPAI)))    /* MODEL: TINYYOLOV3*/
+    {
+        return -1;
+    }
     g_rc->recognize_start();
     g_rc->start_recognize();
 }
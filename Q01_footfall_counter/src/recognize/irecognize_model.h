@@ -34,6 +34,7 @@
 #include "common/recognize_define.h"
 
 #include "common/box.h"
+#include "thread_sched.h"
 
 using namespace std;
 
@@ -61,6 +62,12 @@ public:
     virtual int32_t inf_post_process(float* arg) { return 0; }
     virtual int32_t print_result() { return 0; }
     virtual shared_ptr<PredictNotifyBase> track() { return NULL; }
+    /* Detect-every-N-frames mode: when false the next frame skips DRP-AI and goes to
+       inf_skip_process() and track() only */
+    virtual bool detect_required() { return true; }
+    virtual int32_t inf_skip_process(uint8_t* input_data, uint32_t width, uint32_t height) { return 0; }
+    /* Release the threads waiting on the model, called before they are joined */
+    virtual void stop() {}
 
     /* for recognize proc*/
     string model_dir;
@@ -73,7 +80,11 @@ public:
     int32_t _model_h;
     int32_t _model_c;
     uint8_t _id;
+    /* Set by the constructor when the model cannot run, e.g. on a malformed config.ini */
+    bool _init_failed = false;
     /* Only for pre face detection. post-processing result */
     std::vector<detection> detected_data;
+    /* CPU affinity and scheduling of the application threads, [thread] section of config.ini */
+    ThreadSchedConfig thread_sched;
 };
 #endif
@@ -149,6 +149,11 @@ int32_t RecognizeBase::initialize(IRecognizeModel *model)
 {
     std::cout << "############ INIT ############" << std::endl;
     _model = shared_ptr<IRecognizeModel>(move(model));
+    if (_model->_init_failed)
+    {
+        fprintf(stderr, "[ERROR] Failed to initialize the model.\n");
+        return -1;
+    }
     std::cout << "[INFO] Model     :" << _model->model_name << std::endl;
     std::cout << "[INFO] Directory :" << _model->model_dir << std::endl;
     std::cout << "[INFO] outbuff   :" << _model->outBuffSize << std::endl;
@@ -187,6 +192,9 @@ int32_t RecognizeBase::recognize_start()
     }
     wake_ = false;
     capture_enabled.store(true);
+    /* thread affinity and scheduling of config.ini */
+    _model->thread_sched.print();
+    _model->thread_sched.lock_memory();
     /* capture thread */
     _capture_running = true;
     int32_t create_thread_cap = pthread_create(&_pthread_capture, NULL, capture_thread, this);
@@ -195,6 +203,7 @@ int32_t RecognizeBase::recognize_start()
         fprintf(stderr, "[ERROR] Failed to create Capture Thread.\n");
         return -1;
     }
+    _model->thread_sched.apply(_pthread_capture, "capture");
 #ifdef INFERENE_ON
     /* inference thread */
     _inf_running = true;
@@ -208,6 +217,7 @@ int32_t RecognizeBase::recognize_start()
         fprintf(stderr, "[ERROR] Failed to create AI Inference Thread.\n");
         return -1;
     }
+    _model->thread_sched.apply(_pthread_ai_inf, "inference");
 #endif // INFERENE_ON
     /* framerate thread */
     _fps_runnning = true;
@@ -217,6 +227,7 @@ int32_t RecognizeBase::recognize_start()
         fprintf(stderr, "[ERROR] Failed to create Framerate Thread.\n");
         return -1;
     }
+    _model->thread_sched.apply(_pthread_framerate, "framerate");
     return 0;
 }
 /**
@@ -424,6 +435,19 @@ void *RecognizeBase::tvm_inference_thread(void *arg)
                          { return me->wake_; });
             me->wake_ = false;
         }
+        /*Detector skipped on this frame, the model tracks on its own*/
+        if (!me->_model->detect_required())
+        {
+            me->_model->inf_skip_process(me->input_data, me->cap_w, me->cap_h);
+            ret = capture->inference_capture_qbuf();
+            if (0 != ret)
+            {
+                fprintf(stderr, "[ERROR] Failed to enqueue _capture buffer.\n");
+                break;
+            }
+            me->capture_enabled.store(true); /* Flag for _capture Thread. */
+            continue;
+        }
         /*Pre-process*/
         me->get_time(start_time);
         me->inference_preprocess(arg, me->mode, me->cap_w, me->cap_h, &pre_output_ptr, &out_size);
@@ -505,12 +529,8 @@ void *RecognizeBase::tvm_inference_thread(void *arg)
         data.predict_result = move(drpai_output_buf);
         data.inf_time_ms = ai_time;
         data.preproc_time_ms = preproc_time;
-        /*Post-process start (AI inference result postprocess + image compress + JSON data sending)*/
+        /*Post-process start, the display thread collects the tracking result in send_result*/
         me->inference_postprocess(arg, me->mode, data);
-        {
-            /*Image compress + JSON data sending*/
-            me->send_result(arg, me->mode, data);
-        }
         Measuretime m("Deque inference_capture_qbuf buf time");
         ret = capture->inference_capture_qbuf();
         if (0 != ret)
@@ -626,7 +646,8 @@ void RecognizeBase::send_result(void *arg, uint8_t model_id, recognizeData_t &da
         Measuretime m("Create predict result time");
         notify = _model->track();
     }
-    if(cv::waitKey(30) == 27) // integer 13 = key Enter 
+    /*the key is polled, and the window refreshed, once per frame shown*/
+    if ((NULL != notify) && (cv::waitKey(1) == 27)) // integer 27 = key Esc
     {
         cv::destroyAllWindows();
         recognize_end();
@@ -646,6 +667,7 @@ int32_t RecognizeBase::end_all_threads()
     _capture_running = false;
     _inf_running = false;
     _fps_runnning = false;
+    _model->stop();
     if (0 != _pthread_capture)
     {
         ret = wait_join(&_pthread_capture, CAPTURE_TIMEOUT);
@@ -794,8 +816,11 @@ void RecognizeBase::start_recognize()
 void RecognizeBase::predict_thread()
 {
     blRunPredict = true;
-    pthread_create(&thPredict, NULL, &predict_thread_wrapper, this);
-    pthread_join(thPredict, NULL);
+    if (0 == pthread_create(&thPredict, NULL, &predict_thread_wrapper, this))
+    {
+        _model->thread_sched.apply(thPredict, "display");
+        pthread_join(thPredict, NULL);
+    }
 }
 /**
  * @brief thread wrapper
@@ -815,9 +840,11 @@ void *RecognizeBase::predict_thread_wrapper(void *object)
  */
 void RecognizeBase::run_predict(RecognizeBase *arg)
 {
+    recognizeData_t data;
     while (arg->blRunPredict)
     {
-        usleep(100000);
+        /*display stage, shows each frame once its tracker update has run*/
+        arg->send_result(arg, arg->mode, data);
     }
     std::cout << "All Finish" << std::endl;
 }
@@ -34,7 +34,8 @@
 #include "boost/filesystem.hpp"
 #include "utils.h"
 #include "map"
-#include "tracker.h"
+#include "tracker_service.h"
+#include "zone_counter.h"
 #include "random"
 #include "chrono"
 #include "ctime"
@@ -44,30 +45,84 @@
 #include <sstream>
 #include <string>
 #include <unordered_map>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 using namespace cv;
 using std::chrono::duration_cast;
 using std::chrono::milliseconds;
 using std::chrono::system_clock;
-Tracker tracker;
+/* tracker of the camera stream, updated on the tracker worker threads */
+constexpr int kStreamId = 0;
+std::unique_ptr<TrackerService> tracker_service;
+uint64_t track_seq = 0;
+/* tracking result of the frame shown, display thread only */
+TrackerResult track_result = {};
+/* frames handed from the inference thread to the display thread, which collects their tracking result */
+struct OutputFrame
+{
+    Mat image;
+    uint64_t seq;
+};
+constexpr size_t kOutputDepth = 2;
+std::deque<OutputFrame> output_frames;
+std::mutex output_mtx;
+std::condition_variable output_cv;
+bool output_stopped = false;
 int total_count = 0;
 int kmin;
 float conf;
 int crossing_count = 0;
-int pointx1, pointy1, pointx2, pointy2, actual_count = 0;
+int actual_count = 0;
 long int start_time, end_time;
 bool init = true;
-set<int> unique_ids = {};
-long int time_one;
-long int infer_time_ms;
-map<int, int> id_time;
-set<int> unique_id_entrance = {};
-map<int, int> location_history;
+long int infer_time_ms = 1;
+/* counting lines and regions from config.ini */
+ZoneCounter zone_counter;
+int line_zone = -1;
+int region_zone = -1;
 std::unordered_map<std::string, std::unordered_map<std::string, std::string>> ini_values;
 std::vector<string> detection_object_vector;
-std::vector<cv::Rect> bbox;
-vector<cv::Point> polygon;
+std::vector<TrackerDetection> detections;
+/* frame converted by the inference thread, handed over by push_output */
 Mat bgra_image;
 
+/**
+ * @brief push_output
+ * @details Hand the converted frame and its tracker update to the display thread.
+ * @details Blocks while the display thread is kOutputDepth frames behind.
+ * @param seq sequence number of the tracker update of the frame
+ */
+static void push_output(uint64_t seq)
+{
+    unique_lock<mutex> lock(output_mtx);
+    output_cv.wait(lock, []
+                   { return output_stopped || output_frames.size() < kOutputDepth; });
+    if (output_stopped)
+        return;
+    output_frames.push_back({bgra_image, seq});
+    output_cv.notify_all();
+}
+/**
+ * @brief pop_output
+ * @details Take the oldest frame handed over by the inference thread.
+ * @param out frame
+ * @param timeout_ms time to wait for a frame
+ * @return bool false on timeout or once stopped
+ */
+static bool pop_output(OutputFrame &out, int timeout_ms)
+{
+    unique_lock<mutex> lock(output_mtx);
+    if (!output_cv.wait_for(lock, milliseconds(timeout_ms), []
+                            { return output_stopped || !output_frames.empty(); }) ||
+        output_stopped)
+        return false;
+    out = std::move(output_frames.front());
+    output_frames.pop_front();
+    output_cv.notify_all();
+    return true;
+}
+
 /**
  * @brief config_read
  * @details Read configuration from the config.ini file
@@ -152,18 +207,18 @@ TVM_YOLO_DRPAI::TVM_YOLO_DRPAI(uint8_t id) : IRecognizeModel(0, TVM_MODEL_DIR_YO
     outBuffSize = num_inf_out;
     /*Initialize tracking/detection paramters*/
     config_read();
-    /*set point 1*/
-    pointx1 = stoi(ini_values["line"]["x1"]);
-    pointy1 = stoi(ini_values["line"]["y1"]);
-    /*set point 2*/
-    pointx2 = stoi(ini_values["line"]["x2"]);
-    pointy2 = stoi(ini_values["line"]["y2"]);
-    /*set region of interest*/
-    polygon = {
-        Point(stoi(ini_values["region"]["x1"]), stoi(ini_values["region"]["y1"])),
-        Point(stoi(ini_values["region"]["x2"]), stoi(ini_values["region"]["y2"])),
-        Point(stoi(ini_values["region"]["x3"]), stoi(ini_values["region"]["y3"])),
-        Point(stoi(ini_values["region"]["x4"]), stoi(ini_values["region"]["y4"]))};
+    /*set counting lines and regions of interest*/
+    if (zone_counter.LoadConfig(ini_values) < 0)
+    {
+        fprintf(stderr, "[ERROR] Failed to load the [line] and [region] sections\n");
+        _init_failed = true;
+        return;
+    }
+    /*[line] and [region] are the ones shown as counts*/
+    line_zone = zone_counter.FindZone("line");
+    region_zone = zone_counter.FindZone("region");
+    if (ini_values["tracking"].count("event_log"))
+        zone_counter.OpenLog(ini_values["tracking"]["event_log"]);
     /*set confidence score*/
     conf = stof(ini_values["tracking"]["conf"]);
     /*set kmin hits for tracking */
@@ -180,8 +235,34 @@ TVM_YOLO_DRPAI::TVM_YOLO_DRPAI(uint8_t id) : IRecognizeModel(0, TVM_MODEL_DIR_YO
     cout << "Selected objects to track\n";
     for (const auto &item : detection_object_vector)
         cout << item << endl;
+    /*detect-every-N-frames mode, optional keys*/
+    if (ini_values["tracking"].count("detect_interval"))
+        detect_interval = std::max(1, stoi(ini_values["tracking"]["detect_interval"]));
+    if (ini_values["tracking"].count("detect_max_lost"))
+        detect_max_lost = stoi(ini_values["tracking"]["detect_max_lost"]);
+    if (ini_values["tracking"].count("detect_max_var"))
+        detect_max_var = stof(ini_values["tracking"]["detect_max_var"]);
+    /*tracker of the camera stream*/
+    TrackerConfig tracker_config;
+    tracker_config.kmin = kmin;
+    tracker_config.conf = conf;
+    for (const auto &item : detection_object_vector)
+    {
+        auto it = find(label_file_map.begin(), label_file_map.end(), item);
+        if (it != label_file_map.end())
+            tracker_config.classes.push_back((int)(it - label_file_map.begin()));
+    }
+    int tracker_workers = 2;
+    if (ini_values["tracking"].count("workers"))
+        tracker_workers = std::max(1, stoi(ini_values["tracking"]["workers"]));
+    /*thread affinity and scheduling, optional section*/
+    thread_sched.read(ini_values["thread"]);
+    tracker_service.reset(new TrackerService(tracker_workers));
+    tracker_service->AddStream(kStreamId, tracker_config);
     cout << "Confidence Score : " << conf << endl;
     cout << "KMin Hits : " << kmin << endl;
+    cout << "Tracker Workers : " << tracker_workers << endl;
+    cout << "Detect Interval : " << detect_interval << endl;
 }
 
 /**
@@ -207,17 +288,83 @@ int32_t TVM_YOLO_DRPAI::inf_pre_process(uint8_t *input_data, uint32_t width, uin
         in_param.pre_in_shape_w = _capture_w;
         in_param.pre_in_shape_h = _capture_h;
     }
-    cv::Mat yuyv_image(height, width, CV_8UC2, (void *)input_data);
-    cv::cvtColor(yuyv_image, bgra_image, cv::COLOR_YUV2BGRA_YUYV);
-    cv::line(bgra_image, Point(pointx1, pointy1), Point(pointx2, pointy2), Scalar(0, 0, 255), 4);
-    cv::putText(bgra_image, "human count: " + to_string(actual_count), Point(30, 30), FONT_HERSHEY_DUPLEX, 1.0, Scalar(255, 0, 0), 2);
-    cv::putText(bgra_image, "person in region: " + to_string(crossing_count), Point(30, 50), FONT_HERSHEY_DUPLEX, 1.0, Scalar(255, 0, 0), 2);
-    cv::putText(bgra_image, "FPS:" + to_string(1000 / infer_time_ms), Point(540, 30), FONT_HERSHEY_DUPLEX, 1.0, Scalar(255, 0, 0), 2);
-    cv::polylines(bgra_image, polygon, true, Scalar(0, 255, 0), 2);
-    cv::imshow("Object Tracker", bgra_image);
+    convert_frame(input_data, width, height);
     pre_process_drpai(addr, arg, buf_size);
     return 0;
 }
+/**
+ * @brief inf_skip_process
+ * @details Prepare a frame on which the detector is skipped, the tracker
+ * @details moves the tracks by Kalman prediction only.
+ * @param input_data Input data pointer
+ * @param width input data width.
+ * @param height input data width.
+ * @return int32_t success:0 error: != 0
+ */
+int32_t TVM_YOLO_DRPAI::inf_skip_process(uint8_t *input_data, uint32_t width, uint32_t height)
+{
+    convert_frame(input_data, width, height);
+    /*detector skipped on this frame, extrapolate the tracks*/
+    track_seq = tracker_service->SubmitCoast(kStreamId);
+    frames_since_detect++;
+    push_output(track_seq);
+    return 0;
+}
+/**
+ * @brief detect_required
+ * @details Decide whether the next frame runs the detector. It runs every
+ * @details detect_interval frames, or earlier when the tracks became unreliable.
+ * @details The tracks are judged on the last tracker update that ran.
+ * @return bool true to run DRP-AI on the next frame
+ */
+bool TVM_YOLO_DRPAI::detect_required()
+{
+    if (detect_interval <= 1 || frames_since_detect + 1 >= detect_interval)
+        return true;
+    TrackerResult latest;
+    if (!tracker_service->Latest(kStreamId, latest))
+        return true;
+    if (detect_max_lost > 0 && latest.lost_count >= detect_max_lost)
+        return true;
+    if (detect_max_var > 0 && latest.max_variance > detect_max_var)
+        return true;
+    return false;
+}
+/**
+ * @brief convert_frame
+ * @details Convert the camera frame for display. The capture buffer is given back
+ * @details before the frame is shown, so each frame gets its own image.
+ * @param input_data Input data pointer
+ * @param width input data width.
+ * @param height input data width.
+ */
+void TVM_YOLO_DRPAI::convert_frame(uint8_t *input_data, uint32_t width, uint32_t height)
+{
+    cv::Mat yuyv_image(height, width, CV_8UC2, (void *)input_data);
+    bgra_image = cv::Mat();
+    cv::cvtColor(yuyv_image, bgra_image, cv::COLOR_YUV2BGRA_YUYV);
+}
+/**
+ * @brief draw_zones
+ * @details Draw the counting lines and regions and the counts.
+ * @param image frame to draw on
+ */
+static void draw_zones(Mat &image)
+{
+    for (const Zone &zone : zone_counter.GetZones())
+    {
+        vector<cv::Point> points;
+        for (const ZonePoint &p : zone.points)
+            points.emplace_back(p.x, p.y);
+        if (zone.type == kZoneLine)
+            cv::line(image, points[0], points[1], Scalar(0, 0, 255), 4);
+        else
+            cv::polylines(image, points, true, Scalar(0, 255, 0), 2);
+    }
+    cv::putText(image, "human count: " + to_string(actual_count), Point(30, 30), FONT_HERSHEY_DUPLEX, 1.0, Scalar(255, 0, 0), 2);
+    cv::putText(image, "person in region: " + to_string(crossing_count), Point(30, 50), FONT_HERSHEY_DUPLEX, 1.0, Scalar(255, 0, 0), 2);
+    cv::putText(image, "FPS:" + to_string(1000 / std::max(infer_time_ms, 1L)), Point(540, 30), FONT_HERSHEY_DUPLEX, 1.0, Scalar(255, 0, 0), 2);
+}
 /**
  * @brief inf_post_process
  * @details Run post-processing
@@ -228,6 +375,18 @@ int32_t TVM_YOLO_DRPAI::inf_post_process(float *arg)
 {
     postproc_data.clear();
     post_process(postproc_data, arg);
+    /*hand the detections to the tracker workers, track() collects the result*/
+    detections.clear();
+    for (const detection &det : postproc_data)
+    {
+        detections.push_back({cv::Rect((int32_t)(det.bbox.x - (det.bbox.w / 2)), (int32_t)(det.bbox.y - (det.bbox.h / 2)),
+                                       (int32_t)det.bbox.w, (int32_t)det.bbox.h),
+                              det.c, det.prob});
+    }
+    track_seq = tracker_service->Submit(kStreamId, detections);
+    frames_since_detect = 0;
+    /*the inference thread goes on with the next frame while the tracker runs*/
+    push_output(track_seq);
     return 0;
 }
 /**
@@ -241,157 +400,67 @@ int32_t TVM_YOLO_DRPAI::print_result()
     return 0;
 }
 /**
- * @brief check_above_or_below
- * @details check the given point is above or below the line,
- * @details added a small value of 1e-8 to avoid division by zero
- * @param x x coordinate of the point
- * @param y y coordinate of the point
- * @return int location of the point w.r.t the line
- */
-int check_above_or_below(int x, int y)
-{
-    double m = (pointy2 - pointy1) / ((pointx2 - pointx1) + 0.00000006);
-    double yline = m * (x - pointx1) + pointy1;
-    if (y > yline)
-        return 1;
-    else
-        return 0;
-}
-/**
- * @brief check_inside_rectangle
- * @details check the given point is inside the region difined using the polygon,
- * @param x x coordinate of the point
- * @param y y coordinate of the point
- * @return bool location of the point w.r.t the line
- */
-bool check_inside_rectangle(int x, int y)
-{
-    int result = pointPolygonTest(polygon, Point(x, y), false);
-    if (result == 1)
-        return 1;
-    else
-        return 0;
-}
-/**
- * @brief check_inside_rectangle
- * @details check the given point is inside the region difined using the polygon,
- * @param x x coordinate of the point
- * @param y y coordinate of the point
- * @return bool location of the point w.r.t the line
+ * @brief track
+ * @details Display stage: collect the tracker update of the oldest frame handed
+ * @details over by the inference thread, count the tracks crossing the lines and
+ * @details regions and show the frame. Runs on the display thread, so the tracker
+ * @details of frame N runs while the inference thread processes frame N+1.
+ * @return shared_ptr<PredictNotifyBase> confirmed tracks, NULL when no frame came in time
  */
 shared_ptr<PredictNotifyBase> TVM_YOLO_DRPAI::track()
 {
-    /*timer for fps and person time calculation*/
+    OutputFrame frame;
+    if (!pop_output(frame, 100))
+        return NULL;
+    /*wait for the tracker update of this frame*/
+    if (!tracker_service->Wait(kStreamId, frame.seq, track_result))
+        return NULL;
+    /*timer for fps and person time calculation, interval between shown frames*/
+    end_time = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
     if (init)
-    {
         init = false;
-        end_time = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
-        time_one = end_time - start_time;
-        start_time = end_time;
-    }
     else
-    {
-        end_time = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
         infer_time_ms = end_time - start_time;
-        start_time = end_time;
-    }
-    bbox.clear();
-    /*filter detection based on confidence score and objects selected*/
+    start_time = end_time;
     ObjectDetection *ret = new ObjectDetection();
-    for (detection det : postproc_data)
-    {
-        bbox_t dat;
-        if (det.prob < conf)
-            continue;
-        dat.name = label_file_map[det.c].c_str();
-
-        if (count(detection_object_vector.begin(), detection_object_vector.end(), dat.name) < 0)
-            continue;
-        dat.X = (int32_t)(det.bbox.x - (det.bbox.w / 2));
-        dat.Y = (int32_t)(det.bbox.y - (det.bbox.h / 2));
-        dat.W = (int32_t)det.bbox.w;
-        dat.H = (int32_t)det.bbox.h;
-        dat.pred = det.prob * 100.0;
-        bbox.emplace_back(dat.X, dat.Y, dat.W, dat.H);
-    }
-    /*run the tracker with detected bbox*/
-    tracker.Run(bbox);
-    const auto tracks = tracker.GetTracks();
-    crossing_count = 0;
+    Mat &image = frame.image;
+    zone_counter.BeginFrame(end_time);
     /* result tracks */
-    for (auto &trk : tracks)
+    for (const auto &trk : track_result.objects)
     {
         bbox_t dat;
-        const auto &bbox_trk = trk.second.GetStateAsBbox();
-        /*kmin hit and kmaxcoast cycle*/
-        if (trk.second.coast_cycles_ < kMaxCoastCycles && trk.second.hit_streak_ >= kmin)
-        {
-            if (id_time.find(trk.first) == id_time.end())
-                dat.name = "id : " + to_string(trk.first);
-            dat.name = "id : " + to_string(trk.first) + "   time : " + to_string(id_time[trk.first] / 1000);
-            dat.X = bbox_trk.tl().x;
-            dat.Y = bbox_trk.tl().y;
-            int s = check_above_or_below((int)(dat.X + dat.W / 2), (int)(dat.Y + dat.H));
-            const bool is_in = unique_ids.find(trk.first) != unique_ids.end();
-            if (s)
-            {
-                if (location_history.find(trk.first) == location_history.end())
-                    location_history[trk.first] = s;
-                else
-                {
-                    if (!location_history[trk.first])
-                    {
-                        actual_count++;
-                    }
-                    location_history[trk.first] = s;
-                }
-            }
-            else
-            {
-                if (location_history.find(trk.first) == location_history.end())
-                    location_history[trk.first] = s;
-                else
-                {
-                    if (location_history[trk.first])
-                    {
-                        actual_count--;
-                    }
-                    location_history[trk.first] = s;
-                }
-            }
-            bool is_in_rect = check_inside_rectangle((int)(dat.X + dat.W / 2), (int)(dat.Y + dat.H));
-            if (is_in_rect)
-            {
-                crossing_count++;
-                if (id_time.find(trk.first) == id_time.end())
-                {
-                    id_time[trk.first] = infer_time_ms;
-                }
-                else
-                {
-                    id_time[trk.first] += infer_time_ms;
-                }
-            }
-            dat.W = bbox_trk.width;
-            dat.H = bbox_trk.height;
-            ret->predict.push_back(dat);
-            cv::Rect rect(dat.X, dat.Y, dat.W, dat.H);
-            for (const auto &x : id_time)
-            {
-                std::cout << "tracking id : " << x.first << " n_frames detected : " << x.second << "\n";
-            }
-            if (crossing_count < 0)
-            {
-                crossing_count = 0;
-            }
-            cv::rectangle(bgra_image, rect, cv::Scalar(0, 255, 0));
-            cv::putText(bgra_image, dat.name, Point(dat.X - 10, dat.Y), FONT_HERSHEY_DUPLEX, 1.0, Scalar(255, 0, 0), 2);
-        }
+        const cv::Rect &bbox_trk = trk.box;
+        dat.X = bbox_trk.tl().x;
+        dat.Y = bbox_trk.tl().y;
+        dat.W = bbox_trk.width;
+        dat.H = bbox_trk.height;
+        /*count with the bottom centre of the box, where the person stands*/
+        zone_counter.Update(trk.id, {(int32_t)(dat.X + dat.W / 2), (int32_t)(dat.Y + dat.H)});
+        dat.name = "id : " + to_string(trk.id) + "   time : " + to_string(zone_counter.GetDwellMs(trk.id, region_zone) / 1000);
+        ret->predict.push_back(dat);
+        cv::Rect rect(dat.X, dat.Y, dat.W, dat.H);
+        cv::rectangle(image, rect, cv::Scalar(0, 255, 0));
+        cv::putText(image, dat.name, Point(dat.X - 10, dat.Y), FONT_HERSHEY_DUPLEX, 1.0, Scalar(255, 0, 0), 2);
     }
-    cv::imshow("Object Tracker", bgra_image);
-    cv::waitKey(1);
+    zone_counter.EndFrame();
+    /*net crossings of [line] and persons inside [region]*/
+    const vector<Zone> &zones = zone_counter.GetZones();
+    actual_count = (line_zone < 0) ? 0 : std::max(0, zones[line_zone].count_in - zones[line_zone].count_out);
+    crossing_count = (region_zone < 0) ? 0 : zones[region_zone].occupancy;
+    draw_zones(image);
+    cv::imshow("Object Tracker", image);
     return shared_ptr<PredictNotifyBase>(move(ret));
 }
+/**
+ * @brief stop
+ * @details Release the inference thread waiting for the display thread, and the display thread.
+ */
+void TVM_YOLO_DRPAI::stop()
+{
+    lock_guard<mutex> lock(output_mtx);
+    output_stopped = true;
+    output_cv.notify_all();
+}
 /**
  * @brief pre_process_drpai
  * @details implementation pre process using Pre-processing Runtime.
@@ -405,7 +474,6 @@ int8_t TVM_YOLO_DRPAI::pre_process_drpai(uint32_t addr, float **output_buf, uint
     in_param.pre_in_addr = (uintptr_t)addr;
     /*Run pre-processing*/
     preruntime.Pre(&in_param, (void**)output_buf, buf_size);
-    start_time = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
     return 0;
 }
 /**
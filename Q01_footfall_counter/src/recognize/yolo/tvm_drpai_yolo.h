@@ -77,8 +77,12 @@ public:
     virtual int32_t inf_post_process(float* arg);
     virtual shared_ptr<PredictNotifyBase> track();
     virtual int32_t print_result();
+    virtual bool detect_required();
+    virtual int32_t inf_skip_process(uint8_t* input_data, uint32_t width, uint32_t height);
+    virtual void stop();
 
 private:
+    void convert_frame(uint8_t* input_data, uint32_t width, uint32_t height);
     int8_t pre_process_drpai(uint32_t addr, float** output_buf, uint32_t* buf_size);
     int8_t post_process(std::vector<detection>& det, float* floatarr);
 
@@ -120,6 +124,16 @@ private:
     /* Post-processing result */
     vector<detection> postproc_data;
 
+    /* Detect-every-N-frames mode, config.ini [tracking] */
+    /* run the detector at least every detect_interval frames, 1 runs it on every frame */
+    int32_t detect_interval = 1;
+    /* run it earlier when this many tracks were lost at the last detection, 0 disables */
+    int32_t detect_max_lost = 0;
+    /* run it earlier when a track centre variance (px^2) grows past this, 0 disables */
+    float detect_max_var = 0;
+    /* frames tracked by prediction only since the last detection */
+    int32_t frames_since_detect = 0;
+
 };
 
 #endif //DRP_TVM_MODEL_YOLO_H
@@ -1,53 +1,20 @@
 #include "track.h"
 
 
-Track::Track() : kf_(8, 4) {
+namespace {
+// Give high uncertainty to the unobservable initial velocities
+const float kInitialCovariance[8] = {10, 10, 10, 10, 10000, 10000, 10000, 10000};
+const float kProcessNoise[8] = {1, 1, 1, 1, 0.01, 0.01, 0.0001, 0.0001};
+const float kObservationNoise[4] = {1, 1, 10, 10};
+}
 
-    /*** Define constant velocity model ***/
-    // state - center_x, center_y, width, height, v_cx, v_cy, v_width, v_height
-    kf_.F_ <<
-           1, 0, 0, 0, 1, 0, 0, 0,
-            0, 1, 0, 0, 0, 1, 0, 0,
-            0, 0, 1, 0, 0, 0, 1, 0,
-            0, 0, 0, 1, 0, 0, 0, 1,
-            0, 0, 0, 0, 1, 0, 0, 0,
-            0, 0, 0, 0, 0, 1, 0, 0,
-            0, 0, 0, 0, 0, 0, 1, 0,
-            0, 0, 0, 0, 0, 0, 0, 1;
-
-    // Give high uncertainty to the unobservable initial velocities
-    kf_.P_ <<
-           10, 0, 0, 0, 0, 0, 0, 0,
-            0, 10, 0, 0, 0, 0, 0, 0,
-            0, 0, 10, 0, 0, 0, 0, 0,
-            0, 0, 0, 10, 0, 0, 0, 0,
-            0, 0, 0, 0, 10000, 0, 0, 0,
-            0, 0, 0, 0, 0, 10000, 0, 0,
-            0, 0, 0, 0, 0, 0, 10000, 0,
-            0, 0, 0, 0, 0, 0, 0, 10000;
-
-
-    kf_.H_ <<
-           1, 0, 0, 0, 0, 0, 0, 0,
-            0, 1, 0, 0, 0, 0, 0, 0,
-            0, 0, 1, 0, 0, 0, 0, 0,
-            0, 0, 0, 1, 0, 0, 0, 0;
-
-    kf_.Q_ <<
-           1, 0, 0, 0, 0, 0, 0, 0,
-            0, 1, 0, 0, 0, 0, 0, 0,
-            0, 0, 1, 0, 0, 0, 0, 0,
-            0, 0, 0, 1, 0, 0, 0, 0,
-            0, 0, 0, 0, 0.01, 0, 0, 0,
-            0, 0, 0, 0, 0, 0.01, 0, 0,
-            0, 0, 0, 0, 0, 0, 0.0001, 0,
-            0, 0, 0, 0, 0, 0, 0, 0.0001;
-
-    kf_.R_ <<
-           1, 0, 0,  0,
-            0, 1, 0,  0,
-            0, 0, 10, 0,
-            0, 0, 0,  10;
+
+Track::Track() {
+    /*** Constant velocity model, F and H are implied by Track::Filter ***/
+    std::memcpy(kf_.q_, kProcessNoise, sizeof(kf_.q_));
+    std::memcpy(kf_.r_, kObservationNoise, sizeof(kf_.r_));
+    float zero[4] = {0, 0, 0, 0};
+    kf_.Init(zero, kInitialCovariance);
 }
 
 
@@ -65,6 +32,13 @@ void Track::Predict() {
 }
 
 
+// Advance the state to the next frame when no detection was run for it,
+// the track is neither counted as missed nor as hit
+void Track::Coast() {
+    kf_.Predict();
+}
+
+
 // Update matched trackers with assigned detections
 void Track::Update(const cv::Rect& bbox) {
 
@@ -73,8 +47,9 @@ void Track::Update(const cv::Rect& bbox) {
     // accumulate hit streak count
     hit_streak_++;
 
-    // observation - center_x, center_y, area, ratio
-    Eigen::VectorXd observation = ConvertBboxToObservation(bbox);
+    // observation - center_x, center_y, width, height
+    float observation[4];
+    ConvertBboxToObservation(bbox, observation);
     kf_.Update(observation);
 
 
@@ -83,7 +58,9 @@ void Track::Update(const cv::Rect& bbox) {
 
 // Create and initialize new trackers for unmatched detections, with initial bounding box
 void Track::Init(const cv::Rect &bbox) {
-    kf_.x_.head(4) << ConvertBboxToObservation(bbox);
+    float observation[4];
+    ConvertBboxToObservation(bbox, observation);
+    kf_.Init(observation, kInitialCovariance);
     hit_streak_++;
 }
 
@@ -102,22 +79,27 @@ float Track::GetNIS() const {
 }
 
 
+// Variance of the box centre, grows while the track coasts without detections
+float Track::GetPositionVariance() const {
+    return kf_.P_[0][0] + kf_.P_[1][1];
+}
+
+
 /**
  * Takes a bounding box in the form [x, y, width, height] and returns z in the form
  * [x, y, s, r] where x,y is the centre of the box and s is the scale/area and r is
  * the aspect ratio
  *
  * @param bbox
- * @return
+ * @param observation
  */
-Eigen::VectorXd Track::ConvertBboxToObservation(const cv::Rect& bbox) const{
-    Eigen::VectorXd observation = Eigen::VectorXd::Zero(4);
+void Track::ConvertBboxToObservation(const cv::Rect& bbox, float *observation) const{
     auto width = static_cast<float>(bbox.width);
     auto height = static_cast<float>(bbox.height);
-    float center_x = bbox.x + width / 2;
-    float center_y = bbox.y + height / 2;
-    observation << center_x, center_y, width, height;
-    return observation;
+    observation[0] = bbox.x + width / 2;
+    observation[1] = bbox.y + height / 2;
+    observation[2] = width;
+    observation[3] = height;
 }
 
 
@@ -128,7 +110,7 @@ Eigen::VectorXd Track::ConvertBboxToObservation(const cv::Rect& bbox) const{
  * @param state
  * @return
  */
-cv::Rect Track::ConvertStateToBbox(const Eigen::VectorXd &state) const {
+cv::Rect Track::ConvertStateToBbox(const float *state) const {
     // state - center_x, center_y, width, height, v_cx, v_cy, v_width, v_height
     auto width = std::max(0, static_cast<int>(state[2]));
     auto height = std::max(0, static_cast<int>(state[3]));
@@ -5,8 +5,7 @@ Tracker::Tracker() {
     id_ = 0;
 }
 
-float Tracker::CalculateIou(const cv::Rect& det, const Track& track) {
-    auto trk = track.GetStateAsBbox();
+float Tracker::CalculateIou(const cv::Rect& det, const cv::Rect& trk) {
     // get min/max points
     auto xx1 = std::max(det.tl().x, trk.tl().x);
     auto yy1 = std::max(det.tl().y, trk.tl().y);
@@ -25,89 +24,41 @@ float Tracker::CalculateIou(const cv::Rect& det, const Track& track) {
 }
 
 
-void Tracker::HungarianMatching(const std::vector<std::vector<float>>& iou_matrix,
-                                size_t nrows, size_t ncols,
-                                std::vector<std::vector<float>>& association) {
-    Matrix<float> matrix(nrows, ncols);
-    // Initialize matrix with IOU values
-    for (size_t i = 0 ; i < nrows ; i++) {
-        for (size_t j = 0 ; j < ncols ; j++) {
-            // Multiply by -1 to find max cost
-            if (iou_matrix[i][j] != 0) {
-                matrix(i, j) = -iou_matrix[i][j];
-            }
-            else {
-                // TODO: figure out why we have to assign value to get correct result
-                matrix(i, j) = 1.0f;
-            }
-        }
-    }
-
-    // Apply Kuhn-Munkres algorithm to matrix.
-    Munkres<float> m;
-    m.solve(matrix);
-
-    for (size_t i = 0 ; i < nrows ; i++) {
-        for (size_t j = 0 ; j < ncols ; j++) {
-            association[i][j] = matrix(i, j);
-        }
-    }
-}
-
-
 void Tracker::AssociateDetectionsToTrackers(const std::vector<cv::Rect>& detection,
-                                            std::map<int, Track>& tracks,
-                                            std::map<int, cv::Rect>& matched,
-                                            std::vector<cv::Rect>& unmatched_det,
                                             float iou_threshold) {
+    matched_.clear();
+    unmatched_det_.clear();
 
     // Set all detection as unmatched if no tracks existing
-    if (tracks.empty()) {
-        for (const auto& det : detection) {
-            unmatched_det.push_back(det);
-        }
+    if (tracks_.empty()) {
+        unmatched_det_.assign(detection.begin(), detection.end());
         return;
     }
 
-    std::vector<std::vector<float>> iou_matrix;
-    // resize IOU matrix based on number of detection and tracks
-    iou_matrix.resize(detection.size(), std::vector<float>(tracks.size()));
-
-    std::vector<std::vector<float>> association;
-    // resize association matrix based on number of detection and tracks
-    association.resize(detection.size(), std::vector<float>(tracks.size()));
-
-
     // row - detection, column - tracks
+    const size_t ncols = tracks_.size();
+    track_boxes_.resize(ncols);
+    for (size_t j = 0; j < ncols; j++) {
+        track_boxes_[j] = tracks_[j].track.GetStateAsBbox();
+    }
+    iou_matrix_.resize(detection.size() * ncols);
     for (size_t i = 0; i < detection.size(); i++) {
-        size_t j = 0;
-        for (const auto& trk : tracks) {
-            iou_matrix[i][j] = CalculateIou(detection[i], trk.second);
-            j++;
+        for (size_t j = 0; j < ncols; j++) {
+            iou_matrix_[i * ncols + j] = CalculateIou(detection[i], track_boxes_[j]);
         }
     }
 
-    // Find association
-    HungarianMatching(iou_matrix, detection.size(), tracks.size(), association);
+    // Find association, pairs with low IOU are filtered out by the solver
+    lap_.AssociateIou(iou_matrix_.data(), detection.size(), ncols, iou_threshold, matched_);
 
+    det_matched_.assign(detection.size(), 0);
+    for (const auto& pair : matched_) {
+        det_matched_[pair.first] = 1;
+    }
+    // detections that cannot match with any tracks
     for (size_t i = 0; i < detection.size(); i++) {
-        bool matched_flag = false;
-        size_t j = 0;
-        for (const auto& trk : tracks) {
-            if (0 == association[i][j]) {
-                // Filter out matched with low IOU
-                if (iou_matrix[i][j] >= iou_threshold) {
-                    matched[trk.first] = detection[i];
-                    matched_flag = true;
-                }
-                // It builds 1 to 1 association, so we can break from here
-                break;
-            }
-            j++;
-        }
-        // if detection cannot match with any tracks
-        if (!matched_flag) {
-            unmatched_det.push_back(detection[i]);
+        if (!det_matched_[i]) {
+            unmatched_det_.push_back(detection[i]);
         }
     }
 }
@@ -116,45 +67,106 @@ void Tracker::AssociateDetectionsToTrackers(const std::vector<cv::Rect>& detecti
 void Tracker::Run(const std::vector<cv::Rect>& detections) {
 
     /*** Predict internal tracks from previous frame ***/
-    for (auto &track : tracks_) {
-        track.second.Predict();
+    for (auto &entry : tracks_) {
+        entry.track.Predict();
     }
 
-    // Hash-map between track ID and associated detection bounding box
-    std::map<int, cv::Rect> matched;
-    // vector of unassociated detections
-    std::vector<cv::Rect> unmatched_det;
-
-    // return values - matched, unmatched_det
+    // return values - matched_, unmatched_det_
+    matched_.clear();
+    unmatched_det_.clear();
     if (!detections.empty()) {
-        AssociateDetectionsToTrackers(detections, tracks_, matched, unmatched_det);
+        AssociateDetectionsToTrackers(detections);
     }
 
     /*** Update tracks with associated bbox ***/
-    for (const auto &match : matched) {
-        const auto &ID = match.first;
-        tracks_[ID].Update(match.second);
+    for (const auto &match : matched_) {
+        tracks_[match.second].track.Update(detections[match.first]);
     }
 
     /*** Create new tracks for unmatched detections ***/
-    for (const auto &det : unmatched_det) {
+    for (const auto &det : unmatched_det_) {
         Track tracker;
         tracker.Init(det);
-        // Create new track and generate new ID
-        tracks_[id_++] = tracker;
+        Insert(tracker);
     }
 
     /*** Delete lose tracked tracks ***/
-    for (auto it = tracks_.begin(); it != tracks_.end();) {
-        if (it->second.coast_cycles_ > kMaxCoastCycles) {
-            it = tracks_.erase(it);
+    for (size_t i = 0; i < tracks_.size();) {
+        if (tracks_[i].track.coast_cycles_ > kMaxCoastCycles) {
+            // the last track is moved into i, check it next
+            Erase(i);
         } else {
-            it++;
+            i++;
         }
     }
 }
 
 
-std::map<int, Track> Tracker::GetTracks() {
-    return tracks_;
-}
\ No newline at end of file
+void Tracker::Coast() {
+    for (auto &entry : tracks_) {
+        entry.track.Coast();
+    }
+}
+
+
+int Tracker::GetLostCount() const {
+    int lost = 0;
+    for (const auto &entry : tracks_) {
+        if (entry.track.coast_cycles_ > 0) {
+            lost++;
+        }
+    }
+    return lost;
+}
+
+
+float Tracker::GetMaxPositionVariance() const {
+    float max_var = 0.0f;
+    for (const auto &entry : tracks_) {
+        max_var = std::max(max_var, entry.track.GetPositionVariance());
+    }
+    return max_var;
+}
+
+
+TrackHandle Tracker::Insert(const Track& track) {
+    uint32_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        slot = slots_.size();
+        slots_.push_back({0, 0});
+    }
+    slots_[slot].dense_index = tracks_.size();
+    TrackHandle handle = {slot, slots_[slot].generation};
+    // Create new track and generate new ID
+    tracks_.push_back({id_++, handle, track});
+    return handle;
+}
+
+
+void Tracker::Erase(size_t dense_index) {
+    const uint32_t slot = tracks_[dense_index].handle.slot;
+    if (dense_index != tracks_.size() - 1) {
+        tracks_[dense_index] = tracks_.back();
+        slots_[tracks_[dense_index].handle.slot].dense_index = dense_index;
+    }
+    tracks_.pop_back();
+    // invalidate outstanding handles to this slot
+    slots_[slot].generation++;
+    free_slots_.push_back(slot);
+}
+
+
+const Track *Tracker::Find(TrackHandle handle) const {
+    if (handle.slot >= slots_.size() || slots_[handle.slot].generation != handle.generation) {
+        return nullptr;
+    }
+    return &tracks_[slots_[handle.slot].dense_index].track;
+}
+
+
+TrackSpan Tracker::GetTracks() const {
+    return TrackSpan(tracks_.data(), tracks_.size());
+}
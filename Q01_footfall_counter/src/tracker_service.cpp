@@ -0,0 +1,175 @@
+#include "tracker_service.h"
+
+#include <algorithm>
+
+#include "utils.h"
+
+
+TrackerService::TrackerService(int workers) : stop_(false) {
+    workers = std::max(1, workers);
+    for (int i = 0; i < workers; i++) {
+        workers_.emplace_back(&TrackerService::WorkerLoop, this);
+    }
+}
+
+
+TrackerService::~TrackerService() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    done_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+
+void TrackerService::AddStream(int stream, const TrackerConfig& config) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    auto it = streams_.find(stream);
+    if (it == streams_.end()) {
+        std::unique_ptr<Stream> s(new Stream());
+        s->config = config;
+        s->scheduled = false;
+        s->next_seq = 1;
+        s->result.seq = 0;
+        s->result.lost_count = 0;
+        s->result.max_variance = 0.0f;
+        streams_[stream] = std::move(s);
+        return;
+    }
+    // let a worker holding the old tracker finish first
+    Stream *s = it->second.get();
+    done_cv_.wait(lock, [&] { return !s->scheduled || stop_; });
+    if (s->scheduled) {
+        return;
+    }
+    // reset in place: Wait() callers hold a pointer to the stream. The
+    // sequence numbers go on, so a waiter is released by the next update
+    // instead of waiting for a restarted count to catch up
+    s->config = config;
+    s->tracker = Tracker();
+    s->result.objects.clear();
+    s->result.lost_count = 0;
+    s->result.max_variance = 0.0f;
+}
+
+
+uint64_t TrackerService::Submit(int stream, const std::vector<TrackerDetection>& detections) {
+    return Enqueue(stream, {0, false, detections});
+}
+
+
+uint64_t TrackerService::SubmitCoast(int stream) {
+    return Enqueue(stream, {0, true, {}});
+}
+
+
+uint64_t TrackerService::Enqueue(int stream, Job&& job) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = streams_.find(stream);
+    if (it == streams_.end()) {
+        return 0;
+    }
+    Stream *s = it->second.get();
+    job.seq = s->next_seq++;
+    const uint64_t seq = job.seq;
+    s->jobs.push_back(std::move(job));
+    if (!s->scheduled) {
+        s->scheduled = true;
+        ready_.push_back(s);
+        work_cv_.notify_one();
+    }
+    return seq;
+}
+
+
+bool TrackerService::Wait(int stream, uint64_t seq, TrackerResult& result) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    auto it = streams_.find(stream);
+    if (it == streams_.end()) {
+        return false;
+    }
+    Stream *s = it->second.get();
+    done_cv_.wait(lock, [&] { return s->result.seq >= seq || stop_; });
+    if (s->result.seq < seq) {
+        return false;
+    }
+    result = s->result;
+    return true;
+}
+
+
+bool TrackerService::Latest(int stream, TrackerResult& result) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto it = streams_.find(stream);
+    if (it == streams_.end()) {
+        return false;
+    }
+    result = it->second->result;
+    return true;
+}
+
+
+void TrackerService::WorkerLoop() {
+    TrackerResult result;
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (true) {
+        work_cv_.wait(lock, [this] { return stop_ || !ready_.empty(); });
+        if (stop_) {
+            break;
+        }
+        Stream *s = ready_.front();
+        ready_.pop_front();
+        Job job = std::move(s->jobs.front());
+        s->jobs.pop_front();
+
+        // the stream is held by this worker until it is rescheduled below
+        lock.unlock();
+        Process(*s, job, result);
+        lock.lock();
+
+        std::swap(s->result, result);
+        if (!s->jobs.empty()) {
+            ready_.push_back(s);
+            work_cv_.notify_one();
+        } else {
+            s->scheduled = false;
+        }
+        done_cv_.notify_all();
+    }
+}
+
+
+void TrackerService::Process(Stream& s, const Job& job, TrackerResult& result) {
+    if (job.coast) {
+        s.tracker.Coast();
+    } else {
+        const TrackerConfig& config = s.config;
+        s.boxes.clear();
+        for (const auto& det : job.detections) {
+            if (det.prob < config.conf) {
+                continue;
+            }
+            if (!config.classes.empty() &&
+                std::find(config.classes.begin(), config.classes.end(), det.class_id) == config.classes.end()) {
+                continue;
+            }
+            s.boxes.push_back(det.box);
+        }
+        s.tracker.Run(s.boxes);
+    }
+
+    result.seq = job.seq;
+    result.objects.clear();
+    for (const auto& trk : s.tracker.GetTracks()) {
+        // kmin hit and kmaxcoast cycle
+        if (trk.track.coast_cycles_ < kMaxCoastCycles && trk.track.hit_streak_ >= s.config.kmin) {
+            result.objects.push_back({trk.id, trk.track.GetStateAsBbox()});
+        }
+    }
+    result.lost_count = s.tracker.GetLostCount();
+    result.max_variance = s.tracker.GetMaxPositionVariance();
+}
@@ -61,6 +61,7 @@
 #include <sys/stat.h>
 #include <errno.h>
 #include <vector>
+#include <deque>
 #include <map>
 #include <fstream>
 #include <iomanip>
@@ -156,6 +157,9 @@ const static uint32_t INF_OUT_SIZE  = (NUM_CLASS + 5) * NUM_BB * num_grids[0] *
 /*Waiting Time*/
 #define WAIT_TIME                   (1000) /* microseconds */
 
+/*Frames shown during one detection at most, the trackers of each are kept to correct them later*/
+#define TRACK_HISTORY               (64)
+
 /*Timer Related*/
 #define CAPTURE_TIMEOUT             (20)  /* seconds */
 #define AI_THREAD_TIMEOUT           (20)  /* seconds */
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+
+/**
+ * Constant velocity Kalman filter with compile-time dimensions, for SORT style
+ * bounding box tracking. Everything lives in fixed float arrays, so predict and
+ * update never allocate.
+ *
+ * The model is fixed by the layout of the state vector:
+ *   x = [z_0 .. z_{NZ-1}, v_0 .. v_{NX-NZ-1}]
+ * the first NZ states are observed directly (H = [I 0]) and velocity v_i is
+ * added to state i on every step (F = I + E, E(i, NZ+i) = 1). Process and
+ * observation noise are diagonal. These structures are exploited instead of
+ * forming F, H, Q and R as dense matrices.
+ *
+ * @tparam NX number of states
+ * @tparam NZ number of observations
+ */
+template <int NX, int NZ>
+class FixedKalmanFilter {
+public:
+    static_assert(NZ > 0 && NX >= NZ && NX - NZ <= NZ, "velocities must map onto observed states");
+    static constexpr int kNumVel = NX - NZ;
+
+    FixedKalmanFilter() {
+        std::memset(x_, 0, sizeof(x_));
+        std::memset(P_, 0, sizeof(P_));
+        std::memset(q_, 0, sizeof(q_));
+        std::memset(r_, 0, sizeof(r_));
+        NIS_ = 0.0f;
+    }
+
+    /**
+     * Reset the state to an observation with zero velocity and a diagonal covariance
+     * @param z observation, NZ values
+     * @param p0 initial covariance diagonal, NX values
+     */
+    void Init(const float *z, const float *p0) {
+        std::memset(x_, 0, sizeof(x_));
+        std::memcpy(x_, z, sizeof(float) * NZ);
+        std::memset(P_, 0, sizeof(P_));
+        for (int i = 0; i < NX; i++) {
+            P_[i][i] = p0[i];
+        }
+    }
+
+    /**
+     * x = F x, P = F P F^T + Q
+     */
+    void Predict() {
+        for (int i = 0; i < kNumVel; i++) {
+            x_[i] += x_[NZ + i];
+        }
+        // F P: row i += row NZ+i
+        for (int i = 0; i < kNumVel; i++) {
+            for (int j = 0; j < NX; j++) {
+                P_[i][j] += P_[NZ + i][j];
+            }
+        }
+        // (F P) F^T: column j += column NZ+j
+        for (int i = 0; i < NX; i++) {
+            for (int j = 0; j < kNumVel; j++) {
+                P_[i][j] += P_[i][NZ + j];
+            }
+        }
+        for (int i = 0; i < NX; i++) {
+            P_[i][i] += q_[i];
+        }
+    }
+
+    /**
+     * Measurement update. With H = [I 0] the innovation covariance is the
+     * top-left block of P plus R, and the gain only needs the first NZ
+     * rows of P.
+     * @param z observation, NZ values
+     */
+    void Update(const float *z) {
+        float y[NZ];
+        float S[NZ][NZ];
+        for (int i = 0; i < NZ; i++) {
+            y[i] = z[i] - x_[i];
+            for (int j = 0; j < NZ; j++) {
+                S[i][j] = P_[i][j];
+            }
+            S[i][i] += r_[i];
+        }
+
+        // S = L L^T, stored in place (lower triangle)
+        for (int j = 0; j < NZ; j++) {
+            float d = S[j][j];
+            for (int k = 0; k < j; k++) {
+                d -= S[j][k] * S[j][k];
+            }
+            S[j][j] = std::sqrt(d > 0.0f ? d : 1e-12f);
+            for (int i = j + 1; i < NZ; i++) {
+                float s = S[i][j];
+                for (int k = 0; k < j; k++) {
+                    s -= S[i][k] * S[j][k];
+                }
+                S[i][j] = s / S[j][j];
+            }
+        }
+
+        // NIS = y^T S^-1 y = |L^-1 y|^2
+        float w[NZ];
+        SolveLower(S, y, w);
+        NIS_ = 0.0f;
+        for (int i = 0; i < NZ; i++) {
+            NIS_ += w[i] * w[i];
+        }
+
+        // K^T = S^-1 P[0:NZ, :], one column of P at a time
+        float K[NX][NZ];
+        float col[NZ];
+        float tmp[NZ];
+        for (int c = 0; c < NX; c++) {
+            for (int i = 0; i < NZ; i++) {
+                col[i] = P_[i][c];
+            }
+            SolveLower(S, col, tmp);
+            SolveUpper(S, tmp, col);
+            for (int i = 0; i < NZ; i++) {
+                K[c][i] = col[i];
+            }
+        }
+
+        // x += K y
+        for (int i = 0; i < NX; i++) {
+            float s = 0.0f;
+            for (int k = 0; k < NZ; k++) {
+                s += K[i][k] * y[k];
+            }
+            x_[i] += s;
+        }
+
+        // P = (I - K H) P = P - K P[0:NZ, :]
+        float Ptop[NZ][NX];
+        std::memcpy(Ptop, P_, sizeof(Ptop));
+        for (int i = 0; i < NX; i++) {
+            for (int j = 0; j < NX; j++) {
+                float s = 0.0f;
+                for (int k = 0; k < NZ; k++) {
+                    s += K[i][k] * Ptop[k][j];
+                }
+                P_[i][j] -= s;
+            }
+        }
+    }
+
+    // State vector
+    float x_[NX];
+
+    // Error covariance matrix
+    float P_[NX][NX];
+
+    // Diagonal of the process noise covariance
+    float q_[NX];
+
+    // Diagonal of the observation noise covariance
+    float r_[NZ];
+
+    // Normalized innovation squared of the last update
+    float NIS_;
+
+private:
+    // Solve L w = b, L lower triangular
+    static void SolveLower(const float (&L)[NZ][NZ], const float *b, float *w) {
+        for (int i = 0; i < NZ; i++) {
+            float s = b[i];
+            for (int k = 0; k < i; k++) {
+                s -= L[i][k] * w[k];
+            }
+            w[i] = s / L[i][i];
+        }
+    }
+
+    // Solve L^T v = w, L lower triangular
+    static void SolveUpper(const float (&L)[NZ][NZ], const float *w, float *v) {
+        for (int i = NZ - 1; i >= 0; i--) {
+            float s = w[i];
+            for (int k = i + 1; k < NZ; k++) {
+                s -= L[k][i] * v[k];
+            }
+            v[i] = s / L[i][i];
+        }
+    }
+};
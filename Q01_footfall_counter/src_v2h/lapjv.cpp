@@ -0,0 +1,298 @@
+#include "lapjv.h"
+
+#include <algorithm>
+#include <limits>
+
+
+float LapJV::Solve(int n, const float *cost, int *row_sol) {
+    if (n <= 0) {
+        return 0.0f;
+    }
+    const float kBig = std::numeric_limits<float>::max();
+    col_sol_.resize(n);
+    free_.resize(n);
+    col_list_.resize(n);
+    assign_count_.assign(n, 0);
+    pred_.resize(n);
+    v_.resize(n);
+    d_.resize(n);
+    int *col_sol = col_sol_.data();
+    int *free_rows = free_.data();
+    int *col_list = col_list_.data();
+    int *pred = pred_.data();
+    float *v = v_.data();
+    float *d = d_.data();
+
+    /*** Column reduction, reverse order gives better initial assignments ***/
+    for (int j = n - 1; j >= 0; j--) {
+        float min = cost[j];
+        int imin = 0;
+        for (int i = 1; i < n; i++) {
+            if (cost[i * n + j] < min) {
+                min = cost[i * n + j];
+                imin = i;
+            }
+        }
+        v[j] = min;
+        if (++assign_count_[imin] == 1) {
+            row_sol[imin] = j;
+            col_sol[j] = imin;
+        } else {
+            col_sol[j] = -1;
+        }
+    }
+
+    /*** Reduction transfer from rows assigned once, collect free rows ***/
+    int num_free = 0;
+    for (int i = 0; i < n; i++) {
+        if (assign_count_[i] == 0) {
+            free_rows[num_free++] = i;
+        } else if (assign_count_[i] == 1) {
+            int j1 = row_sol[i];
+            float min = kBig;
+            for (int j = 0; j < n; j++) {
+                if (j != j1 && cost[i * n + j] - v[j] < min) {
+                    min = cost[i * n + j] - v[j];
+                }
+            }
+            v[j1] -= min;
+        }
+    }
+
+    /*** Augmenting row reduction, two passes ***/
+    for (int pass = 0; pass < 2 && num_free > 0; pass++) {
+        int k = 0;
+        int prev_free = num_free;
+        num_free = 0;
+        // bound the re-scans, float ties can otherwise keep swapping the same rows
+        int budget = n * n;
+        while (k < prev_free) {
+            int i = free_rows[k++];
+            const float *c = cost + (size_t)i * n;
+            float umin = c[0] - v[0];
+            float usubmin = kBig;
+            int j1 = 0;
+            int j2 = 0;
+            for (int j = 1; j < n; j++) {
+                float h = c[j] - v[j];
+                if (h < usubmin) {
+                    if (h >= umin) {
+                        usubmin = h;
+                        j2 = j;
+                    } else {
+                        usubmin = umin;
+                        umin = h;
+                        j2 = j1;
+                        j1 = j;
+                    }
+                }
+            }
+
+            int i0 = col_sol[j1];
+            if (umin < usubmin) {
+                v[j1] -= usubmin - umin;
+            } else if (i0 >= 0) {
+                j1 = j2;
+                i0 = col_sol[j2];
+            }
+            row_sol[i] = j1;
+            col_sol[j1] = i;
+
+            if (i0 >= 0) {
+                if (umin < usubmin && --budget > 0) {
+                    free_rows[--k] = i0;
+                } else {
+                    free_rows[num_free++] = i0;
+                }
+            }
+        }
+    }
+
+    /*** Augment each remaining free row along a shortest path (Dijkstra) ***/
+    for (int f = 0; f < num_free; f++) {
+        const int free_row = free_rows[f];
+        for (int j = 0; j < n; j++) {
+            d[j] = cost[(size_t)free_row * n + j] - v[j];
+            pred[j] = free_row;
+            col_list[j] = j;
+        }
+
+        // col_list[0, low) are scanned, [low, up) hold the current minimum, [up, n) are unvisited
+        int low = 0;
+        int up = 0;
+        int last = 0;
+        int end_of_path = -1;
+        float min = 0.0f;
+        while (end_of_path < 0) {
+            if (up == low) {
+                last = low - 1;
+                min = d[col_list[up++]];
+                for (int k = up; k < n; k++) {
+                    int j = col_list[k];
+                    float h = d[j];
+                    if (h <= min) {
+                        if (h < min) {
+                            up = low;
+                            min = h;
+                        }
+                        col_list[k] = col_list[up];
+                        col_list[up++] = j;
+                    }
+                }
+                for (int k = low; k < up; k++) {
+                    if (col_sol[col_list[k]] < 0) {
+                        end_of_path = col_list[k];
+                        break;
+                    }
+                }
+            }
+
+            if (end_of_path < 0) {
+                int j1 = col_list[low++];
+                int i = col_sol[j1];
+                const float *c = cost + (size_t)i * n;
+                float h = c[j1] - v[j1] - min;
+                for (int k = up; k < n; k++) {
+                    int j = col_list[k];
+                    float v2 = c[j] - v[j] - h;
+                    if (v2 < d[j]) {
+                        pred[j] = i;
+                        if (v2 == min) {
+                            if (col_sol[j] < 0) {
+                                end_of_path = j;
+                                break;
+                            }
+                            col_list[k] = col_list[up];
+                            col_list[up++] = j;
+                        }
+                        d[j] = v2;
+                    }
+                }
+            }
+        }
+
+        // update column prices
+        for (int k = 0; k <= last; k++) {
+            int j1 = col_list[k];
+            v[j1] += d[j1] - min;
+        }
+
+        // flip the assignments along the alternating path
+        int i;
+        do {
+            i = pred[end_of_path];
+            col_sol[end_of_path] = i;
+            std::swap(end_of_path, row_sol[i]);
+        } while (i != free_row);
+    }
+
+    float total = 0.0f;
+    for (int i = 0; i < n; i++) {
+        total += cost[(size_t)i * n + row_sol[i]];
+    }
+    return total;
+}
+
+
+int LapJV::FindRoot(int node) {
+    while (parent_[node] != node) {
+        parent_[node] = parent_[parent_[node]];
+        node = parent_[node];
+    }
+    return node;
+}
+
+
+void LapJV::AssociateIou(const float *iou, int rows, int cols, float min_iou,
+                         std::vector<std::pair<int, int>> &matches) {
+    matches.clear();
+    if (rows <= 0 || cols <= 0) {
+        return;
+    }
+
+    /*** Connected components over pairs with positive IoU, node r is row r, node rows+c is column c ***/
+    const int nodes = rows + cols;
+    parent_.resize(nodes);
+    for (int i = 0; i < nodes; i++) {
+        parent_[i] = i;
+    }
+    for (int r = 0; r < rows; r++) {
+        const float *row = iou + (size_t)r * cols;
+        for (int c = 0; c < cols; c++) {
+            if (row[c] > 0.0f) {
+                int a = FindRoot(r);
+                int b = FindRoot(rows + c);
+                if (a != b) {
+                    parent_[a] = b;
+                }
+            }
+        }
+    }
+
+    // bucket rows and columns by root (counting sort)
+    for (int i = 0; i < nodes; i++) {
+        parent_[i] = FindRoot(i);
+    }
+    row_start_.assign(nodes + 1, 0);
+    col_start_.assign(nodes + 1, 0);
+    for (int r = 0; r < rows; r++) {
+        row_start_[parent_[r] + 1]++;
+    }
+    for (int c = 0; c < cols; c++) {
+        col_start_[parent_[rows + c] + 1]++;
+    }
+    for (int i = 0; i < nodes; i++) {
+        row_start_[i + 1] += row_start_[i];
+        col_start_[i + 1] += col_start_[i];
+    }
+    comp_rows_.resize(rows);
+    comp_cols_.resize(cols);
+    cursor_.assign(row_start_.begin(), row_start_.end() - 1);
+    for (int r = 0; r < rows; r++) {
+        comp_rows_[cursor_[parent_[r]]++] = r;
+    }
+    cursor_.assign(col_start_.begin(), col_start_.end() - 1);
+    for (int c = 0; c < cols; c++) {
+        comp_cols_[cursor_[parent_[rows + c]]++] = c;
+    }
+
+    /*** Solve every component with at least one candidate pair ***/
+    for (int root = 0; root < nodes; root++) {
+        const int *cr = comp_rows_.data() + row_start_[root];
+        const int *cc = comp_cols_.data() + col_start_[root];
+        const int nr = row_start_[root + 1] - row_start_[root];
+        const int nc = col_start_[root + 1] - col_start_[root];
+        if (nr == 0 || nc == 0) {
+            continue;
+        }
+        if (nr == 1 && nc == 1) {
+            if (iou[(size_t)cr[0] * cols + cc[0]] >= min_iou) {
+                matches.emplace_back(cr[0], cc[0]);
+            }
+            continue;
+        }
+
+        // square cost 1 - IoU; padding and zero-IoU cells cost 1, the same as staying unmatched
+        const int n = std::max(nr, nc);
+        sub_cost_.assign((size_t)n * n, 1.0f);
+        for (int a = 0; a < nr; a++) {
+            const float *row = iou + (size_t)cr[a] * cols;
+            float *dst = sub_cost_.data() + (size_t)a * n;
+            for (int b = 0; b < nc; b++) {
+                dst[b] = 1.0f - row[cc[b]];
+            }
+        }
+        row_sol_.resize(n);
+        Solve(n, sub_cost_.data(), row_sol_.data());
+        for (int a = 0; a < nr; a++) {
+            int b = row_sol_[a];
+            if (b >= nc) {
+                continue;
+            }
+            float value = iou[(size_t)cr[a] * cols + cc[b]];
+            if (value > 0.0f && value >= min_iou) {
+                matches.emplace_back(cr[a], cc[b]);
+            }
+        }
+    }
+}
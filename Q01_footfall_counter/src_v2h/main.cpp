@@ -61,6 +61,10 @@
 #include "wayland.h"
 
 #include "sort.h"
+#include "zone_counter.h"
+/*Blocking hand-off between threads*/
+#include "stage_graph.h"
+#include "thread_sched.h"
 
 /*****************************************
 * Global Variables
@@ -72,6 +76,7 @@ std::map<std::string, int> input_source_map =
 
 /*Multithreading*/
 static sem_t terminate_req_sem;
+static StageGraph stages(&terminate_req_sem);
 static pthread_t ai_inf_thread;
 static pthread_t capture_thread;
 static pthread_t exit_thread;
@@ -79,8 +84,12 @@ static pthread_t kbhit_thread;
 static std::mutex mtx;
 
 /*Flags*/
-static std::atomic<uint8_t> inference_start (0);
-static std::atomic<uint8_t> img_obj_ready   (0);
+static StageEvent inference_start (stages, "inference_start");
+static StageEvent img_obj_ready   (stages, "img_obj_ready");
+/* Detect-every-N-frames mode: set by the Main Thread when the next frame should go to the detector,
+   set by the AI Inference Thread when trackerbbox holds detections the tracker has not seen yet */
+static StageEvent detect_request  (stages, "detect_request", 1);
+static StageEvent detect_ready    (stages, "detect_ready");
 
 /*Global Variables*/
 static float drpai_output_buf[INF_OUT_SIZE];
@@ -104,12 +113,19 @@ static std::vector<detection> det;
 cv::Mat yuyv_image;
 cv::Mat input_image;
 std::unordered_map<std::string, std::unordered_map<std::string, std::string>> ini_values;
+static ThreadSchedConfig thread_sched;
 std::vector<std::string> detection_object_vector;
 
 static cv::Mat trackerbbox = cv::Mat(0, 6, CV_32F);
+/* Capture frame numbers of the last frame captured, of yuyv_image, of input_image and of trackerbbox */
+static uint64_t capture_frame_no = 0;
+static uint64_t yuyv_frame_no = 0;
+static uint64_t input_frame_no = 0;
+static uint64_t trackerbbox_frame_no = 0;
 static std::vector<bbox_t> bbox;
-int pointx1, pointy1, pointx2, pointy2, actual_count = 0;
-std::vector<cv::Point> polygon;
+int actual_count = 0;
+/* counting lines and regions from config.ini */
+static ZoneCounter zone_counter;
 static float conf = 0;
 
 /* Wayland object */
@@ -506,6 +522,7 @@ void R_Post_Proc(float* floatarr)
     
     bbox.clear();
     trackerbbox = cv::Mat(0, 6, CV_32F);
+    trackerbbox_frame_no = input_frame_no;
     for (detection detect : det)
     {
         bbox_t dat;
@@ -527,40 +544,6 @@ void R_Post_Proc(float* floatarr)
     return ;
 }
 
-/*****************************************
-* Function Name : check_above_or_below
-* Description   : check the given point is above or below the line,
-*                 added a small value of 1e-8 to avoid division by zero
-* Arguments     : x = x coordinate of the point
-*                 y = y coordinate of the point
-* Return value  : int location of the point w.r.t the line
-******************************************/
-int check_above_or_below(int x, int y)
-{
-    double m = (pointy2 - pointy1) / ((pointx2 - pointx1) + 0.00000006);
-    double yline = m * (x - pointx1) + pointy1;
-    if (y > yline)
-        return 1;
-    else
-        return 0;
-}
-
-/*****************************************
-* Function Name : check_inside_rectangle
-* Description   : check the given point is inside the region defined using the polygon,
-* Arguments     : x = x coordinate of the point
-*                 y = y coordinate of the point
-* Return value  : bool location of the point w.r.t the line
-******************************************/
-bool check_inside_rectangle(int x, int y)
-{
-    int result = pointPolygonTest(polygon, cv::Point(x, y), false);
-    if (result == 1)
-        return 1;
-    else
-        return 0;
-}
-
 /*****************************************
 * Function Name : R_Inf_Thread
 * Description   : Executes the DRP-AI inference thread
@@ -607,12 +590,11 @@ void *R_Inf_Thread(void *threadid)
             {
                 goto ai_inf_end;
             }
-            /*Checks if image frame from Capture Thread is ready.*/
-            if (inference_start.load())
+            /*Blocks until image frame from Capture Thread is ready or termination is requested.*/
+            if (inference_start.wait_set())
             {
                 break;
             }
-            usleep(WAIT_TIME);
         }
 
         /*Gets Pre-process starting time*/
@@ -691,6 +673,7 @@ void *R_Inf_Thread(void *threadid)
         /*Post-process Time Result*/
         post_time = (float)((time_difference_msec(post_start_time, post_end_time)));
         total_time = pre_time + ai_time + post_time;
+        detect_ready.store(1);
         inference_start.store(0);
     }
     /*End of Inference Loop*/
@@ -698,7 +681,7 @@ void *R_Inf_Thread(void *threadid)
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto ai_inf_end;
 /*AI Thread Termination*/
 ai_inf_end:
@@ -755,6 +738,11 @@ void *R_Kbhit_Thread(void *threadid)
             goto key_hit_end;
         }
 
+        /* Blocks until a key is pressed or termination is requested. */
+        if (!stages.wait_readable(STDIN_FILENO))
+        {
+            continue;
+        }
         c = getchar();
         if (EOF != c)
         {
@@ -762,17 +750,17 @@ void *R_Kbhit_Thread(void *threadid)
             printf("[INFO] key Detected. !!!\n");
             goto err;
         }
-        else
+        else if (feof(stdin))
         {
-            /* When nothing is pressed. */
-            usleep(WAIT_TIME);
+            /* Standard input is closed, only termination ends the thread. */
+            stages.wait_shutdown();
         }
     }
 
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto key_hit_end;
 
 key_hit_end:
@@ -831,7 +819,7 @@ void *R_exit_Thread(void *threadid)
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto exit_end;
 
 exit_end:
@@ -895,16 +883,19 @@ void *R_Capture_Thread(void *cap_pipeline)
         }
         else
         {   
-            if (!inference_start.load())
+            capture_frame_no++;
+            if (!inference_start.load() && detect_request.load())
             {
 
                 input_image = g_frame.clone();
+                input_frame_no = capture_frame_no;
                 inference_start.store(1); /* Flag for AI Inference Thread. */
             }
 
             if (!img_obj_ready.load())
             {
                 yuyv_image = g_frame.clone();
+                yuyv_frame_no = capture_frame_no;
                 img_obj_ready.store(1); /* Flag for Main Thread. */
             }
         }
@@ -912,7 +903,7 @@ void *R_Capture_Thread(void *cap_pipeline)
 
 /*Error Processing*/
 err:
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto capture_end;
 
 capture_end:
@@ -942,6 +933,48 @@ cv::Mat create_output_frame(cv::Mat frame_g)
     return background;
 }
 
+/*****************************************
+* Function Name : correct_trackers
+* Description   : Corrects the trackers with the detections of an earlier frame. The trackers saved before that
+*                 frame are updated with the detections, then predicted again once per frame shown since, so that
+*                 the detections are not matched against tracks that were already moved past them.
+* Arguments     : mot = SORT tracker
+*                 history = capture frame number and trackers after each frame shown, oldest first
+*                 detections = detections, Mat(M, 6)
+*                 detect_frame = capture frame number of the detections
+*                 frame = capture frame number of the frame shown now
+* Return value  : tracks of the frame shown now
+******************************************/
+static cv::Mat correct_trackers(sort::Sort& mot, const std::deque<std::pair<uint64_t, sort::TrackStore>>& history,
+                                const cv::Mat& detections, uint64_t detect_frame, uint64_t frame)
+{
+    /* newest trackers from before the frame of the detections */
+    auto base = history.end();
+    for (auto it = history.begin(); it != history.end() && it->first < detect_frame; ++it)
+    {
+        base = it;
+    }
+    if (history.end() == base)
+    {
+        /* no trackers that old are kept, correct the current ones */
+        return mot.update(detections);
+    }
+    mot.setTrackers(base->second);
+    cv::Mat tracks = mot.update(detections);
+    for (auto it = std::next(base); it != history.end(); ++it)
+    {
+        if (it->first > detect_frame)
+        {
+            tracks = mot.predict();
+        }
+    }
+    if (frame > detect_frame)
+    {
+        tracks = mot.predict();
+    }
+    return tracks;
+}
+
 /*****************************************
 * Function Name : R_Main_Process
 * Description   : Runs the main process loop
@@ -961,10 +994,10 @@ int8_t R_Main_Process()
     uint32_t idx = 0;
     config_read();
     uint8_t img_buf_id;
-    std::map<int, int> id_time;
-    std::set<int> unique_ids = {};
-    std::map<int, int> location_history;
     long int infer_time_ms;
+    struct timespec frame_time;
+    int line_zone;
+    int region_zone;
     cv::Mat bgra_image;
     std::stringstream stream;
     std::string result_str;
@@ -973,20 +1006,33 @@ int8_t R_Main_Process()
     int class_id;
     std::string class_name;
     int8_t kmin = stoi(ini_values["tracking"]["kmin"]);
+    /* Detect-every-N-frames mode, 1 runs the detector on every frame */
+    int32_t detect_interval = 1;
+    int32_t detect_max_lost = 0;
+    float detect_max_var = 0;
+    int32_t frames_since_detect = 0;
+    /* Capture frame number and trackers after each frame shown since the last detection */
+    std::deque<std::pair<uint64_t, sort::TrackStore>> track_history;
+    if (ini_values["tracking"].count("detect_interval"))
+        detect_interval = std::max(1, stoi(ini_values["tracking"]["detect_interval"]));
+    if (ini_values["tracking"].count("detect_max_lost"))
+        detect_max_lost = stoi(ini_values["tracking"]["detect_max_lost"]);
+    if (ini_values["tracking"].count("detect_max_var"))
+        detect_max_var = stof(ini_values["tracking"]["detect_max_var"]);
     conf = stof(ini_values["tracking"]["conf"]);
-    /*set point 1*/
-    pointx1 = stoi(ini_values["line"]["x1"]);
-    pointy1 = stoi(ini_values["line"]["y1"]);
-    /*set point 2*/
-    pointx2 = stoi(ini_values["line"]["x2"]);
-    pointy2 = stoi(ini_values["line"]["y2"]);
-
-    polygon = {
-        cv::Point(stoi(ini_values["region"]["x1"]), stoi(ini_values["region"]["y1"])),
-        cv::Point(stoi(ini_values["region"]["x2"]), stoi(ini_values["region"]["y2"])),
-        cv::Point(stoi(ini_values["region"]["x3"]), stoi(ini_values["region"]["y3"])),
-        cv::Point(stoi(ini_values["region"]["x4"]), stoi(ini_values["region"]["y4"]))
-    };
+    /*set counting lines and regions of interest*/
+    if (zone_counter.LoadConfig(ini_values) < 0)
+    {
+        fprintf(stderr, "[ERROR] Failed to load the [line] and [region] sections\n");
+        return -1;
+    }
+    /*[line] and [region] are the ones shown as counts*/
+    line_zone = zone_counter.FindZone("line");
+    region_zone = zone_counter.FindZone("region");
+    if (ini_values["tracking"].count("event_log"))
+    {
+        zone_counter.OpenLog(ini_values["tracking"]["event_log"]);
+    }
 
     std::string detection_object_string = ini_values["tracking"]["objects"];
     std::stringstream detection_object_ss(detection_object_string);
@@ -1045,8 +1091,41 @@ int8_t R_Main_Process()
         {
             bgra_image = yuyv_image;
             infer_time_ms = total_time;
-            cv::Mat tracks = mot->update(trackerbbox);
-            region_count = 0;
+            cv::Mat tracks;
+            if (1 == detect_interval)
+            {
+                tracks = mot->update(trackerbbox);
+            }
+            else if (detect_ready.load())
+            {
+                /* new detections of an earlier frame: correct the trackers at that frame */
+                mtx.lock();
+                tracks = correct_trackers(*mot, track_history, trackerbbox, trackerbbox_frame_no, yuyv_frame_no);
+                mtx.unlock();
+                detect_ready.store(0);
+                frames_since_detect = 0;
+                track_history.clear();
+            }
+            else
+            {
+                /* detector skipped: move the trackers by prediction only */
+                tracks = mot->predict();
+                frames_since_detect++;
+            }
+            if (1 < detect_interval)
+            {
+                track_history.emplace_back(yuyv_frame_no, mot->getTrackers());
+                if (TRACK_HISTORY < track_history.size())
+                {
+                    track_history.pop_front();
+                }
+                bool request = (frames_since_detect + 1 >= detect_interval)
+                    || (detect_max_lost > 0 && mot->getLostCount() >= detect_max_lost)
+                    || (detect_max_var > 0 && mot->getMaxPositionVariance() > detect_max_var);
+                detect_request.store(request ? 1 : 0);
+            }
+            timespec_get(&frame_time, TIME_UTC);
+            zone_counter.BeginFrame((int64_t)frame_time.tv_sec * 1000 + frame_time.tv_nsec / 1000000);
             /* result tracks */
             for (int i = 0; i < tracks.rows; ++i)
             {
@@ -1058,55 +1137,16 @@ int8_t R_Main_Process()
                 dat.Y = tracks.at<float>(i, 1);
                 dat.W = tracks.at<float>(i, 2);
                 dat.H = tracks.at<float>(i, 3);
-                if (id_time.find(tracker_id) == id_time.end())
+                /*count with the bottom centre of the box, where the person stands*/
+                zone_counter.Update(tracker_id, {(int32_t)(dat.X + dat.W / 2), (int32_t)(dat.Y + dat.H)});
+                int64_t dwell_ms = zone_counter.GetDwellMs(tracker_id, region_zone);
+                if (0 == dwell_ms)
                 {
                     dat.name = class_name + " Id : " + std::to_string(tracker_id);
                 }
                 else
                 {
-                    dat.name = class_name + " Id: " + std::to_string(tracker_id) + " Time: " + std::to_string(id_time[tracker_id] / 1000);
-                }
-                int s = check_above_or_below((int)(dat.X + dat.W / 2), (int)(dat.Y + dat.H));
-                if (s)
-                {
-                    if (location_history.find(tracker_id) == location_history.end())
-                        location_history[tracker_id] = s;
-                    else
-                    {
-                        if (!location_history[tracker_id])
-                        {
-                            actual_count++;
-                        }
-                        location_history[tracker_id] = s;
-                    }
-                }
-                else
-                {
-                    if (location_history.find(tracker_id) == location_history.end())
-                        location_history[tracker_id] = s;
-                    else
-                    {
-                        if (location_history[tracker_id])
-                        {
-                            actual_count--;
-                            if(actual_count < 0)
-                                actual_count = 0;
-                        }
-                        location_history[tracker_id] = s;
-                    }
-                }
-                bool is_in_rect = check_inside_rectangle((int)(dat.X + dat.W / 2), (int)(dat.Y + dat.H));
-                if (is_in_rect)
-                {
-                    region_count++;
-                    if (id_time.find(tracker_id) == id_time.end())
-                    {
-                        id_time[tracker_id] = infer_time_ms;
-                    }
-                    else
-                    {
-                        id_time[tracker_id] += infer_time_ms;
-                    }
+                    dat.name = class_name + " Id: " + std::to_string(tracker_id) + " Time: " + std::to_string(dwell_ms / 1000);
                 }
                 if (dat.Y < 20){
                     dat.Y = 20;
@@ -1125,8 +1165,27 @@ int8_t R_Main_Process()
                 cv::rectangle(bgra_image, rect_text_box, cv::Scalar(0, 255, 0), cv::FILLED);
                 cv::putText(bgra_image, dat.name, cv::Point(dat.X + 10, dat.Y - 7), cv::FONT_HERSHEY_SIMPLEX, font_size_bb, cv::Scalar(0, 0, 0), font_size_bb, cv::LINE_AA);
             }
-            cv::line(bgra_image, cv::Point(pointx1, pointy1), cv::Point(pointx2, pointy2), cv::Scalar(0, 0, 255), 4);
-            cv::polylines(bgra_image, polygon, true, cv::Scalar(0, 255, 0), 2);
+            zone_counter.EndFrame();
+            const std::vector<Zone> &zones = zone_counter.GetZones();
+            /*net crossings of [line] and persons inside [region]*/
+            actual_count = (line_zone < 0) ? 0 : std::max(0, zones[line_zone].count_in - zones[line_zone].count_out);
+            region_count = (region_zone < 0) ? 0 : zones[region_zone].occupancy;
+            for (const Zone &zone : zones)
+            {
+                std::vector<cv::Point> points;
+                for (const ZonePoint &p : zone.points)
+                {
+                    points.emplace_back(p.x, p.y);
+                }
+                if (kZoneLine == zone.type)
+                {
+                    cv::line(bgra_image, points[0], points[1], cv::Scalar(0, 0, 255), 4);
+                }
+                else
+                {
+                    cv::polylines(bgra_image, points, true, cv::Scalar(0, 255, 0), 2);
+                }
+            }
             bgra_image = create_output_frame(bgra_image);
             cv::putText(bgra_image, "Preprocess Time   : " + std::to_string(int(pre_time)), cv::Point(1500, 60), cv::FONT_HERSHEY_SIMPLEX, font_size, cv::Scalar(255, 255, 255), font_weight, cv::LINE_AA);
             cv::putText(bgra_image, "AI Inference Time  : " + std::to_string(int(ai_time)), cv::Point(1503, 95), cv::FONT_HERSHEY_SIMPLEX, font_size, cv::Scalar(255, 255, 255), font_weight, cv::LINE_AA);
@@ -1145,13 +1204,13 @@ int8_t R_Main_Process()
             wayland.commit(bgra_image.data,NULL);
             img_obj_ready.store(0);
         }
-        /*Wait for 1 TICK.*/
-        usleep(WAIT_TIME);
+        /*Wait for the next frame from Capture Thread.*/
+        img_obj_ready.wait_set();
     }
 
 /*Error Processing*/
 err:
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     main_ret = 1;
     goto main_proc_end;
 /*Main Processing Termination*/
@@ -1387,25 +1446,39 @@ int32_t main(int32_t argc, char * argv[])
         goto end_threads;
     }
 
+    /*Stages and the events they hand over*/
+    stages.add_stage("capture", {&detect_request}, {&inference_start, &img_obj_ready});
+    stages.add_stage("inference", {&inference_start}, {&detect_ready});
+    stages.add_stage("main", {&img_obj_ready, &detect_ready}, {&detect_request});
+    stages.print();
+
+    /*Thread affinity and scheduling of config.ini*/
+    config_read();
+    thread_sched.read(ini_values["thread"]);
+    thread_sched.print();
+    thread_sched.lock_memory();
+
     /*Create Inference Thread*/
     create_thread_ai = pthread_create(&ai_inf_thread, NULL, R_Inf_Thread, NULL);
     if (0 != create_thread_ai)
     {
-        sem_trywait(&terminate_req_sem);
+        stages.shutdown();
         fprintf(stderr, "[ERROR] Failed to create AI Inference Thread.\n");
         ret_main = -1;
         goto end_threads;
     }
+    thread_sched.apply(ai_inf_thread, "inference");
 
     /* Create Capture Thread */
     create_thread_capture = pthread_create(&capture_thread, NULL, R_Capture_Thread, (void *) &gstreamer_pipeline);
     if (0 != create_thread_capture)
     {
-        sem_trywait(&terminate_req_sem);
+        stages.shutdown();
         fprintf(stderr, "[ERROR] Failed to create Capture Thread.\n");
         ret_main = -1;
         goto end_threads;
     }
+    thread_sched.apply(capture_thread, "capture");
 
     /* Create exit Thread */
     create_thread_exit = pthread_create(&exit_thread, NULL, R_exit_Thread, NULL);
@@ -1426,6 +1499,10 @@ int32_t main(int32_t argc, char * argv[])
         ret_main = -1;
         goto end_threads;
     }
+    thread_sched.apply(kbhit_thread, "key");
+
+    /*Main Thread last, the threads created above would inherit its settings*/
+    thread_sched.apply(pthread_self(), "main");
 
     /* Main Processing */
     main_proc = R_Main_Process();
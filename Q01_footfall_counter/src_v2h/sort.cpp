@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cfloat>
 #include "sort.h"
 
 using namespace sort;
@@ -5,7 +7,6 @@ using namespace sort;
 Sort::Sort(int maxAge, int minHits, float iouThresh)
     : maxAge(maxAge), minHits(minHits), iouThresh(iouThresh)
 {
-    km = std::make_shared<KuhnMunkres>();
 }
 
 
@@ -18,128 +19,129 @@ cv::Mat Sort::update(const cv::Mat &bboxesDet)
 {
     assert(bboxesDet.rows >= 0 && bboxesDet.cols == 6); // detections, [xc, yc, w, h, score, class_id]
 
-    cv::Mat bboxesPred(0, 6, CV_32F, cv::Scalar(0));  // predictions used in data association, [xc, yc, w, h, ...]
-    cv::Mat bboxesPost(0, 9, CV_32F, cv::Scalar(0));  // bounding boxes estimate, [xc, yc, w, h, score, class_id, vx, vy, tracker_id]
+    // kalman bbox tracker predict, trackers with NAN predictions are dropped
+    trackers.predictAll();
 
-    // kalman bbox tracker predict
-    for (auto it = trackers.begin(); it != trackers.end();)
-    {
-        cv::Mat bboxPred = (*it)->predict();   // Mat(1, 4)
-        if (isAnyNan<float>(bboxPred))
-            trackers.erase(it);     // remove the NAN value and corresponding tracker
-        else{
-            cv::hconcat(bboxPred, cv::Mat(1, 2, CV_32F,cv::Scalar(0)), bboxPred);   // Mat(1, 6)
-            cv::vconcat(bboxesPred, bboxPred, bboxesPred);  // Mat(N, 6)
-            ++it;
-        }
-    }
-
-    TypeAssociate asTuple = dataAssociate(bboxesDet, bboxesPred);
-    TypeMatchedPairs matchedDetPred = std::get<0>(asTuple);
-    TypeLostDets lostDets = std::get<1>(asTuple);
-    TypeLostPreds lostPreds = std::get<2>(asTuple);
+    dataAssociate(bboxesDet);
 
     // update matched trackers with assigned detections
-    for (auto pair : matchedDetPred)
+    cv::Mat bboxesPost(matchedDetPred.size(), 9, CV_32F);  // bounding boxes estimate, [xc, yc, w, h, score, class_id, vx, vy, tracker_id]
+    int numPost = 0;
+    for (auto [detInd, predInd] : matchedDetPred)
     {
-        int detInd = pair.first;
-        int predInd = pair.second;
-        cv::Mat bboxPost = trackers[predInd]->update(bboxesDet.rowRange(detInd, detInd + 1));
+        const float *det = bboxesDet.ptr<float>(detInd);
+        float *post = bboxesPost.ptr<float>(numPost);
+        trackers.update(predInd, det, post);
 
-        if (trackers[predInd]->getHitStreak() >= minHits)
+        trackers.setDetection(predInd, det[4], (float)(int)det[5]);
+
+        if (trackers.hitStreak(predInd) >= minHits)
         {
-            float score = bboxesDet.at<float>(detInd, 4);
-            int classId = bboxesDet.at<float>(detInd, 5);
-            float dx = trackers[predInd]->getState().at<float>(4, 0);
-            float dy = trackers[predInd]->getState().at<float>(5, 0);
-            int trackerId = trackers[predInd]->getFilterId();
-            cv::Mat tailData = (cv::Mat_<float>(1, 5) << score, classId, dx, dy, trackerId);
-            cv::hconcat(bboxPost, tailData, bboxPost);
-            cv::vconcat(bboxesPost, bboxPost, bboxesPost);  // Mat(N, 9)
+            post[4] = det[4];                           // score
+            post[5] = (float)(int)det[5];               // class_id
+            post[6] = trackers.state(predInd)[4];       // dx
+            post[7] = trackers.state(predInd)[5];       // dy
+            post[8] = (float)trackers.id(predInd);
+            numPost++;
         }
     }
 
     // remove dead trackers
-    trackers.erase(
-        std::remove_if(trackers.begin(), trackers.end(),
-            [&](const KalmanBoxTracker::Ptr& kbt)->bool {
-                return kbt->getTimeSinceUpdate() > maxAge;
-            }),
-        trackers.end()
-    );
+    trackers.removeStale(maxAge);
 
     // create and initialize new trackers for unmatched detections
-    for (int lostInd : lostDets)
+    for (int i = 0; i < bboxesDet.rows; ++i)
     {
-        cv::Mat lostBbox = bboxesDet.rowRange(lostInd, lostInd + 1);
-        trackers.push_back(make_shared<KalmanBoxTracker>(lostBbox));
+        if (!detMatched[i])
+            trackers.add(bboxesDet.ptr<float>(i));
     }
 
-    return bboxesPost;
+    return bboxesPost.rowRange(0, numPost);
 }
 
 
-TypeAssociate Sort::dataAssociate(const cv::Mat& bboxesDet, const cv::Mat& bboxesPred)
+cv::Mat Sort::predict()
 {
-    TypeMatchedPairs matchedDetPred;
-    TypeLostDets lostDets;
-    TypeLostPreds lostPreds;
+    trackers.coastAll();
 
-    // initialize
-    for (int i = 0; i < bboxesDet.rows; ++i)
-        lostDets.push_back(i);  // size M
-    for (int j = 0; j < bboxesPred.rows; ++j)
-        lostPreds.push_back(j); // size N
-
-    // nothing detected or predicted
-    if (bboxesDet.rows == 0 || bboxesPred.rows == 0)
-        return make_tuple(matchedDetPred, lostDets, lostPreds);
-
-    // compute IoU matrix
-    cv::Mat iouMat = getIouMatrix(bboxesDet, bboxesPred);   // Mat(M, N)
-
-    // Kuhn Munkres assignment algorithm
-    Vec2f costMatrix(iouMat.rows, Vec1f(iouMat.cols, 0.0f));
-    for (int i = 0; i < iouMat.rows; ++i)
-        for (int j = 0; j < iouMat.cols; ++j)
-            costMatrix[i][j] = 1.0f - iouMat.at<float>(i, j);
-    auto indices = km->compute(costMatrix);
-
-    // find matched pairs and lost detect and predict
-    for (auto [detInd, predInd] : indices) {
-        matchedDetPred.push_back({detInd, predInd});
-        lostDets.erase(remove(lostDets.begin(), lostDets.end(), detInd), lostDets.end());
-        lostPreds.erase(remove(lostPreds.begin(), lostPreds.end(), predInd), lostPreds.end());
+    cv::Mat bboxesPost(trackers.size(), 9, CV_32F);
+    int numPost = 0;
+    for (int i = 0; i < trackers.size(); ++i)
+    {
+        if (trackers.timeSinceUpdate(i) > 0 || trackers.hitStreak(i) < minHits)
+            continue;
+        float *post = bboxesPost.ptr<float>(numPost++);
+        memcpy(post, trackers.pred() + i * BOX_DIM, sizeof(float) * BOX_DIM);
+        post[4] = trackers.score(i);
+        post[5] = trackers.classId(i);
+        post[6] = trackers.state(i)[4];
+        post[7] = trackers.state(i)[5];
+        post[8] = (float)trackers.id(i);
     }
+    return bboxesPost.rowRange(0, numPost);
+}
+
+
+int Sort::getLostCount() const
+{
+    int lost = 0;
+    for (int i = 0; i < trackers.size(); ++i)
+        if (trackers.timeSinceUpdate(i) > 0)
+            lost++;
+    return lost;
+}
 
-    return make_tuple(matchedDetPred, lostDets, lostPreds);
+
+float Sort::getMaxPositionVariance() const
+{
+    float maxVar = 0.0f;
+    for (int i = 0; i < trackers.size(); ++i)
+        maxVar = std::max(maxVar, trackers.positionVariance(i));
+    return maxVar;
 }
 
 
-cv::Mat Sort::getIouMatrix(const cv::Mat& bboxesA, const cv::Mat& bboxesB)
+void Sort::dataAssociate(const cv::Mat& bboxesDet)
 {
-    assert(bboxesA.cols >= 4 && bboxesB.cols >= 4);
-    int numA = bboxesA.rows;
-    int numB = bboxesB.rows;
-    cv::Mat iouMat(numA, numB, CV_32F, cv::Scalar(0.0));
+    const int numDet = bboxesDet.rows;
+    const int numPred = trackers.size();
+    matchedDetPred.clear();
+    detMatched.assign(numDet, 0);
 
-    cv::Rect re1, re2;
-    for (int i = 0; i < numA; ++i)
+    // nothing detected or predicted
+    if (numDet == 0 || numPred == 0)
+        return;
+
+    // compute IoU matrix, Mat(M, N)
+    iouMat.resize((size_t)numDet * numPred);
+    const float *pred = trackers.pred();
+    for (int i = 0; i < numDet; ++i)
     {
-        for (int j = 0; j < numB; ++j)
-        {
-            re1.x = bboxesA.at<float>(i, 0) - bboxesA.at<float>(i, 2) / 2.0;
-            re1.y = bboxesA.at<float>(i, 1) - bboxesA.at<float>(i, 3) / 2.0;
-            re1.width = bboxesA.at<float>(i, 2);
-            re1.height = bboxesA.at<float>(i, 3);
-            re2.x = bboxesB.at<float>(j, 0) - bboxesB.at<float>(j, 2) / 2.0;
-            re2.y = bboxesB.at<float>(j, 1) - bboxesB.at<float>(j, 3) / 2.0;
-            re2.width = bboxesB.at<float>(j, 2);
-            re2.height = bboxesB.at<float>(j, 3);
-
-            iouMat.at<float>(i, j) = (re1 & re2).area() / ((re1 | re2).area() + FLT_EPSILON);
-        }
+        const float *det = bboxesDet.ptr<float>(i);
+        float *row = &iouMat[(size_t)i * numPred];
+        for (int j = 0; j < numPred; ++j)
+            row[j] = getIou(det, pred + j * BOX_DIM);
     }
 
-    return iouMat;
-}
\ No newline at end of file
+    // LAPJV assignment, solved per connected component of overlapping boxes
+    lap.AssociateIou(iouMat.data(), numDet, numPred, iouThresh, matchedDetPred);
+    for (auto [detInd, predInd] : matchedDetPred)
+        detMatched[detInd] = 1;
+}
+
+
+float Sort::getIou(const float *a, const float *b)
+{
+    // integer pixel boxes, as cv::Rect did before
+    int ax = a[0] - a[2] / 2.0, ay = a[1] - a[3] / 2.0, aw = a[2], ah = a[3];
+    int bx = b[0] - b[2] / 2.0, by = b[1] - b[3] / 2.0, bw = b[2], bh = b[3];
+    int w = std::min(ax + aw, bx + bw) - std::max(ax, bx);
+    int h = std::min(ay + ah, by + bh) - std::max(ay, by);
+    if (w <= 0 || h <= 0)
+        return 0.0f;
+    float inter = (float)w * h;
+    // union as the bounding rectangle of both boxes, as (re1 | re2).area() did before
+    int uw = std::max(ax + aw, bx + bw) - std::min(ax, bx);
+    int uh = std::max(ay + ah, by + bh) - std::min(ay, by);
+    return inter / ((float)uw * uh + FLT_EPSILON);
+}
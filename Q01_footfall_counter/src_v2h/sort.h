@@ -9,24 +9,16 @@
 #pragma once
 
 #include <memory>
-#include "kuhn_munkres.h"
-#include "kalman_box_tracker.h"
+#include <opencv2/core.hpp>
+#include "lapjv.h"
+#include "track_store.h"
 
 namespace sort{
     using std::shared_ptr;
     using std::vector;
     using std::pair;
-    using std::tuple;
-    using std::make_tuple;
-    using std::make_shared;
-    using kuhn_munkres::KuhnMunkres;
-    using kuhn_munkres::Vec2f;
-    using kuhn_munkres::Vec1f;
-    
+
     using TypeMatchedPairs = vector<pair<int, int> >;   // first: detected id, second: predicted id
-    using TypeLostDets = vector<int>;
-    using TypeLostPreds = vector<int>;
-    using TypeAssociate = tuple<TypeMatchedPairs, TypeLostDets, TypeLostPreds>;
 
     class Sort
     {
@@ -37,8 +29,13 @@ namespace sort{
         int maxAge;         // tracker's maximal unmatch count
         int minHits;        // tracker's minimal match count
         float iouThresh;    // IoU threshold
-        vector<KalmanBoxTracker::Ptr> trackers;
-        KuhnMunkres::Ptr km = nullptr;
+        TrackStore trackers;
+        LapJV lap;                      // assignment solver, workspace reused across frames
+
+        // association scratch, reused across frames
+        vector<float> iouMat;           // M x N IoU of detections and predictions, row major
+        TypeMatchedPairs matchedDetPred;
+        vector<char> detMatched;
 
     // methods
     public:
@@ -54,35 +51,47 @@ namespace sort{
          * @return matched bboxes, Mat(N, 9) with the format [[xc,yc,w,h,score,class_id,dx,dy,tracker_id];[...];...].
          */
         cv::Mat update(const cv::Mat &bboxesDet);
-    private:
-        /** 
-         * @brief check if NAN value in Mat
-         * @param mat input Matrix 
-         * @return any NAN value in Matrix or not.
+
+        /**
+         * @brief bbox tracking on a frame where the detector was skipped, the trackers are moved
+         *        by Kalman prediction only and the ones matched at the last update are reported.
+         * @return predicted bboxes, Mat(N, 9) in the same format as update(), score and class_id
+         *         are taken from the last matched detection.
+         */
+        cv::Mat predict();
+
+        /**
+         * @return the trackers after the last frame, setTrackers() brings them back to correct
+         *         them with detections of that frame that come later
          */
-        template<typename _Tp>
-        static bool isAnyNan(const cv::Mat& mat)
-        {
-            for (auto it = mat.begin<_Tp>(); it != mat.end<_Tp>(); ++it)
-                if (*it != *it) return true;
-            return false;
-        }
+        const TrackStore &getTrackers() const { return trackers; }
+        /**
+         * @brief restore trackers returned by getTrackers()
+         * @param store trackers
+         */
+        void setTrackers(const TrackStore &store) { trackers = store; }
+        /**
+         * @return number of trackers that were not matched by the last update
+         */
+        int getLostCount() const;
 
         /**
-         * @brief data associate in SORT
+         * @return largest box centre variance over the trackers
+         */
+        float getMaxPositionVariance() const;
+    private:
+        /**
+         * @brief data associate in SORT, fills matchedDetPred and detMatched
          * @param bboxesDet detected bboxes, Mat(M, 4+)
-         * @param bboxesPred predicted bboxes, Mat(N, 4+)
-         * @return associate tuple (matched pairs, lost detections, lost predictions)
          */
-        TypeAssociate dataAssociate(const cv::Mat& bboxesDet, const cv::Mat& bboxesPred);
+        void dataAssociate(const cv::Mat& bboxesDet);
 
         /**
-         * @brief IoU of bboxes
-         * @param bboxesA input bboxes A, Mat(M, 4+)
-         * @param bboxesB another input bboxes B, Mat(N, 4+)
-         * @return M x N matrix, value(i, j) means IoU of A(i) and B(j)
+         * @brief IoU of two bboxes
+         * @param a bbox [xc, yc, w, h]
+         * @param b bbox [xc, yc, w, h]
+         * @return IoU
          */
-        static cv::Mat getIouMatrix(const cv::Mat& bboxesA, const cv::Mat& bboxesB);
+        static float getIou(const float *a, const float *b);
     };
 }
-
@@ -0,0 +1,140 @@
+#include "track_store.h"
+
+using namespace sort;
+
+int TrackStore::count = 0;
+
+// posteriori error estimate covariance (P(0)), high uncertainty on the unobserved velocities
+static const float kInitialCov[KF_DIM_X] = {10, 10, 10, 10, 1e4, 1e4, 1e4};
+// process noise covariance (Q), P'(k) = A*P(k-1)*At + Q
+static const float kProcessNoise[KF_DIM_X] = {1, 1, 1, 1, 1e-2, 1e-2, 1e-4};
+// measurement noise covariance (R), K(k) = P`(k)*Ht*inv(H*P`(k)*Ht + R)
+static const float kMeasurementNoise[KF_DIM_Z] = {1, 1, 10, 10};
+
+
+TrackStore::TrackStore(int capacity)
+{
+    filters.reserve(capacity);
+    preds.reserve(capacity * BOX_DIM);
+    ids.reserve(capacity);
+    ages.reserve(capacity);
+    hits.reserve(capacity);
+    scores.reserve(capacity);
+    classes.reserve(capacity);
+}
+
+
+int TrackStore::add(const float *bbox)
+{
+    // state transition (A) and measurement (H) matrices are the constant velocity
+    // model built into FixedKalmanFilter: xc, yc, s advance by dxc, dyc, ds each step
+    // and the first KF_DIM_Z states are measured directly
+    filters.emplace_back();
+    Filter &kf = filters.back();
+    memcpy(kf.q_, kProcessNoise, sizeof(kf.q_));
+    memcpy(kf.r_, kMeasurementNoise, sizeof(kf.r_));
+    float z[KF_DIM_Z];
+    convertBBoxToZ(bbox, z);
+    kf.Init(z, kInitialCov);
+
+    preds.insert(preds.end(), bbox, bbox + BOX_DIM);
+    ids.push_back(count++);
+    ages.push_back(0);
+    hits.push_back(0);
+    scores.push_back(0.0f);
+    classes.push_back(0.0f);
+    return size() - 1;
+}
+
+
+void TrackStore::remove(int slot)
+{
+    assert(slot >= 0 && slot < size());
+    int last = size() - 1;
+    if (slot != last)
+    {
+        filters[slot] = filters[last];
+        memcpy(&preds[slot * BOX_DIM], &preds[last * BOX_DIM], sizeof(float) * BOX_DIM);
+        ids[slot] = ids[last];
+        ages[slot] = ages[last];
+        hits[slot] = hits[last];
+        scores[slot] = scores[last];
+        classes[slot] = classes[last];
+    }
+    filters.pop_back();
+    preds.resize(last * BOX_DIM);
+    ids.pop_back();
+    ages.pop_back();
+    hits.pop_back();
+    scores.pop_back();
+    classes.pop_back();
+}
+
+
+void TrackStore::predictAll()
+{
+    for (int i = 0; i < size();)
+    {
+        Filter &kf = filters[i];
+        // bbox area (ds/dt + s) shouldn't be negtive
+        if (kf.x_[6] + kf.x_[2] <= 0)
+            kf.x_[6] = 0;
+        kf.Predict();
+
+        float *box = &preds[i * BOX_DIM];
+        convertXToBBox(kf.x_, box);
+        if (!(isfinite(box[0]) && isfinite(box[1]) && isfinite(box[2]) && isfinite(box[3])))
+        {
+            remove(i);  // the last tracker moved into slot i, predict it next
+            continue;
+        }
+
+        hits[i] = ages[i] > 0 ? 0 : hits[i];
+        ages[i]++;
+        ++i;
+    }
+}
+
+
+void TrackStore::coastAll()
+{
+    for (int i = 0; i < size();)
+    {
+        Filter &kf = filters[i];
+        if (kf.x_[6] + kf.x_[2] <= 0)
+            kf.x_[6] = 0;
+        kf.Predict();
+
+        float *box = &preds[i * BOX_DIM];
+        convertXToBBox(kf.x_, box);
+        if (!(isfinite(box[0]) && isfinite(box[1]) && isfinite(box[2]) && isfinite(box[3])))
+        {
+            remove(i);
+            continue;
+        }
+        ++i;
+    }
+}
+
+
+void TrackStore::update(int slot, const float *bbox, float *bboxPost)
+{
+    ages[slot] = 0;
+    hits[slot] += 1;
+    float z[KF_DIM_Z];
+    convertBBoxToZ(bbox, z);
+    filters[slot].Update(z);
+    convertXToBBox(filters[slot].x_, bboxPost);
+}
+
+
+void TrackStore::removeStale(int maxAge)
+{
+    for (int i = 0; i < size();)
+    {
+        if (ages[i] > maxAge)
+            remove(i);
+        else
+            ++i;
+    }
+}
@@ -0,0 +1,123 @@
+/**
+ * @desc:   Structure-of-arrays store of the SORT box trackers.
+ *          Each tracker is a constant velocity Kalman filter over
+ *          [xc, yc, s, r, dxc/dt, dyc/dt, ds/dt] measured as [xc, yc, s, r].
+ *          Filters, predicted boxes and bookkeeping live in parallel arrays
+ *          indexed by slot; removal swaps the last slot into the hole.
+ */
+#pragma once
+
+#include <assert.h>
+#include <math.h>
+#include <vector>
+#include "fixed_kalman_filter.h"
+
+#define KF_DIM_X 7      // xc, yc, s, r, dxc/dt, dyc/dt, ds/dt
+#define KF_DIM_Z 4      // xc, yc, s, r
+#define BOX_DIM  4      // xc, yc, w, h
+
+namespace sort
+{
+    class TrackStore
+    {
+    public:
+        using Filter = FixedKalmanFilter<KF_DIM_X, KF_DIM_Z>;
+
+        /**
+         * @param capacity number of trackers preallocated, the store grows beyond it if needed
+         */
+        explicit TrackStore(int capacity = 64);
+
+        /**
+         * @brief start a new tracker on a detection
+         * @param bbox boundary box [xc, yc, w, h]
+         * @return slot of the new tracker
+         */
+        int add(const float *bbox);
+
+        /**
+         * @brief remove a tracker, the last tracker is moved into its slot
+         * @param slot tracker slot
+         */
+        void remove(int slot);
+
+        /**
+         * @brief advance every tracker and store its predicted box (see pred()).
+         *        Trackers whose prediction is not finite are removed.
+         */
+        void predictAll();
+
+        /**
+         * @brief advance every tracker by one frame on which the detector was skipped,
+         *        the trackers are neither counted as missed nor as hit
+         */
+        void coastAll();
+
+        /**
+         * @brief update a tracker with an observed box
+         * @param slot tracker slot
+         * @param bbox boundary box [xc, yc, w, h]
+         * @param bboxPost corrected box estimate [xc, yc, w, h]
+         */
+        void update(int slot, const float *bbox, float *bboxPost);
+
+        /**
+         * @brief remove trackers that have not been updated for more than maxAge predictions
+         */
+        void removeStale(int maxAge);
+
+        inline int size() const { return (int)ids.size(); }
+        inline int id(int slot) const { return ids[slot]; }
+        inline int timeSinceUpdate(int slot) const { return ages[slot]; }
+        inline int hitStreak(int slot) const { return hits[slot]; }
+        inline const float *state(int slot) const { return filters[slot].x_; }
+        // variance of the box centre, grows while the tracker coasts
+        inline float positionVariance(int slot) const { return filters[slot].P_[0][0] + filters[slot].P_[1][1]; }
+        // score and class of the last matched detection
+        inline float score(int slot) const { return scores[slot]; }
+        inline float classId(int slot) const { return classes[slot]; }
+        inline void setDetection(int slot, float score, float classId) { scores[slot] = score; classes[slot] = classId; }
+        // predicted boxes of all trackers, size() x BOX_DIM, row major
+        inline const float *pred() const { return preds.data(); }
+
+        static inline int getFilterCount() { return count; }
+
+    private:
+        static int count;
+
+        std::vector<Filter> filters;    // state and covariance
+        std::vector<float> preds;       // predicted box per tracker
+        std::vector<int> ids;
+        std::vector<int> ages;          // predictions since the last update
+        std::vector<int> hits;          // consecutive updates
+        std::vector<float> scores;      // last matched detection score
+        std::vector<float> classes;     // last matched detection class
+
+        /**
+         * @brief convert boundary box to measurement.
+         * @param bbox boundary box [x center, y center, width, height]
+         * @param z measurement vector [x center, y center, scale/area, aspect ratio]
+         */
+        static inline void convertBBoxToZ(const float *bbox, float *z)
+        {
+            z[0] = bbox[0];
+            z[1] = bbox[1];
+            z[2] = bbox[2] * bbox[3];
+            z[3] = bbox[2] / bbox[3];
+        }
+
+        /**
+         * @brief convert state vector to boundary box.
+         * @param state state vector [x center, y center, scale/area, aspect ratio, ...]
+         * @param bbox boundary box [x center, y center, width, height]
+         */
+        static inline void convertXToBBox(const float *state, float *bbox)
+        {
+            float w = sqrt(state[2] * state[3]);
+            bbox[0] = state[0];
+            bbox[1] = state[1];
+            bbox[2] = w;
+            bbox[3] = state[2] / w;
+        }
+    };
+}
@@ -0,0 +1,429 @@
+#include "zone_counter.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+// Upper bound of grid cells per axis of a polygon
+constexpr int32_t kGridCells = 32;
+
+constexpr uint8_t kCellOutside = 0;
+constexpr uint8_t kCellInside = 1;
+constexpr uint8_t kCellBoundary = 2;
+
+// Per track state is dropped when the track has not been updated for this many frames
+constexpr uint32_t kMaxMissedFrames = 30;
+
+// Event ring capacity, a power of two
+constexpr uint64_t kEventCapacity = 4096;
+
+const char *const kEventNames[] = {"in", "out", "enter", "exit"};
+
+// Does the segment a-b touch the closed rectangle [x0, x1] x [y0, y1]
+bool SegmentTouchesRect(ZonePoint a, ZonePoint b, int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+    if (std::max(a.x, b.x) < x0 || std::min(a.x, b.x) > x1 ||
+        std::max(a.y, b.y) < y0 || std::min(a.y, b.y) > y1) {
+        return false;
+    }
+    // separating axis along the segment normal: all corners strictly on one side
+    const int64_t dx = b.x - a.x;
+    const int64_t dy = b.y - a.y;
+    const int32_t cx[4] = {x0, x1, x0, x1};
+    const int32_t cy[4] = {y0, y0, y1, y1};
+    int pos = 0;
+    int neg = 0;
+    for (int i = 0; i < 4; i++) {
+        const int64_t s = dx * (cy[i] - a.y) - dy * (cx[i] - a.x);
+        pos += (s > 0);
+        neg += (s < 0);
+    }
+    return pos != 4 && neg != 4;
+}
+
+int ParseInt(const std::unordered_map<std::string, std::string>& section, const std::string& key) {
+    auto it = section.find(key);
+    if (it == section.end()) {
+        throw std::invalid_argument(key);
+    }
+    return std::stoi(it->second);
+}
+}
+
+
+ZoneCounter::ZoneCounter()
+    : frame_(0), now_ms_(0), frame_dt_ms_(0), has_frame_(false),
+      events_(kEventCapacity), event_seq_(0), logged_seq_(0), log_file_(nullptr) {}
+
+
+ZoneCounter::~ZoneCounter() {
+    if (log_file_ != nullptr) {
+        fclose(log_file_);
+    }
+}
+
+
+int ZoneCounter::LoadConfig(const IniSections& ini) {
+    std::vector<std::string> names;
+    for (const auto& section : ini) {
+        const std::string& name = section.first;
+        if (name == "line" || name.rfind("line_", 0) == 0 ||
+            name == "region" || name.rfind("region_", 0) == 0) {
+            names.push_back(name);
+        }
+    }
+    // unordered_map order is arbitrary, keep the zone indices stable
+    std::sort(names.begin(), names.end());
+
+    int added = 0;
+    for (const auto& name : names) {
+        const auto& section = ini.at(name);
+        try {
+            int debounce = 1;
+            if (section.count("debounce")) {
+                debounce = ParseInt(section, "debounce");
+            }
+            if (name[0] == 'l') {
+                AddLine(name,
+                        {ParseInt(section, "x1"), ParseInt(section, "y1")},
+                        {ParseInt(section, "x2"), ParseInt(section, "y2")}, debounce);
+            } else {
+                int n = 0;
+                if (section.count("n")) {
+                    n = ParseInt(section, "n");
+                } else {
+                    while (section.count("x" + std::to_string(n + 1))) {
+                        n++;
+                    }
+                }
+                if (n < 3) {
+                    fprintf(stderr, "[ERROR] [%s] needs at least 3 points\n", name.c_str());
+                    return -1;
+                }
+                std::vector<ZonePoint> points(n);
+                for (int i = 0; i < n; i++) {
+                    points[i].x = ParseInt(section, "x" + std::to_string(i + 1));
+                    points[i].y = ParseInt(section, "y" + std::to_string(i + 1));
+                }
+                AddPolygon(name, points, debounce);
+            }
+        } catch (const std::exception& e) {
+            fprintf(stderr, "[ERROR] [%s] missing or invalid value: %s\n", name.c_str(), e.what());
+            return -1;
+        }
+        added++;
+    }
+    return added;
+}
+
+
+int ZoneCounter::AddLine(const std::string& name, ZonePoint p1, ZonePoint p2, int debounce) {
+    // "below" is side 1, as y grows downwards in the image; orient left to right
+    if (p2.x < p1.x) {
+        std::swap(p1, p2);
+    }
+    LineGeometry g;
+    const int64_t dx = p2.x - p1.x;
+    const int64_t dy = p2.y - p1.y;
+    g.a = -dy;
+    g.b = dx;
+    g.c = dy * p1.x - dx * p1.y;
+    g.u = dx;
+    g.v = dy;
+    g.t0 = dx * p1.x + dy * p1.y;
+    g.t1 = dx * p2.x + dy * p2.y;
+    lines_.push_back(g);
+    geometry_.push_back((int)lines_.size() - 1);
+
+    zones_.push_back({name, kZoneLine, {p1, p2}, std::max(1, debounce), 0, 0, 0});
+    // the state layout depends on the number of zones
+    slot_of_.clear();
+    slots_.clear();
+    free_slots_.clear();
+    states_.clear();
+    return (int)zones_.size() - 1;
+}
+
+
+int ZoneCounter::AddPolygon(const std::string& name, const std::vector<ZonePoint>& points, int debounce) {
+    PolygonGeometry g;
+    g.min_x = g.max_x = points[0].x;
+    g.min_y = g.max_y = points[0].y;
+    for (const auto& p : points) {
+        g.min_x = std::min(g.min_x, p.x);
+        g.max_x = std::max(g.max_x, p.x);
+        g.min_y = std::min(g.min_y, p.y);
+        g.max_y = std::max(g.max_y, p.y);
+    }
+    g.cell_w = std::max(1, (g.max_x - g.min_x + kGridCells) / kGridCells);
+    g.cell_h = std::max(1, (g.max_y - g.min_y + kGridCells) / kGridCells);
+    g.cols = (g.max_x - g.min_x) / g.cell_w + 1;
+    g.rows = (g.max_y - g.min_y) / g.cell_h + 1;
+
+    const size_t n = points.size();
+
+    // Row edge tables, the crossing test of a point only looks at its own row
+    g.row_start.assign(g.rows + 1, 0);
+    for (int32_t r = 0; r < g.rows; r++) {
+        g.row_start[r] = (uint32_t)g.row_edges.size();
+        const int32_t y0 = g.min_y + r * g.cell_h;
+        const int32_t y1 = y0 + g.cell_h;
+        for (size_t i = 0; i < n; i++) {
+            const ZonePoint& a = points[i];
+            const ZonePoint& b = points[(i + 1) % n];
+            if (std::max(a.y, b.y) >= y0 && std::min(a.y, b.y) <= y1) {
+                g.row_edges.push_back((uint32_t)i);
+            }
+        }
+    }
+    g.row_start[g.rows] = (uint32_t)g.row_edges.size();
+
+    // Cells touched by an edge are boundary cells, the others are uniformly
+    // inside or outside and are classified by one of their points
+    g.cells.assign((size_t)g.rows * g.cols, kCellOutside);
+    for (int32_t r = 0; r < g.rows; r++) {
+        const int32_t y0 = g.min_y + r * g.cell_h;
+        for (int32_t c = 0; c < g.cols; c++) {
+            const int32_t x0 = g.min_x + c * g.cell_w;
+            bool boundary = false;
+            for (uint32_t k = g.row_start[r]; k < g.row_start[r + 1] && !boundary; k++) {
+                const uint32_t i = g.row_edges[k];
+                boundary = SegmentTouchesRect(points[i], points[(i + 1) % n],
+                                              x0, y0, x0 + g.cell_w, y0 + g.cell_h);
+            }
+            uint8_t cls = kCellBoundary;
+            if (!boundary) {
+                cls = CrossingTest(points, g, r, {x0, y0}) ? kCellInside : kCellOutside;
+            }
+            g.cells[(size_t)r * g.cols + c] = cls;
+        }
+    }
+    polygons_.push_back(std::move(g));
+    geometry_.push_back((int)polygons_.size() - 1);
+
+    zones_.push_back({name, kZonePolygon, points, std::max(1, debounce), 0, 0, 0});
+    slot_of_.clear();
+    slots_.clear();
+    free_slots_.clear();
+    states_.clear();
+    return (int)zones_.size() - 1;
+}
+
+
+bool ZoneCounter::OpenLog(const std::string& path) {
+    if (log_file_ != nullptr) {
+        fclose(log_file_);
+    }
+    log_file_ = fopen(path.c_str(), "a");
+    if (log_file_ == nullptr) {
+        fprintf(stderr, "[ERROR] Failed to open event log %s\n", path.c_str());
+        return false;
+    }
+    logged_seq_ = event_seq_;
+    return true;
+}
+
+
+bool ZoneCounter::CrossingTest(const std::vector<ZonePoint>& pts, const PolygonGeometry& g,
+                               int32_t row, ZonePoint p) const {
+    const size_t n = pts.size();
+    bool inside = false;
+    for (uint32_t k = g.row_start[row]; k < g.row_start[row + 1]; k++) {
+        const uint32_t i = g.row_edges[k];
+        const ZonePoint& a = pts[i];
+        const ZonePoint& b = pts[(i + 1) % n];
+        if ((a.y > p.y) != (b.y > p.y)) {
+            // x of the edge at the height of p, compared without division
+            const int64_t lhs = (int64_t)(p.x - a.x) * (b.y - a.y);
+            const int64_t rhs = (int64_t)(b.x - a.x) * (p.y - a.y);
+            if ((b.y > a.y) ? (lhs < rhs) : (lhs > rhs)) {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+
+bool ZoneCounter::Inside(int zone, ZonePoint p) const {
+    const PolygonGeometry& g = polygons_[geometry_[zone]];
+    if (p.x < g.min_x || p.x > g.max_x || p.y < g.min_y || p.y > g.max_y) {
+        return false;
+    }
+    const int32_t r = (p.y - g.min_y) / g.cell_h;
+    const int32_t c = (p.x - g.min_x) / g.cell_w;
+    const uint8_t cls = g.cells[(size_t)r * g.cols + c];
+    if (cls != kCellBoundary) {
+        return cls == kCellInside;
+    }
+    return CrossingTest(zones_[zone].points, g, r, p);
+}
+
+
+int ZoneCounter::Side(int zone, ZonePoint p) const {
+    const LineGeometry& g = lines_[geometry_[zone]];
+    const int64_t t = g.u * p.x + g.v * p.y;
+    if (t < g.t0 || t > g.t1) {
+        return -1;
+    }
+    return (g.a * p.x + g.b * p.y + g.c) > 0 ? 1 : 0;
+}
+
+
+int ZoneCounter::FindZone(const std::string& name) const {
+    for (size_t z = 0; z < zones_.size(); z++) {
+        if (zones_[z].name == name) {
+            return (int)z;
+        }
+    }
+    return -1;
+}
+
+
+void ZoneCounter::BeginFrame(int64_t timestamp_ms) {
+    frame_dt_ms_ = has_frame_ ? std::max<int64_t>(0, timestamp_ms - now_ms_) : 0;
+    now_ms_ = timestamp_ms;
+    has_frame_ = true;
+    frame_++;
+    for (auto& zone : zones_) {
+        zone.occupancy = 0;
+    }
+}
+
+
+void ZoneCounter::Update(int track_id, ZonePoint anchor) {
+    const int slot = AllocSlot(track_id);
+    slots_[slot].last_frame = frame_;
+    ZoneState *state = &states_[(size_t)slot * zones_.size()];
+
+    for (size_t z = 0; z < zones_.size(); z++) {
+        Zone& zone = zones_[z];
+        ZoneState& s = state[z];
+        const bool polygon = zone.type == kZonePolygon;
+        const int raw = polygon ? (int)Inside((int)z, anchor) : Side((int)z, anchor);
+        if (raw >= 0) {
+            if (s.side < 0) {
+                // first sighting: lines only learn the side, polygons count an entry
+                s.side = (int8_t)raw;
+                if (polygon && raw == 1) {
+                    zone.count_in++;
+                    Log(track_id, (int)z, kEventEnter);
+                }
+            } else if (raw == s.side) {
+                s.pending_frames = 0;
+            } else {
+                if (raw == s.pending) {
+                    s.pending_frames++;
+                } else {
+                    s.pending = (int8_t)raw;
+                    s.pending_frames = 1;
+                }
+                if (s.pending_frames >= zone.debounce) {
+                    s.side = (int8_t)raw;
+                    s.pending_frames = 0;
+                    if (raw == 1) {
+                        zone.count_in++;
+                        Log(track_id, (int)z, polygon ? kEventEnter : kEventLineIn);
+                    } else {
+                        zone.count_out++;
+                        Log(track_id, (int)z, polygon ? kEventExit : kEventLineOut);
+                    }
+                }
+            }
+        }
+        if (polygon && s.side == 1) {
+            s.dwell_ms += frame_dt_ms_;
+            zone.occupancy++;
+        }
+    }
+}
+
+
+void ZoneCounter::EndFrame() {
+    for (int slot = 0; slot < (int)slots_.size(); slot++) {
+        TrackSlot& t = slots_[slot];
+        if (t.id < 0 || frame_ - t.last_frame <= kMaxMissedFrames) {
+            continue;
+        }
+        const ZoneState *state = &states_[(size_t)slot * zones_.size()];
+        for (size_t z = 0; z < zones_.size(); z++) {
+            if (zones_[z].type == kZonePolygon && state[z].side == 1) {
+                zones_[z].count_out++;
+                Log(t.id, (int)z, kEventExit);
+            }
+        }
+        FreeSlot(slot);
+    }
+
+    if (log_file_ != nullptr && logged_seq_ != event_seq_) {
+        if (event_seq_ - logged_seq_ > kEventCapacity) {
+            logged_seq_ = event_seq_ - kEventCapacity;
+        }
+        for (; logged_seq_ < event_seq_; logged_seq_++) {
+            const ZoneEvent& e = events_[logged_seq_ & (kEventCapacity - 1)];
+            fprintf(log_file_, "%lld,%d,%s,%s\n", (long long)e.timestamp_ms, e.track_id,
+                    zones_[e.zone].name.c_str(), kEventNames[e.type]);
+        }
+        fflush(log_file_);
+    }
+}
+
+
+int64_t ZoneCounter::GetDwellMs(int track_id, int zone) const {
+    auto it = slot_of_.find(track_id);
+    if (it == slot_of_.end() || zone < 0 || zone >= (int)zones_.size()) {
+        return 0;
+    }
+    return states_[(size_t)it->second * zones_.size() + zone].dwell_ms;
+}
+
+
+void ZoneCounter::ReadEvents(uint64_t& cursor, std::vector<ZoneEvent>& out) const {
+    if (event_seq_ - cursor > kEventCapacity) {
+        cursor = event_seq_ - kEventCapacity;
+    }
+    for (; cursor < event_seq_; cursor++) {
+        out.push_back(events_[cursor & (kEventCapacity - 1)]);
+    }
+}
+
+
+int ZoneCounter::AllocSlot(int track_id) {
+    auto it = slot_of_.find(track_id);
+    if (it != slot_of_.end()) {
+        return it->second;
+    }
+    int slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        slot = (int)slots_.size();
+        slots_.push_back({-1, 0});
+        states_.resize(states_.size() + zones_.size());
+    }
+    slots_[slot].id = track_id;
+    ZoneState *state = &states_[(size_t)slot * zones_.size()];
+    for (size_t z = 0; z < zones_.size(); z++) {
+        state[z] = {-1, -1, 0, 0};
+    }
+    slot_of_[track_id] = slot;
+    return slot;
+}
+
+
+void ZoneCounter::FreeSlot(int slot) {
+    slot_of_.erase(slots_[slot].id);
+    slots_[slot].id = -1;
+    free_slots_.push_back(slot);
+}
+
+
+void ZoneCounter::Log(int track_id, int zone, ZoneEventType type) {
+    ZoneEvent& e = events_[event_seq_ & (kEventCapacity - 1)];
+    e.timestamp_ms = now_ms_;
+    e.track_id = track_id;
+    e.zone = (uint16_t)zone;
+    e.type = type;
+    e.reserved = 0;
+    event_seq_++;
+}
@@ -0,0 +1,188 @@
+/**
+ * @desc:   Counting engine for many named lines and polygons at once.
+ *          Geometry is preprocessed when a zone is added: lines into a side
+ *          test with a segment band, polygons into a bounding box, a uniform
+ *          grid of inside / outside / boundary cells and per-row edge tables,
+ *          so a point test is one cell lookup and, on boundary cells only, a
+ *          crossing test against the few edges of that row.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ZonePoint {
+    int32_t x;
+    int32_t y;
+};
+
+enum ZoneType : uint8_t {
+    kZoneLine = 0,
+    kZonePolygon = 1
+};
+
+enum ZoneEventType : uint8_t {
+    kEventLineIn = 0,     // crossed a line from side 0 (above) to side 1 (below)
+    kEventLineOut = 1,    // crossed a line from side 1 to side 0
+    kEventEnter = 2,      // entered a polygon
+    kEventExit = 3        // left a polygon, or was lost inside it
+};
+
+/**
+ * One entry of the event log, 16 bytes
+ */
+struct ZoneEvent {
+    int64_t timestamp_ms;
+    int32_t track_id;
+    uint16_t zone;
+    uint8_t type;
+    uint8_t reserved;
+};
+
+/**
+ * Named zone with its counters, read-only for callers
+ */
+struct Zone {
+    std::string name;
+    ZoneType type;
+    std::vector<ZonePoint> points;
+    // frames a new side / inside state must persist before it is accepted
+    int debounce;
+    // line crossings per direction, polygon entries and exits
+    int count_in;
+    int count_out;
+    // polygon only: tracks inside on the last frame
+    int occupancy;
+};
+
+class ZoneCounter {
+public:
+    using IniSections = std::unordered_map<std::string, std::unordered_map<std::string, std::string>>;
+
+    ZoneCounter();
+    ~ZoneCounter();
+
+    /**
+     * Add the zones of config.ini: sections [line] and [line_<name>] with keys
+     * x1, y1, x2, y2, sections [region] and [region_<name>] with key n and
+     * x1, y1 .. xn, yn. An optional key debounce gives the frames of hysteresis.
+     * @param ini parsed config.ini
+     * @return number of zones added, -1 on a malformed section
+     */
+    int LoadConfig(const IniSections& ini);
+
+    /**
+     * @return index of the new zone
+     */
+    int AddLine(const std::string& name, ZonePoint p1, ZonePoint p2, int debounce = 1);
+    int AddPolygon(const std::string& name, const std::vector<ZonePoint>& points, int debounce = 1);
+
+    /**
+     * Append new events to a CSV file (timestamp_ms,track_id,zone,event)
+     * @return false if the file cannot be opened
+     */
+    bool OpenLog(const std::string& path);
+
+    /**
+     * Frame protocol: BeginFrame, Update for every confirmed track, EndFrame
+     * @param timestamp_ms frame time, dwell time is accumulated from its deltas
+     */
+    void BeginFrame(int64_t timestamp_ms);
+    void Update(int track_id, ZonePoint anchor);
+    void EndFrame();
+
+    /**
+     * @return time the track has spent inside the polygon zone, 0 if unknown
+     */
+    int64_t GetDwellMs(int track_id, int zone) const;
+
+    /**
+     * @return zone index, -1 if there is no zone of that name
+     */
+    int FindZone(const std::string& name) const;
+
+    const std::vector<Zone>& GetZones() const { return zones_; }
+
+    /**
+     * Copy the events logged after the cursor, then advance it. Events that
+     * were overwritten in the ring before being read are skipped.
+     * @param cursor in/out, sequence number of the next event to read, start at 0
+     * @param out events appended in time order
+     */
+    void ReadEvents(uint64_t& cursor, std::vector<ZoneEvent>& out) const;
+
+    /**
+     * Point in polygon against the preprocessed geometry of a polygon zone,
+     * points on the boundary may go either way
+     */
+    bool Inside(int zone, ZonePoint p) const;
+
+    /**
+     * @return side of a line zone the point is on (1 below, 0 above), -1 if it
+     *         is beyond the ends of the segment
+     */
+    int Side(int zone, ZonePoint p) const;
+
+private:
+    // Preprocessed polygon: bounding box, grid of cell classes and per-row edge tables
+    struct PolygonGeometry {
+        int32_t min_x, min_y, max_x, max_y;
+        int32_t cell_w, cell_h;
+        int32_t cols, rows;
+        // kCellOutside / kCellInside / kCellBoundary, rows x cols
+        std::vector<uint8_t> cells;
+        // edges overlapping each row band: row_start[r] .. row_start[r + 1] in row_edges
+        std::vector<uint32_t> row_start;
+        std::vector<uint32_t> row_edges;
+    };
+
+    // Per track, per zone state
+    struct ZoneState {
+        int8_t side;          // accepted state, -1 until first seen
+        int8_t pending;       // candidate state
+        uint16_t pending_frames;
+        int64_t dwell_ms;
+    };
+
+    struct TrackSlot {
+        int id;
+        uint32_t last_frame;
+    };
+
+    bool CrossingTest(const std::vector<ZonePoint>& pts, const PolygonGeometry& g,
+                      int32_t row, ZonePoint p) const;
+    int AllocSlot(int track_id);
+    void FreeSlot(int slot);
+    void Log(int track_id, int zone, ZoneEventType type);
+
+    std::vector<Zone> zones_;
+    // index of the geometry of each zone, in lines_ or polygons_
+    std::vector<int> geometry_;
+    std::vector<PolygonGeometry> polygons_;
+    // line side test: a x + b y + c, band along the segment: t0 <= u x + v y <= t1
+    struct LineGeometry {
+        int64_t a, b, c;
+        int64_t u, v, t0, t1;
+    };
+    std::vector<LineGeometry> lines_;
+
+    // track id -> slot, slot * zones_.size() + zone -> state
+    std::unordered_map<int, int> slot_of_;
+    std::vector<TrackSlot> slots_;
+    std::vector<int> free_slots_;
+    std::vector<ZoneState> states_;
+
+    uint32_t frame_;
+    int64_t now_ms_;
+    int64_t frame_dt_ms_;
+    bool has_frame_;
+
+    // event ring buffer, capacity is a power of two
+    std::vector<ZoneEvent> events_;
+    uint64_t event_seq_;
+    uint64_t logged_seq_;
+    FILE *log_file_;
+};
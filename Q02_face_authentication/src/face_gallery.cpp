@@ -0,0 +1,333 @@
+/*
+ * Original Code (C) Copyright Renesas Electronics Corporation 2024
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/***********************************************************************************************************************
+* File Name    : face_gallery.cpp
+* Version      : 1.0
+* Description  : Enrolled face embeddings and one-vs-all matching
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* Include
+***********************************************************************************************************************/
+#include "face_gallery.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+/*****************************************
+* Function Name : aligned_floats
+* Description   : Allocate a FACE_GALLERY_ALIGN aligned float array.
+* Arguments     : n = number of floats
+* Return value  : pointer to the array, throws std::bad_alloc on failure
+******************************************/
+static float* aligned_floats(size_t n)
+{
+    void* ptr = NULL;
+    if (0 != posix_memalign(&ptr, FACE_GALLERY_ALIGN, (n > 0 ? n : 1) * sizeof(float)))
+    {
+        throw std::bad_alloc();
+    }
+    return (float*)ptr;
+}
+
+/*****************************************
+* Function Name : embedding_dot
+* Description   : Dot product of two embeddings.
+* Arguments     : a, b = embeddings
+*                 dim = embedding length
+* Return value  : float = dot product
+******************************************/
+float embedding_dot(const float* a, const float* b, int32_t dim)
+{
+    int32_t i = 0;
+    float sum = 0.0f;
+#if defined(__ARM_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    float32x4_t acc2 = vdupq_n_f32(0.0f);
+    float32x4_t acc3 = vdupq_n_f32(0.0f);
+    for (; i + 16 <= dim; i += 16)
+    {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i),      vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4),  vld1q_f32(b + i + 4));
+        acc2 = vfmaq_f32(acc2, vld1q_f32(a + i + 8),  vld1q_f32(b + i + 8));
+        acc3 = vfmaq_f32(acc3, vld1q_f32(a + i + 12), vld1q_f32(b + i + 12));
+    }
+    sum = vaddvq_f32(vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+#elif defined(__AVX__)
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (; i + 16 <= dim; i += 16)
+    {
+#if defined(__FMA__)
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),     _mm256_loadu_ps(b + i),     acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+#else
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i),     _mm256_loadu_ps(b + i)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+#endif
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+    sum = _mm_cvtss_f32(half);
+#endif
+    for (; i < dim; i++)
+    {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/*****************************************
+* Function Name : embedding_normalize
+* Description   : L2-normalize an embedding. A zero vector is copied as is.
+* Arguments     : src = input embedding
+*                 dst = output embedding, may alias src
+*                 dim = embedding length
+* Return value  : float = L2 norm of src
+******************************************/
+float embedding_normalize(const float* src, float* dst, int32_t dim)
+{
+    float norm = std::sqrt(embedding_dot(src, src, dim));
+    float scale = (norm > 0.0f) ? 1.0f / norm : 1.0f;
+    for (int32_t i = 0; i < dim; i++)
+    {
+        dst[i] = src[i] * scale;
+    }
+    return norm;
+}
+
+/*****************************************
+* Function Name : embedding_scan
+* Description   : One-vs-all cosine search of a normalized query over a
+*                 matrix of normalized embeddings.
+* Arguments     : matrix = rows x stride embeddings
+*                 rows = number of embeddings
+*                 stride = row pitch in floats
+*                 query = normalized query embedding
+*                 dim = embedding length
+* Return value  : gallery_match_t = best identity and its margin
+******************************************/
+gallery_match_t embedding_scan(const float* matrix, int32_t rows, int32_t stride, const float* query, int32_t dim)
+{
+    gallery_match_t result;
+    result.index  = -1;
+    result.score  = -FLT_MAX;
+    result.margin = 0.0f;
+    float second = -FLT_MAX;
+    for (int32_t r = 0; r < rows; r++)
+    {
+        float score = embedding_dot(matrix + (size_t)r * stride, query, dim);
+        if (score > result.score)
+        {
+            second = result.score;
+            result.score = score;
+            result.index = r;
+        }
+        else if (score > second)
+        {
+            second = score;
+        }
+    }
+    if (result.index < 0)
+    {
+        result.score = 0.0f;
+    }
+    else
+    {
+        /* With a single identity the margin is measured against orthogonality */
+        result.margin = result.score - ((rows > 1) ? second : 0.0f);
+    }
+    return result;
+}
+
+FaceGallery::FaceGallery(int32_t dim)
+{
+    const int32_t floats_per_line = FACE_GALLERY_ALIGN / sizeof(float);
+    n_dim    = dim;
+    n_stride = (dim + floats_per_line - 1) / floats_per_line * floats_per_line;
+    base       = NULL;
+    base_names = NULL;
+    base_count = 0;
+    count    = 0;
+    capacity = 0;
+    matrix   = NULL;
+    query    = aligned_floats(n_stride);
+}
+
+FaceGallery::~FaceGallery()
+{
+    free(matrix);
+    free(query);
+}
+
+/*****************************************
+* Function Name : reserve
+* Description   : Grow the embedding matrix to hold at least the given number of rows.
+* Arguments     : rows = number of identities
+* Return value  : -
+******************************************/
+void FaceGallery::reserve(int32_t rows)
+{
+    if (rows <= capacity)
+    {
+        return;
+    }
+    float* grown = aligned_floats((size_t)rows * n_stride);
+    if (NULL != matrix)
+    {
+        memcpy(grown, matrix, (size_t)count * n_stride * sizeof(float));
+        free(matrix);
+    }
+    matrix = grown;
+    capacity = rows;
+    names.reserve(rows);
+}
+
+/*****************************************
+* Function Name : enrol
+* Description   : Add an identity. The embedding is normalized once here so
+*                 that matching is a plain dot-product scan.
+* Arguments     : name = identity label
+*                 embedding = raw model output of n_dim floats
+* Return value  : int32_t = index of the new identity
+******************************************/
+int32_t FaceGallery::enrol(const std::string& name, const float* embedding)
+{
+    if (count == capacity)
+    {
+        reserve((capacity > 0) ? capacity * 2 : 16);
+    }
+    float* dst = matrix + (size_t)count * n_stride;
+    embedding_normalize(embedding, dst, n_dim);
+    memset(dst + n_dim, 0, (n_stride - n_dim) * sizeof(float));
+    names.push_back(name);
+    return base_count + count++;
+}
+
+/*****************************************
+* Function Name : attach
+* Description   : Use an external matrix of normalized embeddings as the
+*                 first rows of the gallery. The memory is not copied and
+*                 must outlive the gallery or the next attach().
+* Arguments     : rows = rows_count x stride() normalized embeddings
+*                 row_names = rows_count FACE_NAME_LEN byte names
+*                 rows_count = number of rows
+* Return value  : -
+******************************************/
+void FaceGallery::attach(const float* rows, const char* row_names, int32_t rows_count)
+{
+    base       = rows;
+    base_names = row_names;
+    base_count = (NULL != rows) ? rows_count : 0;
+}
+
+/*****************************************
+* Function Name : name
+* Description   : Label of an identity.
+* Arguments     : index = identity index
+* Return value  : std::string = identity name
+******************************************/
+std::string FaceGallery::name(int32_t index) const
+{
+    if (index < base_count)
+    {
+        const char* field = base_names + (size_t)index * FACE_NAME_LEN;
+        return std::string(field, strnlen(field, FACE_NAME_LEN));
+    }
+    return names[index - base_count];
+}
+
+/*****************************************
+* Function Name : row
+* Description   : Normalized embedding of an identity.
+* Arguments     : index = identity index
+* Return value  : const float* = n_dim floats
+******************************************/
+const float* FaceGallery::row(int32_t index) const
+{
+    if (index < base_count)
+    {
+        return base + (size_t)index * n_stride;
+    }
+    return matrix + (size_t)(index - base_count) * n_stride;
+}
+
+/*****************************************
+* Function Name : match
+* Description   : Find the enrolled identity closest to a live embedding.
+*                 Attached rows are scanned in place, followed by the rows
+*                 enrolled in this process.
+* Arguments     : embedding = raw model output of n_dim floats
+* Return value  : gallery_match_t = best identity and its margin
+******************************************/
+gallery_match_t FaceGallery::match(const float* embedding)
+{
+    embedding_normalize(embedding, query, n_dim);
+    gallery_match_t head = embedding_scan(base, base_count, n_stride, query, n_dim);
+    gallery_match_t tail = embedding_scan(matrix, count, n_stride, query, n_dim);
+    if (head.index < 0)
+    {
+        return tail;
+    }
+    if (tail.index < 0)
+    {
+        return head;
+    }
+
+    /* Runner-up of the merged result is the better of the loser's score and the winner's own runner-up */
+    gallery_match_t* win  = (tail.score > head.score) ? &tail : &head;
+    gallery_match_t* lose = (win == &tail) ? &head : &tail;
+    float second = lose->score;
+    if ((win == &head) ? (base_count > 1) : (count > 1))
+    {
+        second = std::max(second, win->score - win->margin);
+    }
+    gallery_match_t result;
+    result.index  = (win == &tail) ? base_count + tail.index : head.index;
+    result.score  = win->score;
+    result.margin = win->score - second;
+    return result;
+}
+
+/*****************************************
+* Function Name : clear
+* Description   : Remove every identity enrolled in this process, keeping
+*                 the allocated storage. Attached rows are left in place.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void FaceGallery::clear()
+{
+    count = 0;
+    names.clear();
+}
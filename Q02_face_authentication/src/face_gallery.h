@@ -0,0 +1,116 @@
+/*
+ * Original Code (C) Copyright Renesas Electronics Corporation 2024
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/***********************************************************************************************************************
+* File Name    : face_gallery.h
+* Version      : 1.0
+* Description  : Enrolled face embeddings and one-vs-all matching
+***********************************************************************************************************************/
+#pragma once
+
+#ifndef FACE_GALLERY_H
+#define FACE_GALLERY_H
+/***********************************************************************************************************************
+* Include
+***********************************************************************************************************************/
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/***********************************************************************************************************************
+* Macro
+***********************************************************************************************************************/
+/* FaceNet embedding length */
+#define FACE_EMBED_DIM          (512)
+/* Alignment of every embedding row, in bytes */
+#define FACE_GALLERY_ALIGN      (64)
+/* Fixed identity name field, including the terminating NUL */
+#define FACE_NAME_LEN           (64)
+
+/***********************************************************************************************************************
+* Struct
+***********************************************************************************************************************/
+/*****************************************
+* gallery_match_t : Result of a one-vs-all search.
+*                   index is -1 when the gallery is empty.
+*                   score is the cosine similarity of the best identity,
+*                   margin its distance to the runner-up.
+******************************************/
+typedef struct
+{
+    int32_t index;
+    float   score;
+    float   margin;
+} gallery_match_t;
+
+/***********************************************************************************************************************
+* Functions
+***********************************************************************************************************************/
+float embedding_normalize(const float* src, float* dst, int32_t dim);
+float embedding_dot(const float* a, const float* b, int32_t dim);
+gallery_match_t embedding_scan(const float* matrix, int32_t rows, int32_t stride, const float* query, int32_t dim);
+
+/***********************************************************************************************************************
+* Class
+***********************************************************************************************************************/
+class FaceGallery
+{
+    public:
+        FaceGallery(int32_t dim = FACE_EMBED_DIM);
+        ~FaceGallery();
+        FaceGallery(const FaceGallery&) = delete;
+        FaceGallery& operator=(const FaceGallery&) = delete;
+
+        int32_t enrol(const std::string& name, const float* embedding);
+        gallery_match_t match(const float* embedding);
+        void clear();
+        void reserve(int32_t rows);
+        void attach(const float* rows, const char* row_names, int32_t rows_count);
+
+        int32_t size() const { return base_count + count; }
+        int32_t dim() const { return n_dim; }
+        int32_t stride() const { return n_stride; }
+        int32_t attached() const { return base_count; }
+        std::string name(int32_t index) const;
+        const float* row(int32_t index) const;
+
+    private:
+        int32_t n_dim;
+        /* Row pitch in floats, keeps every row FACE_GALLERY_ALIGN aligned */
+        int32_t n_stride;
+        /* Read-only rows owned by the caller (e.g. a mapped gallery file),
+           names are FACE_NAME_LEN byte fields */
+        const float* base;
+        const char* base_names;
+        int32_t base_count;
+        /* Rows enrolled in this process, indexed after the attached rows */
+        int32_t count;
+        int32_t capacity;
+        /* count x n_stride L2-normalized embeddings */
+        float* matrix;
+        std::vector<std::string> names;
+        /* Normalized copy of the last query */
+        float* query;
+};
+
+#endif
@@ -0,0 +1,434 @@
+/*
+ * Original Code (C) Copyright Renesas Electronics Corporation 2024
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/***********************************************************************************************************************
+* File Name    : face_gallery_store.cpp
+* Version      : 1.0
+* Description  : Persistent face gallery: memory-mapped gallery file plus an append-only enrolment log
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* Include
+***********************************************************************************************************************/
+#include "face_gallery_store.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static_assert(sizeof(gallery_file_header_t) == FACE_GALLERY_ALIGN, "gallery header must fill one alignment unit");
+
+/*****************************************
+* Function Name : fnv1a
+* Description   : FNV-1a hash used as the log record checksum.
+* Arguments     : data = bytes to hash
+*                 size = number of bytes
+*                 hash = running hash value
+* Return value  : uint32_t = updated hash
+******************************************/
+static uint32_t fnv1a(const void* data, size_t size, uint32_t hash = 2166136261u)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/*****************************************
+* Function Name : write_all
+* Description   : write() until every byte is written.
+* Arguments     : fd = file descriptor
+*                 data = bytes to write
+*                 size = number of bytes
+* Return value  : true if succeeded, false otherwise
+******************************************/
+static bool write_all(int fd, const void* data, size_t size)
+{
+    const char* p = (const char*)data;
+    while (size > 0)
+    {
+        ssize_t n = write(fd, p, size);
+        if (n < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+/*****************************************
+* Function Name : sync_dir
+* Description   : fsync the directory of a file, so that a rename() into it
+*                 survives a power cut.
+* Arguments     : file_path = file in the directory
+* Return value  : true if succeeded, false otherwise
+******************************************/
+static bool sync_dir(const std::string& file_path)
+{
+    const std::string::size_type slash = file_path.rfind('/');
+    const std::string dir = (std::string::npos == slash) ? "." : file_path.substr(0, slash + 1);
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool ok = (0 == fsync(fd));
+    ::close(fd);
+    return ok;
+}
+
+GalleryStore::GalleryStore()
+{
+    wal_fd      = -1;
+    wal_records = 0;
+    generation  = 0;
+    map_addr    = NULL;
+    map_size    = 0;
+}
+
+GalleryStore::~GalleryStore()
+{
+    close();
+}
+
+/*****************************************
+* Function Name : open
+* Description   : Map the gallery file read-only and attach it to the gallery,
+*                 then replay the enrolment log on top of it. The mapping cost
+*                 does not depend on the gallery size; the log is bounded by
+*                 GALLERY_WAL_COMPACT records.
+* Arguments     : file_path = gallery file, the log is file_path + ".wal"
+*                 gallery = gallery to populate
+* Return value  : true if succeeded, false otherwise
+******************************************/
+bool GalleryStore::open(const std::string& file_path, FaceGallery& gallery)
+{
+    close();
+    path     = file_path;
+    wal_path = file_path + ".wal";
+    if (!map_file(gallery))
+    {
+        return false;
+    }
+    if (!replay_wal(gallery))
+    {
+        return false;
+    }
+    if (wal_records >= GALLERY_WAL_COMPACT)
+    {
+        return compact(gallery);
+    }
+    return true;
+}
+
+/*****************************************
+* Function Name : close
+* Description   : Close the log and release the mapping.
+*                 The gallery must be detached or destroyed first.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void GalleryStore::close()
+{
+    if (wal_fd >= 0)
+    {
+        ::close(wal_fd);
+        wal_fd = -1;
+    }
+    wal_records = 0;
+    unmap_file();
+}
+
+/*****************************************
+* Function Name : map_file
+* Description   : mmap the gallery file and attach its rows to the gallery.
+*                 A missing file is an empty gallery.
+* Arguments     : gallery = gallery to attach to
+* Return value  : true if succeeded, false otherwise
+******************************************/
+bool GalleryStore::map_file(FaceGallery& gallery)
+{
+    generation = 0;
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        if (ENOENT == errno)
+        {
+            gallery.attach(NULL, NULL, 0);
+            return true;
+        }
+        fprintf(stderr, "[ERROR] Failed to open gallery file %s : errno=%d\n", path.c_str(), errno);
+        return false;
+    }
+
+    struct stat st;
+    if (0 != fstat(fd, &st) || (size_t)st.st_size < sizeof(gallery_file_header_t))
+    {
+        fprintf(stderr, "[ERROR] Invalid gallery file %s\n", path.c_str());
+        ::close(fd);
+        return false;
+    }
+    void* addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (MAP_FAILED == addr)
+    {
+        fprintf(stderr, "[ERROR] Failed to map gallery file %s : errno=%d\n", path.c_str(), errno);
+        return false;
+    }
+
+    const gallery_file_header_t* header = (const gallery_file_header_t*)addr;
+    const uint64_t names_end  = header->names_offset + (uint64_t)header->count * header->name_len;
+    const uint64_t matrix_end = header->matrix_offset + (uint64_t)header->count * header->stride * sizeof(float);
+    if ((0 != memcmp(header->magic, GALLERY_FILE_MAGIC, 4))
+        || (GALLERY_FILE_VERSION != header->version)
+        || ((int32_t)header->dim != gallery.dim())
+        || ((int32_t)header->stride != gallery.stride())
+        || (FACE_NAME_LEN != header->name_len)
+        || (0 != header->matrix_offset % FACE_GALLERY_ALIGN)
+        || (names_end > header->matrix_offset)
+        || (matrix_end > (uint64_t)st.st_size))
+    {
+        fprintf(stderr, "[ERROR] Gallery file %s does not match this model\n", path.c_str());
+        munmap(addr, st.st_size);
+        return false;
+    }
+
+    map_addr   = addr;
+    map_size   = st.st_size;
+    generation = header->generation;
+    gallery.attach((const float*)((const char*)addr + header->matrix_offset),
+        (const char*)addr + header->names_offset, header->count);
+    return true;
+}
+
+/*****************************************
+* Function Name : unmap_file
+* Description   : Release the gallery file mapping.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void GalleryStore::unmap_file()
+{
+    if (NULL != map_addr)
+    {
+        munmap(map_addr, map_size);
+        map_addr = NULL;
+        map_size = 0;
+    }
+}
+
+/*****************************************
+* Function Name : replay_wal
+* Description   : Enrol every valid record of the current generation from the
+*                 log. A torn record at the end (power loss during append) is
+*                 truncated away.
+* Arguments     : gallery = gallery to enrol into
+* Return value  : true if succeeded, false otherwise
+******************************************/
+bool GalleryStore::replay_wal(FaceGallery& gallery)
+{
+    wal_fd = ::open(wal_path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (wal_fd < 0)
+    {
+        fprintf(stderr, "[ERROR] Failed to open gallery log %s : errno=%d\n", wal_path.c_str(), errno);
+        return false;
+    }
+
+    const size_t payload = (size_t)gallery.stride() * sizeof(float);
+    std::vector<float> row(gallery.stride());
+    gallery_wal_record_t record;
+    off_t good = 0;
+    wal_records = 0;
+    while (true)
+    {
+        if (sizeof(record) != pread(wal_fd, &record, sizeof(record), good)
+            || (ssize_t)payload != pread(wal_fd, row.data(), payload, good + sizeof(record)))
+        {
+            break;
+        }
+        uint32_t checksum = fnv1a(record.name, sizeof(record.name));
+        checksum = fnv1a(row.data(), payload, checksum);
+        if ((GALLERY_WAL_MAGIC != record.magic) || (checksum != record.checksum))
+        {
+            break;
+        }
+        good += sizeof(record) + payload;
+        if (record.generation != generation)
+        {
+            continue;
+        }
+        record.name[FACE_NAME_LEN - 1] = '\0';
+        gallery.enrol(record.name, row.data());
+        wal_records++;
+    }
+
+    struct stat st;
+    if (0 == fstat(wal_fd, &st) && st.st_size > good)
+    {
+        fprintf(stderr, "[WARNING] Discarding %ld bytes of incomplete gallery log\n", (long)(st.st_size - good));
+        if (0 != ftruncate(wal_fd, good))
+        {
+            fprintf(stderr, "[ERROR] Failed to truncate gallery log : errno=%d\n", errno);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*****************************************
+* Function Name : append
+* Description   : Log an identity enrolled in the gallery. The record is on
+*                 disk when this returns.
+* Arguments     : gallery = gallery holding the identity
+*                 index = identity index
+* Return value  : true if succeeded, false otherwise
+******************************************/
+bool GalleryStore::append(FaceGallery& gallery, int32_t index)
+{
+    if (wal_fd < 0)
+    {
+        return false;
+    }
+    const size_t payload = (size_t)gallery.stride() * sizeof(float);
+    std::vector<char> buffer(sizeof(gallery_wal_record_t) + payload);
+    gallery_wal_record_t* record = (gallery_wal_record_t*)buffer.data();
+    std::string name = gallery.name(index);
+    memset(record, 0, sizeof(*record));
+    strncpy(record->name, name.c_str(), FACE_NAME_LEN - 1);
+    memcpy(buffer.data() + sizeof(*record), gallery.row(index), payload);
+    record->magic      = GALLERY_WAL_MAGIC;
+    record->generation = generation;
+    record->checksum   = fnv1a(buffer.data() + sizeof(*record), payload, fnv1a(record->name, sizeof(record->name)));
+
+    if (!write_all(wal_fd, buffer.data(), buffer.size()) || 0 != fdatasync(wal_fd))
+    {
+        fprintf(stderr, "[ERROR] Failed to write gallery log : errno=%d\n", errno);
+        return false;
+    }
+    wal_records++;
+    if (wal_records >= GALLERY_WAL_COMPACT)
+    {
+        return compact(gallery);
+    }
+    return true;
+}
+
+/*****************************************
+* Function Name : compact
+* Description   : Rewrite the gallery file with every identity, swap it in
+*                 atomically, remap it and empty the log.
+* Arguments     : gallery = gallery to persist
+* Return value  : true if succeeded, false otherwise
+******************************************/
+bool GalleryStore::compact(FaceGallery& gallery)
+{
+    const std::string tmp_path = path + ".tmp";
+    const uint32_t count = gallery.size();
+    const size_t payload = (size_t)gallery.stride() * sizeof(float);
+
+    gallery_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, GALLERY_FILE_MAGIC, 4);
+    header.version       = GALLERY_FILE_VERSION;
+    header.dim           = gallery.dim();
+    header.stride        = gallery.stride();
+    header.count         = count;
+    header.name_len      = FACE_NAME_LEN;
+    header.names_offset  = sizeof(header);
+    header.matrix_offset = (header.names_offset + (uint64_t)count * FACE_NAME_LEN + FACE_GALLERY_ALIGN - 1)
+                            / FACE_GALLERY_ALIGN * FACE_GALLERY_ALIGN;
+    header.generation    = generation + 1;
+
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        fprintf(stderr, "[ERROR] Failed to create %s : errno=%d\n", tmp_path.c_str(), errno);
+        return false;
+    }
+    bool ok = write_all(fd, &header, sizeof(header));
+    char field[FACE_NAME_LEN];
+    for (uint32_t i = 0; ok && i < count; i++)
+    {
+        memset(field, 0, sizeof(field));
+        strncpy(field, gallery.name(i).c_str(), FACE_NAME_LEN - 1);
+        ok = write_all(fd, field, sizeof(field));
+    }
+    const size_t pad = header.matrix_offset - (header.names_offset + (uint64_t)count * FACE_NAME_LEN);
+    memset(field, 0, sizeof(field));
+    ok = ok && write_all(fd, field, pad);
+    for (uint32_t i = 0; ok && i < count; i++)
+    {
+        ok = write_all(fd, gallery.row(i), payload);
+    }
+    ok = ok && (0 == fsync(fd));
+    ::close(fd);
+    if (!ok || 0 != rename(tmp_path.c_str(), path.c_str()))
+    {
+        fprintf(stderr, "[ERROR] Failed to write gallery file %s : errno=%d\n", path.c_str(), errno);
+        unlink(tmp_path.c_str());
+        return false;
+    }
+    if (!sync_dir(path))
+    {
+        fprintf(stderr, "[WARNING] Failed to sync the directory of %s : errno=%d\n", path.c_str(), errno);
+    }
+
+    /* Attach the new mapping before releasing the old one the gallery still points into */
+    void* old_addr = map_addr;
+    size_t old_size = map_size;
+    map_addr = NULL;
+    if (!map_file(gallery))
+    {
+        /* map_file() cleared the generation. The gallery keeps the old rows, but
+           the file on disk is the renamed one now, so the log records written
+           from here on must carry its generation or the replay drops them */
+        map_addr = old_addr;
+        map_size = old_size;
+        generation = header.generation;
+        return false;
+    }
+    gallery.clear();
+    if (NULL != old_addr)
+    {
+        munmap(old_addr, old_size);
+    }
+
+    /* Records of the previous generation are ignored from now on, so a
+       crash before this truncation cannot enrol them twice */
+    if (0 != ftruncate(wal_fd, 0))
+    {
+        fprintf(stderr, "[WARNING] Failed to truncate gallery log : errno=%d\n", errno);
+    }
+    wal_records = 0;
+    return true;
+}
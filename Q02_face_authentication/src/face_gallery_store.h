@@ -0,0 +1,119 @@
+/*
+ * Original Code (C) Copyright Renesas Electronics Corporation 2024
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/***********************************************************************************************************************
+* File Name    : face_gallery_store.h
+* Version      : 1.0
+* Description  : Persistent face gallery: memory-mapped gallery file plus an append-only enrolment log
+***********************************************************************************************************************/
+#pragma once
+
+#ifndef FACE_GALLERY_STORE_H
+#define FACE_GALLERY_STORE_H
+/***********************************************************************************************************************
+* Include
+***********************************************************************************************************************/
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include "face_gallery.h"
+
+/***********************************************************************************************************************
+* Macro
+***********************************************************************************************************************/
+#define GALLERY_FILE_MAGIC      "RZFG"
+#define GALLERY_FILE_VERSION    (1)
+#define GALLERY_WAL_MAGIC       (0x57465A52)    /* "RZFW" */
+/* Number of logged enrolments that triggers a compaction */
+#define GALLERY_WAL_COMPACT     (32)
+
+/***********************************************************************************************************************
+* Struct
+***********************************************************************************************************************/
+/*****************************************
+* gallery_file_header_t : Gallery file header.
+*   The file is laid out as
+*     header | count x FACE_NAME_LEN names | pad | count x stride float32 rows
+*   with the row matrix starting on a FACE_GALLERY_ALIGN boundary.
+******************************************/
+typedef struct
+{
+    char     magic[4];
+    uint32_t version;
+    uint32_t dim;
+    uint32_t stride;
+    uint32_t count;
+    uint32_t name_len;
+    uint64_t names_offset;
+    uint64_t matrix_offset;
+    uint32_t generation;
+    uint8_t  reserved[20];
+} gallery_file_header_t;
+
+/*****************************************
+* gallery_wal_record_t : Enrolment log record header.
+*   Followed by stride float32 values of the normalized embedding.
+*   Records whose generation differs from the gallery file were already
+*   folded into it by a compaction that did not get to truncate the log.
+******************************************/
+typedef struct
+{
+    uint32_t magic;
+    uint32_t generation;
+    uint32_t checksum;
+    char     name[FACE_NAME_LEN];
+} gallery_wal_record_t;
+
+/***********************************************************************************************************************
+* Class
+***********************************************************************************************************************/
+class GalleryStore
+{
+    public:
+        GalleryStore();
+        ~GalleryStore();
+        GalleryStore(const GalleryStore&) = delete;
+        GalleryStore& operator=(const GalleryStore&) = delete;
+
+        bool open(const std::string& file_path, FaceGallery& gallery);
+        bool append(FaceGallery& gallery, int32_t index);
+        bool compact(FaceGallery& gallery);
+        void close();
+
+        int32_t pending() const { return wal_records; }
+        uint32_t file_generation() const { return generation; }
+
+    private:
+        std::string path;
+        std::string wal_path;
+        int wal_fd;
+        int32_t wal_records;
+        uint32_t generation;
+        void* map_addr;
+        size_t map_size;
+
+        bool map_file(FaceGallery& gallery);
+        void unmap_file();
+        bool replay_wal(FaceGallery& gallery);
+};
+
+#endif
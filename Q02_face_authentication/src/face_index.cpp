@@ -0,0 +1,516 @@
+/*
+ * Original Code (C) Copyright Renesas Electronics Corporation 2024
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/***********************************************************************************************************************
+* File Name    : face_index.cpp
+* Version      : 1.0
+* Description  : Approximate nearest-neighbour index (IVF, int8 residuals) over a FaceGallery
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* Include
+***********************************************************************************************************************/
+#include "face_index.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*****************************************
+* Function Name : code_dot
+* Description   : Dot product of a float query with an int8 code.
+* Arguments     : q = query
+*                 code = int8 code
+*                 dim = length
+* Return value  : float = dot product
+******************************************/
+static float code_dot(const float* q, const int8_t* code, int32_t dim)
+{
+    int32_t i = 0;
+    float sum = 0.0f;
+#if defined(__ARM_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (; i + 8 <= dim; i += 8)
+    {
+        int16x8_t c16 = vmovl_s8(vld1_s8(code + i));
+        acc0 = vfmaq_f32(acc0, vld1q_f32(q + i),     vcvtq_f32_s32(vmovl_s16(vget_low_s16(c16))));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(q + i + 4), vcvtq_f32_s32(vmovl_s16(vget_high_s16(c16))));
+    }
+    sum = vaddvq_f32(vaddq_f32(acc0, acc1));
+#elif defined(__AVX2__)
+    __m256 acc = _mm256_setzero_ps();
+    for (; i + 8 <= dim; i += 8)
+    {
+        __m256 c = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)(code + i))));
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(q + i), c));
+    }
+    __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+    sum = _mm_cvtss_f32(half);
+#endif
+    for (; i < dim; i++)
+    {
+        sum += q[i] * (float)code[i];
+    }
+    return sum;
+}
+
+FaceIndex::FaceIndex()
+{
+    prm     = default_param(FACE_INDEX_MIN_ROWS);
+    n_dim   = 0;
+    indexed = 0;
+}
+
+/*****************************************
+* Function Name : default_param
+* Description   : Parameters for a gallery of the given size: about sqrt(rows)
+*                 clusters, 1/16 of them probed, 32 exact reranks.
+* Arguments     : rows = gallery size
+* Return value  : face_index_param_t = parameters
+******************************************/
+face_index_param_t FaceIndex::default_param(int32_t rows)
+{
+    face_index_param_t p;
+    p.nlist  = std::max(16, (int32_t)std::sqrt((float)std::max(rows, 1)));
+    p.nprobe = std::max(4, p.nlist / 16);
+    p.rerank = 32;
+    p.iters  = 8;
+    p.train_per_list = 32;
+    return p;
+}
+
+/*****************************************
+* Function Name : set_param
+* Description   : Change the tuning knobs. nprobe and rerank take effect on
+*                 the next search; nlist, iters and train_per_list on the
+*                 next train().
+* Arguments     : p = parameters
+* Return value  : -
+******************************************/
+void FaceIndex::set_param(const face_index_param_t& p)
+{
+    prm = p;
+    prm.nlist  = std::max(prm.nlist, 1);
+    prm.nprobe = std::max(prm.nprobe, 1);
+    prm.rerank = std::max(prm.rerank, 1);
+}
+
+/*****************************************
+* Function Name : reset
+* Description   : Drop the trained clusters and every indexed row.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void FaceIndex::reset()
+{
+    centroids.clear();
+    lists.clear();
+    indexed = 0;
+}
+
+/*****************************************
+* Function Name : nearest_centroid
+* Description   : Cluster with the highest cosine similarity to a normalized vector.
+* Arguments     : v = normalized vector
+* Return value  : int32_t = cluster index
+******************************************/
+int32_t FaceIndex::nearest_centroid(const float* v) const
+{
+    const int32_t nlist = (int32_t)lists.size();
+    int32_t best = 0;
+    float best_score = -FLT_MAX;
+    for (int32_t l = 0; l < nlist; l++)
+    {
+        float score = embedding_dot(centroids.data() + (size_t)l * n_dim, v, n_dim);
+        if (score > best_score)
+        {
+            best_score = score;
+            best = l;
+        }
+    }
+    return best;
+}
+
+/*****************************************
+* Function Name : train
+* Description   : Spherical k-means over a sample of the gallery, then index
+*                 every gallery row.
+* Arguments     : gallery = gallery to index
+* Return value  : true if succeeded, false if the gallery is too small
+******************************************/
+bool FaceIndex::train(const FaceGallery& gallery)
+{
+    reset();
+    n_dim = gallery.dim();
+    const int32_t rows  = gallery.size();
+    const int32_t nlist = std::min(prm.nlist, rows);
+    if (nlist < 1)
+    {
+        return false;
+    }
+
+    /* Evenly strided training sample */
+    const int32_t samples = std::min(rows, nlist * prm.train_per_list);
+    std::vector<int32_t> sample(samples);
+    for (int32_t i = 0; i < samples; i++)
+    {
+        sample[i] = (int32_t)((int64_t)i * rows / samples);
+    }
+
+    centroids.assign((size_t)nlist * n_dim, 0.0f);
+    lists.resize(nlist);
+    for (int32_t l = 0; l < nlist; l++)
+    {
+        const float* src = gallery.row(sample[(int64_t)l * samples / nlist]);
+        std::copy(src, src + n_dim, centroids.begin() + (size_t)l * n_dim);
+    }
+
+    std::vector<float> sums((size_t)nlist * n_dim);
+    std::vector<int32_t> members(nlist);
+    for (int32_t it = 0; it < prm.iters; it++)
+    {
+        std::fill(sums.begin(), sums.end(), 0.0f);
+        std::fill(members.begin(), members.end(), 0);
+        for (int32_t s = 0; s < samples; s++)
+        {
+            const float* v = gallery.row(sample[s]);
+            int32_t l = nearest_centroid(v);
+            float* sum = sums.data() + (size_t)l * n_dim;
+            for (int32_t d = 0; d < n_dim; d++)
+            {
+                sum[d] += v[d];
+            }
+            members[l]++;
+        }
+        for (int32_t l = 0; l < nlist; l++)
+        {
+            float* c = centroids.data() + (size_t)l * n_dim;
+            if (0 == members[l])
+            {
+                /* Reseed an empty cluster from a sample that moves with the iteration */
+                const float* src = gallery.row(sample[((int64_t)l * 7919 + it * 104729) % samples]);
+                std::copy(src, src + n_dim, c);
+            }
+            else
+            {
+                embedding_normalize(sums.data() + (size_t)l * n_dim, c, n_dim);
+            }
+        }
+    }
+
+    sync(gallery);
+    return true;
+}
+
+/*****************************************
+* Function Name : save
+* Description   : Write the trained index restricted to the first rows gallery
+*                 rows, so that it can be loaded instead of retrained while the
+*                 gallery file keeps the same generation. The file is replaced
+*                 atomically.
+* Arguments     : file_path = index file
+*                 generation = generation of the gallery file
+*                 rows = rows of the gallery file, usually FaceGallery::attached()
+* Return value  : true if succeeded, false otherwise
+******************************************/
+bool FaceIndex::save(const std::string& file_path, uint32_t generation, int32_t rows) const
+{
+    if (!trained())
+    {
+        return false;
+    }
+    const std::string tmp_path = file_path + ".tmp";
+    const int32_t limit = std::min(rows, indexed);
+
+    face_index_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FACE_INDEX_FILE_MAGIC, 4);
+    header.version    = FACE_INDEX_FILE_VERSION;
+    header.dim        = n_dim;
+    header.nlist      = lists.size();
+    header.indexed    = limit;
+    header.generation = generation;
+
+    FILE* fp = fopen(tmp_path.c_str(), "wb");
+    if (NULL == fp)
+    {
+        fprintf(stderr, "[ERROR] Failed to create %s\n", tmp_path.c_str());
+        return false;
+    }
+    bool ok = (1 == fwrite(&header, sizeof(header), 1, fp))
+        && (centroids.size() == fwrite(centroids.data(), sizeof(float), centroids.size(), fp));
+
+    /* Members enrolled after the gallery file are left out, load() adds them back */
+    std::vector<int32_t> ids;
+    std::vector<float> scales;
+    std::vector<int8_t> codes;
+    for (size_t l = 0; ok && l < lists.size(); l++)
+    {
+        const ivf_list_t& list = lists[l];
+        ids.clear();
+        scales.clear();
+        codes.clear();
+        for (size_t m = 0; m < list.ids.size(); m++)
+        {
+            if (list.ids[m] < limit)
+            {
+                ids.push_back(list.ids[m]);
+                scales.push_back(list.scales[m]);
+                codes.insert(codes.end(), list.codes.begin() + m * n_dim, list.codes.begin() + (m + 1) * n_dim);
+            }
+        }
+        uint32_t members = ids.size();
+        ok = (1 == fwrite(&members, sizeof(members), 1, fp))
+            && (ids.size() == fwrite(ids.data(), sizeof(int32_t), ids.size(), fp))
+            && (scales.size() == fwrite(scales.data(), sizeof(float), scales.size(), fp))
+            && (codes.size() == fwrite(codes.data(), sizeof(int8_t), codes.size(), fp));
+    }
+    ok = (0 == fflush(fp)) && ok;
+    ok = (0 == fsync(fileno(fp))) && ok;
+    ok = (0 == fclose(fp)) && ok;
+    if (!ok || 0 != rename(tmp_path.c_str(), file_path.c_str()))
+    {
+        fprintf(stderr, "[ERROR] Failed to write face index %s\n", file_path.c_str());
+        remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+/*****************************************
+* Function Name : load
+* Description   : Read an index written by save() for the same gallery file
+*                 generation, then index the gallery rows enrolled after it.
+*                 nlist is taken from the file, nprobe and rerank are kept.
+* Arguments     : file_path = index file
+*                 generation = generation of the gallery file
+*                 gallery = indexed gallery
+* Return value  : true if loaded, false if the file is missing, stale or invalid
+******************************************/
+bool FaceIndex::load(const std::string& file_path, uint32_t generation, const FaceGallery& gallery)
+{
+    reset();
+    FILE* fp = fopen(file_path.c_str(), "rb");
+    if (NULL == fp)
+    {
+        return false;
+    }
+    face_index_file_header_t header;
+    bool ok = (1 == fread(&header, sizeof(header), 1, fp))
+        && (0 == memcmp(header.magic, FACE_INDEX_FILE_MAGIC, 4))
+        && (FACE_INDEX_FILE_VERSION == header.version)
+        && ((int32_t)header.dim == gallery.dim())
+        && (0 < header.nlist)
+        && (generation == header.generation)
+        && ((int32_t)header.indexed <= gallery.size());
+    if (ok)
+    {
+        n_dim = header.dim;
+        centroids.resize((size_t)header.nlist * n_dim);
+        lists.resize(header.nlist);
+        ok = (centroids.size() == fread(centroids.data(), sizeof(float), centroids.size(), fp));
+    }
+    uint32_t total = 0;
+    for (size_t l = 0; ok && l < lists.size(); l++)
+    {
+        ivf_list_t& list = lists[l];
+        uint32_t members = 0;
+        ok = (1 == fread(&members, sizeof(members), 1, fp)) && (members <= header.indexed - total);
+        if (!ok)
+        {
+            break;
+        }
+        list.ids.resize(members);
+        list.scales.resize(members);
+        list.codes.resize((size_t)members * n_dim);
+        ok = (members == fread(list.ids.data(), sizeof(int32_t), members, fp))
+            && (members == fread(list.scales.data(), sizeof(float), members, fp))
+            && (list.codes.size() == fread(list.codes.data(), sizeof(int8_t), list.codes.size(), fp));
+        for (uint32_t m = 0; ok && m < members; m++)
+        {
+            ok = (0 <= list.ids[m]) && (list.ids[m] < (int32_t)header.indexed);
+        }
+        total += members;
+    }
+    ok = ok && (total == header.indexed) && (EOF == fgetc(fp));
+    fclose(fp);
+    if (!ok)
+    {
+        reset();
+        return false;
+    }
+    prm.nlist = header.nlist;
+    indexed = header.indexed;
+    sync(gallery);
+    return true;
+}
+
+/*****************************************
+* Function Name : encode
+* Description   : Store the int8 quantized residual of a vector to its cluster centroid.
+* Arguments     : list = cluster index
+*                 id = gallery index
+*                 v = normalized vector
+* Return value  : -
+******************************************/
+void FaceIndex::encode(int32_t list, int32_t id, const float* v)
+{
+    ivf_list_t& l = lists[list];
+    const float* c = centroids.data() + (size_t)list * n_dim;
+    float max_abs = 0.0f;
+    for (int32_t d = 0; d < n_dim; d++)
+    {
+        max_abs = std::max(max_abs, std::fabs(v[d] - c[d]));
+    }
+    const float scale = (max_abs > 0.0f) ? max_abs / 127.0f : 1.0f;
+    const float inv_scale = 1.0f / scale;
+
+    const size_t offset = l.codes.size();
+    l.codes.resize(offset + n_dim);
+    for (int32_t d = 0; d < n_dim; d++)
+    {
+        l.codes[offset + d] = (int8_t)std::lround((v[d] - c[d]) * inv_scale);
+    }
+    l.ids.push_back(id);
+    l.scales.push_back(scale);
+}
+
+/*****************************************
+* Function Name : add
+* Description   : Insert one gallery row into the trained index.
+* Arguments     : gallery = gallery holding the row
+*                 index = gallery index
+* Return value  : -
+******************************************/
+void FaceIndex::add(const FaceGallery& gallery, int32_t index)
+{
+    const float* v = gallery.row(index);
+    encode(nearest_centroid(v), index, v);
+    indexed++;
+}
+
+/*****************************************
+* Function Name : sync
+* Description   : Insert every gallery row enrolled since the last call.
+*                 Gallery indices are append-only, so the index only
+*                 needs to catch up from its own size.
+* Arguments     : gallery = indexed gallery
+* Return value  : -
+******************************************/
+void FaceIndex::sync(const FaceGallery& gallery)
+{
+    if (!trained())
+    {
+        return;
+    }
+    while (indexed < gallery.size())
+    {
+        add(gallery, indexed);
+    }
+}
+
+/*****************************************
+* Function Name : search
+* Description   : Approximate one-vs-all search. The nprobe closest clusters
+*                 are scanned with int8 residual codes, and the best rerank
+*                 candidates are rescored exactly against the gallery rows.
+* Arguments     : gallery = indexed gallery
+*                 embedding = raw model output of dim floats
+* Return value  : gallery_match_t = best identity and its margin
+******************************************/
+gallery_match_t FaceIndex::search(FaceGallery& gallery, const float* embedding)
+{
+    if (!trained())
+    {
+        return gallery.match(embedding);
+    }
+
+    const int32_t nlist = (int32_t)lists.size();
+    query.resize(n_dim);
+    embedding_normalize(embedding, query.data(), n_dim);
+
+    centroid_score.resize(nlist);
+    probe.resize(nlist);
+    for (int32_t l = 0; l < nlist; l++)
+    {
+        centroid_score[l] = embedding_dot(centroids.data() + (size_t)l * n_dim, query.data(), n_dim);
+        probe[l] = l;
+    }
+    const int32_t nprobe = std::min(prm.nprobe, nlist);
+    std::partial_sort(probe.begin(), probe.begin() + nprobe, probe.end(),
+        [this](int32_t a, int32_t b) { return centroid_score[a] > centroid_score[b]; });
+
+    /* q.v ~= q.c + scale * q.code */
+    candidates.clear();
+    for (int32_t p = 0; p < nprobe; p++)
+    {
+        const ivf_list_t& l = lists[probe[p]];
+        const float base_score = centroid_score[probe[p]];
+        for (size_t m = 0; m < l.ids.size(); m++)
+        {
+            float score = base_score + l.scales[m] * code_dot(query.data(), l.codes.data() + m * n_dim, n_dim);
+            candidates.push_back(std::make_pair(score, l.ids[m]));
+        }
+    }
+
+    gallery_match_t result;
+    result.index  = -1;
+    result.score  = 0.0f;
+    result.margin = 0.0f;
+    if (candidates.empty())
+    {
+        return result;
+    }
+
+    const size_t rerank = std::min(candidates.size(), (size_t)prm.rerank);
+    std::partial_sort(candidates.begin(), candidates.begin() + rerank, candidates.end(),
+        [](const std::pair<float, int32_t>& a, const std::pair<float, int32_t>& b) { return a.first > b.first; });
+
+    float best = -FLT_MAX;
+    float second = 0.0f;
+    for (size_t c = 0; c < rerank; c++)
+    {
+        float score = embedding_dot(gallery.row(candidates[c].second), query.data(), n_dim);
+        if (score > best)
+        {
+            second = (result.index < 0) ? 0.0f : best;
+            best = score;
+            result.index = candidates[c].second;
+        }
+        else if (score > second)
+        {
+            second = score;
+        }
+    }
+    result.score  = best;
+    result.margin = best - second;
+    return result;
+}
@@ -0,0 +1,143 @@
+/*
+ * Original Code (C) Copyright Renesas Electronics Corporation 2024
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/***********************************************************************************************************************
+* File Name    : face_index.h
+* Version      : 1.0
+* Description  : Approximate nearest-neighbour index (IVF, int8 residuals) over a FaceGallery
+***********************************************************************************************************************/
+#pragma once
+
+#ifndef FACE_INDEX_H
+#define FACE_INDEX_H
+/***********************************************************************************************************************
+* Include
+***********************************************************************************************************************/
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "face_gallery.h"
+
+/***********************************************************************************************************************
+* Macro
+***********************************************************************************************************************/
+/* Below this gallery size the exact scan is fast enough and the index is not built */
+#define FACE_INDEX_MIN_ROWS     (20000)
+#define FACE_INDEX_FILE_MAGIC   "RZFI"
+#define FACE_INDEX_FILE_VERSION (1)
+
+/***********************************************************************************************************************
+* Struct
+***********************************************************************************************************************/
+/*****************************************
+* face_index_param_t : Index tuning knobs.
+*   nlist    : number of coarse clusters
+*   nprobe   : clusters visited per query, higher is slower and more accurate
+*   rerank   : candidates rescored with the exact float embedding
+*   iters    : k-means iterations at training
+*   train_per_list : training rows sampled per cluster
+******************************************/
+typedef struct
+{
+    int32_t nlist;
+    int32_t nprobe;
+    int32_t rerank;
+    int32_t iters;
+    int32_t train_per_list;
+} face_index_param_t;
+
+/*****************************************
+* face_index_file_header_t : Index file header.
+*   The file is laid out as
+*     header | nlist x dim float32 centroids | nlist x list
+*   and each list as
+*     uint32 members | members x int32 ids | members x float32 scales | members x dim int8 codes
+*   It indexes the first indexed rows of the gallery file of the given
+*   generation, the rows enrolled after them are added at load.
+******************************************/
+typedef struct
+{
+    char     magic[4];
+    uint32_t version;
+    uint32_t dim;
+    uint32_t nlist;
+    uint32_t indexed;
+    uint32_t generation;
+    uint8_t  reserved[40];
+} face_index_file_header_t;
+
+/***********************************************************************************************************************
+* Class
+***********************************************************************************************************************/
+class FaceIndex
+{
+    public:
+        FaceIndex();
+
+        static face_index_param_t default_param(int32_t rows);
+
+        void set_param(const face_index_param_t& p);
+        const face_index_param_t& param() const { return prm; }
+
+        bool train(const FaceGallery& gallery);
+        bool save(const std::string& file_path, uint32_t generation, int32_t rows) const;
+        bool load(const std::string& file_path, uint32_t generation, const FaceGallery& gallery);
+        void add(const FaceGallery& gallery, int32_t index);
+        void sync(const FaceGallery& gallery);
+        gallery_match_t search(FaceGallery& gallery, const float* embedding);
+        void reset();
+
+        bool trained() const { return !centroids.empty(); }
+        int32_t size() const { return indexed; }
+
+    private:
+        /*****************************************
+        * ivf_list_t : Members of one coarse cluster.
+        *   codes holds dim int8 residual codes per member,
+        *   scale the per-member dequantization factor.
+        ******************************************/
+        typedef struct
+        {
+            std::vector<int32_t> ids;
+            std::vector<float>   scales;
+            std::vector<int8_t>  codes;
+        } ivf_list_t;
+
+        face_index_param_t prm;
+        int32_t n_dim;
+        int32_t indexed;
+        /* nlist x n_dim normalized centroids */
+        std::vector<float> centroids;
+        std::vector<ivf_list_t> lists;
+
+        /* Per-query scratch, reused across searches */
+        std::vector<float> query;
+        std::vector<float> centroid_score;
+        std::vector<int32_t> probe;
+        std::vector<std::pair<float, int32_t>> candidates;
+
+        int32_t nearest_centroid(const float* v) const;
+        void encode(int32_t list, int32_t id, const float* v);
+};
+
+#endif
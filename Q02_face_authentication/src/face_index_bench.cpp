@@ -0,0 +1,135 @@
+/*
+ * Original Code (C) Copyright Renesas Electronics Corporation 2024
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/***********************************************************************************************************************
+* File Name    : face_index_bench.cpp
+* Version      : 1.0
+* Description  : Host benchmark of FaceIndex against the exact FaceGallery scan on synthetic embeddings.
+*                Usage: face_index_bench [rows] [queries]
+***********************************************************************************************************************/
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "face_gallery.h"
+#include "face_index.h"
+
+/* Synthetic data: identities scattered around this many population clusters */
+#define BENCH_CLUSTERS      (256)
+/* Noise of a live capture relative to its enrolled embedding (same-person cosine about 0.7) */
+#define BENCH_QUERY_NOISE   (1.0f)
+
+static double elapsed_ms(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char **argv)
+{
+    const int32_t rows    = (argc > 1) ? atoi(argv[1]) : 50000;
+    const int32_t queries = (argc > 2) ? atoi(argv[2]) : 200;
+    const int32_t dim     = FACE_EMBED_DIM;
+
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+
+    std::vector<float> clusters((size_t)BENCH_CLUSTERS * dim);
+    for (auto &v : clusters)
+    {
+        v = normal(rng);
+    }
+
+    printf("[INFO] Enrolling %d synthetic identities\n", rows);
+    FaceGallery gallery(dim);
+    gallery.reserve(rows);
+    std::vector<float> embedding(dim);
+    for (int32_t r = 0; r < rows; r++)
+    {
+        const float* c = clusters.data() + (size_t)(r % BENCH_CLUSTERS) * dim;
+        for (int32_t d = 0; d < dim; d++)
+        {
+            embedding[d] = c[d] + normal(rng);
+        }
+        gallery.enrol(std::to_string(r), embedding.data());
+    }
+
+    std::vector<std::vector<float>> live(queries, std::vector<float>(dim));
+    std::uniform_int_distribution<int32_t> pick(0, rows - 1);
+    for (auto &q : live)
+    {
+        const float* src = gallery.row(pick(rng));
+        for (int32_t d = 0; d < dim; d++)
+        {
+            q[d] = src[d] + BENCH_QUERY_NOISE * normal(rng) / std::sqrt((float)dim);
+        }
+    }
+
+    std::vector<int32_t> truth(queries);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int32_t q = 0; q < queries; q++)
+    {
+        truth[q] = gallery.match(live[q].data()).index;
+    }
+    const double exact_ms = elapsed_ms(t0) / queries;
+    printf("[INFO] Exact scan       : %8.3f ms/query\n", exact_ms);
+
+    FaceIndex index;
+    face_index_param_t param = FaceIndex::default_param(rows);
+    index.set_param(param);
+    t0 = std::chrono::steady_clock::now();
+    index.train(gallery);
+    printf("[INFO] Train nlist=%d   : %8.1f ms\n", param.nlist, elapsed_ms(t0));
+
+    /* Startup with the saved index instead of k-means */
+    const std::string index_file = "face_index_bench.ivf";
+    if (index.save(index_file, 0, rows))
+    {
+        t0 = std::chrono::steady_clock::now();
+        bool loaded = index.load(index_file, 0, gallery);
+        printf("[INFO] Load saved index : %8.1f ms%s\n", elapsed_ms(t0), loaded ? "" : " (failed)");
+        remove(index_file.c_str());
+    }
+
+    const int32_t probes[] = { 1, 2, 4, 8, 16, 32, 64 };
+    printf("\n  nprobe  rerank   ms/query   speedup   recall@1\n");
+    for (int32_t nprobe : probes)
+    {
+        if (nprobe > param.nlist)
+        {
+            break;
+        }
+        param.nprobe = nprobe;
+        index.set_param(param);
+        int32_t hits = 0;
+        t0 = std::chrono::steady_clock::now();
+        for (int32_t q = 0; q < queries; q++)
+        {
+            hits += (index.search(gallery, live[q].data()).index == truth[q]) ? 1 : 0;
+        }
+        const double ms = elapsed_ms(t0) / queries;
+        printf("  %6d  %6d  %9.3f  %8.1fx  %9.3f\n", nprobe, param.rerank, ms, exact_ms / ms, (double)hits / queries);
+    }
+    return 0;
+}
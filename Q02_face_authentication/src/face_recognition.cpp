@@ -45,6 +45,9 @@
 #include <cmath>
 #include "PreRuntime.h"
 #include "MeraDrpRuntimeWrapper.h"
+#include "face_gallery.h"
+#include "face_gallery_store.h"
+#include "face_index.h"
 
 #define BLUE                        cv::Scalar(255, 0, 0)
 #define WHITE                       cv::Scalar(255, 255, 255)
@@ -84,17 +87,23 @@ cv::Mat img;
 cv::Mat image;
 cv::Mat frame;
 
-vector<float> floatarr(512);
-vector<float> img_arr1(512);
-vector<float> img_arr2(512);
+vector<float> floatarr(FACE_EMBED_DIM);
+
+/* Enrolled identities, persisted in gallery_file */
+FaceGallery gallery(FACE_EMBED_DIM);
+GalleryStore gallery_store;
+/* Approximate search, only trained for galleries of FACE_INDEX_MIN_ROWS or more */
+FaceIndex face_index;
+std::string gallery_file = "face_gallery.bin";
+/* Trained index of the gallery file, retrained only when the file generation changes */
+std::string index_file = gallery_file + ".ivf";
+uint32_t index_generation = 0;
 
 /* Image buffer (u-dma-buf) */
 unsigned char *img_buffer;
 unsigned int try_cnt;
 bool add_face_clicked = false;
 bool recognize_face_clicked = false;
-bool img1_array1_udated = false;
-bool img1_array2_udated = false;
 bool cam_kill_esc_key   = false;
 
 uint64_t drpaimem_addr_start = 0;
@@ -118,68 +127,6 @@ cv::Mat hwc2chw(const cv::Mat &image)
     cv::hconcat(matArray, 3, flat_image);
     return flat_image;
 }
-/*****************************************
- * Function Name : cosine_similarity
- * Description   : This function computes the cosine similarity between two input
- *                 feature vectors represented as std::vector<float>.
- * Arguments     : features1 = std::vector<float>
- *                 features2 = std::vector<float>
- * Return value  : float value that represents the cosine similarity
- *                 between the two input feature vectors.
- ******************************************/
-float cosine_similarity(const std::vector<float> &features1, const std::vector<float> &features2)
-{
-    if ((features1.empty() || features2.empty()) || (features1.size() != features2.size()))
-        return 0.0;
-    float dot_product = 0.0;
-    for (int i = 0; i < features1.size(); i++)
-    {
-        dot_product += features1[i] * features2[i];
-    }
-    float norm1 = 0.0;
-    float norm2 = 0.0;
-    for (int i = 0; i < features1.size(); i++)
-    {
-        norm1 += features1[i] * features1[i];
-        norm2 += features2[i] * features2[i];
-    }
-    norm1 = std::sqrt(norm1);
-    norm2 = std::sqrt(norm2);
-    float similarity = 0.0;
-    if (norm1 != 0.0 && norm2 != 0.0)
-    {
-        similarity = dot_product / (norm1 * norm2);
-    }
-    return similarity;
-}
-/*****************************************
- * Function Name : euclidean_distance
- * Description   : This function takes two vectors of floats (a and b)
- *                 and an integer n as parameters and returns a float representing the Euclidean distance between the two vectors.
- * Arguments     : vector<float> a: a vector of float values representing the first vector for which to compute the Euclidean distance.
- *                 vector<float> b: a vector of float values representing the second vector for which to compute the Euclidean distance.
- * Return value  : float value representing the Euclidean distance between the two input vectors a and b.
- ******************************************/
-float euclidean_distance(vector<float> a, vector<float> b, int n)
-{
-    float dist = 0.0;
-    double length_a;
-    double length_b;
-    for (int i = 0; i < n; i++)
-    {
-        length_a += a[i] * a[i];
-    }
-    for (int i = 0; i < n; i++)
-    {
-        length_b += b[i] * b[i];
-    }
-    for (int i = 0; i < n; i++)
-    {
-        float diff = a[i] / sqrt(length_a) - b[i] / sqrt(length_b);
-        dist += diff * diff;
-    }
-    return sqrt(dist);
-}
 /*****************************************
  * Function Name : run_inference
  * Description   : This is a function that takes a cropped image as input, runs inference on it using a runtime object,
@@ -253,12 +200,12 @@ void mouse_callback_button_click(int event, int x, int y, int flags, void *userd
 {
     if (event == EVENT_LBUTTONDOWN)
     {
-        if (add_faces_x0 < x && x < add_faces_x1 && add_faces_y0 < y && y < add_faces_y1 && img1_array1_udated == false)
+        if (add_faces_x0 < x && x < add_faces_x1 && add_faces_y0 < y && y < add_faces_y1)
         {
             std::cout << "clicked add face \n";
             add_face_clicked = true;
         }
-        else if (recognize_x0 < x && x < recognize_x1 && recognize_y0 < y && y < recognize_y1 && img1_array1_udated == true) 
+        else if (recognize_x0 < x && x < recognize_x1 && recognize_y0 < y && y < recognize_y1 && gallery.size() > 0)
         {
             std::cout << "cliked compare face \n";
             recognize_face_clicked = true;
@@ -309,7 +256,6 @@ Mat capture_frame(std::string cap_pipeline)
             if(wait_key == 27)
             {
                 cam_kill_esc_key = true;
-                img1_array1_udated = false;
             }
             cv::destroyAllWindows();
             break;   
@@ -325,33 +271,31 @@ Mat capture_frame(std::string cap_pipeline)
 /*****************************************
  * Function Name : compare_with_existing_faces
  * Description   : This function takes in a vector of floats floatarr representing the 
- *                 features of a face detected in an image,and compares it with the features of 
- *                 previously stored faces in text files located in the directory "faces/".
+ *                 features of a face detected in an image, and searches the enrolled
+ *                 gallery for the closest identity.
  * Arguments     : floatarr = vector<float>
  * Return value  : The return value of the function compare_with_existing_faces is a string.
- *                 It can be either the string "none" if there is no match or the path to the text file that 
- *                 contains the 512-dimensional feature vector of the matching face.
+ *                 It can be either the string "none" if there is no match or the name
+ *                 of the matching identity.
  ******************************************/
-string compare_with_existing_faces(vector<float> floatarr1,vector<float> floatarr2)
+string compare_with_existing_faces(const vector<float> &floatarr1)
 {
     float co_thresh = 0.12; //defacult th:0.21
-    float eu_thresh = 10.0;
-    float max_value_co = 0.0;
-    float min_value_eu = 10000000.0;
-    float co_score = 0.0;
-    float eu_distance = 0.0;
-    string match = "none";
-    co_score = cosine_similarity(floatarr1, floatarr2);
-    eu_distance = euclidean_distance(floatarr1, floatarr2, 512);
-    if (co_score > max_value_co)
-        max_value_co = co_score;
-    if (eu_distance < min_value_eu)
-        min_value_eu = eu_distance;
-    cout << "cosine similarity  : " << co_score <<"\n";
+    if (floatarr1.size() != FACE_EMBED_DIM)
+    {
+        try_cnt++;
+        return "none";
+    }
+    gallery_match_t best = face_index.trained() ? face_index.search(gallery, floatarr1.data())
+                                                : gallery.match(floatarr1.data());
+    /* Both embeddings are unit length, so the euclidean distance follows from the cosine */
+    float eu_distance = std::sqrt(std::max(0.0f, 2.0f - 2.0f * best.score));
+    cout << "cosine similarity  : " << best.score <<"\n";
     cout << "euclidean_distance : " << eu_distance <<"\n";
-    if ((min_value_eu < eu_thresh) && (max_value_co > co_thresh))
+    cout << "margin             : " << best.margin <<"\n";
+    if ((best.index >= 0) && (best.score > co_thresh))
     {
-        return "match";
+        return gallery.name(best.index);
     }
     else
     {
@@ -359,6 +303,47 @@ string compare_with_existing_faces(vector<float> floatarr1,vector<float> floatar
         return "none";
     }
 }
+/*****************************************
+ * Function Name : save_face_index
+ * Description   : Saves the trained index of the rows of the current gallery file,
+ *                 so that the next start loads it instead of running k-means again.
+ * Arguments     : -
+ * Return value  : -
+ ******************************************/
+void save_face_index()
+{
+    if (face_index.save(index_file, gallery_store.file_generation(), gallery.attached()))
+    {
+        index_generation = gallery_store.file_generation();
+    }
+    else
+    {
+        fprintf(stderr, "[WARNING] Face index is trained again on the next start. \n");
+    }
+}
+/*****************************************
+ * Function Name : build_face_index
+ * Description   : Loads the index of the current gallery file, or trains it on
+ *                 the gallery and saves it. Called once the gallery has
+ *                 FACE_INDEX_MIN_ROWS rows, at start or after an enrolment.
+ * Arguments     : -
+ * Return value  : -
+ ******************************************/
+void build_face_index()
+{
+    face_index.set_param(FaceIndex::default_param(gallery.size()));
+    if (face_index.load(index_file, gallery_store.file_generation(), gallery))
+    {
+        index_generation = gallery_store.file_generation();
+        cout << "face index loaded, clusters:" << face_index.param().nlist << endl;
+    }
+    else
+    {
+        face_index.train(gallery);
+        cout << "face index trained, clusters:" << face_index.param().nlist << endl;
+        save_face_index();
+    }
+}
 /*****************************************
  * Function Name : draw_rect_add_txt
  * Description   : This function to draws a rectangle and adds text on it.
@@ -478,6 +463,17 @@ int main(int argc, char **argv)
 
     // runtime.LoadModel(model_dir);
     cout << "loaded model:" << model_dir << endl;
+
+    if (!gallery_store.open(gallery_file, gallery))
+    {
+        fprintf(stderr, "[ERROR] Failed to open face gallery %s. \n", gallery_file.c_str());
+        return 0;
+    }
+    cout << "enrolled faces:" << gallery.size() << endl;
+    if (gallery.size() >= FACE_INDEX_MIN_ROWS)
+    {
+        build_face_index();
+    }
     namedWindow(app_name, WINDOW_NORMAL);
     //resizeWindow(app_name,1200, 800);
     resizeWindow(app_name,800,600);
@@ -491,36 +487,47 @@ int main(int argc, char **argv)
         frame = cv::imread("face_rec_bg.jpg");
         if ((add_face_clicked) || (recognize_face_clicked))
         {
-            if (add_face_clicked && img1_array1_udated == false)
+            if (add_face_clicked)
             {
                 img_preprocess(str1, add_faces_x0, add_faces_y0, add_faces_x1, add_faces_y1);
-                if(cam_kill_esc_key == false)
+                if(cam_kill_esc_key == false && floatarr.size() == FACE_EMBED_DIM)
                 {
-                    for (int i = 0; i < 512; i++)
+                    int32_t index = gallery.enrol("ID " + std::to_string(gallery.size() + 1), floatarr.data());
+                    if (!gallery_store.append(gallery, index))
                     {
-                        img_arr1[i] = floatarr[i];
+                        fprintf(stderr, "[WARNING] Face is enrolled for this session only. \n");
+                    }
+                    if (!face_index.trained() && gallery.size() >= FACE_INDEX_MIN_ROWS)
+                    {
+                        /* The gallery has just grown to the size of the approximate search */
+                        frame = cv::imread("face_rec_bg.jpg");
+                        cv::putText(frame, "Building face index...", cv::Point(50, 150), cv::FONT_HERSHEY_SIMPLEX, 1.0, GREEN, 2);
+                        cv::imshow(app_name, frame);
+                        cv::waitKey(1);
+                        build_face_index();
+                    }
+                    face_index.sync(gallery);
+                    /* A compaction started a new gallery file generation, keep the index file in step */
+                    if (face_index.trained() && index_generation != gallery_store.file_generation())
+                    {
+                        save_face_index();
                     }
                     frame = cv::imread("face_rec_bg.jpg");
                     cv::putText(frame, "Face added !!", cv::Point(50, 150), cv::FONT_HERSHEY_SIMPLEX, 1.0, GREEN, 2);
                     cv::imshow(app_name, frame);
                     cv::waitKey(2000);
-                    img1_array1_udated = true;
                 }
                 add_face_clicked = false;
                 cam_kill_esc_key = false;
             }
-            else if (recognize_face_clicked && img1_array1_udated == true)
+            else if (recognize_face_clicked && gallery.size() > 0)
             {
                 INIT:
                 frame = cv::imread("face_rec_bg.jpg");
                 img_preprocess(str2, recognize_x0, recognize_y0, recognize_x1, recognize_y1);
                 if(cam_kill_esc_key == false)
                 {
-                    for (int i = 0; i < 512; i++)
-                    {
-                        img_arr2[i] = floatarr[i];
-                    }
-                    string match = compare_with_existing_faces(img_arr1,img_arr2);
+                    string match = compare_with_existing_faces(floatarr);
                     cout << "return_string:" << match <<"\n";
                     cv::waitKey(10);
                     if (match == "none")
@@ -529,9 +536,6 @@ int main(int argc, char **argv)
                         {
                             cv::putText(frame,"Face authentication failed !!!", cv::Point(50, 150), cv::FONT_HERSHEY_SIMPLEX, 1.0, RED, 2);
                             try_cnt = 0;
-                            std::fill(img_arr1.begin(),img_arr1.end(),0);
-                            std::fill(img_arr2.begin(),img_arr2.end(),0);
-                            img1_array1_udated = false;
                             cv::imshow(app_name, frame);
                             cv::waitKey(3000);
                         }
@@ -543,15 +547,13 @@ int main(int argc, char **argv)
                             goto INIT;
                         }
                     }
-                    else if(match == "match")
+                    else
                     {
                         cv::putText(frame,"Face authentication using ID is succesfull !!!", cv::Point(50, 150), cv::FONT_HERSHEY_SIMPLEX, 1.0, GREEN, 2);
+                        cv::putText(frame,"Matched: " + match, cv::Point(50, 190), cv::FONT_HERSHEY_SIMPLEX, 1.0, GREEN, 2);
                         cv::imshow(app_name, frame);
                         cv::waitKey(3000);
                         try_cnt = 0;
-                        std::fill(img_arr1.begin(),img_arr1.end(),0);
-                        std::fill(img_arr2.begin(),img_arr2.end(),0);
-                        img1_array1_udated = false;
                     }  
                 }
                 recognize_face_clicked = false;
@@ -43,12 +43,15 @@
 #include "opencv2/highgui.hpp"
 #include <vector>
 #include <cmath>
-#include <queue>
+#include <atomic>
 #include <thread>
 #include "PreRuntime.h"
+#include "frame_queue.h"
 
 /* DRP-AI memory offset for model object file*/
 #define DRPAI_MEM_OFFSET            (0X38E0000)
+/* Frames waiting for the inference thread */
+#define FRAME_QUEUE_SIZE            (4)
 
 using namespace cv;
 using namespace std;
@@ -242,7 +245,14 @@ void mouse_callback_button_click(int event, int x, int y, int flags, void *userd
     }
 }
 
-void read_frames(const string &videoFile, queue<Mat> &frames, bool &stop)
+/*****************************************
+ * Function Name     : read_frames
+ * Description       : Capture thread, reads frames into the pool buffers of the frame queue.
+ * Arguments         : videoFile = video file, "0" for the camera
+ *                     frames    = frame queue shared with process_frames
+ *                     stop      = set when the user ends the inference
+ ******************************************/
+void read_frames(const string &videoFile, FrameQueue &frames, atomic<bool> &stop)
 {
     VideoCapture cap;
     if (filename == "0")
@@ -252,33 +262,52 @@ void read_frames(const string &videoFile, queue<Mat> &frames, bool &stop)
     if (!cap.isOpened())
     {
         cerr << "Failed " << videoFile << endl;
+        frames.close();
         return;
     }
-    Mat frame;
     while (!stop)
     {
-        cap.read(frame);
-        if (frame.empty())
+        /* each frame is read into its own buffer, so a queued frame is never overwritten by the next read */
+        Mat *frame = frames.acquire();
+        if (NULL == frame)
+        {
+            break;
+        }
+        cap.read(*frame);
+        if (frame->empty())
         {
+            frames.cancel(frame);
             break;
         }
         frames.push(frame);
     }
+    /* end of the video: process_frames drains the queued frames then ends */
+    frames.close();
 }
 
-void process_frames(queue<Mat> &frames, bool &stop)
+/*****************************************
+ * Function Name     : process_frames
+ * Description       : Inference thread, waits for a frame of the queue and runs the slot classifier on it.
+ * Arguments         : frames = frame queue shared with read_frames
+ *                     stop   = set when the user ends the inference
+ ******************************************/
+void process_frames(FrameQueue &frames, atomic<bool> &stop)
 {
     
     Rect box;
     Mat patch1, patch_con, patch_norm, inp_img;
     while (!stop)
     {
-        if (!frames.empty())
+        Mat *frame = frames.pop();
+        if (NULL == frame)
+        {
+            break;
+        }
         {
             auto t1 = std::chrono::high_resolution_clock::now();
-            Mat frame = frames.front();
-            frames.pop();
-            img = frame;
+            /* copy the frame out of the pool, img is drawn on and shown after the slot is refilled */
+            frame->copyTo(img);
+            frames.release(frame);
             for (int i = 0; i < boxes.size(); i++)
             {
                 box = boxes[i];
@@ -299,6 +328,7 @@ void process_frames(queue<Mat> &frames, bool &stop)
                 if (output_num != 1)
                 {
                     std::cerr << "[ERROR] Output size : not 1." << std::endl;
+                    frames.close();
                     return;
                 }
                 auto output_buffer = runtime.GetOutput(0);
@@ -329,6 +359,7 @@ void process_frames(queue<Mat> &frames, bool &stop)
             if (waitKey(10)==27)// Wait for 'Esc' key press to stop inference window!!
             {   
             stop = true;
+            frames.close();
             destroyAllWindows();
             break;
             }
@@ -458,8 +489,9 @@ int main(int argc, char **argv)
             destroyAllWindows();
             std::cout << "Running tvm runtime" << std::endl;
 
-            queue<Mat> frames;
-            bool stop = false;
+            /* camera: keep the newest frames, video file: process every frame */
+            FrameQueue frames(FRAME_QUEUE_SIZE, (filename == "0") ? FRAME_QUEUE_DROP_OLDEST : FRAME_QUEUE_BLOCK);
+            atomic<bool> stop(false);
             thread readThread(read_frames, filename, ref(frames), ref(stop));
             cout << "Waiting for read frames to add frames to buffer!!!!!" << endl;
             this_thread::sleep_for(std::chrono::seconds(0));
@@ -469,6 +501,8 @@ int main(int argc, char **argv)
             stop = false;
             readThread.join();
             processThread.join();
+            cout << "Frame queue: " << frames.get_enqueued() << " queued, " << frames.get_dropped()
+                 << " dropped, high-water mark " << frames.get_high_water() << endl;
         }
         else
         {
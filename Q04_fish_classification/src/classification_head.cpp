@@ -0,0 +1,185 @@
+/*
+ * Original Code (C) Copyright Renesas Electronics Corporation 2024
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/***********************************************************************************************************************
+* File Name    : classification_head.cpp
+* Version      : 1.0
+* Description  : Post-processing for classification models: FP16 conversion, softmax and top-k selection
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* Include
+***********************************************************************************************************************/
+#include "classification_head.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <builtin_fp16.h>
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/*****************************************
+* Function Name : fp16_to_fp32_bulk
+* Description   : Cast an array of FP16 values into FP32 in one pass.
+* Arguments     : src = FP16 input
+*                 dst = FP32 output
+*                 size = number of elements
+* Return value  : -
+******************************************/
+static void fp16_to_fp32_bulk(const uint16_t* src, float* dst, int64_t size)
+{
+    int64_t i = 0;
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    for (; i + 4 <= size; i += 4)
+    {
+        vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+    }
+#endif
+    for (; i < size; i++)
+    {
+        dst[i] = __extendXfYf2__<uint16_t, uint16_t, 10, float, uint32_t, 23>(src[i]);
+    }
+}
+
+ClassificationHead::ClassificationHead(uint32_t topk, float threshold, float temperature)
+{
+    set_topk(topk);
+    set_threshold(threshold);
+    set_temperature(temperature);
+}
+
+void ClassificationHead::set_topk(uint32_t k)
+{
+    topk = std::min<uint32_t>(std::max<uint32_t>(k, 1), CLS_TOPK_MAX);
+}
+
+void ClassificationHead::set_threshold(float th)
+{
+    threshold = th;
+}
+
+void ClassificationHead::set_temperature(float temperature)
+{
+    inv_temperature = (temperature > 0.0f) ? 1.0f / temperature : 1.0f;
+}
+
+/*****************************************
+* Function Name : reserve
+* Description   : Grow the scratch buffers so that a run of the given size
+*                 does not allocate. Only the first run of a model allocates.
+* Arguments     : size = number of classes
+* Return value  : -
+******************************************/
+void ClassificationHead::reserve(int64_t size)
+{
+    if ((int64_t)prob.size() < size)
+    {
+        prob.resize(size);
+        order.resize(size);
+    }
+}
+
+/*****************************************
+* Function Name : run_fp16
+* Description   : Convert FP16 logits, apply softmax and select the top-k classes.
+* Arguments     : logits = FP16 model output
+*                 size = number of classes
+* Return value  : cls_result_t = top-k result
+******************************************/
+cls_result_t ClassificationHead::run_fp16(const uint16_t* logits, int64_t size)
+{
+    reserve(size);
+    fp16_to_fp32_bulk(logits, prob.data(), size);
+    return select(size);
+}
+
+/*****************************************
+* Function Name : run_fp32
+* Description   : Apply softmax to FP32 logits and select the top-k classes.
+* Arguments     : logits = FP32 model output
+*                 size = number of classes
+* Return value  : cls_result_t = top-k result
+******************************************/
+cls_result_t ClassificationHead::run_fp32(const float* logits, int64_t size)
+{
+    reserve(size);
+    std::copy(logits, logits + size, prob.begin());
+    return select(size);
+}
+
+/*****************************************
+* Function Name : select
+* Description   : Numerically stable softmax over prob[0..size) followed by
+*                 a partial sort of the class indices.
+* Arguments     : size = number of classes
+* Return value  : cls_result_t = top-k result
+******************************************/
+cls_result_t ClassificationHead::select(int64_t size)
+{
+    cls_result_t result;
+    result.count = 0;
+    result.best  = -1;
+    if (size <= 0)
+    {
+        return result;
+    }
+
+    float* val = prob.data();
+    float max_num = -FLT_MAX;
+    for (int64_t i = 0; i < size; i++)
+    {
+        max_num = std::max(max_num, val[i]);
+    }
+
+    float sum = 0.0f;
+    for (int64_t i = 0; i < size; i++)
+    {
+        val[i] = std::exp((val[i] - max_num) * inv_temperature);
+        sum += val[i];
+    }
+
+    const float inv_sum = 1.0f / sum;
+    for (int64_t i = 0; i < size; i++)
+    {
+        val[i] *= inv_sum;
+    }
+
+    const int64_t k = std::min<int64_t>(topk, size);
+    for (int64_t i = 0; i < size; i++)
+    {
+        order[i] = (int32_t)i;
+    }
+    std::partial_sort(order.begin(), order.begin() + k, order.begin() + size,
+        [val](int32_t a, int32_t b) { return val[a] > val[b]; });
+
+    for (int64_t i = 0; i < k; i++)
+    {
+        result.top[i].index = order[i];
+        result.top[i].prob  = val[order[i]];
+    }
+    result.count = (uint32_t)k;
+    if (result.top[0].prob > threshold)
+    {
+        result.best = result.top[0].index;
+    }
+    return result;
+}
@@ -39,6 +39,9 @@
 #include <cstring>
 #include "MeraDrpRuntimeWrapper.h"
 #include "PreRuntime.h"
+#include "classification_head.h"
+#include "gst_yuv_capture.h"
+#include "yuv_preprocess.h"
 #include "opencv2/core.hpp"
 #include "iostream"
 #include "opencv2/imgproc.hpp"
@@ -69,15 +72,18 @@
 #define MODEL_IN_H (224)
 #define MODEL_IN_W (224)
 #define MODEL_IN_C (3)
+/*Camera capture info*/
+#define CAM_IMAGE_W (640)
+#define CAM_IMAGE_H (480)
 
 /* DRP-AI TVM[*1] Runtime object */
 MeraDrpRuntimeWrapper model_runtime;
+/* Top-5 softmax head, returns -1 below threshold */
+ClassificationHead cls_head(5, 0.6f);
 
 
 int duration,fps;
 unsigned int out;
-uint32_t out_size_arr;
-std::vector<float> floatarr(1);
 std::string score_per = "";
 cv::Mat frame;
 cv::VideoCapture cap;
@@ -120,25 +126,13 @@ uint32_t get_drpai_start_addr()
     return drpai_data.address;
 }
 
-/*****************************************
- * Function Name     : float16_to_float32
- * Description       : Function by Edgecortex. Cast uint16_t a into float value.
- * Arguments         : a = uint16_t number
- * Return value      : float = float32 number
- ******************************************/
-float float16_to_float32(uint16_t a)
-{
-    return __extendXfYf2__<uint16_t, uint16_t, 10, float, uint32_t, 23>(a);
-}
-
-
 /*****************************************
  * Function Name     : start_runtime
- * Description       : Function to perform the pre processing and post processing.
+ * Description       : Function to perform the inference and post processing.
  * Arguments         : *input = frame input address
- * Return value      : *float floatarr = pre-processed and post-processed output
+ * Return value      : cls_result_t = top-k classification result
  ******************************************/
-float *start_runtime(float *input)
+cls_result_t start_runtime(float *input)
 {
     /*Set Pre-processing output to be inference input. */
     model_runtime.SetInput(0, input);
@@ -152,50 +146,46 @@ float *start_runtime(float *input)
     }
     /* get output buffer */
     auto output_buffer = model_runtime.GetOutput(0);
-    out_size_arr = std::get<2>(output_buffer);
-    floatarr.resize(out_size_arr);
+    int64_t out_size = std::get<2>(output_buffer);
      /* Post-processing for FP16 */
     if (InOutDataType::FLOAT16 == std::get<0>(output_buffer))
     {
         std::cout << "[INFO] Output data type : FP16.\n";
         /* Extract data in FP16 <uint16_t>. */
         uint16_t *data_ptr = reinterpret_cast<uint16_t *>(std::get<1>(output_buffer));
-        for (int n = 0; n < out_size_arr; n++)
-        {
-            /* Cast FP16 output data to FP32. */
-            floatarr[n] = float16_to_float32(data_ptr[n]);
-        }
+        return cls_head.run_fp16(data_ptr, out_size);
     }
-    return floatarr.data();
+    return cls_head.run_fp32(reinterpret_cast<float *>(std::get<1>(output_buffer)), out_size);
 }
+
 /*****************************************
-* Function Name : softmax
-* Description   : Function for Post Processing
-* Arguments     : val[] = array to be computed Softmax
-*                 size = size of array
-* Return value  : -
-******************************************/
-void softmax(float* val, int32_t size)
+ * Function Name : run_model
+ * Description   : passes the pre-processed input through the model runtime and prints the result
+ * Arguments     : input = BGR HWC FP32 model input
+ *                 t1 = start time of the pre-processing
+ * Return value  : int 0 - 30
+ *                 int -1 if not found
+ ******************************************/
+int run_model(float *input, std::chrono::high_resolution_clock::time_point t1)
 {
-    float max_num = -INT_MAX;
-    float sum = 0;
-    int32_t i;
-    for ( i = 0 ; i<size ; i++ )
-    {
-        max_num = std::max(max_num, val[i]);
-    }
-
-    for ( i = 0 ; i<size ; i++ )
-    {
-        val[i]= (float) exp(val[i] - max_num);
-        sum+= val[i];
-    }
-
-    for ( i = 0 ; i<size ; i++ )
+    /*start inference using drp runtime*/
+    cls_result_t result = start_runtime(input);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+    fps = 1000/duration;
+    std::cout << "\n[INFO] AI-Inference Time(ms): " << duration << " ms\n" <<"[INFO] FPS: "<<fps<<"\n";
+    /* Print Top-5 results. */
+    std::cout << "\n[INFO] Result -----------------------"<< std::endl;
+    for (uint32_t i = 0; i < result.count; i++)
     {
-        val[i]= val[i]/sum;
+        float re_fl = std::round(result.top[i].prob*100);
+        std::cout << "Top "<< i+1 << " ["
+            << std::right << std::setw(5) << std::fixed << std::setprecision(1) << re_fl
+            <<"% ] : [" << class_names[result.top[i].index] << "]" <<std::endl;
+        if(i == 0)score_per = std::to_string(re_fl);
     }
-    return;
+    score_per.erase(5);
+    return result.best;
 }
 
 /*****************************************
@@ -208,10 +198,7 @@ void softmax(float* val, int32_t size)
  ******************************************/
 int run_inference(cv::Mat frame)
 {
-    float *output;
     auto t1 = std::chrono::high_resolution_clock::now();
-    std::map<float,int> result;
-    int result_cnt = 0;
     cv::Size size(MODEL_IN_H, MODEL_IN_W);
     /*resize the image to the model input size*/
     cv::resize(frame, frame, size);
@@ -220,42 +207,28 @@ int run_inference(cv::Mat frame)
     /*deep copy, if not continuous*/
     if (!frame.isContinuous())
         frame = frame.clone();
-    result.clear();
-    /*start inference using drp runtime*/
-    output = start_runtime(frame.ptr<float>());
+    return run_model(frame.ptr<float>(), t1);
+}
 
-    softmax(output,out_size_arr);
-    auto t2 = std::chrono::high_resolution_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
-    fps = 1000/duration;
-    std::cout << "\n[INFO] AI-Inference Time(ms): " << duration << " ms\n" <<"[INFO] FPS: "<<fps<<"\n";
-    int max_ind = -1;
-    float max_value = -1;
-    float threshold = 0.6;
-    for (int n = 0; n < out_size_arr; n++)
-    {
-        result[floatarr[n]] = n;
-        if (output[n] > max_value)
-        {
-            max_value = output[n];
-            max_ind = n;
-        }
-    }
-    /* Print Top-5 results. */
-    std::cout << "\n[INFO] Result -----------------------"<< std::endl;
-    for (auto it = result.rbegin(); it != result.rend(); it++)
+/*****************************************
+ * Function Name : run_inference_yuv
+ * Description   : pre-processes the camera image straight from its YUV buffer and passes it through the model
+ * Arguments     : image = camera image
+ * Return value  : int 0 - 30
+ *                 int -1 if not found
+ ******************************************/
+int run_inference_yuv(const yuv_image_t& image)
+{
+    /* Same input as run_inference: BGR HWC, 0-255 */
+    static std::vector<float> input(MODEL_IN_W * MODEL_IN_H * MODEL_IN_C);
+    yuv_preproc_param_t param = { MODEL_IN_W, MODEL_IN_H, false, false, 1.0f, 0, 0, 0, 0 };
+    auto t1 = std::chrono::high_resolution_clock::now();
+    if (0 != yuv_preprocess(image, param, input.data()))
     {
-        result_cnt++;
-        if(result_cnt > 5) break;
-        float re_fl = (float)(*it).first*100;
-        re_fl = std::round(re_fl);
-        std::cout << "Top "<< result_cnt << " ["
-            << std::right << std::setw(5) << std::fixed << std::setprecision(1) << re_fl
-            <<"% ] : [" << class_names[(*it).second] << "]" <<std::endl;
-        if(result_cnt == 1)score_per = std::to_string(re_fl);
+        fprintf(stderr, "[ERROR] Failed to pre-process the camera image.\n");
+        return -1;
     }
-    score_per.erase(5);
-    return (max_value > threshold) ? max_ind : -1;
+    return run_model(input.data(), t1);
 }
 
 
@@ -393,6 +366,43 @@ void capture_frame(std::string cap_pipeline)
     return;
 }
 
+/*****************************************
+ * Function Name : capture_camera
+ * Description   : captures the camera in YUYV without videoconvert, the model input is pre-processed from the
+ *                 camera buffer and the frame is converted to BGR for the display only
+ * Arguments     : source = GStreamer camera source
+ * Return value  : 0 if the camera was captured
+ *                 not 0 if the camera does not give YUYV
+ ******************************************/
+int8_t capture_camera(const std::string& source)
+{
+    int wait_key;
+    GstYuvCapture capture;
+    yuv_image_t image;
+    if (0 != capture.open(source, YUV_FORMAT_YUYV, CAM_IMAGE_W, CAM_IMAGE_H))
+    {
+        return -1;
+    }
+    while (true)
+    {
+        if (0 != capture.read(image))
+        {
+            std::cout << "[INFO] Video ended or corrupted frame !\n";
+            break;
+        }
+        out = run_inference_yuv(image);
+        yuv_to_bgr(image, frame);
+        show_result(out);
+        imshow("output", frame);
+        wait_key = cv::waitKey(30); /* Allowing 30 milliseconds frame processing time and initiating break condition */
+        if (wait_key == 27) /* If 'Esc' is entered break the loop */
+            break;
+    }
+    capture.close();
+    cv::destroyAllWindows();
+    return 0;
+}
+
 
 /*****************************************
  * Function Name : mipi_cam_init
@@ -543,8 +553,12 @@ int main(int argc, char **argv)
             std::string gstreamer_pipeline = "v4l2src device=/dev/video0 ! videoconvert ! appsink";
             /* MIPI Camera Setup */
             mipi_cam_init();
-            /* Open camera and capture frame*/
-            capture_frame(gstreamer_pipeline);
+            /* Open camera and capture frame, in YUYV if the camera gives it */
+            if (0 != capture_camera("v4l2src device=/dev/video0"))
+            {
+                fprintf(stderr, "[WARNING] YUYV capture not available, using videoconvert.\n");
+                capture_frame(gstreamer_pipeline);
+            }
             break;
         }
     }
@@ -0,0 +1,208 @@
+/*
+ * Original Code (C) Copyright Renesas Electronics Corporation 2024
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/***********************************************************************************************************************
+* File Name    : yuv_preprocess_bench.cpp
+* Version      : 1.0
+* Description  : Host benchmark of the CPU time per camera frame spent before inference, on a synthetic VGA YUYV frame:
+*                    bgr path   : full frame YUYV to BGR (the work of videoconvert), copy out of appsink, bilinear
+*                                 resize and FP32 conversion, in plain C++
+*                    opencv     : the same with cv::cvtColor, cv::resize and convertTo (BENCH_WITH_OPENCV), a lower
+*                                 bound of the videoconvert pipeline
+*                    yuv        : yuv_preprocess straight from the YUYV buffer
+*                The display conversion of the full frame is reported apart, both paths pay it when the frame is shown.
+*                Usage: yuv_preprocess_bench [frames] [model_size]
+***********************************************************************************************************************/
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include "yuv_preprocess.h"
+#ifdef BENCH_WITH_OPENCV
+#include "opencv2/core.hpp"
+#include "opencv2/imgproc.hpp"
+#endif
+
+#define BENCH_W     (640)
+#define BENCH_H     (480)
+
+/* CPU time of the process [ms], counts the threads of OpenCV too */
+static double cpu_ms()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t);
+    return t.tv_sec * 1000.0 + t.tv_nsec / 1000000.0;
+}
+
+/* Smooth synthetic scene with some texture, so that the conversions do not run on constant data */
+static void make_frame(std::vector<uint8_t>& yuyv)
+{
+    for (int32_t y = 0; y < BENCH_H; y++)
+    {
+        for (int32_t x = 0; x < BENCH_W; x += 2)
+        {
+            uint8_t* p = &yuyv[(y * BENCH_W + x) * 2];
+            for (int32_t k = 0; k < 2; k++)
+            {
+                int32_t xk = x + k;
+                p[k * 2] = (uint8_t)(126 + 90 * std::sin(xk * 0.031) * std::cos(y * 0.047) + 8 * std::sin(xk * 0.9));
+            }
+            p[1] = (uint8_t)(128 + 60 * std::sin(x * 0.013 + y * 0.021));
+            p[3] = (uint8_t)(128 + 60 * std::cos(x * 0.017 - y * 0.011));
+        }
+    }
+}
+
+/* Full frame YUYV to 8-bit BGR, BT.601 as cv::COLOR_YUV2BGR_YUYV */
+static void yuyv_to_bgr(const uint8_t* yuyv, uint8_t* bgr)
+{
+    for (int32_t i = 0; i < BENCH_W * BENCH_H; i += 2)
+    {
+        const uint8_t* p = yuyv + i * 2;
+        float u = p[1] - 128.0f;
+        float v = p[3] - 128.0f;
+        for (int32_t k = 0; k < 2; k++)
+        {
+            float luma = 1.164f * (p[k * 2] - 16.0f);
+            uint8_t* q = bgr + (i + k) * 3;
+            q[0] = (uint8_t)std::lround(std::min(255.0f, std::max(0.0f, luma + 2.018f * u)));
+            q[1] = (uint8_t)std::lround(std::min(255.0f, std::max(0.0f, luma - 0.813f * v - 0.391f * u)));
+            q[2] = (uint8_t)std::lround(std::min(255.0f, std::max(0.0f, luma + 1.596f * v)));
+        }
+    }
+}
+
+/* Bilinear resize of the BGR frame to size x size (cv::resize INTER_LINEAR sampling) and FP32 conversion */
+static void resize_to_float(const uint8_t* bgr, int32_t size, float* out)
+{
+    float rx = (float)BENCH_W / size;
+    float ry = (float)BENCH_H / size;
+    for (int32_t oy = 0; oy < size; oy++)
+    {
+        float fy = std::max(0.0f, (oy + 0.5f) * ry - 0.5f);
+        int32_t y0 = std::min((int32_t)fy, BENCH_H - 1);
+        int32_t y1 = std::min(y0 + 1, BENCH_H - 1);
+        float wy = fy - y0;
+        for (int32_t ox = 0; ox < size; ox++)
+        {
+            float fx = std::max(0.0f, (ox + 0.5f) * rx - 0.5f);
+            int32_t x0 = std::min((int32_t)fx, BENCH_W - 1);
+            int32_t x1 = std::min(x0 + 1, BENCH_W - 1);
+            float wx = fx - x0;
+            for (int32_t c = 0; c < 3; c++)
+            {
+                float a = bgr[(y0 * BENCH_W + x0) * 3 + c];
+                float b = bgr[(y0 * BENCH_W + x1) * 3 + c];
+                float d = bgr[(y1 * BENCH_W + x0) * 3 + c];
+                float e = bgr[(y1 * BENCH_W + x1) * 3 + c];
+                float top = a + (b - a) * wx;
+                float bottom = d + (e - d) * wx;
+                out[(oy * size + ox) * 3 + c] = top + (bottom - top) * wy;
+            }
+        }
+    }
+}
+
+static void report(const char* name, double ms, int32_t frames)
+{
+    printf("%-28s %8.3f ms/frame\n", name, ms / frames);
+}
+
+int main(int argc, char** argv)
+{
+    int32_t frames = (1 < argc) ? atoi(argv[1]) : 300;
+    int32_t size = (2 < argc) ? atoi(argv[2]) : 224;
+    if (0 >= frames || 0 >= size)
+    {
+        fprintf(stderr, "[ERROR] Usage: yuv_preprocess_bench [frames] [model_size]\n");
+        return -1;
+    }
+    std::vector<uint8_t> yuyv(BENCH_W * BENCH_H * 2);
+    std::vector<uint8_t> bgr(BENCH_W * BENCH_H * 3);
+    std::vector<uint8_t> appsink_copy(BENCH_W * BENCH_H * 3);
+    std::vector<float> ref(size * size * 3);
+    std::vector<float> fused(size * size * 3);
+    make_frame(yuyv);
+    printf("VGA YUYV frame, %dx%d BGR HWC FP32 model input, %d frames\n", size, size, frames);
+
+    double t = cpu_ms();
+    for (int32_t i = 0; i < frames; i++)
+    {
+        yuyv_to_bgr(yuyv.data(), bgr.data());
+        memcpy(appsink_copy.data(), bgr.data(), bgr.size());
+        resize_to_float(appsink_copy.data(), size, ref.data());
+    }
+    report("bgr path", cpu_ms() - t, frames);
+
+#ifdef BENCH_WITH_OPENCV
+    cv::Mat yuyv_mat(BENCH_H, BENCH_W, CV_8UC2, yuyv.data());
+    cv::Mat bgr_mat, copy_mat, resized, input;
+    t = cpu_ms();
+    for (int32_t i = 0; i < frames; i++)
+    {
+        cv::cvtColor(yuyv_mat, bgr_mat, cv::COLOR_YUV2BGR_YUYV);
+        bgr_mat.copyTo(copy_mat);
+        cv::resize(copy_mat, resized, cv::Size(size, size));
+        resized.convertTo(input, CV_32FC3);
+    }
+    report("opencv", cpu_ms() - t, frames);
+#endif
+
+    yuv_image_t image = { yuyv.data(), NULL, BENCH_W * 2, 0, BENCH_W, BENCH_H, YUV_FORMAT_YUYV };
+    yuv_preproc_param_t param = { size, size, false, false, 1.0f, 0, 0, 0, 0 };
+    t = cpu_ms();
+    for (int32_t i = 0; i < frames; i++)
+    {
+        yuv_preprocess(image, param, fused.data());
+    }
+    report("yuv", cpu_ms() - t, frames);
+
+    t = cpu_ms();
+    for (int32_t i = 0; i < frames; i++)
+    {
+        yuyv_to_bgr(yuyv.data(), bgr.data());
+    }
+    report("display conversion", cpu_ms() - t, frames);
+#ifdef BENCH_WITH_OPENCV
+    t = cpu_ms();
+    for (int32_t i = 0; i < frames; i++)
+    {
+        cv::cvtColor(yuyv_mat, bgr_mat, cv::COLOR_YUV2BGR_YUYV);
+    }
+    report("display conversion, opencv", cpu_ms() - t, frames);
+#endif
+
+    /* The yuv path interpolates luma before the colour conversion and takes the nearest chroma */
+    double max_diff = 0;
+    double sum_diff = 0;
+    for (size_t i = 0; i < ref.size(); i++)
+    {
+        double d = std::fabs(ref[i] - fused[i]);
+        max_diff = std::max(max_diff, d);
+        sum_diff += d;
+    }
+    printf("yuv against bgr path: mean |diff| %.3f, max |diff| %.3f (0-255 scale)\n", sum_diff / ref.size(), max_diff);
+    return 0;
+}
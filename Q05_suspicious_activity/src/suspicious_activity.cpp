@@ -59,6 +59,7 @@
 #include <string.h>
 #include <queue>
 #include <linux/drpai.h>
+#include "frame_queue.h"
 #define DRPAI_MEM_OFFSET        (0x38E0000)
 
 #define GREEN cv::Scalar(0, 255, 0)
@@ -75,6 +76,8 @@ const int BATCH_SIZE        = 10;
 unsigned int BUFFER_SIZE    = 2;
 /* Default frame interval */
 unsigned int FRAME_INTERVAL = 10; 
+/* Frames waiting for inference, the oldest is dropped when inference falls behind */
+const size_t FRAME_QUEUE_SIZE = 4;
 
 bool running_process_frame     = true;
 bool plot_g = false;
@@ -93,7 +96,7 @@ uint32_t out_size_arr;
 
 std::vector<double> x;
 std::vector<double> y;
-std::queue<cv::Mat> frame_queue;
+FrameQueue frame_queue(FRAME_QUEUE_SIZE, FRAME_QUEUE_DROP_OLDEST);
 std::vector<float> floatarr(1);
 
 const std::string non_violence      = "Non Violence activity";
@@ -196,19 +199,27 @@ void camera_thread(void)
     while (true)
     {
         frame_count++;
-        cv::Mat frame;
-        cap.read(frame);
+        /* read into a buffer of the frame queue pool, no copy when it is queued */
+        cv::Mat *buffer = frame_queue.acquire();
+        if (NULL == buffer)
+        {
+            break;
+        }
+        cap.read(*buffer);
         /* Breaking the loop if no video frame is detected */
-        if (frame.empty())
+        if (buffer->empty())
         {
             std::cout << "[INFO] Video ended or corrupted frame !\n";
+            frame_queue.cancel(buffer);
             running_process_frame = false;
             break;
         }
         /*check frame interval based on the FRAME_INTERVAL parameter*/
         if (frame_count % FRAME_INTERVAL != 0)
         {
-            cv::resize(frame, frame, cv::Size(640, 480), cv::INTER_LINEAR);
+            cv::Mat frame;
+            cv::resize(*buffer, frame, cv::Size(640, 480), cv::INTER_LINEAR);
+            frame_queue.cancel(buffer);
             if (result != none)
             {
                 Color = (result == violence) ? RED : GREEN;
@@ -235,12 +246,15 @@ void camera_thread(void)
         }
         else
         {
-            /*push frames to the queue for processing if queue size is not 100*/
-            if (frame_queue.size()<100)
-                frame_queue.push(frame);
+            /*push frames to the queue for processing, the oldest queued frame is dropped if it is full*/
+            frame_queue.push(buffer);
             frame_count = 0;
         }
     }
+    /* wake process_frames waiting for a frame */
+    frame_queue.close();
+    std::cout << "[INFO] Frame queue: " << frame_queue.get_enqueued() << " queued, "
+              << frame_queue.get_dropped() << " dropped, high-water mark " << frame_queue.get_high_water() << "\n";
     cap.release();
     cv::destroyAllWindows();
 }
@@ -415,20 +429,21 @@ void process_frames(void)
 
     while (running_process_frame)
     {
-        /* checking input frame array is empty or not */
-        if (frame_queue.empty())
-            continue;
-        cv::Mat frame = frame_queue.front();
-        frame_queue.pop();
+        /* wait for the next frame, NULL once the camera thread has ended */
+        cv::Mat *buffer = frame_queue.pop();
+        if (NULL == buffer)
+            break;
         auto t1 = std::chrono::high_resolution_clock::now();
         /* checking the input frame is empty or not*/
-        if(frame.empty())
+        if(buffer->empty())
         {
             std::cout << "[ERROR] Unable to read frame" << std::endl;
+            frame_queue.release(buffer);
             break;
         }
         /* run inference*/
-        cv::Mat feature_vector = run_inference(frame);
+        cv::Mat feature_vector = run_inference(*buffer);
+        frame_queue.release(buffer);
         features.push_back(feature_vector);
         if (features.size() >= BATCH_SIZE)
         {
@@ -61,6 +61,8 @@
 #include "image.h"
 /*Wayland control*/
 #include "wayland.h"
+/*Blocking hand-off between threads*/
+#include "stage_graph.h"
 /*Common Definitions of Macros*/
 #include "../common/comm_define.h"
 /*box drawing*/
@@ -82,14 +84,15 @@ using namespace std;
  ******************************************/
 /*Multithreading*/
 static sem_t terminate_req_sem;
+static StageGraph stages(&terminate_req_sem);
 static pthread_t ai_inf_thread;
 static pthread_t kbhit_thread;
 static pthread_t capture_thread;
 static mutex mtx;
 
 /*Flags*/
-static atomic<uint8_t> inference_start(0);
-static atomic<uint8_t> img_obj_ready(0);
+static StageEvent inference_start(stages, "inference_start");
+static StageEvent img_obj_ready(stages, "img_obj_ready");
 
 /*Global Variables*/
 static float drpai_output_buf[INF_OUT_SIZE];
@@ -663,12 +666,11 @@ void *R_Inf_Thread(void *threadid)
             {
                 goto ai_inf_end;
             }
-            /*Checks if image frame from Capture Thread is ready.*/
-            if (inference_start.load())
+            /*Blocks until image frame from Capture Thread is ready or termination is requested.*/
+            if (inference_start.wait_set())
             {
                 break;
             }
-            usleep(WAIT_TIME);
         }
 
         /* set image address for pre- processing */
@@ -763,7 +765,7 @@ void *R_Inf_Thread(void *threadid)
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto ai_inf_end;
 /*AI Thread Termination*/
 ai_inf_end:
@@ -862,7 +864,7 @@ void *R_Capture_Thread(void *threadid)
 
 /*Error Processing*/
 err:
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto capture_end;
 
 capture_end:
@@ -922,6 +924,11 @@ void *R_Kbhit_Thread(void *threadid)
             goto key_hit_end;
         }
 
+        /* Blocks until a key is pressed or termination is requested. */
+        if (!stages.wait_readable(STDIN_FILENO))
+        {
+            continue;
+        }
         c = getchar();
         if (EOF != c)
         {
@@ -929,17 +936,17 @@ void *R_Kbhit_Thread(void *threadid)
             printf("key Detected.\n");
             goto err;
         }
-        else
+        else if (feof(stdin))
         {
-            /* When nothing is pressed. */
-            usleep(WAIT_TIME);
+            /* Standard input is closed, only termination ends the thread. */
+            stages.wait_shutdown();
         }
     }
 
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto key_hit_end;
 
 key_hit_end:
@@ -1006,13 +1013,13 @@ int8_t R_Main_Process()
 
             img_obj_ready.store(0);
         }
-        /*Wait for 1 TICK.*/
-        usleep(WAIT_TIME);
+        /*Wait for the next frame from Capture Thread.*/
+        img_obj_ready.wait_set();
     }
 
 /*Error Processing*/
 err:
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     main_ret = 1;
     goto main_proc_end;
 /*Main Processing Termination*/
@@ -1226,6 +1233,12 @@ int32_t main(int32_t argc, char *argv[])
         goto end_threads;
     }
 
+    /*Stages and the events they hand over*/
+    stages.add_stage("capture", {}, {&inference_start, &img_obj_ready});
+    stages.add_stage("inference", {&inference_start}, {});
+    stages.add_stage("main", {&img_obj_ready}, {});
+    stages.print();
+
     /*Create Key Hit Thread*/
     create_thread_key = pthread_create(&kbhit_thread, NULL, R_Kbhit_Thread, NULL);
     if (0 != create_thread_key)
@@ -1239,7 +1252,7 @@ int32_t main(int32_t argc, char *argv[])
     create_thread_ai = pthread_create(&ai_inf_thread, NULL, R_Inf_Thread, NULL);
     if (0 != create_thread_ai)
     {
-        sem_trywait(&terminate_req_sem);
+        stages.shutdown();
         fprintf(stderr, "[ERROR] Failed to create AI Inference Thread.\n");
         ret_main = -1;
         goto end_threads;
@@ -1249,7 +1262,7 @@ int32_t main(int32_t argc, char *argv[])
     create_thread_capture = pthread_create(&capture_thread, NULL, R_Capture_Thread, (void *)capture);
     if (0 != create_thread_capture)
     {
-        sem_trywait(&terminate_req_sem);
+        stages.shutdown();
         fprintf(stderr, "[ERROR] Failed to create Capture Thread.\n");
         ret_main = -1;
         goto end_threads;
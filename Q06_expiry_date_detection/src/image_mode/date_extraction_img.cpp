@@ -9,6 +9,10 @@
 #include "../common/utils/common_utils.h"
 #include "../common/comm_define.h"
 #include "../camera_mode/PreRuntime.h"
+#include "ocr_pool/ocr_pool.h"
+#include <algorithm>
+#include <dirent.h>
+#include <thread>
 
 using namespace std;
 
@@ -320,30 +324,12 @@ void date_extraction()
             continue;
         }
 
-        /*Get the cropped image */
-        cv::Mat crop_img = get_crop_gray(frame_g, (int)det[i].bbox.x, (int)det[i].bbox.y,
-                                         (int)det[i].bbox.w, (int)det[i].bbox.h);
-
-        /* Resize when height < 32 */
-        cv::Mat process_img = resize_gray_image(crop_img, MIN_CROP_HEIGHT);
-
         /*Run the Tesseract Engine*/
         // Get the initialized Tesseract engine instance
         TesseractEngine &tesseract = TesseractEngine::getInstance();
 
-        // Use the initialized Tesseract engine for processing
-        tesseract::TessBaseAPI &tess_ocr_engine = tesseract.getEngine();
-
-        tess_ocr_engine.SetImage(process_img.data, process_img.cols, process_img.rows, 1, process_img.step);
-
-        tess_ocr_engine.SetSourceResolution(TESS_IMG_RESOLUTION);
-
-        /* Perform OCR and retrieve the recognized text */
-
-        char *recognizedText = tess_ocr_engine.GetUTF8Text();
-
-        /*Remove trailing and leading white spaces */
-        processed_text = trim_white_spc(recognizedText);
+        /* Crop, OCR and trim, the engine is cleared after the call */
+        processed_text = ocr_box(tesseract.getEngine(), frame_g, det[i]);
  
         cout<< "Detected String :"<< processed_text << endl;
 
@@ -386,10 +372,6 @@ void date_extraction()
             }
 
         }
-
-        /*free up the memory and clear the image from the tesseract*/
-        delete[] recognizedText;
-        tesseract.clear();
     }
 
     mtx.unlock();
@@ -611,6 +593,143 @@ cv::Mat create_output_frame()
     return background;
 }
 
+/**
+ * @brief List the images of a directory in name order
+ *
+ * @param dir
+ * @return vector<string> paths of the jpg, jpeg, png and bmp files
+ */
+static vector<string> list_images(const string& dir)
+{
+    vector<string> images;
+    DIR *dp = opendir(dir.c_str());
+    if (NULL == dp)
+    {
+        fprintf(stderr, "[ERROR] Failed to open image directory %s\n", dir.c_str());
+        return images;
+    }
+    for (dirent *entry = readdir(dp); NULL != entry; entry = readdir(dp))
+    {
+        string name = entry->d_name;
+        size_t dot = name.rfind('.');
+        if (string::npos == dot)
+        {
+            continue;
+        }
+        string ext = name.substr(dot + 1);
+        transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return tolower(c); });
+        if (ext == "jpg" || ext == "jpeg" || ext == "png" || ext == "bmp")
+        {
+            images.push_back(dir + "/" + name);
+        }
+    }
+    closedir(dp);
+    sort(images.begin(), images.end());
+    return images;
+}
+
+/**
+ * @brief Batch mode: the DRP-AI detects the date boxes of each image of a directory while a pool of OCR workers
+ *        reads the boxes of the previous images, and one line per image is written to the result file
+ *
+ * @param dir image directory
+ * @param workers number of OCR workers
+ * @param out_path result file, JSONL if it ends with .jsonl, CSV otherwise
+ * @return int 0 if succeeded
+ */
+int run_batch(const string& dir, int32_t workers, const string& out_path)
+{
+    vector<string> images = list_images(dir);
+    if (images.empty())
+    {
+        fprintf(stderr, "[ERROR] No image in %s\n", dir.c_str());
+        return -1;
+    }
+    OcrResultWriter writer;
+    if (!writer.open(out_path, rem_days_shown))
+    {
+        return -1;
+    }
+
+    /* Totals of the images read, updated by one worker at a time */
+    int32_t done = 0;
+    int32_t dates = 0;
+    double sum_read = 0, sum_pre = 0, sum_ai = 0, sum_post = 0, sum_queue = 0, sum_ocr = 0, sum_total = 0;
+    OcrPool pool(workers, regex_dict_g, rem_days_shown, [&](const OcrResult& r)
+    {
+        writer.write(r);
+        done++;
+        dates += r.dates.size();
+        sum_read += r.read_ms;
+        sum_pre += r.pre_ms;
+        sum_ai += r.ai_ms;
+        sum_post += r.post_ms;
+        sum_queue += r.queue_ms;
+        sum_ocr += r.ocr_ms;
+        sum_total += r.total_ms;
+    });
+    if (0 != pool.start())
+    {
+        writer.close();
+        return -1;
+    }
+    std::cout << "[INFO] Batch of " << images.size() << " images, results in " << out_path << std::endl;
+
+    int ret = 0;
+    auto t_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        OcrJob job;
+        job.index = i;
+        job.path = images[i];
+        job.start = std::chrono::steady_clock::now();
+        /* frame_g gets a new buffer for each image, the queued frames keep theirs */
+        frame_g = cv::imread(images[i]);
+        if (frame_g.empty())
+        {
+            fprintf(stderr, "[WARNING] Failed to load %s, skipped\n", images[i].c_str());
+            continue;
+        }
+        cv::resize(frame_g, frame_g, cv::Size(IMAGE_WIDTH, IMAGE_HEIGHT));
+        auto t_pre = std::chrono::steady_clock::now();
+        cv::Mat input = pre_process();
+        auto t_ai = std::chrono::steady_clock::now();
+        if (0 != drpai_inference(input))
+        {
+            fprintf(stderr, "[ERROR] DRP Inference failed on %s\n", images[i].c_str());
+            ret = -1;
+            break;
+        }
+        auto t_post = std::chrono::steady_clock::now();
+        R_Post_Proc(drpai_output_buf);
+        auto t_end = std::chrono::steady_clock::now();
+
+        job.read_ms = std::chrono::duration<double, std::milli>(t_pre - job.start).count();
+        job.pre_ms = std::chrono::duration<double, std::milli>(t_ai - t_pre).count();
+        job.ai_ms = std::chrono::duration<double, std::milli>(t_post - t_ai).count();
+        job.post_ms = std::chrono::duration<double, std::milli>(t_end - t_post).count();
+        job.frame = frame_g;
+        job.det = det;
+        pool.push(std::move(job));
+    }
+    /* The OCR of the queued images ends before the totals are read */
+    pool.finish();
+    writer.close();
+
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_start).count();
+    if (0 < done)
+    {
+        printf("[INFO] %d images in %.2f s, %.2f images/s, %d dates\n", done, elapsed / 1000.0,
+               done * 1000.0 / elapsed, dates);
+        printf("[INFO] Mean per image [ms]: read %.2f, pre %.2f, ai %.2f, post %.2f, ocr queue %.2f, ocr %.2f, "
+               "latency %.2f\n", sum_read / done, sum_pre / done, sum_ai / done, sum_post / done, sum_queue / done,
+               sum_ocr / done, sum_total / done);
+        printf("[INFO] DRP-AI utilization %.1f %%, OCR workers utilization %.1f %%\n", 100.0 * sum_ai / elapsed,
+               100.0 * sum_ocr / (elapsed * workers));
+    }
+    return ret;
+}
+
 /*****************************************
 * Function Name : get_drpai_start_addr
 * Description   : Function to get the start address of DRPAImem.
@@ -647,12 +766,47 @@ uint32_t get_drpai_start_addr()
 int main(int argc, char *argv[])
 {
     std::cout << "Date-Extraction Application Start" << std::endl;
-    
+
+    /* Batch mode: date_extraction_img --batch img_dir [-rem] [--workers=N] [--out=results.csv|results.jsonl] */
+    bool batch_mode = (argc >= 3 && std::string(argv[1]) == "--batch");
+    string batch_dir;
+    string out_path = "date_results.csv";
+    /* The main thread runs the DRP-AI, the other cores read the dates */
+    int32_t workers = std::max(1, (int32_t)std::thread::hardware_concurrency() - 1);
+
+    if (batch_mode)
+    {
+        batch_dir = argv[2];
+        for (int i = 3; i < argc; i++)
+        {
+            string arg = argv[i];
+            if (arg == "-rem")
+            {
+                std::cout<<"[INFO] Remaining Expiry Days will be written"<<std::endl;
+                rem_days_shown = true;
+            }
+            else if (0 == arg.rfind("--workers=", 0))
+            {
+                workers = std::max(1, atoi(arg.c_str() + 10));
+            }
+            else if (0 == arg.rfind("--out=", 0))
+            {
+                out_path = arg.substr(6);
+            }
+            else
+            {
+                std::cerr << "[ERROR] Wrong Arguments are passed\n";
+                printf("Usage3: date_extraction_img --batch img_dir [-rem] [--workers=N] [--out=results.csv] \n");
+                return 1;
+            }
+        }
+    }
     /* If more than three arguments are passed */
-    if (argc>3)
+    else if (argc>3)
     {
         std::cerr << "Wrong number Arguments are passed \n";
         printf("Usage1: date_extraction_img img_pth.jpg -rem \n Usage2 : date_extraction_img img_pth.jpg \n");
+        printf(" Usage3 : date_extraction_img --batch img_dir [-rem] [--workers=N] [--out=results.csv] \n");
         return 1;
     }
     else 
@@ -690,8 +844,11 @@ int main(int argc, char *argv[])
 
     }
         
-    // initialize tesseract engine
-    TesseractEngine &tesseract = TesseractEngine::getInstance();
+    // initialize tesseract engine, the batch mode has one per OCR worker
+    if (!batch_mode)
+    {
+        TesseractEngine::getInstance();
+    }
 
     // create regex dictionary from regex module functions
     regex_dict_g = create_regex_dict();
@@ -718,6 +875,11 @@ int main(int argc, char *argv[])
         return -1;
     }    
 
+    if (batch_mode)
+    {
+        return run_batch(batch_dir, workers, out_path);
+    }
+
     
 
     /* Resize to fixed height and width*/
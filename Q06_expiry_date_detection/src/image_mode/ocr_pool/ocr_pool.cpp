@@ -0,0 +1,392 @@
+/***********************************************************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only intended for use with Renesas products. No
+* other uses are authorized. This software is owned by Renesas Electronics Corporation and is protected under all
+* applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED. TO THE MAXIMUM
+* EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES
+* SHALL BE LIABLE FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR ANY REASON RELATED TO THIS
+* SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software and to discontinue the availability of
+* this software. By using this software, you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer
+*
+* Copyright (C) 2024 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : ocr_pool.cpp
+* Version      : v1.00
+* Description  : RZ/V2L AI SDK Sample Application: Expiry Date Extraction
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "ocr_pool.h"
+#include <iomanip>
+#include <sstream>
+#include "../image_proc/image_processing.h"
+#include "../../common/regex_module/regex_function.h"
+#include "../../common/text_proc_module/TextProc.h"
+
+#define PAGE_SEGMENT_MODE  (7)
+
+/**
+ * @brief Milliseconds between two time points
+ *
+ * @param from
+ * @param to
+ * @return double
+ */
+static double elapsed_ms(ocr_time_t from, ocr_time_t to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+/**
+ * @brief Tesseract engine set up as TesseractEngine: English, default OCR engine, single text line
+ *
+ * @param engine
+ * @return int8_t 0 if succeeded
+ */
+int8_t init_ocr_engine(tesseract::TessBaseAPI& engine)
+{
+    if (engine.Init(NULL, "eng", tesseract::OEM_DEFAULT))
+    {
+        fprintf(stderr, "[ERROR] Failed to initialize tesseract OCR engine\n");
+        return -1;
+    }
+    engine.SetPageSegMode(static_cast<tesseract::PageSegMode>(PAGE_SEGMENT_MODE));
+    return 0;
+}
+
+/**
+ * @brief Text of one detected box: gray crop, resize to MIN_CROP_HEIGHT and Tesseract
+ *
+ * @param engine Tesseract engine, cleared after the call
+ * @param frame
+ * @param d detected box
+ * @return std::string text without leading and trailing white spaces
+ */
+std::string ocr_box(tesseract::TessBaseAPI& engine, cv::Mat& frame, const detection& d)
+{
+    /*Get the cropped image */
+    cv::Mat crop_img = get_crop_gray(frame, (int)d.bbox.x, (int)d.bbox.y, (int)d.bbox.w, (int)d.bbox.h);
+
+    /* Resize when height < 32 */
+    cv::Mat process_img = resize_gray_image(crop_img, MIN_CROP_HEIGHT);
+
+    engine.SetImage(process_img.data, process_img.cols, process_img.rows, 1, process_img.step);
+    engine.SetSourceResolution(TESS_IMG_RESOLUTION);
+
+    /* Perform OCR and retrieve the recognized text */
+    char *recognized_text = engine.GetUTF8Text();
+    std::string text;
+    if (NULL != recognized_text)
+    {
+        /*Remove trailing and leading white spaces */
+        text = trim_white_spc(recognized_text);
+        delete[] recognized_text;
+    }
+
+    /*clear the image from the tesseract*/
+    engine.Clear();
+    return text;
+}
+
+OcrPool::OcrPool(int32_t workers, const std::map<boost::regex, std::string>& regex_dict, bool rem_days,
+                 result_cb_t on_result)
+    : workers(std::max(1, workers)), regex_dict(regex_dict), rem_days(rem_days), on_result(on_result),
+      stopped(false)
+{
+}
+
+OcrPool::~OcrPool()
+{
+    finish();
+}
+
+/**
+ * @brief Initializes the engines and starts the workers
+ *
+ * @return int8_t 0 if succeeded
+ */
+int8_t OcrPool::start()
+{
+    /* The workers already use all the cores, each Tesseract call is kept on one thread */
+    setenv("OMP_THREAD_LIMIT", "1", 0);
+    for (int32_t i = 0; i < workers; i++)
+    {
+        std::unique_ptr<tesseract::TessBaseAPI> engine(new tesseract::TessBaseAPI());
+        if (0 != init_ocr_engine(*engine))
+        {
+            return -1;
+        }
+        engines.push_back(std::move(engine));
+    }
+    printf("[INFO] %d OCR workers\n", workers);
+    stopped = false;
+    for (auto& engine : engines)
+    {
+        threads.emplace_back(&OcrPool::worker_loop, this, engine.get());
+    }
+    return 0;
+}
+
+/**
+ * @brief Queues an image, waits while the queue holds two images per worker
+ *
+ * @param job
+ */
+void OcrPool::push(OcrJob&& job)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    cond.wait(lock, [this] { return stopped || jobs.size() < 2 * threads.size(); });
+    if (stopped)
+    {
+        return;
+    }
+    job.queued = std::chrono::steady_clock::now();
+    jobs.push_back(std::move(job));
+    cond.notify_all();
+}
+
+/**
+ * @brief Waits until the queued images are read and stops the workers
+ *
+ */
+void OcrPool::finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopped = true;
+    }
+    cond.notify_all();
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+    threads.clear();
+    for (auto& engine : engines)
+    {
+        engine->End();
+    }
+    engines.clear();
+}
+
+void OcrPool::worker_loop(tesseract::TessBaseAPI* engine)
+{
+    while (true)
+    {
+        OcrJob job;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cond.wait(lock, [this] { return stopped || !jobs.empty(); });
+            /* The queue is drained before the workers stop */
+            if (jobs.empty())
+            {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        cond.notify_all();
+        OcrResult result = process(*engine, job);
+        std::lock_guard<std::mutex> lock(result_mtx);
+        on_result(result);
+    }
+}
+
+/**
+ * @brief Reads the date boxes of an image as date_extraction does
+ *
+ * @param engine
+ * @param job
+ * @return OcrResult
+ */
+OcrResult OcrPool::process(tesseract::TessBaseAPI& engine, OcrJob& job)
+{
+    OcrResult result;
+    result.index = job.index;
+    result.path = job.path;
+    result.boxes = 0;
+    result.read_ms = job.read_ms;
+    result.pre_ms = job.pre_ms;
+    result.ai_ms = job.ai_ms;
+    result.post_ms = job.post_ms;
+
+    ocr_time_t t_ocr = std::chrono::steady_clock::now();
+    result.queue_ms = elapsed_ms(job.queued, t_ocr);
+    for (const detection& d : job.det)
+    {
+        /* Only the non overlapped, non empty boxes of class 0 [i.e. date] */
+        if (d.prob == 0 || d.c != 0 || (int)d.bbox.h == 0 || (int)d.bbox.w == 0)
+        {
+            continue;
+        }
+        result.boxes++;
+        std::string text = ocr_box(engine, job.frame, d);
+        if (text.empty())
+        {
+            continue;
+        }
+        result.texts.push_back(text);
+        ymd_struct ymd = get_yymmddd(regex_dict, text);
+        if (!ymd.matched)
+        {
+            continue;
+        }
+        date_struct date;
+        date.txt_extr = text;
+        date.year = ymd.year;
+        date.month = ymd.month;
+        date.day = ymd.day;
+        date.remaining_days = 0;
+        if (rem_days)
+        {
+            std::lock_guard<std::mutex> lock(result_mtx);
+            date.remaining_days = date_checker.calculate_days_left(date.year, date.month, date.day);
+        }
+        result.dates.push_back(date);
+    }
+    ocr_time_t t_end = std::chrono::steady_clock::now();
+    result.ocr_ms = elapsed_ms(t_ocr, t_end);
+    result.total_ms = elapsed_ms(job.start, t_end);
+    return result;
+}
+
+/**
+ * @brief Quoted CSV field
+ *
+ * @param s
+ * @return std::string
+ */
+static std::string csv_field(const std::string& s)
+{
+    std::string out = "\"";
+    for (char c : s)
+    {
+        if ('"' == c)
+        {
+            out += '"';
+        }
+        out += c;
+    }
+    return out + "\"";
+}
+
+/**
+ * @brief JSON string, control characters escaped
+ *
+ * @param s
+ * @return std::string
+ */
+static std::string json_string(const std::string& s)
+{
+    std::ostringstream out;
+    out << '"';
+    for (unsigned char c : s)
+    {
+        if ('"' == c || '\\' == c)
+        {
+            out << '\\' << c;
+        }
+        else if (0x20 > c)
+        {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec;
+        }
+        else
+        {
+            out << c;
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+bool OcrResultWriter::open(const std::string& path, bool rem_days)
+{
+    this->rem_days = rem_days;
+    const std::string ext = ".jsonl";
+    jsonl = (path.size() >= ext.size() && 0 == path.compare(path.size() - ext.size(), ext.size(), ext));
+    file.open(path);
+    if (!file.is_open())
+    {
+        fprintf(stderr, "[ERROR] Failed to open the result file %s\n", path.c_str());
+        return false;
+    }
+    if (!jsonl)
+    {
+        file << "index,image,boxes,texts,dates,remaining_days,read_ms,pre_ms,ai_ms,post_ms,queue_ms,ocr_ms,total_ms\n";
+    }
+    return true;
+}
+
+/**
+ * @brief One line of the image, the dates are YYYY-MM-DD as read, several dates separated by ';' in CSV
+ *
+ * @param result
+ */
+void OcrResultWriter::write(const OcrResult& result)
+{
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(2);
+    if (jsonl)
+    {
+        line << "{\"index\":" << result.index << ",\"image\":" << json_string(result.path)
+             << ",\"boxes\":" << result.boxes << ",\"texts\":[";
+        for (size_t i = 0; i < result.texts.size(); i++)
+        {
+            line << (i ? "," : "") << json_string(result.texts[i]);
+        }
+        line << "],\"dates\":[";
+        for (size_t i = 0; i < result.dates.size(); i++)
+        {
+            const date_struct& d = result.dates[i];
+            line << (i ? "," : "") << "{\"text\":" << json_string(d.txt_extr) << ",\"year\":" << json_string(d.year)
+                 << ",\"month\":" << json_string(d.month) << ",\"day\":" << json_string(d.day);
+            if (rem_days)
+            {
+                line << ",\"remaining_days\":" << d.remaining_days;
+            }
+            line << "}";
+        }
+        line << "],\"timing_ms\":{\"read\":" << result.read_ms << ",\"pre\":" << result.pre_ms
+             << ",\"ai\":" << result.ai_ms << ",\"post\":" << result.post_ms << ",\"queue\":" << result.queue_ms
+             << ",\"ocr\":" << result.ocr_ms << ",\"total\":" << result.total_ms << "}}\n";
+    }
+    else
+    {
+        std::string texts, dates, remaining;
+        for (size_t i = 0; i < result.texts.size(); i++)
+        {
+            texts += (i ? ";" : "") + result.texts[i];
+        }
+        for (size_t i = 0; i < result.dates.size(); i++)
+        {
+            const date_struct& d = result.dates[i];
+            dates += (i ? ";" : "") + d.year + "-" + d.month + "-" + d.day;
+            if (rem_days)
+            {
+                remaining += (i ? ";" : "") + std::to_string(d.remaining_days);
+            }
+        }
+        line << result.index << "," << csv_field(result.path) << "," << result.boxes << "," << csv_field(texts)
+             << "," << csv_field(dates) << "," << csv_field(remaining) << "," << result.read_ms << ","
+             << result.pre_ms << "," << result.ai_ms << "," << result.post_ms << "," << result.queue_ms << ","
+             << result.ocr_ms << "," << result.total_ms << "\n";
+    }
+    file << line.str();
+    file.flush();
+}
+
+void OcrResultWriter::close()
+{
+    if (file.is_open())
+    {
+        file.close();
+    }
+}
@@ -0,0 +1,199 @@
+/***********************************************************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only intended for use with Renesas products. No
+* other uses are authorized. This software is owned by Renesas Electronics Corporation and is protected under all
+* applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED. TO THE MAXIMUM
+* EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES
+* SHALL BE LIABLE FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR ANY REASON RELATED TO THIS
+* SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software and to discontinue the availability of
+* this software. By using this software, you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer
+*
+* Copyright (C) 2024 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : ocr_pool.h
+* Version      : v1.00
+* Description  : RZ/V2L AI SDK Sample Application: Expiry Date Extraction
+*                Pool of OCR workers of the batch mode. Each worker owns a Tesseract engine and reads the date boxes
+*                of one image while the DRP-AI detects the next ones.
+***********************************************************************************************************************/
+
+#ifndef OCR_POOL_H
+#define OCR_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/regex.hpp>
+#include <tesseract/baseapi.h>
+#include <opencv2/opencv.hpp>
+#include "../../common/box.h"
+#include "../../common/comm_define.h"
+#include "../../common/date_chck_module/date_check.h"
+
+typedef std::chrono::steady_clock::time_point ocr_time_t;
+
+/**
+ * @brief Image detected by the DRP-AI, waiting for the OCR of its date boxes
+ *
+ */
+struct OcrJob
+{
+    int32_t index;
+    std::string path;
+    /* Frame of IMAGE_WIDTH x IMAGE_HEIGHT the boxes refer to */
+    cv::Mat frame;
+    std::vector<detection> det;
+    /* Detection stage times [ms] */
+    double read_ms;
+    double pre_ms;
+    double ai_ms;
+    double post_ms;
+    /* Image read start and queueing time */
+    ocr_time_t start;
+    ocr_time_t queued;
+};
+
+/**
+ * @brief Dates read in one image, with the times of all its stages
+ *
+ */
+struct OcrResult
+{
+    int32_t index;
+    std::string path;
+    int32_t boxes;
+    /* Text of each date box read, matched or not */
+    std::vector<std::string> texts;
+    std::vector<date_struct> dates;
+    double read_ms;
+    double pre_ms;
+    double ai_ms;
+    double post_ms;
+    /* Wait for a free worker, OCR of all the boxes, image read start to OCR end [ms] */
+    double queue_ms;
+    double ocr_ms;
+    double total_ms;
+};
+
+/**
+ * @brief Tesseract engine set up as TesseractEngine: English, default OCR engine, single text line
+ *
+ * @param engine
+ * @return int8_t 0 if succeeded
+ */
+int8_t init_ocr_engine(tesseract::TessBaseAPI& engine);
+
+/**
+ * @brief Text of one detected box: gray crop, resize to MIN_CROP_HEIGHT and Tesseract
+ *
+ * @param engine Tesseract engine, cleared after the call
+ * @param frame
+ * @param d detected box
+ * @return std::string text without leading and trailing white spaces
+ */
+std::string ocr_box(tesseract::TessBaseAPI& engine, cv::Mat& frame, const detection& d);
+
+/**
+ * @brief Workers taking the detected images from a bounded queue, one Tesseract engine each
+ *
+ */
+class OcrPool
+{
+public:
+    typedef std::function<void(const OcrResult&)> result_cb_t;
+
+    /**
+     * @brief
+     *
+     * @param workers number of worker threads
+     * @param regex_dict date formats of get_yymmddd
+     * @param rem_days remaining days of each date are calculated
+     * @param on_result called for each image, by one worker at a time
+     */
+    OcrPool(int32_t workers, const std::map<boost::regex, std::string>& regex_dict, bool rem_days,
+            result_cb_t on_result);
+    ~OcrPool();
+
+    OcrPool(const OcrPool&) = delete;
+    OcrPool& operator=(const OcrPool&) = delete;
+
+    /**
+     * @brief Initializes the engines and starts the workers
+     *
+     * @return int8_t 0 if succeeded
+     */
+    int8_t start();
+
+    /**
+     * @brief Queues an image, waits while the queue holds two images per worker
+     *
+     * @param job
+     */
+    void push(OcrJob&& job);
+
+    /**
+     * @brief Waits until the queued images are read and stops the workers
+     *
+     */
+    void finish();
+
+private:
+    void worker_loop(tesseract::TessBaseAPI* engine);
+    OcrResult process(tesseract::TessBaseAPI& engine, OcrJob& job);
+
+    int32_t workers;
+    const std::map<boost::regex, std::string>& regex_dict;
+    bool rem_days;
+    result_cb_t on_result;
+
+    std::vector<std::unique_ptr<tesseract::TessBaseAPI>> engines;
+    std::vector<std::thread> threads;
+    std::deque<OcrJob> jobs;
+    bool stopped;
+    std::mutex mtx;
+    std::condition_variable cond;
+    /* Serializes on_result and the DateChecker, which reads the local time */
+    std::mutex result_mtx;
+    DateChecker date_checker;
+};
+
+/**
+ * @brief Writes one line per image, JSONL if the file name ends with .jsonl, CSV otherwise
+ *
+ */
+class OcrResultWriter
+{
+public:
+    /**
+     * @brief
+     *
+     * @param path
+     * @param rem_days the remaining days are written
+     * @return true if the file is opened
+     */
+    bool open(const std::string& path, bool rem_days);
+    void write(const OcrResult& result);
+    void close();
+
+private:
+    std::ofstream file;
+    bool jsonl = false;
+    bool rem_days = false;
+};
+
+#endif
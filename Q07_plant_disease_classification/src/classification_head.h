@@ -0,0 +1,99 @@
+/*
+ * Original Code (C) Copyright Renesas Electronics Corporation 2024
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/***********************************************************************************************************************
+* File Name    : classification_head.h
+* Version      : 1.0
+* Description  : Post-processing for classification models: FP16 conversion, softmax and top-k selection
+***********************************************************************************************************************/
+#pragma once
+
+#ifndef CLASSIFICATION_HEAD_H
+#define CLASSIFICATION_HEAD_H
+/***********************************************************************************************************************
+* Include
+***********************************************************************************************************************/
+#include <cstdint>
+#include <vector>
+
+/***********************************************************************************************************************
+* Macro
+***********************************************************************************************************************/
+/* Maximum number of entries kept in a cls_result_t */
+#define CLS_TOPK_MAX    (5)
+
+/***********************************************************************************************************************
+* Struct
+***********************************************************************************************************************/
+/*****************************************
+* cls_entry_t : One ranked class
+******************************************/
+typedef struct
+{
+    int32_t index;
+    float   prob;
+} cls_entry_t;
+
+/*****************************************
+* cls_result_t : Top-k result of a classification run.
+*                best is the top class index, or -1 when its probability
+*                does not exceed the configured threshold.
+******************************************/
+typedef struct
+{
+    cls_entry_t top[CLS_TOPK_MAX];
+    uint32_t    count;
+    int32_t     best;
+} cls_result_t;
+
+/***********************************************************************************************************************
+* Class
+***********************************************************************************************************************/
+class ClassificationHead
+{
+    public:
+        ClassificationHead(uint32_t topk = CLS_TOPK_MAX, float threshold = 0.0f, float temperature = 1.0f);
+
+        void set_topk(uint32_t topk);
+        void set_threshold(float threshold);
+        void set_temperature(float temperature);
+
+        cls_result_t run_fp16(const uint16_t* logits, int64_t size);
+        cls_result_t run_fp32(const float* logits, int64_t size);
+
+        /* Softmax probabilities of the last run, indexed by class */
+        const float* probabilities() const { return prob.data(); }
+
+    private:
+        uint32_t topk;
+        float threshold;
+        float inv_temperature;
+
+        /* Scratch buffers, grown on first use and reused afterwards */
+        std::vector<float> prob;
+        std::vector<int32_t> order;
+
+        void reserve(int64_t size);
+        cls_result_t select(int64_t size);
+};
+
+#endif
@@ -39,6 +39,9 @@
 #include <cstring>
 #include "MeraDrpRuntimeWrapper.h"
 #include "PreRuntime.h"
+#include "classification_head.h"
+#include "gst_yuv_capture.h"
+#include "yuv_preprocess.h"
 #include "opencv2/core.hpp"
 #include "iostream"
 #include "opencv2/imgproc.hpp"
@@ -85,6 +88,9 @@ MeraDrpRuntimeWrapper runtime;
 /*Threshold value info*/
 #define threshold 0.6
 
+/* Top-5 softmax head, returns -1 below threshold */
+ClassificationHead cls_head(5, threshold);
+
 bool drawing_box  = false;
 
 int slot_id;
@@ -92,7 +98,6 @@ unsigned int out;
 int duration;
 
 std::string score_per = "";
-std::vector<float>floatarr(1);
 std::vector<Rect> boxes;
 Point2f box_start, box_end;
 
@@ -141,45 +146,6 @@ uint32_t get_drpai_start_addr()
     return drpai_data.address;
 }
 
-/*****************************************
- * Function Name     : float16_to_float32
- * Description       : Function by Edgecortex. Cast uint16_t a into float value.
- * Arguments         : a = uint16_t number
- * Return value      : float = float32 number
- ******************************************/
-float float16_to_float32(uint16_t a)
-{
-    return __extendXfYf2__<uint16_t, uint16_t, 10, float, uint32_t, 23>(a);
-}
-/*****************************************
-* Function Name : softmax
-* Description   : Function for Post Processing
-* Arguments     : val[] = array to be computed Softmax
-*                 size = size of array
-* Return value  : -
-******************************************/
-void softmax(float* val, int32_t size)
-{
-    float max_num = -INT_MAX;
-    float sum = 0;
-    int32_t i;
-    for ( i = 0 ; i<size ; i++ )
-    {
-        max_num = std::max(max_num, val[i]);
-    }
-
-    for ( i = 0 ; i<size ; i++ )
-    {
-        val[i]= (float) exp(val[i] - max_num);
-        sum+= val[i];
-    }
-
-    for ( i = 0 ; i<size ; i++ )
-    {
-        val[i]= val[i]/sum;
-    }
-    return;
-}
 /*****************************************
  * Function Name : hwc2chw
  * Description   : This function takes an input image in HWC (height, width, channels)
@@ -199,36 +165,17 @@ cv::Mat hwc2chw(const cv::Mat &image)
     return flat_image;
 }
 /*****************************************
- * Function Name : run_inference
- * Description   : frame preprocessing and postprocessing.
- * Arguments     : Mat frame
+ * Function Name : run_model
+ * Description   : passes the pre-processed input through the model runtime and postprocessing.
+ * Arguments     : temp_input = RGB CHW FP32 model input
+ *                 t1 = start time of the pre-processing
  * Return value  : int 0 - 8 succeeded
  *                  otherwise  -1
  ******************************************/
-int run_inference(Mat frame)
-{   
-    float *output;
-    int max_ind     = -1;
-    float max_value = -1;
-    std::map<float,int> result;
-    int result_cnt = 0;
-    auto t1 = std::chrono::high_resolution_clock::now();
-    /* pre processing the input frame */
-    cv::Size size(MODEL_IN_H, MODEL_IN_W);
-    /*resize the image to the model input size*/
-    cv::resize(frame, frame, size);
-    /*convert to FP32*/
-    frame.convertTo(frame, CV_32FC3);
-    divide(frame, 255.0, frame);
-    cv::cvtColor(frame, frame, cv::COLOR_BGR2RGB);
-    frame = hwc2chw(frame);
-    /* deep copy, if not continuous */
-    if (!frame.isContinuous())
-        frame = frame.clone();
-    result.clear();
-    float *temp_input = frame.ptr<float>();
+int run_model(float *temp_input, std::chrono::high_resolution_clock::time_point t1)
+{
     /*start inference using drp runtime*/
-    if ((frame.ptr<float>()) != 0)
+    if (temp_input != 0)
     {
         /*Set Pre-processing output to be inference input. */
         runtime.SetInput(0, temp_input);
@@ -243,8 +190,6 @@ int run_inference(Mat frame)
         /* get output buffer */
         auto output_buffer = runtime.GetOutput(0);
         int64_t out_size = std::get<2>(output_buffer);
-        floatarr.resize(out_size);
-        
 
          /* Post-processing for FP16 */
         if(InOutDataType::FLOAT16 == std::get<0>(output_buffer))
@@ -252,39 +197,23 @@ int run_inference(Mat frame)
             std::cout << "[INFO] FLOAT16 Datatype\n";
             /* Extract data in FP16 <uint16_t>. */
             uint16_t *data_ptr = reinterpret_cast<uint16_t *>(std::get<1>(output_buffer));
-            for (int n = 0; n < out_size; n++)
-            { 
-                /* Cast FP16 output data to FP32. */
-                floatarr[n]= float16_to_float32(data_ptr[n]);
-                softmax(floatarr.data(),out_size);
-                result[floatarr[n]] = n;
-                if (floatarr[n] > max_value)
-                {
-                     max_value = floatarr[n];
-                     max_ind = n;
-                }
-            }
+            cls_result_t result = cls_head.run_fp16(data_ptr, out_size);
             auto t2 = std::chrono::high_resolution_clock::now();
             duration = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
             std::cout<<"\n[INFO] AI-Inference Time(ms): "<<duration<<" ms\n";
-            
-            float score = floor(((max_value)*100)*100)/100;
-            score_per = std::to_string(score);
+
              /* Print Top-5 results. */
              std::cout << "\n[INFO] Result -----------------------"<< std::endl;
-            for (auto it = result.rbegin(); it != result.rend(); it++)
+            for (uint32_t i = 0; i < result.count; i++)
             {
-                result_cnt++;
-                if(result_cnt > 5) break;
-                float re_fl = (float)(*it).first*100;
-                re_fl = std::round(re_fl);
-                std::cout << "Top "<< result_cnt << " ["
+                float re_fl = std::round(result.top[i].prob*100);
+                std::cout << "Top "<< i+1 << " ["
                     << std::right << std::setw(5) << std::fixed << std::setprecision(1) << re_fl
-                    <<"% ] : [" << class_names[(*it).second] << "]" <<std::endl;
-                if(result_cnt == 1)score_per = std::to_string(re_fl);
+                    <<"% ] : [" << class_names[result.top[i].index] << "]" <<std::endl;
+                if(i == 0)score_per = std::to_string(re_fl);
             }
             score_per.erase(5);
-            return (max_value > threshold) ? max_ind : -1;  
+            return result.best;
         }
     }
     else
@@ -295,6 +224,54 @@ int run_inference(Mat frame)
     return 0;
 }
 
+/*****************************************
+ * Function Name : run_inference
+ * Description   : frame preprocessing and postprocessing.
+ * Arguments     : Mat frame
+ * Return value  : int 0 - 8 succeeded
+ *                  otherwise  -1
+ ******************************************/
+int run_inference(Mat frame)
+{   
+    auto t1 = std::chrono::high_resolution_clock::now();
+    /* pre processing the input frame */
+    cv::Size size(MODEL_IN_H, MODEL_IN_W);
+    /*resize the image to the model input size*/
+    cv::resize(frame, frame, size);
+    /*convert to FP32*/
+    frame.convertTo(frame, CV_32FC3);
+    divide(frame, 255.0, frame);
+    cv::cvtColor(frame, frame, cv::COLOR_BGR2RGB);
+    frame = hwc2chw(frame);
+    /* deep copy, if not continuous */
+    if (!frame.isContinuous())
+        frame = frame.clone();
+    return run_model(frame.ptr<float>(), t1);
+}
+
+/*****************************************
+ * Function Name : run_inference_yuv
+ * Description   : preprocessing of the selected area straight from the camera YUV buffer, and postprocessing.
+ * Arguments     : image = camera image
+ *                 roi = selected area, the whole image if empty
+ * Return value  : int 0 - 8 succeeded
+ *                  otherwise  -1
+ ******************************************/
+int run_inference_yuv(const yuv_image_t& image, const cv::Rect& roi)
+{
+    /* Same input as run_inference: RGB CHW, 0-1 */
+    static std::vector<float> input(MODEL_IN_W * MODEL_IN_H * MODEL_IN_C);
+    yuv_preproc_param_t param = { MODEL_IN_W, MODEL_IN_H, true, true, 1.0f / 255.0f,
+                                  roi.x, roi.y, roi.width, roi.height };
+    auto t1 = std::chrono::high_resolution_clock::now();
+    if (0 != yuv_preprocess(image, param, input.data()))
+    {
+        fprintf(stderr, "[ERROR] Failed to pre-process the camera image.\n");
+        return -1;
+    }
+    return run_model(input.data(), t1);
+}
+
 /*****************************************
  * Function Name : classification
  * Description   : frame preprocessing and postprocessing.
@@ -536,6 +513,67 @@ void capture_frame(std::string cap_pipeline)
     destroyAllWindows();
     return;
 }
+
+/*****************************************
+ * Function Name : capture_camera
+ * Description   : captures the camera in YUYV without videoconvert, the selected area is pre-processed from the
+ *                 camera buffer and the frame is converted to BGR for the display only
+ * Arguments     : source = GStreamer camera source
+ * Return value  : 0 if the camera was captured
+ *                 not 0 if the camera does not give YUYV
+ ******************************************/
+int8_t capture_camera(const std::string& source)
+{
+    int8_t wait_key;
+    GstYuvCapture capture;
+    yuv_image_t image;
+    if (0 != capture.open(source, YUV_FORMAT_YUYV, FRAME_IN_W, FRAME_IN_H))
+    {
+        return -1;
+    }
+    /* getting only first frame to draw the box */
+    for (int i = 0; i < 6; i++)
+    {
+        if (0 != capture.read(image))
+        {
+            std::cout << "[ERROR] Error opening video stream or camera \n";
+            capture.close();
+            return 0;
+        }
+    }
+    yuv_to_bgr(image, img);
+    std::cout << "[INFO] Draw rectangle !!!\n";
+    draw_rectangle();
+    /* The area drawn on the display frame, which has the camera size */
+    cv::Rect roi;
+    if (!boxes.empty())
+    {
+        roi = boxes[0] & cv::Rect(0, 0, image.width, image.height);
+    }
+    /* Taking an everlasting loop to show the video */
+    while (1)
+    {
+        if (0 != capture.read(image))
+        {
+            std::cout << "[INFO] Video ended or corrupted frame !\n";
+            break;
+        }
+        out = run_inference_yuv(image, roi);
+        yuv_to_bgr(image, frame);
+        classification(out);
+        int64_t FPS = 1000/duration;
+        std::cout<<"\nFPS: "<<FPS<<endl;
+        cv::putText(frame, "FPS: "+std::to_string(FPS), cv::Point(553, 20), cv::FONT_HERSHEY_SIMPLEX, 0.7, BLUE, 2);
+        cv::rectangle(frame, roi, BLUE, 2);
+        cv::imshow("output", frame);
+        wait_key = waitKey(1);
+        if(wait_key == 27)
+            break;
+    }
+    capture.close();
+    destroyAllWindows();
+    return 0;
+}
 int main(int argc, char **argv)
 {
     /* Model Binary */
@@ -590,8 +628,12 @@ int main(int argc, char **argv)
             std::string gstreamer_pipeline = "v4l2src device=/dev/video0 ! videoconvert ! appsink";
             /* MIPI Camera Setup */
             mipi_cam_init();
-            /* Open camera and capture frame*/
-            capture_frame(gstreamer_pipeline);
+            /* Open camera and capture frame, in YUYV if the camera gives it */
+            if (0 != capture_camera("v4l2src device=/dev/video0"))
+            {
+                fprintf(stderr, "[WARNING] YUYV capture not available, using videoconvert.\n");
+                capture_frame(gstreamer_pipeline);
+            }
         }
         break;
     /* Input Source : Image */
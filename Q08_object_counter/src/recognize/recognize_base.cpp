@@ -73,6 +73,8 @@ RecognizeBase::RecognizeBase()
     _pthread_ai_inf = 0;
     _pthread_capture = 0;
     _pthread_framerate = 0;
+    _pthread_preprocess = 0;
+    _pthread_postprocess = 0;
 }
 
 /*****************************************
@@ -103,6 +105,13 @@ uint32_t RecognizeBase::get_drpai_start_addr()
     return drpai_data.address;
 }
 
+/* Names of the pipeline stages in the measurement log */
+static const char *pipeline_stage_names[PIPELINE_STAGE_NUM] =
+    {
+        "Pipeline pre-process",
+        "Pipeline inference",
+        "Pipeline post-process"};
+
 /**
  * @brief print_measure_log
  * @details Print measurement log to console
@@ -185,6 +194,9 @@ int32_t RecognizeBase::recognize_start()
     }
     wake_ = false;
     capture_enabled.store(true);
+    /* thread affinity and scheduling of config.ini */
+    _model->thread_sched.print();
+    _model->thread_sched.lock_memory();
     /* capture thread */
     _capture_running = true;
     int32_t create_thread_cap = pthread_create(&_pthread_capture, NULL, capture_thread, this);
@@ -193,6 +205,7 @@ int32_t RecognizeBase::recognize_start()
         fprintf(stderr, "[ERROR] Failed to create Capture Thread.\n");
         return -1;
     }
+    _model->thread_sched.apply(_pthread_capture, "capture");
 #ifdef INFERENE_ON
     /* inference thread */
     _inf_running = true;
@@ -206,6 +219,7 @@ int32_t RecognizeBase::recognize_start()
         fprintf(stderr, "[ERROR] Failed to create AI Inference Thread.\n");
         return -1;
     }
+    _model->thread_sched.apply(_pthread_ai_inf, "inference");
 #endif // INFERENE_ON
     /* framerate thread */
     _fps_runnning = true;
@@ -215,11 +229,15 @@ int32_t RecognizeBase::recognize_start()
         fprintf(stderr, "[ERROR] Failed to create Framerate Thread.\n");
         return -1;
     }
+    _model->thread_sched.apply(_pthread_framerate, "framerate");
     output_writer = cv::VideoWriter(g_pipeline, cv::CAP_GSTREAMER,
                                     cv::VideoWriter::fourcc('H', '2', '6', '4'), 1, 
                                     cv::Size(DISP_OUTPUT_WIDTH, DISP_OUTPUT_HEIGHT), true);
     /* creates quit key thread*/
-    pthread_create(&_pthread_quit_key, NULL, &get_quit_key, this);
+    if (0 == pthread_create(&_pthread_quit_key, NULL, &get_quit_key, this))
+    {
+        _model->thread_sched.apply(_pthread_quit_key, "key");
+    }
     /* detach quit key thread from all other thread*/
     pthread_detach(_pthread_quit_key);
     start_recognize();
@@ -367,23 +385,14 @@ void *RecognizeBase::tvm_inference_thread(void *arg)
     int8_t ret = 0;
     /* Time Measure variables */
     timespec start_time, end_time;
+    timespec stage_start_time;
     float ai_time = 0;
-    float get_time = 0;
-    float preproc_time = 0;
     /* DRP-AI TVM[*1] Runtime object */
     MeraDrpRuntimeWrapper runtime;
-    /*Pre-processing output buffer pointer (DRP-AI TVM[*1] input data)*/
-    float *pre_output_ptr;
-    uint32_t out_size;
-    float *pre_output_ptr_2;
-    uint32_t out_size_2;
     /*Inference Variables*/
     int32_t inf_cnt = -1;
     /*Counter for inference output buffer*/
     uint32_t size_count = 0;
-    /*Inference output buffer*/
-    shared_ptr<float> drpai_output_buf;
-    recognizeData_t data;
     InOutDataType input_data_type;
     InOutDataType input_data_type_2;
     /* object names string stream*/
@@ -459,45 +468,60 @@ void *RecognizeBase::tvm_inference_thread(void *arg)
     }
     /*DRP-AI TVM[*1]::Get input data type*/
     input_data_type = runtime.GetInputDataType(0);
+    /*Input data type can be either FLOAT32 or FLOAT16, which depends on the model */
+    if (InOutDataType::FLOAT32 != input_data_type)
+    {
+        std::cerr << "[ERROR] Input data type : not FP32." << std::endl;
+        me->capture_enabled.store(true);
+        return 0;
+    }
+    /*Frames in flight between the pre-process, inference and post-process stages*/
+    me->_pipeline.init(std::min(std::max(1, me->_model->pipeline_depth), PIPELINE_MAX_DEPTH), me->_outBuffSize);
+    std::cout << "[INFO] Pipeline depth : " << me->_pipeline.get_depth() << std::endl;
+    if (0 != pthread_create(&me->_pthread_preprocess, NULL, preprocess_thread, me))
+    {
+        fprintf(stderr, "[ERROR] Failed to create Pre-process Thread.\n");
+        me->_pthread_preprocess = 0;
+        me->_pipeline.close_all();
+    }
+    else
+    {
+        me->_model->thread_sched.apply(me->_pthread_preprocess, "preprocess");
+    }
+    if (0 != pthread_create(&me->_pthread_postprocess, NULL, postprocess_thread, me))
+    {
+        fprintf(stderr, "[ERROR] Failed to create Post-process Thread.\n");
+        me->_pthread_postprocess = 0;
+        me->_pipeline.close_all();
+    }
+    else
+    {
+        me->_model->thread_sched.apply(me->_pthread_postprocess, "postprocess");
+    }
     /*Inference Loop Start*/
-    while (me->_inf_running)
+    while (true)
     {
-        std::cout << "[inf_thread] waiting for inference start..." << std::endl;
-        /*Checks if image frame from _capture Thread is ready.*/
-        {
-            Measuretime m("Inference start wait time");
-            unique_lock<mutex> lock(me->mtx_);
-            me->cv_.wait(lock, [me]
-                         { return me->wake_; });
-            me->wake_ = false;
-        }
-        /*Pre-process*/
-        me->init_time = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
-        me->get_time(start_time);
-        me->inference_preprocess(arg, me->mode, me->cap_w, me->cap_h, &pre_output_ptr, &out_size);
-        me->get_time(end_time);
-        preproc_time = (float)((me->timedifference_msec(start_time, end_time)));
-        print_measure_log("AI preprocess Time", preproc_time, "ms");
-        /*Input data type can be either FLOAT32 or FLOAT16, which depends on the model */
-        /*For DeepPose, Input=FP32*/
-        if (InOutDataType::FLOAT32 == input_data_type)
-        {
-            /*DRP-AI TVM[*1]::Set input data to DRP-AI TVM[*1]*/
-            runtime.SetInput(0, pre_output_ptr);
-        }
-        else
+        /*Waits for the next pre-processed frame*/
+        PipelineSlot *slot = me->_pipeline.get(PIPELINE_INFERENCE);
+        if (NULL == slot)
         {
-            std::cerr << "[ERROR] Input data type : not FP32." << std::endl;
             break;
         }
+        me->get_time(stage_start_time);
+        /*DRP-AI TVM[*1]::Set input data to DRP-AI TVM[*1]*/
+        runtime.SetInput(0, slot->input.data());
         /**DRP-AI TVM[*1]::Start Inference*/
         errno = 0;
         inf_cnt++;
         printf("Inference ----------- No. %d\n", (inf_cnt + 1));
         /*Gets inference starting time*/
         me->get_time(start_time);
-        /*DRP-AI TVM[*1]::Run inference*/
-        runtime.Run();
+        {
+            /*DRP-AI is shared with the pre-processing of the next frame*/
+            lock_guard<mutex> lock(me->drpai_mtx_);
+            /*DRP-AI TVM[*1]::Run inference*/
+            runtime.Run();
+        }
         /*Gets AI Inference End Time*/
         me->get_time(end_time);
         /*Inference End Time */
@@ -506,7 +530,8 @@ void *RecognizeBase::tvm_inference_thread(void *arg)
         /*Process to read the DRP-AI output data.*/
         /* DRP-AI TVM[*1]::Get the number of output of the target model. For DeepPose, 1 output. */
         auto output_num = runtime.GetNumOutput();
-        drpai_output_buf.reset(new float[me->_outBuffSize], std::default_delete<float[]>());
+        /*Inference output buffer of this frame*/
+        float *drpai_output_buf = slot->output.get();
         size_count = 0;
         /*GetOutput loop*/
         for (int i = 0; i < output_num; i++)
@@ -523,7 +548,7 @@ void *RecognizeBase::tvm_inference_thread(void *arg)
                 for (int j = 0; j < output_size; j++)
                 {
                     /*FP16 to FP32 conversion*/
-                    drpai_output_buf.get()[j + size_count] = float16_to_float32(data_ptr[j]);
+                    drpai_output_buf[j + size_count] = float16_to_float32(data_ptr[j]);
                 }
             }
             else if (InOutDataType::FLOAT32 == std::get<0>(output_buffer))
@@ -532,7 +557,7 @@ void *RecognizeBase::tvm_inference_thread(void *arg)
                 float *data_ptr = reinterpret_cast<float *>(std::get<1>(output_buffer));
                 for (int j = 0; j < output_size; j++)
                 {
-                    drpai_output_buf.get()[j + size_count] = data_ptr[j];
+                    drpai_output_buf[j + size_count] = data_ptr[j];
                 }
             }
             else
@@ -548,17 +573,84 @@ void *RecognizeBase::tvm_inference_thread(void *arg)
         {
             break;
         }
-        /*Fill AI Inference result structure*/
-        data.predict_image = me->input_data;
-        data.predict_result = move(drpai_output_buf);
-        data.inf_time_ms = ai_time;
-        data.preproc_time_ms = preproc_time;
-        /*Post-process start (AI inference result postprocess + image compress + JSON data sending)*/
-        me->inference_postprocess(arg, me->mode, data);
+        slot->inf_time_ms = ai_time;
+        me->get_time(end_time);
+        me->_pipeline.add_time(PIPELINE_INFERENCE, (float)me->timedifference_msec(stage_start_time, end_time));
+        /*Hand the frame over to the post-process stage*/
+        me->_pipeline.put(PIPELINE_INFERENCE, slot);
+    }
+    /*End of Inference Loop*/
+    /*Post-process stage ends after the frames in flight, pre-process stage ends when the loop ended on an error*/
+    me->_pipeline.close(PIPELINE_POST);
+    me->_pipeline.close(PIPELINE_PRE);
+    if (0 != me->_pthread_preprocess && 0 != me->wait_join(&me->_pthread_preprocess, AI_THREAD_TIMEOUT))
+    {
+        fprintf(stderr, "[ERROR] Failed to exit Pre-process Thread on time.\n");
+    }
+    if (0 != me->_pthread_postprocess && 0 != me->wait_join(&me->_pthread_postprocess, AI_THREAD_TIMEOUT))
+    {
+        fprintf(stderr, "[ERROR] Failed to exit Post-process Thread on time.\n");
+    }
+    /*To terminate the loop in _capture Thread.*/
+    me->capture_enabled.store(true);
+    cout << "<<<<<<<<<<<<<<<<<<<<< AI Inference Thread Terminated >>>>>>>>>>>>>>>>>>" << endl;
+    pthread_exit(NULL);
+    me->_pthread_ai_inf = 0;
+    return NULL;
+}
+
+/**
+ * @brief preprocess_thread
+ * @details Pre-process stage of the inference pipeline: converts the camera frame for display and
+ * @details pre-processes it into a free slot, then gives the camera buffer back to the _capture Thread.
+ * @param arg pointer to itself
+ * @return void*
+ */
+void *RecognizeBase::preprocess_thread(void *arg)
+{
+    RecognizeBase *me = (RecognizeBase *)arg;
+    shared_ptr<Camera> capture = me->_capture;
+    int8_t ret = 0;
+    /* Time Measure variables */
+    timespec start_time, end_time;
+    /*Pre-processing output buffer pointer (DRP-AI TVM[*1] input data)*/
+    float *pre_output_ptr;
+    uint32_t out_size;
+
+    printf("Pre-process Thread Starting\n");
+    while (me->_inf_running)
+    {
+        /*Waits for a free slot, at most pipeline depth frames are in flight*/
+        PipelineSlot *slot = me->_pipeline.get(PIPELINE_PRE);
+        if (NULL == slot)
         {
-            /*Image compress + JSON data sending*/
-            me->send_result(arg, me->mode, data);
+            break;
+        }
+        /*A slot is free, the _capture Thread hands over its next frame*/
+        me->capture_enabled.store(true); /* Flag for _capture Thread. */
+        std::cout << "[pre_thread] waiting for inference start..." << std::endl;
+        /*Checks if image frame from _capture Thread is ready.*/
+        {
+            Measuretime m("Inference start wait time");
+            unique_lock<mutex> lock(me->mtx_);
+            me->cv_.wait(lock, [me]
+                         { return me->wake_; });
+            me->wake_ = false;
+        }
+        if (!me->_inf_running)
+        {
+            break;
         }
+        /*Pre-process*/
+        slot->start_ms = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+        me->get_time(start_time);
+        me->inference_preprocess(arg, me->mode, me->cap_w, me->cap_h, &pre_output_ptr, &out_size, slot->image);
+        /*The pre-processing runtime output buffer is reused for the next frame*/
+        slot->input.assign(pre_output_ptr, pre_output_ptr + out_size);
+        me->get_time(end_time);
+        slot->preproc_time_ms = (float)((me->timedifference_msec(start_time, end_time)));
+        print_measure_log("AI preprocess Time", slot->preproc_time_ms, "ms");
+        /*The frame is copied to the slot, give the camera buffer back*/
         Measuretime m("Deque inference_capture_qbuf buf time");
         ret = capture->inference_capture_qbuf();
         if (0 != ret)
@@ -566,15 +658,64 @@ void *RecognizeBase::tvm_inference_thread(void *arg)
             fprintf(stderr, "[ERROR] Failed to enqueue _capture buffer.\n");
             break;
         }
+        me->_pipeline.add_time(PIPELINE_PRE, slot->preproc_time_ms);
+        /*Hand the frame over to the inference stage*/
+        me->_pipeline.put(PIPELINE_PRE, slot);
+    }
+    /*Inference stage ends after the frames in flight*/
+    me->_pipeline.close(PIPELINE_INFERENCE);
+    cout << "<<<<<<<<<<<<<<<<<<<<< Pre-process Thread Terminated >>>>>>>>>>>>>>>>>>" << endl;
+    pthread_exit(NULL);
+    me->_pthread_preprocess = 0;
+    return NULL;
+}
+/**
+ * @brief postprocess_thread
+ * @details Post-process stage of the inference pipeline: decodes the DRP-AI output of a slot,
+ * @details draws and displays the frame, then gives the slot back to the pre-process stage.
+ * @param arg pointer to itself
+ * @return void*
+ */
+void *RecognizeBase::postprocess_thread(void *arg)
+{
+    RecognizeBase *me = (RecognizeBase *)arg;
+    /* Time Measure variables */
+    timespec start_time, end_time;
+    recognizeData_t data;
+    printf("Post-process Thread Starting\n");
+    while (true)
+    {
+        /*Waits for the next frame out of DRP-AI*/
+        PipelineSlot *slot = me->_pipeline.get(PIPELINE_POST);
+        if (NULL == slot)
+        {
+            break;
+        }
+        me->get_time(start_time);
+        /*Frame to draw and display*/
+        me->g_bgra_image = slot->image;
+        /*Inference time on the display is measured from the pre-process start of this frame*/
+        me->init_time = slot->start_ms;
+        /*Fill AI Inference result structure*/
+        data.predict_image = slot->image.data;
+        data.predict_result = slot->output;
+        data.inf_time_ms = slot->inf_time_ms;
+        data.preproc_time_ms = slot->preproc_time_ms;
+        /*Post-process start (AI inference result postprocess + image compress + JSON data sending)*/
+        me->inference_postprocess(arg, me->mode, data);
+        {
+            /*Image compress + JSON data sending*/
+            me->send_result(arg, me->mode, data);
+        }
+        me->get_time(end_time);
+        me->_pipeline.add_time(PIPELINE_POST, (float)me->timedifference_msec(start_time, end_time));
         me->_ai_frame_count.store(me->_ai_frame_count.load() + 1);
-        me->capture_enabled.store(true); /* Flag for _capture Thread. */
+        /*Slot is free for the next frame*/
+        me->_pipeline.put(PIPELINE_POST, slot);
     }
-    /*End of Inference Loop*/
-    /*To terminate the loop in _capture Thread.*/
-    me->capture_enabled.store(true);
-    cout << "<<<<<<<<<<<<<<<<<<<<< AI Inference Thread Terminated >>>>>>>>>>>>>>>>>>" << endl;
+    cout << "<<<<<<<<<<<<<<<<<<<<< Post-process Thread Terminated >>>>>>>>>>>>>>>>>>" << endl;
     pthread_exit(NULL);
-    me->_pthread_ai_inf = 0;
+    me->_pthread_postprocess = 0;
     return NULL;
 }
 /**
@@ -597,6 +738,13 @@ void *RecognizeBase::framerate_thread(void *arg)
         int32_t cam_count = me->_camera_frame_count.load();
         me->_camera_frame_count.store(0);
         print_measure_log("------------------------------>Camera FPS", cam_count, "fps");
+        /* Average time of each pipeline stage*/
+        for (int32_t i = 0; i < PIPELINE_STAGE_NUM; i++)
+        {
+            float avg_ms = 0;
+            int32_t frames = me->_pipeline.take_stats((PipelineStage)i, avg_ms);
+            printf("[MeasLog],%s, %.1f, [ms], %d frames\n", pipeline_stage_names[i], avg_ms, frames);
+        }
         /* CPU usage*/
         string cpuUsage = me->_analyzer.get_cpu_usage(2);
         print_measure_log("CPU Usage", cpuUsage);
@@ -618,9 +766,10 @@ void *RecognizeBase::framerate_thread(void *arg)
  * @param height new height of input data.
  * @param out_ptr pre-processing result data
  * @param out_size size of out_ptr
+ * @param bgr_image BGR frame for display
  */
 void RecognizeBase::inference_preprocess(void *arg, uint8_t model_id, uint32_t width, uint32_t height, 
-                                            float **out_ptr, uint32_t *out_size)
+                                            float **out_ptr, uint32_t *out_size, cv::Mat &bgr_image)
 {
     timespec start_time;
     timespec end_time;
@@ -628,7 +777,9 @@ void RecognizeBase::inference_preprocess(void *arg, uint8_t model_id, uint32_t w
     Measuretime m("Pre process time");
     cv::Mat yuyv_image(height, width, CV_8UC2, (void *)me->input_data);
     /*convert yuv format to bgr*/
-    cv::cvtColor(yuyv_image, g_bgra_image, cv::COLOR_YUV2BGR_YUYV);
+    cv::cvtColor(yuyv_image, bgr_image, cv::COLOR_YUV2BGR_YUYV);
+    /*DRP-AI is shared with the inference of the previous frame*/
+    lock_guard<mutex> lock(me->drpai_mtx_);
     _model->inf_pre_process(me->input_data, width, height, me->capture_address, out_ptr, out_size);
 }
 /**
@@ -874,6 +1025,8 @@ int32_t RecognizeBase::end_all_threads()
     _capture_running = false;
     _inf_running = false;
     _fps_runnning = false;
+    /*wake the pipeline stages waiting for a frame*/
+    _pipeline.close_all();
     if (0 != _pthread_capture)
     {
         ret = wait_join(&_pthread_capture, CAPTURE_TIMEOUT);
@@ -1021,8 +1174,11 @@ void RecognizeBase::start_recognize()
 void RecognizeBase::predict_thread()
 {
     blRunPredict = true;
-    pthread_create(&thPredict, NULL, &predict_thread_wrapper, this);
-    pthread_join(thPredict, NULL);
+    if (0 == pthread_create(&thPredict, NULL, &predict_thread_wrapper, this))
+    {
+        _model->thread_sched.apply(thPredict, "display");
+        pthread_join(thPredict, NULL);
+    }
 }
 /**
  * @brief thread wrapper
@@ -62,6 +62,7 @@
 #include "../util/MeraDrpRuntimeWrapper.h"
 #include "irecognize_model.h"
 #include "recognize_data.h"
+#include "inference_pipeline.h"
 #include "../command/object_detection.h"
 #include "opencv2/core.hpp"
 #include "opencv2/imgproc.hpp"
@@ -156,9 +157,11 @@ private:
 private:
     static void *capture_thread(void *arg);
     static void *tvm_inference_thread(void *arg);
+    static void *preprocess_thread(void *arg);
+    static void *postprocess_thread(void *arg);
     static void *framerate_thread(void *arg);
     void inference_preprocess(void *arg, uint8_t model_id, uint32_t width, uint32_t height, 
-                                float **out_ptr, uint32_t *out_size);
+                                float **out_ptr, uint32_t *out_size, cv::Mat &bgr_image);
     void inference_postprocess(void *arg, uint8_t model_id, recognizeData_t &data);
     void send_result(void *arg, uint8_t model_id, recognizeData_t &data);
     int32_t end_all_threads();
@@ -175,6 +178,8 @@ private:
     pthread_t _pthread_ai_inf;
     pthread_t _pthread_capture;
     pthread_t _pthread_framerate;
+    pthread_t _pthread_preprocess;
+    pthread_t _pthread_postprocess;
 
     /* variants */
     shared_ptr<Camera> _capture;
@@ -193,6 +198,11 @@ private:
     condition_variable cv_;
     bool wake_;
 
+    /* frames in flight between the pre-process, inference and post-process stages */
+    InferencePipeline _pipeline;
+    /* DRP-AI runs one job at a time, pre-processing runtime or DRP-AI TVM */
+    mutex drpai_mtx_;
+
     /* for capture */
     volatile uint32_t capture_address;
     uint8_t *input_data;
@@ -81,6 +81,11 @@ TVM_YOLO_DRPAI::TVM_YOLO_DRPAI(uint8_t id, std::unordered_map<std::string,
     conf = std::stof(config_values["detect"]["conf"]);
     get_anchor = config_values["detect"]["anchors"];
     detection_object_string = config_values["detect"]["objects"];
+    /*overlapped pre-process/inference/post-process, optional key*/
+    if (config_values["pipeline"].count("depth"))
+        pipeline_depth = stoi(config_values["pipeline"]["depth"]);
+    /*thread affinity and scheduling, optional section*/
+    thread_sched.read(config_values["thread"]);
     
     stringstream detection_anchor_ss(get_anchor);
     std::string anch_value;
@@ -56,11 +56,15 @@
 /*box drawing*/
 #include "box.h"
 #include "utils.h"
+/*Blocking hand-off between threads*/
+#include "stage_graph.h"
+#include "thread_sched.h"
 
 
 
 /*Multithreading*/
 static sem_t terminate_req_sem;
+static StageGraph stages(&terminate_req_sem);
 static pthread_t ai_inf_thread;
 static pthread_t capture_thread;
 static pthread_t exit_thread;
@@ -68,8 +72,8 @@ static pthread_t kbhit_thread;
 static std::mutex mtx;
 
 /*Flags*/
-static std::atomic<uint8_t> inference_start (0);
-static std::atomic<uint8_t> img_obj_ready   (0);
+static StageEvent inference_start (stages, "inference_start");
+static StageEvent img_obj_ready   (stages, "img_obj_ready");
 
 /*Global Variables*/
 float * drpai_output_buf;
@@ -87,6 +91,7 @@ static std::vector<detection> det;
 cv::Mat yuyv_image;
 cv::Mat input_image;
 std::unordered_map<std::string, std::string> ini_values;
+static ThreadSchedConfig thread_sched;
 std::vector<double> anchors;
 bool doubleClick = false;
 static int32_t drpai_freq;
@@ -512,7 +517,7 @@ void *R_exit_Thread(void *threadid)
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto exit_end;
 
 exit_end:
@@ -568,12 +573,11 @@ void *R_Inf_Thread(void *threadid)
             {
                 goto ai_inf_end;
             }
-            /*Checks if image frame from Capture Thread is ready.*/
-            if (inference_start.load())
+            /*Blocks until image frame from Capture Thread is ready or termination is requested.*/
+            if (inference_start.wait_set())
             {
                 break;
             }
-            usleep(WAIT_TIME);
         }
 
         /*Gets Pre-process starting time*/
@@ -659,7 +663,7 @@ void *R_Inf_Thread(void *threadid)
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto ai_inf_end;
 /*AI Thread Termination*/
 ai_inf_end:
@@ -739,7 +743,7 @@ void *R_Capture_Thread(void *cap_pipeline)
 
 /*Error Processing*/
 err:
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto capture_end;
 
 capture_end:
@@ -959,13 +963,13 @@ int8_t R_Main_Process()
             img_obj_ready.store(0);
         }
  
-        /*Wait for 1 TICK.*/
-        usleep(WAIT_TIME);
+        /*Wait for the next frame from Capture Thread.*/
+        img_obj_ready.wait_set();
     }
 
 /*Error Processing*/
 err:
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     main_ret = 1;
     goto main_proc_end;
 /*Main Processing Termination*/
@@ -1117,6 +1121,11 @@ void *R_Kbhit_Thread(void *threadid)
             goto key_hit_end;
         }
 
+        /* Blocks until a key is pressed or termination is requested. */
+        if (!stages.wait_readable(STDIN_FILENO))
+        {
+            continue;
+        }
         c = getchar();
         if (EOF != c)
         {
@@ -1124,17 +1133,17 @@ void *R_Kbhit_Thread(void *threadid)
             printf("key Detected.\n");
             goto err;
         }
-        else
+        else if (feof(stdin))
         {
-            /* When nothing is pressed. */
-            usleep(WAIT_TIME);
+            /* Standard input is closed, only termination ends the thread. */
+            stages.wait_shutdown();
         }
     }
 
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto key_hit_end;
 
 key_hit_end:
@@ -1303,6 +1312,18 @@ int32_t main(int32_t argc, char * argv[])
         ret_main = -1;
         goto end_threads;
     }
+
+    /*Stages and the events they hand over*/
+    stages.add_stage("capture", {}, {&inference_start, &img_obj_ready});
+    stages.add_stage("inference", {&inference_start}, {});
+    stages.add_stage("main", {&img_obj_ready}, {});
+    stages.print();
+
+    /*Thread affinity and scheduling of config.ini*/
+    thread_sched.read(config_read(ini_values["config_path"])["thread"]);
+    thread_sched.print();
+    thread_sched.lock_memory();
+
     /*Create exit Thread*/
     create_thread_exit = pthread_create(&exit_thread, NULL, R_exit_Thread, NULL);
     if (0 != create_thread_exit)
@@ -1320,26 +1341,32 @@ int32_t main(int32_t argc, char * argv[])
         ret_main = -1;
         goto end_threads;
     }
+    thread_sched.apply(kbhit_thread, "key");
 
     /*Create Inference Thread*/
     create_thread_ai = pthread_create(&ai_inf_thread, NULL, R_Inf_Thread, NULL);
     if (0 != create_thread_ai)
     {
-        sem_trywait(&terminate_req_sem);
+        stages.shutdown();
         fprintf(stderr, "[ERROR] Failed to create AI Inference Thread.\n");
         ret_main = -1;
         goto end_threads;
     }
+    thread_sched.apply(ai_inf_thread, "inference");
 
     /*Create Capture Thread*/
     create_thread_capture = pthread_create(&capture_thread, NULL, R_Capture_Thread, (void *) &gstreamer_pipeline);
     if (0 != create_thread_capture)
     {
-        sem_trywait(&terminate_req_sem);
+        stages.shutdown();
         fprintf(stderr, "[ERROR] Failed to create Capture Thread.\n");
         ret_main = -1;
         goto end_threads;
     }
+    thread_sched.apply(capture_thread, "capture");
+
+    /*Main Thread last, the threads created above would inherit its settings*/
+    thread_sched.apply(pthread_self(), "main");
 
     /*Main Processing*/
     main_proc = R_Main_Process();
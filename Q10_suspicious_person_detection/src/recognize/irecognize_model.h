@@ -32,6 +32,7 @@
 #include "../includes.h"
 #include "../util/recognize_define.h"
 #include "../util/box.h"
+#include "thread_sched.h"
 
 class IRecognizeModel
 {
@@ -84,6 +85,10 @@ public:
 
     float conf;
     string detection_object_string;
+    /* Frames in flight between the pre-process, inference and post-process stages, 1 runs them in sequence */
+    int32_t pipeline_depth = 1;
+    /* CPU affinity and scheduling of the application threads, [thread] section of config.ini */
+    ThreadSchedConfig thread_sched;
     /* Post-processing result */
     vector<detection> postproc_data;
 };
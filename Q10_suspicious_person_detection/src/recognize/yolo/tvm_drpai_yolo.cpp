@@ -78,6 +78,11 @@ TVM_YOLO_DRPAI::TVM_YOLO_DRPAI(uint8_t id) : IRecognizeModel(0, TVM_MODEL_DIR_YO
     conf = std::stof(ini_values["detect"]["conf"]);
     get_anchor = ini_values["detect"]["anchors"];
     detection_object_string = ini_values["detect"]["objects"];
+    /*overlapped pre-process/inference/post-process, optional key*/
+    if (ini_values["pipeline"].count("depth"))
+        pipeline_depth = stoi(ini_values["pipeline"]["depth"]);
+    /*thread affinity and scheduling, optional section*/
+    thread_sched.read(ini_values["thread"]);
     
     stringstream detection_anchor_ss(get_anchor);
     std::string anch_value;
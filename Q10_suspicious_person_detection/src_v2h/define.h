@@ -79,19 +79,11 @@
 #include "opencv2/core.hpp"
 #include "opencv2/imgproc.hpp"
 #include "opencv2/highgui.hpp"
-#include "wayland.h"
-
-
-static Wayland wayland;
-/* Empty since labels will be loaded from label_list file */
-static std::vector<std::string> label_file_map = {};
 
 /*****************************************
 * Macro for YOLOv3
 ******************************************/
 
-/* Number of class to be detected */
-int32_t NUM_CLASS;
 /* Number for [region] layer num parameter */
 #define NUM_BB                      (3)
 #define NUM_INF_OUT_LAYER           (3)
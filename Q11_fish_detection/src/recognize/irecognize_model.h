@@ -32,6 +32,7 @@
 #include "../includes.h"
 #include "../util/recognize_define.h"
 #include "../util/box.h"
+#include "thread_sched.h"
 
 class IRecognizeModel
 {
@@ -84,6 +85,12 @@ public:
 
     float conf;
     string detection_object_string;
+    /* Run the detector on one frame out of detect_interval, the last result is shown in between */
+    int32_t detect_interval = 1;
+    /* Frames in flight between the pre-process, inference and post-process stages, 1 runs them in sequence */
+    int32_t pipeline_depth = 1;
+    /* CPU affinity and scheduling of the application threads, [thread] section of config.ini */
+    ThreadSchedConfig thread_sched;
     /* Post-processing result */
     vector<detection> postproc_data;
 };
@@ -49,31 +49,31 @@
 /*****************************************
 * Includes
 ******************************************/
-/*DRP-AI TVM[*1] Runtime*/
-#include "MeraDrpRuntimeWrapper.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <sstream>
 /*Definition of Macros & other variables*/
 #include "define.h"
 /*box drawing*/
 #include "box.h"
-/*Double cliick termination*/
-#include "utils.h"
-/*Wayland display*/
-#include "wayland.h"
-
-using INI_FORMAT = std::unordered_map<std::string, std::unordered_map<std::string, std::string>>;
+/*Capture, inference and display threads*/
+#include "pipeline.h"
+#include "multi_pipeline.h"
+#include "pipeline_utils.h"
+#include "v4l2_capture.h"
 
 /*****************************************
 * Global Variables
 ******************************************/
 std::map<std::string, int> input_source_map =
 {
-    {"USB", 1}
+    {"USB", 1},
+    {"VIDEO", 2},
+    {"IMAGES", 3}
 };
 
-static Wayland wayland;
-
 /*Model data*/
-int32_t num_class;
 constexpr static float TH_PROB = 0.5f;
 constexpr static float TH_NMS = 0.5f;
 constexpr static int32_t NUM_BB = 3;
@@ -81,230 +81,44 @@ constexpr static int32_t MODEL_IN_W = 416;
 constexpr static int32_t MODEL_IN_H = 416;
 constexpr static int32_t NUM_INF_OUT_LAYER = 3;
 constexpr static uint8_t num_grids[] = { 13, 26, 52 };
-static uint32_t INF_OUT_SIZE;
-static std::vector<std::string> label_file_map = {};
-
-/*Multithreading*/
-static sem_t terminate_req_sem;
-static pthread_t ai_inf_thread;
-static pthread_t exit_thread;
-static pthread_t capture_thread;
-static pthread_t kbhit_thread;
-static std::mutex mtx;
-
-/*Flags*/
-static std::atomic<uint8_t> inference_start (0);
-static std::atomic<uint8_t> img_obj_ready   (0);
-
-/*Global Variables*/
-float* drpai_output_buf;
-static uint64_t udmabuf_address = 0;
-
-/*AI Inference for DRPAI*/
-/* DRP-AI TVM[*1] Runtime object */
-MeraDrpRuntimeWrapper runtime;
-
-static float pre_time = 0;
-static float post_time = 0;
-static float ai_time = 0;
-static float total_time = 0;
-
-static std::vector<detection> det;
-
-cv::Mat yuyv_image;
-cv::Mat input_image;
-INI_FORMAT ini_values;
-std::vector<double> anchors;
-
-bool doubleClick = false;
-
-static int32_t drpai_freq;
-
-/*****************************************
-* Function Name     : float16_to_float32
-* Description       : Function by Edgecortex. Cast uint16_t a into float value.
-* Arguments         : a = uint16_t number
-* Return value      : float = float32 number
-******************************************/
-float float16_to_float32(uint16_t a)
-{
-    return __extendXfYf2__<uint16_t, uint16_t, 10, float, uint32_t, 23>(a);
-}
-
-/*****************************************
-* Function Name : timedifference_msec
-* Description   : compute the time differences in ms between two moments
-* Arguments     : t0 = start time
-*                 t1 = stop time
-* Return value  : the time difference in ms
-******************************************/
-static double timedifference_msec(struct timespec t0, struct timespec t1)
-{
-    return (t1.tv_sec - t0.tv_sec) * 1000.0 + (t1.tv_nsec - t0.tv_nsec) / 1000000.0;
-}
-
-/*****************************************
-* Function Name : wait_join
-* Description   : waits for a fixed amount of time for the thread to exit
-* Arguments     : p_join_thread = thread that the function waits for to Exit
-*                 join_time = the timeout time for the thread for exiting
-* Return value  : 0 if successful
-*                 not 0 otherwise
-******************************************/
-static int8_t wait_join(pthread_t *p_join_thread, uint32_t join_time)
-{
-    int8_t ret_err;
-    struct timespec join_timeout;
-    ret_err = clock_gettime(CLOCK_REALTIME, &join_timeout);
-    if ( 0 == ret_err )
-    {
-        join_timeout.tv_sec += join_time;
-        ret_err = pthread_timedjoin_np(*p_join_thread, NULL, &join_timeout);
-    }
-    return ret_err;
-}
 
 /*****************************************
-* Function Name     : config_read
-* Description       : Read configuration from the config.ini file.
+* Function Name : sigmoid
+* Description   : Helper function for YOLO Post Processing
+* Arguments     : x = input argument for the calculation
+* Return value  : sigmoid result of input x
 ******************************************/
-void config_read()
+static double sigmoid(double x)
 {
-    /*Open config.ini file*/
-    std::ifstream ini_file("config.ini");
-    std::string line;
-    std::string current_section;
-    /*parsing ini file*/
-    while (std::getline(ini_file, line))
-    {
-        std::string::size_type comment_pos = line.find(";");
-        if (comment_pos != std::string::npos)
-        {
-            line.erase(comment_pos);
-        }
-        line.erase(0, line.find_first_not_of(" \t\r\n"));
-        line.erase(line.find_last_not_of(" \t\r\n") + 1);
-        if (line.empty())
-        {
-            continue;
-        }
-        else if (line[0] == '[')
-        {
-            current_section = line.substr(1, line.size() - 2);
-        }
-        else
-        {
-            std::string::size_type delimiter_pos = line.find("=");
-            std::string key = line.substr(0, delimiter_pos);
-            std::string value = line.substr(delimiter_pos + 1);
-            ini_values[current_section][key] = value;
-        }
-    }
-    return ;
+    return 1.0/(1.0 + exp(-x));
 }
 
-/*****************************************
-* Function Name     : load_label_file
-* Description       : Load label list text file and return the label list that contains the label.
-* Arguments         : label_file_name = filename of label list. must be in txt format
-* Return value      : vector<string> list = list contains labels
-*                     empty if error occurred
-******************************************/
-std::vector<std::string> load_label_file(std::string label_file_name)
+/* YOLOv3 decode of the model output, and drawing of the detected fish on the display */
+class FishDetector : public PostProcessor, public Overlay
 {
-    std::vector<std::string> list = {};
-    std::vector<std::string> empty = {};
-    std::ifstream infile(label_file_name);
-
-    if (!infile.is_open())
-    {
-        return list;
-    }
-
-    std::string line = "";
-    while (getline(infile,line))
-    {
-        list.push_back(line);
-        if (infile.fail())
+    public:
+        FishDetector(const std::vector<std::string>& labels, const std::vector<double>& anchors,
+                     const std::set<std::string>& objects, float conf)
+            : label_file_map(labels), anchors(anchors), detection_object_set(objects), conf(conf),
+              num_class((int32_t)labels.size())
         {
-            return empty;
         }
-    }
-
-    return list;
-}
-
-/*****************************************
-* Function Name : get_result
-* Description   : Get DRP-AI Output from memory via DRP-AI Driver
-* Arguments     : drpai_fd = file descriptor of DRP-AI Driver
-*                 output_addr = memory start address of DRP-AI output
-*                 output_size = output data size
-* Return value  : 0 if succeeded
-*                 not 0 otherwise
-******************************************/
-int8_t get_result()
-{
-    int8_t ret = 0;
-    int32_t i = 0;
-    int32_t output_num = 0;
-    std::tuple<InOutDataType, void*, int64_t> output_buffer;
-    int64_t output_size;
-    uint32_t size_count = 0;
 
-    /* Get the number of output of the target model. */
-    output_num = runtime.GetNumOutput();
-    size_count = 0;
-    /*GetOutput loop*/
-    for (i = 0;i<output_num;i++)
-    {
-        /* output_buffer below is tuple, which is { data type, address of output data, number of elements } */
-        output_buffer = runtime.GetOutput(i);
-        /*Output Data Size = std::get<2>(output_buffer). */
-        output_size = std::get<2>(output_buffer);
-
-        /*Output Data Type = std::get<0>(output_buffer)*/
-        if (InOutDataType::FLOAT16 == std::get<0>(output_buffer))
-        {
-            /*Output Data = std::get<1>(output_buffer)*/
-            uint16_t* data_ptr = reinterpret_cast<uint16_t*>(std::get<1>(output_buffer));
-            for (int j = 0; j<output_size; j++)
-            {
-                /*FP16 to FP32 conversion*/
-                drpai_output_buf[j + size_count]=float16_to_float32(data_ptr[j]);
-            }
-        }
-        else if (InOutDataType::FLOAT32 == std::get<0>(output_buffer))
-        {
-            /*Output Data = std::get<1>(output_buffer)*/
-            float* data_ptr = reinterpret_cast<float*>(std::get<1>(output_buffer));
-            for (int j = 0; j<output_size; j++)
-            {
-                drpai_output_buf[j + size_count]=data_ptr[j];
-            }
-        }
-        else
-        {
-            fprintf(stderr, "[ERROR] Output data type : not floating point.\n", errno);
-            ret = -1;
-            break;
-        }
-        size_count += output_size;
-    }
-    return ret;
-}
+        int8_t decode(const float *floatarr, uint32_t size) override;
+        void draw(cv::Mat& frame, const PipelineTimes& times) override;
 
-/*****************************************
-* Function Name : sigmoid
-* Description   : Helper function for YOLO Post Processing
-* Arguments     : x = input argument for the calculation
-* Return value  : sigmoid result of input x
-******************************************/
-double sigmoid(double x)
-{
-    return 1.0/(1.0 + exp(-x));
-}
+    private:
+        int32_t yolo_index(uint8_t n, int32_t offs, int32_t channel);
+        int32_t yolo_offset(uint8_t n, int32_t b, int32_t y, int32_t x);
+        cv::Mat create_output_frame(cv::Mat frame_g);
 
+        std::vector<std::string> label_file_map;
+        std::vector<double> anchors;
+        std::set<std::string> detection_object_set;
+        float conf;
+        int32_t num_class;
+        std::vector<detection> det;
+};
 
 /*****************************************
 * Function Name : yolo_index
@@ -314,7 +128,7 @@ double sigmoid(double x)
 *                 channel = channel to access each bounding box attribute.
 * Return value  : index to access the bounding box attribute.
 ******************************************/
-int32_t yolo_index(uint8_t n, int32_t offs, int32_t channel)
+int32_t FishDetector::yolo_index(uint8_t n, int32_t offs, int32_t channel)
 {
     uint8_t num_grid = num_grids[n];
     return offs + channel * num_grid *  num_grid;
@@ -330,9 +144,8 @@ int32_t yolo_index(uint8_t n, int32_t offs, int32_t channel)
 *                 x = Number to indicate which region [0~13]
 * Return value  : offset to access the bounding box attributes.
 ******************************************/
-int32_t yolo_offset(uint8_t n, int32_t b, int32_t y, int32_t x)
+int32_t FishDetector::yolo_offset(uint8_t n, int32_t b, int32_t y, int32_t x)
 {
- 
     uint8_t num = num_grids[n];
     uint32_t prev_layer_num = 0;
     int32_t i = 0;
@@ -344,39 +157,29 @@ int32_t yolo_offset(uint8_t n, int32_t b, int32_t y, int32_t x)
     return prev_layer_num + b *(num_class + 5)* num * num + y * num + x;
 }
 
-
-/*****************************************
- * Function Name : hwc2chw
- * Description   : This function takes an input image in HWC (height, width, channels)
- *                 format and returns an output image in CHW (channels, height, width) format.
- * Arguments     : image = cv::Mat
- * Return value  : flat_image = cv::Mat
- ******************************************/
-cv::Mat hwc2chw(const cv::Mat &image)
-{
-    std::vector<cv::Mat> rgb_images;
-    cv::split(image, rgb_images);
-    cv::Mat m_flat_r = rgb_images[0].reshape(1, 1);
-    cv::Mat m_flat_g = rgb_images[1].reshape(1, 1);
-    cv::Mat m_flat_b = rgb_images[2].reshape(1, 1);
-    cv::Mat matArray[] = {m_flat_r, m_flat_g, m_flat_b};
-    cv::Mat flat_image;
-    cv::hconcat(matArray, 3, flat_image);
-    return flat_image;
-}
-
-
 /*****************************************
-* Function Name : R_Post_Proc
+* Function Name : decode
 * Description   : Process CPU post-processing for YOLOv3
 * Arguments     : floatarr = drpai output address
-* Return value  : -
+*                 size = number of floats of the output
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
 ******************************************/
-void R_Post_Proc(float* floatarr)
+int8_t FishDetector::decode(const float *floatarr, uint32_t size)
 {
+    uint32_t inf_out_size = 0;
+    for (int32_t n = 0; n < NUM_INF_OUT_LAYER; n++)
+    {
+        inf_out_size += (num_class + 5) * NUM_BB * num_grids[n] * num_grids[n];
+    }
+    if (size < inf_out_size)
+    {
+        fprintf(stderr, "[ERROR] Output size %u is smaller than expected %u.\n", size, inf_out_size);
+        return -1;
+    }
+
     /* Following variables are required for correct_region_boxes in Darknet implementation*/
     /* Note: This implementation refers to the "darknet detector test" */
-    mtx.lock();
     float new_w, new_h;
     float correct_w = 1.;
     float correct_h = 1.;
@@ -422,8 +225,8 @@ void R_Post_Proc(float* floatarr)
     {
         num_grid = num_grids[n];
         anchor_offset = 2 * NUM_BB * (NUM_INF_OUT_LAYER - (n + 1));
-        
-        for(b = 0; b < NUM_BB; b++)        
+
+        for(b = 0; b < NUM_BB; b++)
         {
             for(y = 0; y < num_grid; y++)
             {
@@ -481,294 +284,7 @@ void R_Post_Proc(float* floatarr)
     }
     /* Non-Maximum Supression filter */
     filter_boxes_nms(det, det.size(), TH_NMS);
-    mtx.unlock();
-    return ;
-}
-
-/*****************************************
-* Function Name : R_Inf_Thread
-* Description   : Executes the DRP-AI inference thread
-* Arguments     : threadid = thread identification
-* Return value  : -
-******************************************/
-void *R_Inf_Thread(void *threadid)
-{
-    /*Semaphore Variable*/
-    int32_t inf_sem_check = 0;
-
-    /*Inference Variables*/
-    fd_set rfds;
-    struct timespec tv;
-    int8_t inf_status = 0;
-    /*Variable for checking return value*/
-    int8_t ret = 0;
-    /*Variable for Performance Measurement*/
-    static struct timespec start_time;
-    static struct timespec inf_end_time;
-    static struct timespec pre_start_time;
-    static struct timespec pre_end_time;
-    static struct timespec post_start_time;
-    static struct timespec post_end_time;
-
-    printf("Inference Thread Starting\n");
-
-    /*Inference Loop Start*/
-    while(1)
-    {
-        while(1)
-        {
-            /*Gets the Termination request semaphore value. If different then 1 Termination was requested*/
-            /*Checks if sem_getvalue is executed wihtout issue*/
-            errno = 0;
-            ret = sem_getvalue(&terminate_req_sem, &inf_sem_check);
-            if (0 != ret)
-            {
-                fprintf(stderr, "[ERROR] Failed to get Semaphore Value: errno=%d\n", errno);
-                goto err;
-            }
-            /*Checks the semaphore value*/
-            if (1 != inf_sem_check)
-            {
-                goto ai_inf_end;
-            }
-            /*Checks if image frame from Capture Thread is ready.*/
-            if (inference_start.load())
-            {
-                break;
-            }
-            usleep(WAIT_TIME);
-        }
-
-        /*Gets Pre-process starting time*/
-        ret = timespec_get(&pre_start_time, TIME_UTC);
-        if (0 == ret)
-        {
-            fprintf(stderr, "[ERROR] Failed to get Pre-process Start Time\n");
-            goto err;
-        }
-
-        cv::Size size(MODEL_IN_H, MODEL_IN_W);
-        cv::resize(input_image, input_image, size);
-        cv::cvtColor(input_image, input_image, cv::COLOR_BGR2RGB);
-        input_image = hwc2chw(input_image);
-        input_image.convertTo(input_image, CV_32FC3,1.0 / 255.0, 0);
-        if (!input_image.isContinuous())
-        input_image = input_image.clone();
-
-        ret = timespec_get(&pre_end_time, TIME_UTC);
-        if ( 0 == ret)
-        {
-            fprintf(stderr, "[ERROR] Failed to Get Pre-process End Time\n");
-            goto err;
-        }
-
-        /*Set Pre-processing output to be inference input. */
-        runtime.SetInput(0, input_image.ptr<float>());
-        
-        /*Pre-process Time Result*/
-        pre_time = (float)((timedifference_msec(pre_start_time, pre_end_time)));
-
-        /*Gets inference starting time*/
-        ret = timespec_get(&start_time, TIME_UTC);
-        if (0 == ret)
-        {
-            fprintf(stderr, "[ERROR] Failed to get Inference Start Time\n");
-            goto err;
-        }
-
-        runtime.Run(drpai_freq);
-
-        /*Gets AI Inference End Time*/
-        ret = timespec_get(&inf_end_time, TIME_UTC);
-        if ( 0 == ret)
-        {
-            fprintf(stderr, "[ERROR] Failed to Get Inference End Time\n");
-            goto err;
-        }
-        /*Inference Time Result*/
-        ai_time = (float)((timedifference_msec(start_time, inf_end_time)));
-
-        /*Gets Post-process starting time*/
-        ret = timespec_get(&post_start_time, TIME_UTC);
-        if (0 == ret)
-        {
-            fprintf(stderr, "[ERROR] Failed to get Post-process Start Time\n");
-            goto err;
-        }
-        /*Process to read the DRPAI output data.*/
-        ret = get_result();
-        if (0 != ret)
-        {
-            fprintf(stderr, "[ERROR] Failed to get result from memory.\n");
-            goto err;
-        }
-        
-        /*CPU Post-Processing For YOLOv3*/
-        R_Post_Proc(drpai_output_buf);
-        /*Gets Post-process End Time*/
-        ret = timespec_get(&post_end_time, TIME_UTC);
-        if ( 0 == ret)
-        {
-            fprintf(stderr, "[ERROR] Failed to Get Post-process End Time\n");
-            goto err;
-        }
-        /*Post-process Time Result*/
-        post_time = (float)((timedifference_msec(post_start_time, post_end_time)));
-        total_time = pre_time + ai_time + post_time;
-        inference_start.store(0);
-    }
-    /*End of Inference Loop*/
-
-/*Error Processing*/
-err:
-    /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
-    goto ai_inf_end;
-/*AI Thread Termination*/
-ai_inf_end:
-    /*To terminate the loop in Capture Thread.*/
-    printf("AI Inference Thread Terminated\n");
-    pthread_exit(NULL);
-}
-
-/*****************************************
-* Function Name : R_Capture_Thread
-* Description   : Executes the V4L2 capture with Capture thread.
-* Arguments     : cap_pipeline = gstreamer pipeline
-* Return value  : -
-******************************************/
-void *R_Capture_Thread(void *cap_pipeline)
-{
-    std::string &gstream = *(static_cast<std::string*>(cap_pipeline));
-    std::cout << gstream << std::endl;
-    /*Semaphore Variable*/
-    int32_t capture_sem_check = 0;
-    int8_t ret = 0;
-    cv::Mat g_frame;
-    cv::Mat raw_frame;
-    cv::VideoCapture g_cap;
-
-    printf("Capture Thread Starting\n");
-
-    g_cap.open(gstream, cv::CAP_GSTREAMER);
-    if (!g_cap.isOpened())
-    {
-        std::cout << "[ERROR] Error opening video stream or camera !\n"
-                  << std::endl;
-        goto err;
-    }
-
-    while(1)
-    {
-        /*Gets the Termination request semaphore value. If different then 1 Termination was requested*/
-        /*Checks if sem_getvalue is executed wihtout issue*/
-        errno = 0;
-        ret = sem_getvalue(&terminate_req_sem, &capture_sem_check);
-        if (0 != ret)
-        {
-            fprintf(stderr, "[ERROR] Failed to get Semaphore Value: errno=%d\n", errno);
-            goto err;
-        }
-        /*Checks the semaphore value*/
-        if (1 != capture_sem_check)
-        {
-            goto capture_end;
-        }
-
-        g_cap >> g_frame;
-        /* Breaking the loop if no video frame is detected */
-        if (g_frame.empty())
-        {
-            std::cout << "[INFO] Video ended or corrupted frame !\n";
-            goto capture_end;
-        }
-        else
-        {   
-            if (!inference_start.load())
-            {
-
-                input_image = g_frame.clone();
-                inference_start.store(1); /* Flag for AI Inference Thread. */
-            }
-
-            if (!img_obj_ready.load())
-            {
-                yuyv_image = g_frame.clone();
-                img_obj_ready.store(1); /* Flag for Main Thread. */
-            }
-        }
-    } /*End of Loop*/
-
-/*Error Processing*/
-err:
-    sem_trywait(&terminate_req_sem);
-    goto capture_end;
-
-capture_end:
-    /*To terminate the loop in AI Inference Thread.*/
-    inference_start.store(1);
-
-    printf("Capture Thread Terminated\n");
-    pthread_exit(NULL);
-}
-
-/*****************************************
-* Function Name : R_exit_Thread
-* Description   : Executes the double click exit thread
-* Arguments     : threadid = thread identification
-* Return value  : -
-******************************************/
-void *R_exit_Thread(void *threadid)
-{
-    /*Semaphore Variable*/
-    int32_t kh_sem_check = 0;
-
-    /*Variable for checking return value*/
-    int8_t ret = 0;
-    devices dev;
-
-    /*Set Standard Input to Non Blocking*/
-    errno = 0;
-    ret = fcntl(0, F_SETFL, O_NONBLOCK);
-    if (-1 == ret)
-    {
-        fprintf(stderr, "[ERROR] Failed to run fctnl(): errno=%d\n", errno);
-        goto err;
-    }
-
-    while(1)
-    {
-        /*Gets the Termination request semaphore value. If different then 1 Termination was requested*/
-        /*Checks if sem_getvalue is executed wihtout issue*/
-        errno = 0;
-        ret = sem_getvalue(&terminate_req_sem, &kh_sem_check);
-        if (0 != ret)
-        {
-            fprintf(stderr, "[ERROR] Failed to get Semaphore Value: errno=%d\n", errno);
-            goto err;
-        }
-        /*Checks the semaphore value*/
-        if (1 != kh_sem_check)
-        {
-            goto exit_end;
-        }
-
-        dev.detect_mouse_click();
-        if (doubleClick)
-        {
-            goto err;
-        }
-    }
-
-/*Error Processing*/
-err:
-    /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
-    goto exit_end;
-
-exit_end:
-    printf("Exit Thread Terminated\n");
-    pthread_exit(NULL);
+    return 0;
 }
 
 /*****************************************
@@ -777,7 +293,7 @@ exit_end:
  * Arguments        : cv::Mat frame_g, input frame to be displayed in the background
  * Return value     : cv::Mat background, final display frame to be written to gstreamer pipeline
  *****************************************/
-cv::Mat create_output_frame(cv::Mat frame_g)
+cv::Mat FishDetector::create_output_frame(cv::Mat frame_g)
 {
     /* Create a black background image of size 1080x720 */
     cv::Mat background(DISP_OUTPUT_HEIGHT, DISP_OUTPUT_WIDTH, frame_g.type(), cv::Scalar(0, 0, 0));
@@ -790,80 +306,15 @@ cv::Mat create_output_frame(cv::Mat frame_g)
     return background;
 }
 
-
 /*****************************************
-* Function Name : R_Main_Process
-* Description   : Runs the main process loop
-* Arguments     : -
-* Return value  : 0 if succeeded
-*                 not 0 otherwise
+* Function Name : draw
+* Description   : Draws the detections selected in config.ini and the processing times
+* Arguments     : frame = camera frame, replaced by the display frame
+*                 times = processing times of the last inference
+* Return value  : -
 ******************************************/
-int8_t R_Main_Process()
+void FishDetector::draw(cv::Mat& frame, const PipelineTimes& times)
 {
-    /*Main Process Variables*/
-    int8_t main_ret = 0;
-    /*Semaphore Related*/
-    int32_t sem_check = 0;
-    /*Variable for checking return value*/
-    int8_t ret = 0;
-    /*Variable for image buffer id*/
-    uint8_t img_buf_id;
-    /* wayland Index = 0 */
-    uint32_t idx = 0;
-
-    /*Variable for detected object time ids*/
-    std::map<int, int> id_time;
-    std::set<int> unique_ids = {};
-    std::map<int, int> location_history;
-    long int infer_time_ms;
-    cv::Mat bgra_image;
-    std::stringstream stream;
-    std::string result_str;
-    int8_t region_count;
-    std::set<std::string> detection_object_set;
-    std::string objects_available = "";
-    std::string objects_not_available = "";
-    float conf = std::stof(ini_values["detect"]["conf"]);
-    std::string get_anchor = ini_values["detect"]["anchors"];
-    std::string detection_object_string = ini_values["detect"]["objects"];
-    std::stringstream detection_anchor_ss(get_anchor);
-    std::string anch_value;
-    while (std::getline(detection_anchor_ss, anch_value, ','))
-    {
-        double conv_anch_value =std::stod(anch_value);
-        anchors.push_back(conv_anch_value);
-    }
-    std::stringstream detection_object_ss(detection_object_string);
-    std::string item;
-    while (std::getline(detection_object_ss, item, ','))
-    {
-        if (count(label_file_map.begin(), label_file_map.end(), item) > 0)
-        {
-            detection_object_set.insert(item);
-            objects_available += item + "\n";
-        }
-        else
-        {
-            objects_not_available += item + "\n";
-        }
-    }
-     std::cout << "[INFO] *******************Detection Parameters*******************" << std::endl;
-    if (!objects_not_available.empty())
-    {
-        std::cout << "[INFO] Selected objects in config.ini which is not found in the label list\n"
-                  << objects_not_available << "\n";
-    }
-    if (!objects_available.empty())
-    {
-        std::cout << "[INFO] Selected objects to detect\n"
-                  << objects_available << "\n";
-    }
-    else
-    {
-        std::cerr << "[ERROR] No matching objects in label list from the config.ini file" << std::endl;
-	exit(0);
-    }
-
     float font_size = 0.9;
     float font_weight = 2;
     float font_size_bb = 0.5;
@@ -875,328 +326,109 @@ int8_t R_Main_Process()
     std::vector<std::string> detection_string_vector;
     int text_height = 150;
 
-    /* Initialize waylad */
-    ret = wayland.init(idx, IMAGE_OUTPUT_WIDTH, IMAGE_OUTPUT_HEIGHT, IMAGE_CHANNEL_BGRA);
-    if(0 != ret)
+    /*filter detection based on confidence score and objects selected*/
+    for (detection detect : det)
     {
-        fprintf(stderr, "[ERROR] Failed to initialize Image for Wayland\n");
-        return -1;
-    }
+        bbox_t dat;
 
-    printf("Main Loop Starts\n");
-    while(1)
-    {
-        /*Gets the Termination request semaphore value. If different then 1 Termination was requested*/
-        errno = 0;
-        ret = sem_getvalue(&terminate_req_sem, &sem_check);
-        if (0 != ret)
-        {
-            fprintf(stderr, "[ERROR] Failed to get Semaphore Value: errno=%d\n", errno);
-            goto err;
-        }
-        /*Checks the semaphore value*/
-        if (1 != sem_check)
-        {
-            goto main_proc_end;
-        }
-        /* Check img_obj_ready flag which is set in Capture Thread. */
-        if (img_obj_ready.load())
+        /*ignore detection based on the threshold from the config.ini file*/
+        if (detect.prob < conf)
         {
-            detection_string_vector.clear();
-            bgra_image = yuyv_image;
-            infer_time_ms = total_time;
-            int total_count = 0;
-            int items = 0;
-
-            mtx.lock();
-            /*filter detection based on confidence score and objects selected*/
-            for (detection detect : det)
-            {
-                bbox_t dat;
-
-                /*ignore detection based on the threshold from the config.ini file*/
-                if (detect.prob < conf)
-                {
-                    continue;
-                }
-                /*get the label from label file map*/
-                dat.name = label_file_map[detect.c].c_str();
-
-                /*check if the detected object is in the list of objects to be detected(from the config.ini file)*/
-                if (count(detection_object_set.begin(), detection_object_set.end(), dat.name) <= 0)
-                {
-                    continue;
-                }
-
-                dat.X = (int32_t)(detect.bbox.x - (detect.bbox.w / 2));
-                dat.Y = (int32_t)(detect.bbox.y - (detect.bbox.h / 2));
-                dat.W = (int32_t)detect.bbox.w;
-                dat.H = (int32_t)detect.bbox.h;
-                dat.pred = detect.prob * 100.0;
-
-                pred_score = ((int)dat.pred);
-                pred_score = pred_score / 100;
-                /* convert float predict score to string */
-                pred_score_str = std::to_string(pred_score);
-                /* remove trailing zeros in converted pred_score(string) */
-                size_t d_pos = pred_score_str.find_last_not_of('0');
-                if(d_pos != std::string::npos)
-                    pred_score_str.erase(d_pos + 1,std::string::npos);
-                bbox_text = dat.name + " " + pred_score_str;
-                detection_string_vector.push_back(dat.name + ": " + std::to_string(int(dat.pred)) + " %");
-
-                cv::Size text_size = cv::getTextSize(bbox_text, cv::FONT_HERSHEY_SIMPLEX, font_size_bb, 2, 0);
-
-                /*adjust the font size based on the detection text size*/
-                if (text_size.width > dat.W)
-                {
-                    font_weight_bb  = .75;
-                    font_size_bb    = 0.3;
-                }
-		        else
-		        {
-                    font_weight_bb  = 1;
-                    font_size_bb    = 0.5;
-                }
-
-                cv::Rect rect(dat.X, dat.Y, dat.W, dat.H);
-                cv::Rect rect_text_box(dat.X, dat.Y - 20, dat.W, 20);
-                /*draw the rectangle for detected object*/
-                cv::rectangle(bgra_image, rect, cv::Scalar(0, 255, 0), 1.5);
-                /*draw text box for holding the class label*/
-                cv::rectangle(bgra_image, rect_text_box, cv::Scalar(0, 255, 0), cv::FILLED);
-                /*writing class label to the display frame */
-                cv::putText(bgra_image, bbox_text, cv::Point(dat.X + 5, dat.Y - 8), 
-                            cv::FONT_HERSHEY_SIMPLEX, font_size_bb, cv::Scalar(0, 0, 0), font_weight_bb);
-            }
-            mtx.unlock();
-            bgra_image = create_output_frame(bgra_image);
-	        cv::putText(bgra_image, "Total AI Time[ms] : " + std::to_string(int(total_time)), cv::Point(1520, 60), 
-			cv::FONT_HERSHEY_DUPLEX, font_size, cv::Scalar(255, 255, 255), font_weight);
-            cv::putText(bgra_image, "Preprocess Time: " + std::to_string(int(pre_time)), cv::Point(1520, 96), 
-                        cv::FONT_HERSHEY_DUPLEX, font_size, cv::Scalar(255, 255, 255), font_weight);
-            cv::putText(bgra_image, "AI Inference Time: " + std::to_string(int(ai_time)), cv::Point(1520, 128), 
-                        cv::FONT_HERSHEY_DUPLEX, font_size, cv::Scalar(255, 255, 255), font_weight);
-            cv::putText(bgra_image, "Postprocess Time: " + std::to_string(int(post_time)), cv::Point(1520, 159), 
-                        cv::FONT_HERSHEY_DUPLEX, font_size, cv::Scalar(255, 255, 255), font_weight);
-            text_height = 200;            
-            for (std::string bb_string : detection_string_vector)
-            {
-                cv::putText(bgra_image, bb_string, cv::Point(1520, text_height), 
-                        cv::FONT_HERSHEY_DUPLEX, font_size, cv::Scalar(255, 255, 255), font_weight);
-                text_height += 30;
-            }
-	        cv::cvtColor(bgra_image, bgra_image, cv::COLOR_BGR2BGRA);
-            wayland.commit(bgra_image.data, NULL);
-            img_obj_ready.store(0);
+            continue;
         }
-        /*Wait for 1 TICK.*/
-        usleep(WAIT_TIME);
-    }
-
-/*Error Processing*/
-err:
-    sem_trywait(&terminate_req_sem);
-    main_ret = 1;
-    goto main_proc_end;
-/*Main Processing Termination*/
-main_proc_end:
-    /*To terminate the loop in Capture Thread.*/
-    img_obj_ready.store(0);
-    printf("Main Process Terminated\n");
-    return main_ret;
-}
-
-
-/*****************************************
-* Function Name : get_drpai_start_addr
-* Description   : Get DRP-AI Memory Area Address via DRP-AI Driver
-* Arguments     : -
-* Return value  : drpai start address 
-******************************************/
-uint64_t get_drpai_start_addr(int drpai_fd)
-{
-    int fd  = 0;
-    int ret = 0;
-    drpai_data_t drpai_data;
+        /*get the label from label file map*/
+        dat.name = label_file_map[detect.c].c_str();
 
-    errno = 0;
-
-    fd = open("/dev/drpai0", O_RDWR);
-    if (0 > fd )
-    {
-        LOG(FATAL) << "[ERROR] Failed to open DRP-AI Driver : errno=" << errno;
-        return (uint32_t)NULL;
-    }
-
-    /* Get DRP-AI Memory Area Address via DRP-AI Driver */
-    ret = ioctl(fd , DRPAI_GET_DRPAI_AREA, &drpai_data);
-    if (-1 == ret)
-    {
-        LOG(FATAL) << "[ERROR] Failed to get DRP-AI Memory Area : errno=" << errno ;
-        return (uint32_t)NULL;
-    }
-
-    return drpai_data.address;
-}
-
-
-/*****************************************
- * Function Name : query_device_status
- * Description   : function to check USB device is connectod.
- * Return value  : media_port, media port that device is connectod. 
- ******************************************/
-std::string query_device_status(std::string device_type)
-{
-    std::string media_port = "";
-    /* Linux command to be executed */
-    const char* command = "v4l2-ctl --list-devices";
-    /* Open a pipe to the command and execute it */ 
-    FILE* pipe = popen(command, "r");
-    if (!pipe) 
-    {
-        std::cerr << "[ERROR] Unable to open the pipe." << std::endl;
-        return media_port;
-    }
-    /* Read the command output line by line */
-    char buffer[128];
-    size_t found;
-    while (fgets(buffer, sizeof(buffer), pipe) != nullptr) 
-    {
-        std::string response = std::string(buffer);
-        found = response.find(device_type);
-        if (found != std::string::npos)
+        /*check if the detected object is in the list of objects to be detected(from the config.ini file)*/
+        if (count(detection_object_set.begin(), detection_object_set.end(), dat.name) <= 0)
         {
-            fgets(buffer, sizeof(buffer), pipe);
-            media_port = std::string(buffer);
-            pclose(pipe);
-            /* return media port*/
-            return media_port;
-        } 
-    }
-    pclose(pipe);
-    /* return media port*/
-    return media_port;
-}
-
-/*****************************************
-* Function Name : init_drpai
-* Description   : Function to initialize DRP-AI.
-* Arguments     : drpai_fd: DRP-AI file descriptor
-* Return value  : If non-zero, DRP-AI memory start address.
-*                 0 is failure.
-******************************************/
-uint64_t init_drpai(int drpai_fd)
-{
-    int ret = 0;
-    uint64_t drpai_addr = 0;
-
-    /*Get DRP-AI memory start address*/
-    drpai_addr = get_drpai_start_addr(drpai_fd);
-    if (drpai_addr == 0)
-    {
-        return 0;
-    }
-
-    return drpai_addr;
-}
-
-/*****************************************
- * Function Name : R_Kbhit_Thread
- * Description   : Executes the Keyboard hit thread (checks if enter key is hit)
- * Arguments     : threadid = thread identification
- * Return value  : -
- ******************************************/
-void *R_Kbhit_Thread(void *threadid)
-{
-    /*Semaphore Variable*/
-    int32_t kh_sem_check = 0;
-    /*Variable to store the getchar() value*/
-    int32_t c = 0;
-    /*Variable for checking return value*/
-    int8_t ret = 0;
+            continue;
+        }
 
-    printf("[INFO] Key Hit Thread Starting\n");
+        dat.X = (int32_t)(detect.bbox.x - (detect.bbox.w / 2));
+        dat.Y = (int32_t)(detect.bbox.y - (detect.bbox.h / 2));
+        dat.W = (int32_t)detect.bbox.w;
+        dat.H = (int32_t)detect.bbox.h;
+        dat.pred = detect.prob * 100.0;
 
-    printf("************************************************\n");
-    printf("* Press ENTER key to quit. *\n");
-    printf("************************************************\n");
+        pred_score = ((int)dat.pred);
+        pred_score = pred_score / 100;
+        /* convert float predict score to string */
+        pred_score_str = std::to_string(pred_score);
+        /* remove trailing zeros in converted pred_score(string) */
+        size_t d_pos = pred_score_str.find_last_not_of('0');
+        if(d_pos != std::string::npos)
+            pred_score_str.erase(d_pos + 1,std::string::npos);
+        bbox_text = dat.name + " " + pred_score_str;
+        detection_string_vector.push_back(dat.name + ": " + std::to_string(int(dat.pred)) + " %");
 
-    /*Set Standard Input to Non Blocking*/
-    errno = 0;
-    ret = fcntl(0, F_SETFL, O_NONBLOCK);
-    if (-1 == ret)
-    {
-        fprintf(stderr, "[ERROR] Failed to run fctnl(): errno=%d\n", errno);
-        goto err;
-    }
+        cv::Size text_size = cv::getTextSize(bbox_text, cv::FONT_HERSHEY_SIMPLEX, font_size_bb, 2, 0);
 
-    while (1)
-    {
-        /*Gets the Termination request semaphore value. If different then 1 Termination was requested*/
-        /*Checks if sem_getvalue is executed wihtout issue*/
-        errno = 0;
-        ret = sem_getvalue(&terminate_req_sem, &kh_sem_check);
-        if (0 != ret)
-        {
-            fprintf(stderr, "[ERROR] Failed to get Semaphore Value: errno=%d\n", errno);
-            goto err;
-        }
-        /*Checks the semaphore value*/
-        if (1 != kh_sem_check)
+        /*adjust the font size based on the detection text size*/
+        if (text_size.width > dat.W)
         {
-            goto key_hit_end;
-        }
-
-        c = getchar();
-        if (EOF != c)
-        {
-            /* When key is pressed. */
-            printf("key Detected.\n");
-            goto err;
+            font_weight_bb  = .75;
+            font_size_bb    = 0.3;
         }
         else
         {
-            /* When nothing is pressed. */
-            usleep(WAIT_TIME);
-        }
+            font_weight_bb  = 1;
+            font_size_bb    = 0.5;
+        }
+
+        cv::Rect rect(dat.X, dat.Y, dat.W, dat.H);
+        cv::Rect rect_text_box(dat.X, dat.Y - 20, dat.W, 20);
+        /*draw the rectangle for detected object*/
+        cv::rectangle(frame, rect, cv::Scalar(0, 255, 0), 1.5);
+        /*draw text box for holding the class label*/
+        cv::rectangle(frame, rect_text_box, cv::Scalar(0, 255, 0), cv::FILLED);
+        /*writing class label to the display frame */
+        cv::putText(frame, bbox_text, cv::Point(dat.X + 5, dat.Y - 8),
+                    cv::FONT_HERSHEY_SIMPLEX, font_size_bb, cv::Scalar(0, 0, 0), font_weight_bb);
+    }
+    frame = create_output_frame(frame);
+    cv::putText(frame, "Total AI Time[ms] : " + std::to_string(int(times.total)), cv::Point(1520, 60),
+                cv::FONT_HERSHEY_DUPLEX, font_size, cv::Scalar(255, 255, 255), font_weight);
+    cv::putText(frame, "Preprocess Time: " + std::to_string(int(times.pre)), cv::Point(1520, 96),
+                cv::FONT_HERSHEY_DUPLEX, font_size, cv::Scalar(255, 255, 255), font_weight);
+    cv::putText(frame, "AI Inference Time: " + std::to_string(int(times.ai)), cv::Point(1520, 128),
+                cv::FONT_HERSHEY_DUPLEX, font_size, cv::Scalar(255, 255, 255), font_weight);
+    cv::putText(frame, "Postprocess Time: " + std::to_string(int(times.post)), cv::Point(1520, 159),
+                cv::FONT_HERSHEY_DUPLEX, font_size, cv::Scalar(255, 255, 255), font_weight);
+    text_height = 200;
+    for (std::string bb_string : detection_string_vector)
+    {
+        cv::putText(frame, bb_string, cv::Point(1520, text_height),
+                    cv::FONT_HERSHEY_DUPLEX, font_size, cv::Scalar(255, 255, 255), font_weight);
+        text_height += 30;
     }
-
-/*Error Processing*/
-err:
-    /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
-    goto key_hit_end;
-
-key_hit_end:
-    printf("Key Hit Thread Terminated\n");
-    pthread_exit(NULL);
 }
 
 int32_t main(int32_t argc, char * argv[])
 {
-    int8_t main_proc = 0;
-    int8_t ret = 0;
-    int8_t ret_main = 0;
+    int32_t drpai_freq;
+    INI_FORMAT ini_values;
+    std::vector<std::string> label_file_map;
+    std::vector<double> anchors;
+    std::set<std::string> detection_object_set;
+    std::string objects_available = "";
+    std::string objects_not_available = "";
+    std::string usb_device;
+    std::string input_path;
+    int32_t decode_threads = 2;
+    PipelineConfig config;
 
     /*Disable OpenCV Accelerator due to the use of multithreading */
     unsigned long OCA_list[16];
     for(int i = 0; i < 16; i++) OCA_list[i] = 0;
     OCA_Activate(&OCA_list[0]);
 
-    /*Multithreading Variables*/
-    int32_t create_thread_ai = -1;
-    int32_t create_thread_capture = -1;
-    int32_t create_thread_exit = -1;
-    int32_t create_thread_key = -1;
-    int32_t sem_create = -1;
-    InOutDataType input_data_type;
-    bool runtime_status = false;
-    std::string gstreamer_pipeline;
-    if (argc < 2) 
+    if (argc < 2)
     {
         std::cout << "[ERROR] Please specify Input Source" << std::endl;
         std::cout << "[INFO] Usage : ./fish_detector USB" << std::endl;
+        std::cout << "[INFO]         ./fish_detector VIDEO <file> | IMAGES <directory>"
+                  << " [--display=0] [--decode_threads=N]" << std::endl;
         std::cout << "\n[INFO] End Application\n";
         return -1;
     }
@@ -1207,15 +439,30 @@ int32_t main(int32_t argc, char * argv[])
         case 1:
         {
             std::cout << "[INFO] USB CAMERA \n";
-            std::string media_port = query_device_status("usb");
-            gstreamer_pipeline = "v4l2src device=" + media_port + " ! videoconvert ! appsink";
-
+            usb_device = query_device_status("usb");
+        }
+        break;
+        /* Input Source : Video file or image directory, offline throughput mode */
+        case 2:
+        case 3:
+        {
+            if (argc < 3)
+            {
+                std::cout << "[ERROR] Please specify the video file or image directory" << std::endl;
+                std::cout << "\n[INFO] End Application\n";
+                return -1;
+            }
+            input_path = argv[2];
+            config.offline = true;
+            std::cout << "[INFO] " << input_source << " " << input_path << ", offline throughput mode\n";
         }
         break;
         default:
         {
-	        std::cout << "[ERROR] Please specify Input Source" << std::endl;
+            std::cout << "[ERROR] Please specify Input Source" << std::endl;
             std::cout << "[INFO] Usage : ./fish_detector USB" << std::endl;
+            std::cout << "[INFO]         ./fish_detector VIDEO <file> | IMAGES <directory>"
+                      << " [--display=0] [--decode_threads=N]" << std::endl;
             std::cout << "\n[INFO] End Application\n";
             return -1;
         }
@@ -1223,11 +470,11 @@ int32_t main(int32_t argc, char * argv[])
 
     std::map<std::string, std::string> args;
     /* Parse input arguments */
-    for (int i = 1; i < argc; ++i) 
+    for (int i = 1; i < argc; ++i)
     {
         std::string arg = argv[i];
         size_t pos = arg.find('=');
-        if (pos != std::string::npos) 
+        if (pos != std::string::npos)
         {
             std::string key = arg.substr(0, pos);
             std::string value = arg.substr(pos + 1);
@@ -1235,172 +482,157 @@ int32_t main(int32_t argc, char * argv[])
         }
     }
     /* DRP-AI Frequency Setting */
-    if (args.find("--drpai_freq") != args.end() && std::stoi(args["--drpai_freq"]) <= 127 && std::stoi(args["--drpai_freq"]) > 0) 
+    if (args.find("--drpai_freq") != args.end() && std::stoi(args["--drpai_freq"]) <= 127 && std::stoi(args["--drpai_freq"]) > 0)
         drpai_freq = std::stoi(args["--drpai_freq"]);
-    else 
+    else
         drpai_freq = DRPAI_FREQ;
     std::cout<<"\n[INFO] DRPAI FREQUENCY : "<<drpai_freq<<"\n";
+    /* Offline mode: display of the frames and threads decoding the file */
+    if (args.find("--decode_threads") != args.end() && std::stoi(args["--decode_threads"]) > 0)
+        decode_threads = std::stoi(args["--decode_threads"]);
+    if (config.offline && args.find("--display") != args.end())
+    {
+        config.display = (0 != std::stoi(args["--display"]));
+        config.double_click_exit = config.display;
+    }
 
     /* Read the configuration file */
-    config_read();
-    printf("RZ/V2H AI SDK Sample Application\n");
-    printf("Model : Darknet YOLOv3 | %s\n", ini_values["path"]["model_path"].c_str());
-
-    int drpai_fd = open("/dev/drpai0", O_RDWR);
-    if (0 > drpai_fd)
+    config_read("config.ini", ini_values);
+    if (ini_values["tracking"].count("detect_interval"))
     {
-        std::cerr << "[ERROR] Failed to open DRP-AI Driver : errno=" << errno << std::endl;
-        std::cout << "[INFO] End Application.\n";
-        return -1;
+        config.detect_interval = std::max(1, std::stoi(ini_values["tracking"]["detect_interval"]));
     }
-    /* Set drpai mem start address */
-    uint64_t drpaimem_addr_start = 0;
+    config.capture_timeout = CAPTURE_TIMEOUT;
+    config.ai_thread_timeout = AI_THREAD_TIMEOUT;
+    config.key_thread_timeout = EXIT_THREAD_TIMEOUT;
+    config.thread_sched.read(ini_values["thread"]);
+    /* Optional [trace] section: CSV of the frame timestamps */
+    config.trace_file = ini_values["trace"]["file"];
+    printf("RZ/V2H AI SDK Sample Application\n");
+    printf("Model : Darknet YOLOv3 | %s\n", ini_values["path"]["model_path"].c_str());
 
     /*Load Label from label_list file*/
     label_file_map = load_label_file(ini_values["path"]["label_path"]);
     if (label_file_map.empty())
     {
         fprintf(stderr,"[ERROR] Failed to load label file: %s\n", ini_values["path"]["label_path"].c_str());
-        ret = -1;
-        goto end_main;
+        printf("Application End\n");
+        return -1;
     }
-    num_class = label_file_map.size();
-    INF_OUT_SIZE = (num_class + 5) * NUM_BB * num_grids[0] * num_grids[0] 
-                    + (num_class + 5) * NUM_BB * num_grids[1] * num_grids[1]
-     		    + (num_class + 5) * NUM_BB * num_grids[2] * num_grids[2];
-
-    drpai_output_buf = new float[INF_OUT_SIZE];
 
-    /*Load model_dir structure and its weight to runtime object */
-    drpaimem_addr_start = init_drpai(drpai_fd);
-    if ((uint32_t)NULL == drpaimem_addr_start) 
+    float conf = std::stof(ini_values["detect"]["conf"]);
+    std::stringstream detection_anchor_ss(ini_values["detect"]["anchors"]);
+    std::string anch_value;
+    while (std::getline(detection_anchor_ss, anch_value, ','))
     {
-        fprintf(stderr, "[ERROR] Failed to get DRP-AI memory area start address.\n");
-        goto end_main;
+        anchors.push_back(std::stod(anch_value));
     }
-
-    runtime_status = runtime.LoadModel(ini_values["path"]["model_path"], drpaimem_addr_start+DRPAI_MEM_OFFSET);
-
-    if(!runtime_status)
+    std::stringstream detection_object_ss(ini_values["detect"]["objects"]);
+    std::string item;
+    while (std::getline(detection_object_ss, item, ','))
     {
-        fprintf(stderr, "[ERROR] Failed to load model.\n");
-        goto end_main;
+        if (count(label_file_map.begin(), label_file_map.end(), item) > 0)
+        {
+            detection_object_set.insert(item);
+            objects_available += item + "\n";
+        }
+        else
+        {
+            objects_not_available += item + "\n";
+        }
     }
-
-    /*Get input data */
-    input_data_type = runtime.GetInputDataType(0);
-    if (InOutDataType::FLOAT32 == input_data_type)
+    std::cout << "[INFO] *******************Detection Parameters*******************" << std::endl;
+    if (!objects_not_available.empty())
     {
-        /*Do nothing*/
+        std::cout << "[INFO] Selected objects in config.ini which is not found in the label list\n"
+                  << objects_not_available << "\n";
     }
-    else if (InOutDataType::FLOAT16 == input_data_type)
+    if (!objects_available.empty())
     {
-        fprintf(stderr, "[ERROR] Input data type : FP16.\n");
-        /*If your model input data type is FP16, use std::vector<uint16_t> for reading input data. */
-        goto end_main;
+        std::cout << "[INFO] Selected objects to detect\n"
+                  << objects_available << "\n";
     }
     else
     {
-        fprintf(stderr, "[ERROR] Input data type : neither FP32 nor FP16.\n");
-        goto end_main;
-    }
-
-    /*Termination Request Semaphore Initialization*/
-    /*Initialized value at 1.*/
-    sem_create = sem_init(&terminate_req_sem, 0, 1);
-    if (0 != sem_create)
-    {
-        fprintf(stderr, "[ERROR] Failed to Initialize Termination Request Semaphore.\n");
-        ret_main = -1;
-        goto end_threads;
-    }
-
-    /*Create exit Thread*/
-    create_thread_exit = pthread_create(&exit_thread, NULL, R_exit_Thread, NULL);
-    if (0 != create_thread_exit)
-    {
-        fprintf(stderr, "[ERROR] Failed to create exit Thread.\n");
-        ret_main = -1;
-        goto end_threads;
-    }
-    /* Detached exit thread */
-    pthread_detach(exit_thread);
-
-    /*Create Key Hit Thread*/
-    create_thread_key = pthread_create(&kbhit_thread, NULL, R_Kbhit_Thread, NULL);
-    if (0 != create_thread_key)
-    {
-        fprintf(stderr, "[ERROR] Failed to create Key Hit Thread.\n");
-        ret_main = -1;
-        goto end_threads;
-    }
-
-    /*Create Inference Thread*/
-    create_thread_ai = pthread_create(&ai_inf_thread, NULL, R_Inf_Thread, NULL);
-    if (0 != create_thread_ai)
-    {
-        sem_trywait(&terminate_req_sem);
-        fprintf(stderr, "[ERROR] Failed to create AI Inference Thread.\n");
-        ret_main = -1;
-        goto end_threads;
-    }
-
-    /*Create Capture Thread*/
-    create_thread_capture = pthread_create(&capture_thread, NULL, R_Capture_Thread, (void *) &gstreamer_pipeline);
-    if (0 != create_thread_capture)
-    {
-        sem_trywait(&terminate_req_sem);
-        fprintf(stderr, "[ERROR] Failed to create Capture Thread.\n");
-        ret_main = -1;
-        goto end_threads;
+        std::cerr << "[ERROR] No matching objects in label list from the config.ini file" << std::endl;
+        return 0;
     }
 
-    /*Main Processing*/
-    main_proc = R_Main_Process();
-    if (0 != main_proc)
-    {
-        fprintf(stderr, "[ERROR] Error during Main Process\n");
-        ret_main = -1;
-    }
-    goto end_threads;
+    TvmModel model(ini_values["path"]["model_path"], MODEL_IN_W, MODEL_IN_H, drpai_freq);
+    WaylandSink sink(IMAGE_OUTPUT_WIDTH, IMAGE_OUTPUT_HEIGHT);
+    int8_t ret_main = 0;
 
-end_threads:
-    if(0 == create_thread_capture)
+    V4l2Capture capture;
+    std::vector<std::unique_ptr<FrameSource>> sources;
+    std::vector<std::string> devices;
+    if (config.offline)
     {
-        ret = wait_join(&capture_thread, CAPTURE_TIMEOUT);
-        if (0 != ret)
+        /* The file is decoded by its own threads while the DRP-AI runs */
+        if (2 == input_source_map[input_source])
+        {
+            sources.emplace_back(new GstSource(GstSource::video_file_pipeline(input_path, decode_threads)));
+        }
+        else
         {
-            fprintf(stderr, "[ERROR] Failed to exit Capture Thread on time.\n");
-            ret_main = -1;
+            sources.emplace_back(new ImageDirSource(input_path, decode_threads));
         }
     }
-    if (0 == create_thread_ai)
+    else
     {
-        ret = wait_join(&ai_inf_thread, AI_THREAD_TIMEOUT);
-        if (0 != ret)
+        /* Optional [camera] section: several cameras sharing the DRP-AI, captured by GStreamer or V4L2 */
+        devices = split_list(ini_values["camera"]["devices"]);
+        if (devices.empty())
         {
-            fprintf(stderr, "[ERROR] Failed to exit AI Inference Thread on time.\n");
-            ret_main = -1;
+            devices.push_back(usb_device);
+        }
+        if (0 != create_camera_sources(devices, ini_values["camera"], CAM_IMAGE_WIDTH, CAM_IMAGE_HEIGHT, capture,
+                                       sources))
+        {
+            fprintf(stderr, "[ERROR] Failed to open the cameras.\n");
+            printf("Application End\n");
+            return -1;
         }
     }
-    if (0 == create_thread_key)
+    if (1 < devices.size())
     {
-        ret = wait_join(&kbhit_thread, EXIT_THREAD_TIMEOUT);
-        if (0 != ret)
+        StreamPolicy policy = StreamPolicy::ROUND_ROBIN;
+        if (ini_values["camera"].count("policy") && !parse_stream_policy(ini_values["camera"]["policy"], policy))
         {
-            fprintf(stderr, "[ERROR] Failed to exit Key Hit Thread on time.\n");
-            ret_main = -1;
+            fprintf(stderr, "[WARNING] Unknown camera policy %s, round_robin is used.\n",
+                    ini_values["camera"]["policy"].c_str());
         }
-    }
+        std::vector<std::string> weights = split_list(ini_values["camera"]["weights"]);
+        std::vector<std::string> deadlines = split_list(ini_values["camera"]["deadline_ms"]);
+        std::cout << "[INFO] " << devices.size() << " cameras, " << stream_policy_name(policy) << std::endl;
 
-    /*Delete Terminate Request Semaphore.*/
-    if (0 == sem_create)
+        /* Each camera has its own results and overlay, the model is shared */
+        std::vector<std::unique_ptr<FishDetector>> detectors;
+        std::vector<PipelineStream> streams;
+        for (size_t i = 0; i < devices.size(); i++)
+        {
+            detectors.emplace_back(new FishDetector(label_file_map, anchors, detection_object_set, conf));
+            PipelineStream stream = { sources[i].get(), detectors.back().get(), detectors.back().get() };
+            if (i < weights.size())
+            {
+                stream.weight = std::stoi(weights[i]);
+            }
+            if (i < deadlines.size())
+            {
+                stream.deadline_ms = std::stod(deadlines[i]);
+            }
+            streams.push_back(stream);
+        }
+        MultiPipeline pipeline(streams, model, sink, policy, cv::Size(IMAGE_OUTPUT_WIDTH, IMAGE_OUTPUT_HEIGHT),
+                               config);
+        ret_main = pipeline.run();
+    }
+    else
     {
-        sem_destroy(&terminate_req_sem);
+        FishDetector detector(label_file_map, anchors, detection_object_set, conf);
+        Pipeline pipeline(*sources[0], model, detector, detector, sink, config);
+        ret_main = pipeline.run();
     }
-    goto end_main;
 
-end_main:
     printf("Application End\n");
     return ret_main;
 }
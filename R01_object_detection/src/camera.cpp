@@ -32,6 +32,7 @@ Camera::Camera()
     camera_width    = CAM_IMAGE_WIDTH;
     camera_height   = CAM_IMAGE_HEIGHT;
     camera_color    = CAM_IMAGE_CHANNEL_YUY2;
+    memset(&inference_buf_capture, 0, sizeof(inference_buf_capture));
 }
 
 Camera::~Camera()
@@ -216,6 +217,39 @@ int8_t Camera::capture_qbuf()
 }
 
 
+/*****************************************
+* Function Name : sync_inference_buf_capture
+* Description   : Function to keep the last captured buffer for the AI Inference Thread.
+*                 The buffer is not given back with capture_qbuf, but with inference_capture_qbuf
+*                 once the inference has read it.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void Camera::sync_inference_buf_capture()
+{
+    inference_buf_capture = buf_capture;
+}
+
+/*****************************************
+* Function Name : inference_capture_qbuf
+* Description   : Function to enqueue the buffer kept by sync_inference_buf_capture.
+*                 (Call this function after the inference has read the buffer to restart filling image data into it)
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t Camera::inference_capture_qbuf()
+{
+    int8_t ret = 0;
+
+    ret = xioctl(m_fd, VIDIOC_QBUF, &inference_buf_capture);
+    if (-1 == ret)
+    {
+        return -1;
+    }
+    return 0;
+}
+
 /*****************************************
 * Function Name : capture_image
 * Description   : Function to capture image and return the physical memory address where the captured image stored.
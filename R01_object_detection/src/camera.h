@@ -37,6 +37,8 @@ class Camera
         int8_t start_camera();
         int8_t capture_qbuf();
         uint64_t capture_image(uint64_t udmabuf_address);
+        void sync_inference_buf_capture();
+        int8_t inference_capture_qbuf();
         int8_t close_camera();
         int8_t save_bin(std::string filename);
 
@@ -60,6 +62,8 @@ class Camera
         int8_t udmabuf_file;
 
         struct v4l2_buffer buf_capture;
+        /* buffer read in place by the AI Inference Thread */
+        struct v4l2_buffer inference_buf_capture;
 
         int8_t xioctl(int8_t fd, int32_t request, void *arg);
         int8_t start_capture();
@@ -153,7 +153,8 @@ const static uint32_t INF_OUT_SIZE  = (NUM_CLASS + 5) * NUM_BB * num_grids[0] *
 #ifdef INPUT_CORAL
 #define CAP_BUF_NUM                 (6)
 #else /* INPUT_CORAL */
-#define CAP_BUF_NUM                 (3)
+/* One buffer is kept by the AI Inference Thread while Pre-processing Runtime reads it */
+#define CAP_BUF_NUM                 (4)
 #endif /* INPUT_CORAL */
 
 /*DRP-AI Input image information*/
@@ -169,7 +170,6 @@ const static uint32_t INF_OUT_SIZE  = (NUM_CLASS + 5) * NUM_BB * num_grids[0] *
 
 /*udmabuf memory area Information*/
 #define UDMABUF_OFFSET              (CAM_IMAGE_WIDTH * CAM_IMAGE_HEIGHT * CAM_IMAGE_CHANNEL_YUY2 * CAP_BUF_NUM)
-#define UDMABUF_INFIMAGE_OFFSET     (IMAGE_OUTPUT_WIDTH * IMAGE_OUTPUT_HEIGHT * IMAGE_CHANNEL_BGRA * WL_BUF_NUM + UDMABUF_OFFSET)
 
 /*Image:: Text information to be drawn on image*/
 #define CHAR_SCALE_LARGE            (0.8)
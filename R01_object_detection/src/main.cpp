@@ -63,6 +63,8 @@
 #include "wayland.h"
 /*box drawing*/
 #include "box.h"
+/*Blocking hand-off between threads*/
+#include "stage_graph.h"
 /*Mutual exclusion*/
 #include <mutex>
 
@@ -72,14 +74,15 @@ using namespace std;
 ******************************************/
 /*Multithreading*/
 static sem_t terminate_req_sem;
+static StageGraph stages(&terminate_req_sem);
 static pthread_t ai_inf_thread;
 static pthread_t kbhit_thread;
 static pthread_t capture_thread;
 static mutex mtx;
 
 /*Flags*/
-static atomic<uint8_t> inference_start (0);
-static atomic<uint8_t> img_obj_ready   (0);
+static StageEvent inference_start (stages, "inference_start");
+static StageEvent img_obj_ready   (stages, "img_obj_ready");
 
 /*Global Variables*/
 static float drpai_output_buf[INF_OUT_SIZE];
@@ -536,6 +539,7 @@ int8_t print_result(Image* img)
 ******************************************/
 void *R_Inf_Thread(void *threadid)
 {
+    Camera* capture = (Camera*) threadid;
     /*Semaphore Variable*/
     int32_t inf_sem_check = 0;
     /*Variable for getting Inference output data*/
@@ -582,12 +586,11 @@ void *R_Inf_Thread(void *threadid)
             {
                 goto ai_inf_end;
             }
-            /*Checks if image frame from Capture Thread is ready.*/
-            if (inference_start.load())
+            /*Blocks until image frame from Capture Thread is ready or termination is requested.*/
+            if (inference_start.wait_set())
             {
                 break;
             }
-            usleep(WAIT_TIME);
         }
         in_param.pre_in_addr    = (uintptr_t) capture_address;
         /*Gets Pre-process starting time*/
@@ -603,6 +606,13 @@ void *R_Inf_Thread(void *threadid)
             fprintf(stderr, "[ERROR] Failed to run Pre-processing Runtime Pre()\n");
             goto err;
         }
+        /* Pre() has read the camera buffer, place it back to the capture queue */
+        ret = capture->inference_capture_qbuf();
+        if (0 != ret)
+        {
+            fprintf(stderr, "[ERROR] Failed to enqueue inference capture buffer.\n");
+            goto err;
+        }
         /*Gets AI Pre-process End Time*/
         ret = timespec_get(&pre_end_time, TIME_UTC);
         if ( 0 == ret)
@@ -669,7 +679,7 @@ void *R_Inf_Thread(void *threadid)
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto ai_inf_end;
 /*AI Thread Termination*/
 ai_inf_end:
@@ -694,27 +704,13 @@ void *R_Capture_Thread(void *threadid)
     int8_t ret = 0;
     int32_t counter = 0;
     uint8_t * img_buffer;
-    uint8_t * img_buffer0 = (unsigned char*)MAP_FAILED;
     const int32_t th_cnt = INF_FRAME_NUM;
-    int udmabuf_fd0 = -1;
+    /*Set when the captured buffer is kept for the AI Inference Thread*/
+    bool inference_buf = false;
     uint8_t capture_stabe_cnt = 8;  // Counter to wait for the camera to stabilize
 
     printf("Capture Thread Starting\n");
 
-    udmabuf_fd0 = open("/dev/udmabuf0", O_RDWR );
-    if (0 > udmabuf_fd0)
-    {
-        fprintf(stderr, "[ERROR] Failed to open /dev/udmabuf0\n");
-        goto err;
-    }
-    img_buffer0 = (unsigned char*) mmap(NULL, CAM_IMAGE_WIDTH * CAM_IMAGE_HEIGHT * CAM_IMAGE_CHANNEL_YUY2 ,PROT_READ|PROT_WRITE, MAP_SHARED,  udmabuf_fd0, UDMABUF_INFIMAGE_OFFSET);
-    if (MAP_FAILED == img_buffer0)
-    {
-        fprintf(stderr, "[ERROR] Failed to mmap\n");
-        goto err;
-    }
-    capture_address = (uint32_t)udmabuf_address + UDMABUF_INFIMAGE_OFFSET;
-
     while(1)
     {
         /*Gets the Termination request semaphore value. If different then 1 Termination was requested*/
@@ -734,6 +730,7 @@ void *R_Capture_Thread(void *threadid)
 
         /* Capture MIPI camera image and stop updating the capture buffer */
         capture_addr = (uint32_t)capture->capture_image(udmabuf_address);
+        inference_buf = false;
         if (capture_addr == 0)
         {
             fprintf(stderr, "[ERROR] Failed to capture image from camera.\n");
@@ -749,45 +746,45 @@ void *R_Capture_Thread(void *threadid)
             else
             {
                 img_buffer = capture->get_img();
-                if (!inference_start.load())
-                {
-                    /* Copy captured image to Image object. This will be used in Main Thread. */
-                    memcpy(img_buffer0, img_buffer, CAM_IMAGE_WIDTH * CAM_IMAGE_HEIGHT * CAM_IMAGE_CHANNEL_YUY2);
-                    inference_start.store(1); /* Flag for AI Inference Thread. */
-                }
-
+                /* Converted for the Main Thread first, the AI Inference Thread may requeue the buffer. */
                 if (!img_obj_ready.load())
                 {
                     img.camera_to_image(img_buffer, capture->get_size());
                     img_obj_ready.store(1); /* Flag for Main Thread. */
                 }
+
+                if (!inference_start.load())
+                {
+                    /* The captured buffer is already in the physically contiguous udmabuf area:
+                       Pre-processing Runtime reads it in place instead of a copy of it. */
+                    capture->sync_inference_buf_capture();
+                    capture_address = capture_addr;
+                    inference_buf = true;
+                    inference_start.store(1); /* Flag for AI Inference Thread. */
+                }
             }
         }
-        /* IMPORTANT: Place back the image buffer to the capture queue */
-        ret = capture->capture_qbuf();
-        if (0 != ret)
+        /* IMPORTANT: Place back the image buffer to the capture queue,
+           the AI Inference Thread places back the buffer it reads. */
+        if (!inference_buf)
         {
-            fprintf(stderr, "[ERROR] Failed to enqueue capture buffer.\n");
-            goto err;
+            ret = capture->capture_qbuf();
+            if (0 != ret)
+            {
+                fprintf(stderr, "[ERROR] Failed to enqueue capture buffer.\n");
+                goto err;
+            }
         }
     } /*End of Loop*/
 
 /*Error Processing*/
 err:
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto capture_end;
 
 capture_end:
-    if (MAP_FAILED != img_buffer0)
-    {
-        munmap(img_buffer0, CAM_IMAGE_WIDTH * CAM_IMAGE_HEIGHT * CAM_IMAGE_CHANNEL_YUY2);
-    }
-    if (0 < udmabuf_fd0)
-    {
-        close(udmabuf_fd0);
-    }
-    /*To terminate the loop in AI Inference Thread.*/
-    inference_start.store(1);
+    /*Termination is requested here, it wakes the AI Inference Thread. inference_start is not set: the inference
+      would read a capture buffer already placed back to the capture queue.*/
 
     printf("Capture Thread Terminated\n");
     pthread_exit(NULL);
@@ -840,6 +837,11 @@ void *R_Kbhit_Thread(void *threadid)
             goto key_hit_end;
         }
 
+        /* Blocks until a key is pressed or termination is requested. */
+        if (!stages.wait_readable(STDIN_FILENO))
+        {
+            continue;
+        }
         c = getchar();
         if (EOF != c)
         {
@@ -847,17 +849,17 @@ void *R_Kbhit_Thread(void *threadid)
             printf("key Detected.\n");
             goto err;
         }
-        else
+        else if (feof(stdin))
         {
-            /* When nothing is pressed. */
-            usleep(WAIT_TIME);
+            /* Standard input is closed, only termination ends the thread. */
+            stages.wait_shutdown();
         }
     }
 
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto key_hit_end;
 
 key_hit_end:
@@ -920,13 +922,13 @@ int8_t R_Main_Process()
 
             img_obj_ready.store(0);
         }
-        /*Wait for 1 TICK.*/
-        usleep(WAIT_TIME);
+        /*Wait for the next frame from Capture Thread.*/
+        img_obj_ready.wait_set();
     }
 
 /*Error Processing*/
 err:
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     main_ret = 1;
     goto main_proc_end;
 /*Main Processing Termination*/
@@ -1098,6 +1100,12 @@ int32_t main(int32_t argc, char * argv[])
         goto end_threads;
     }
 
+    /*Stages and the events they hand over*/
+    stages.add_stage("capture", {}, {&inference_start, &img_obj_ready});
+    stages.add_stage("inference", {&inference_start}, {});
+    stages.add_stage("main", {&img_obj_ready}, {});
+    stages.print();
+
     /*Create Key Hit Thread*/
     create_thread_key = pthread_create(&kbhit_thread, NULL, R_Kbhit_Thread, NULL);
     if (0 != create_thread_key)
@@ -1108,10 +1116,10 @@ int32_t main(int32_t argc, char * argv[])
     }
 
     /*Create Inference Thread*/
-    create_thread_ai = pthread_create(&ai_inf_thread, NULL, R_Inf_Thread, NULL);
+    create_thread_ai = pthread_create(&ai_inf_thread, NULL, R_Inf_Thread, (void *) capture);
     if (0 != create_thread_ai)
     {
-        sem_trywait(&terminate_req_sem);
+        stages.shutdown();
         fprintf(stderr, "[ERROR] Failed to create AI Inference Thread.\n");
         ret_main = -1;
         goto end_threads;
@@ -1121,7 +1129,7 @@ int32_t main(int32_t argc, char * argv[])
     create_thread_capture = pthread_create(&capture_thread, NULL, R_Capture_Thread, (void *) capture);
     if (0 != create_thread_capture)
     {
-        sem_trywait(&terminate_req_sem);
+        stages.shutdown();
         fprintf(stderr, "[ERROR] Failed to create Capture Thread.\n");
         ret_main = -1;
         goto end_threads;
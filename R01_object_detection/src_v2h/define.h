@@ -208,6 +208,10 @@ const static uint32_t INF_OUT_SIZE  = (NUM_CLASS + 5) * NUM_BB * num_grids[0] *
 /*Waiting Time*/
 #define WAIT_TIME               (1000) /* microseconds */
 
+/*Frame rings between threads: frames that can wait for the next thread, the newest frame wins when full*/
+#define CAPTURE_RING_DEPTH      (1)
+#define DISPLAY_RING_DEPTH      (1)
+
 /*Array size*/
 #define SIZE_OF_ARRAY(array) (sizeof(array)/sizeof(array[0]))
 
@@ -26,6 +26,7 @@
 * Includes
 ******************************************/
 #include "image.h"
+#include <algorithm>
 
 Image::Image()
 {
@@ -90,13 +91,65 @@ cv::Mat Image::get_mat()
 
 /*****************************************
 * Function Name : set_mat
-* Description   : Function to register cv::Mat to Image class
+* Description   : Function to register cv::Mat to Image class.
+*                 The pixel data is shared, not copied: drawing writes to input_mat,
+*                 which must stay valid until the image is done.
 * Arguments     : input_mat = input cv::Mat to be registered.
 * Return value  : -
 ******************************************/
 void Image::set_mat(const cv::Mat& input_mat)
 {
-    img_mat = input_mat.clone();
+    img_mat = input_mat;
+}
+
+
+/*****************************************
+* Function Name : set_overlay
+* Description   : Function to draw the boxes and the strings on an overlay layer instead of img_mat.
+*                 The boxes are then drawn in output image coordinates, on the camera image scaled
+*                 as convert_size() does.
+* Arguments     : layer = overlay layer, NULL to draw on img_mat
+* Return value  : -
+******************************************/
+void Image::set_overlay(OverlayLayer* layer)
+{
+    overlay = layer;
+    overlay_scale = 1.0f;
+    if (NULL != overlay)
+    {
+        overlay_scale = std::min((float)out_w / img_w, (float)out_h / img_h);
+    }
+}
+
+
+/*****************************************
+* Function Name : canvas
+* Description   : Function to get the image to draw on
+* Arguments     : -
+* Return value  : canvas of the overlay layer if set, img_mat otherwise
+******************************************/
+cv::Mat& Image::canvas()
+{
+    if (NULL != overlay)
+    {
+        return overlay->canvas();
+    }
+    return img_mat;
+}
+
+
+/*****************************************
+* Function Name : mark
+* Description   : Function to record a region drawn on the overlay layer
+* Arguments     : rect = region drawn
+* Return value  : -
+******************************************/
+void Image::mark(const cv::Rect& rect)
+{
+    if (NULL != overlay)
+    {
+        overlay->mark(rect);
+    }
 }
 
 
@@ -146,8 +199,8 @@ void Image::write_string_rgb(std::string str, uint8_t align_type,  uint32_t x, u
     uint8_t b = color & RGB_FILTER;
     int ptx = 0;
     int pty = 0;
-    /*OpenCV image data is in BGRA */
-    cv::Mat bgra_image = img_mat.clone();
+    /*OpenCV image data is in BGRA, drawn in place */
+    cv::Mat& bgra_image = canvas();
 
     int baseline = 0;
     cv::Size size = cv::getTextSize(str.c_str(), cv::FONT_HERSHEY_SIMPLEX, scale, thickness + 2, &baseline);
@@ -166,9 +219,8 @@ void Image::write_string_rgb(std::string str, uint8_t align_type,  uint32_t x, u
                     scale, cv::Scalar(0x00, 0x00, 0x00, 0xFF), thickness + 2);
     cv::putText(bgra_image, str.c_str(), cv::Point(ptx, pty), cv::FONT_HERSHEY_SIMPLEX, 
                     scale, cv::Scalar(b, g, r, 0xFF), thickness);
-
-    img_mat = bgra_image.clone();
-
+    mark(cv::Rect(ptx - thickness - 2, pty - size.height - thickness - 2,
+                    size.width + (thickness + 2) * 2, size.height + baseline + (thickness + 2) * 2));
 }
 
 /*****************************************
@@ -189,7 +241,10 @@ void Image::write_string_rgb_boundingbox(std::string str, uint8_t align_type,
     uint32_t x_min, uint32_t y_min, uint32_t x_max, uint32_t y_max,
     float scale, uint32_t color, uint32_t str_color)
 {
-    uint8_t thickness = CHAR_THICKNESS_BB;
+    /*Line widths follow the scale of the camera image on the overlay*/
+    uint8_t thickness = std::max(1, (int)std::lround(CHAR_THICKNESS_BB * overlay_scale));
+    int32_t line_size = std::max(1, (int)std::lround(BOX_LINE_SIZE * overlay_scale));
+    int32_t double_line_size = std::max(1, (int)std::lround(BOX_DOUBLE_LINE_SIZE * overlay_scale));
     /*Extract RGB information*/
     uint8_t r = (color >> 16) & RGB_FILTER;
     uint8_t g = (color >>  8) & RGB_FILTER;
@@ -201,18 +256,18 @@ void Image::write_string_rgb_boundingbox(std::string str, uint8_t align_type,
 	
     int ptx = 0;
     int pty = 0;
-    /*OpenCV image data is in BGRA */
-    cv::Mat bgra_image = img_mat.clone();
+    /*OpenCV image data is in BGRA, drawn in place */
+    cv::Mat& bgra_image = canvas();
     int baseline = 0;
 
     /*Color must be in BGR order*/
     /*Draw Bounding Box with white double line */
-    cv::rectangle(bgra_image, cv::Point(x_min+BOX_LINE_SIZE,y_min+BOX_LINE_SIZE), 
-                    cv::Point(x_max-BOX_LINE_SIZE,y_max-BOX_LINE_SIZE), 
-                    cv::Scalar(0xFF, 0xFF, 0xFF, 0xFF), BOX_DOUBLE_LINE_SIZE);
+    cv::rectangle(bgra_image, cv::Point(x_min+line_size,y_min+line_size), 
+                    cv::Point(x_max-line_size,y_max-line_size), 
+                    cv::Scalar(0xFF, 0xFF, 0xFF, 0xFF), double_line_size);
     cv::rectangle(bgra_image, cv::Point(x_min,y_min), 
                     cv::Point(x_max,y_max), 
-                    cv::Scalar(b, g, r, 0xFF), BOX_LINE_SIZE);
+                    cv::Scalar(b, g, r, 0xFF), line_size);
 
     cv::Size size = cv::getTextSize(str.c_str(), cv::FONT_HERSHEY_SIMPLEX, scale, thickness + 2, &baseline);
     if (align_type == align_l)
@@ -222,17 +277,19 @@ void Image::write_string_rgb_boundingbox(std::string str, uint8_t align_type,
     }
     else if (align_type == align_r)
     {
-        ptx = img_w - (size.width + x_min);
+        ptx = bgra_image.cols - (size.width + x_min);
         pty = y_min;
     }
     /*Draw label rectangle*/
-    cv::rectangle(bgra_image, cv::Point(ptx-BOX_LINE_SIZE+1,pty+size.height+2), 
+    cv::rectangle(bgra_image, cv::Point(ptx-line_size+1,pty+size.height+2), 
                     cv::Point(ptx+size.width,pty), cv::Scalar(b, g, r, 0xFF), cv::FILLED);
     /*Draw text as bounding box label in BLACK*/
     cv::putText(bgra_image, str.c_str(), cv::Point(ptx, pty+size.height), 
                     cv::FONT_HERSHEY_SIMPLEX, scale, cv::Scalar(b_str, g_str, r_str, 0xFF), thickness);
-
-    img_mat = bgra_image.clone();
+    mark(cv::Rect(cv::Point(x_min - line_size, y_min - line_size),
+                    cv::Point(x_max + line_size + 1, y_max + line_size + 1))
+            | cv::Rect(cv::Point(ptx - line_size, pty),
+                    cv::Point(ptx + size.width + 1, pty + size.height + baseline + 3)));
 }
 /*****************************************
 * Function Name : draw_rect
@@ -258,8 +315,14 @@ void Image::draw_rect(int32_t x, int32_t y, int32_t w, int32_t h, const char * s
     y_min = y_min < 1 ? 1 : y_min;
     y_max = ((img_h - 2) < y_max) ? (img_h - 2) : y_max;
 
+    /* Camera image coordinates to overlay coordinates */
+    x_min = std::lround(x_min * overlay_scale);
+    y_min = std::lround(y_min * overlay_scale);
+    x_max = std::lround(x_max * overlay_scale);
+    y_max = std::lround(y_max * overlay_scale);
+
     /* Draw the bounding box and class and probability*/
-    write_string_rgb_boundingbox(str,1,x_min, y_min,x_max,y_max,CHAR_SCALE_BB,color, label_color);
+    write_string_rgb_boundingbox(str,1,x_min, y_min,x_max,y_max,CHAR_SCALE_BB * overlay_scale,color, label_color);
 
     return;
 }
@@ -26,6 +26,7 @@
 #define IMAGE_H
 
 #include "define.h"
+#include "overlay_layer.h"
 #include <opencv2/opencv.hpp>
 
 class Image
@@ -50,6 +51,7 @@ class Image
         void convert_size(int in_w, int resize_w, bool is_padding);
         void set_mat(const cv::Mat& input_mat);
         cv::Mat get_mat();
+        void set_overlay(OverlayLayer* layer);
 
     private:
         /* Input Image (BGR from camera) Information */
@@ -61,6 +63,14 @@ class Image
         uint32_t out_w;
         uint32_t out_c;
 
+        /* Overlay drawn on instead of img_mat, in output image coordinates */
+        OverlayLayer* overlay   = NULL;
+        /* Scale of the camera image on the output image */
+        float overlay_scale     = 1.0f;
+
+        cv::Mat& canvas();
+        void mark(const cv::Rect& rect);
+
         uint8_t align_l         = ALIGHN_LEFT;
         uint8_t align_r         = ALIGHN_RIGHT;
 };
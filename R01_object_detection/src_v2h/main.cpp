@@ -59,18 +59,26 @@
 #include "image.h"
 /*Wayland control*/
 #include "wayland.h"
+/*Boxes and text blended over the camera image*/
+#include "overlay_layer.h"
 /*box drawing*/
 #include "box.h"
 /*dmabuf for Pre-processing Runtime input data*/
 #include "dmabuf.h"
+/*Blocking hand-off between threads*/
+#include "stage_graph.h"
+/*Frame slots passed between threads*/
+#include "frame_ring.h"
 /*Mutual exclusion*/
 #include <mutex>
+#include <atomic>
 
 /*****************************************
 * Global Variables
 ******************************************/
 /*Multithreading*/
 static sem_t terminate_req_sem;
+static StageGraph stages(&terminate_req_sem);
 static pthread_t ai_inf_thread;
 static pthread_t kbhit_thread;
 static pthread_t capture_thread;
@@ -79,18 +87,15 @@ static pthread_t hdmi_thread;
 static std::mutex mtx;
 
 /*Flags*/
-static std::atomic<uint8_t> inference_start (0);
-static std::atomic<uint8_t> img_obj_ready   (0);
-static std::atomic<uint8_t> hdmi_obj_ready  (0);
+static StageEvent inference_start (stages, "inference_start");
+
+/*Frame rings: Capture Thread -> Img Thread (BGR camera frames), Img Thread -> Display Thread (BGRA output frames)*/
+static FrameRing<cv::Mat> capture_ring(CAPTURE_RING_DEPTH, FRAME_RING_LATEST_WINS);
+static FrameRing<cv::Mat> display_ring(DISPLAY_RING_DEPTH, FRAME_RING_LATEST_WINS);
 /*Global Variables*/
 static float drpai_output_buf[INF_OUT_SIZE];
 
 static Image img;
-/*Image to be displayed on GUI*/
-cv::Mat input_image;
-cv::Mat capture_image;
-cv::Mat proc_image;
-cv::Mat display_image;
 
 /*GStreamer pipeline for camera capture*/
 static std::string gstreamer_pipeline = "";
@@ -118,6 +123,9 @@ static uint32_t array_cap_time[30] = {1000,1000,1000,1000,1000,1000,1000,1000,10
 static int32_t drpai_freq;
 
 static Wayland wayland;
+static OverlayLayer overlay;
+/*Incremented by Inference Thread each time det and the processing times are updated*/
+static std::atomic<uint32_t> result_generation(0);
 static std::vector<detection> det;
 static std::vector<detection> print_det;
 
@@ -491,8 +499,8 @@ void R_Post_Proc(float* floatarr)
 
 /*****************************************
 * Function Name : draw_bounding_box
-* Description   : Draw bounding box on image. 
-*                 Must be called before resizing the display image.
+* Description   : Draw bounding box on the overlay.
+*                 Boxes are given in camera image coordinates, Image scales them to the display.
 * Arguments     : -
 * Return value  : 0 if succeeded
 *               not 0 otherwise
@@ -511,7 +519,7 @@ void draw_bounding_box(void)
     mtx.unlock();
 
     print_det.clear();
-    /* Draw bounding box on RGB image. */
+    /* Draw bounding box on the overlay. */
     for (i = 0; i < det_buff.size(); i++)
     {
         /* Skip the overlapped bounding boxes */
@@ -665,12 +673,11 @@ void *R_Inf_Thread(void *threadid)
             {
                 goto ai_inf_end;
             }
-            /*Checks if image frame from Capture Thread is ready.*/
-            if (inference_start.load())
+            /*Blocks until image frame from Capture Thread is ready or termination is requested.*/
+            if (inference_start.wait_set())
             {
                 break;
             }
-            usleep(WAIT_TIME);
         }
 
         /*Gets Pre-process Start time*/
@@ -754,13 +761,14 @@ void *R_Inf_Thread(void *threadid)
         /*Post-process Time Result*/
 
         post_time = (timedifference_msec(post_start_time, post_end_time)*TIME_COEF);
+        result_generation++;
     }
     /*End of Inference Loop*/
 
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto ai_inf_end;
 /*AI Thread Termination*/
 ai_inf_end:
@@ -793,8 +801,11 @@ void *R_Capture_Thread(void *threadid)
 #endif /* DISP_CAM_FRAME_RATE */
 
     cv::VideoCapture g_cap;
-    cv::Mat g_frame;
+    /*Slot of capture_ring the camera frame is read into*/
+    cv::Mat *g_frame = NULL;
     cv::Mat padding_frame(CAM_IMAGE_WIDTH - CAM_IMAGE_HEIGHT, CAM_IMAGE_WIDTH, CV_8UC3);
+    /*DRP-AI input (CAM_IMAGE_WIDTH*CAM_IMAGE_WIDTH BGR), written in place in drpai_buf*/
+    cv::Mat drpai_image(DRPAI_IN_HEIGHT, DRPAI_IN_WIDTH, CV_8UC3, drpai_buf->mem);
 
     printf("Capture Thread Starting\n");
 
@@ -824,7 +835,13 @@ void *R_Capture_Thread(void *threadid)
 
         /* Capture camera image and stop updating the capture buffer */
 
-        g_cap.read(g_frame);
+        /*Latest-wins ring: never blocks, reuses the oldest frame the Img Thread has not taken yet*/
+        g_frame = capture_ring.acquire_write();
+        if (NULL == g_frame)
+        {
+            goto capture_end;
+        }
+        g_cap.read(*g_frame);
 #ifdef DISP_CAM_FRAME_RATE
         cap_cnt++;
         ret = timespec_get(&capture_time, TIME_UTC);
@@ -839,8 +856,9 @@ void *R_Capture_Thread(void *threadid)
 #endif /* DISP_CAM_FRAME_RATE */
 
         /* Breaking the loop if no video frame is detected */
-        if (g_frame.empty())
+        if (g_frame->empty())
         {
+            capture_ring.cancel_write(g_frame);
             fprintf(stderr, "[ERROR] Failed to get capture image.\n");
             goto err;
         }
@@ -850,46 +868,36 @@ void *R_Capture_Thread(void *threadid)
             if( capture_stabe_cnt > 0 )
             {
                 capture_stabe_cnt--;
+                capture_ring.cancel_write(g_frame);
             }
             else
             {
                 if (!inference_start.load())
                 {
-                    /* Copy captured image to Image object. This will be used in Main Thread. */
                     mtx.lock();
-                    /*Image: CAM_IMAGE_WIDTH*CAM_IMAGE_HEIGHT (BGR) */
-                    input_image = g_frame.clone();
-                    
-                    /*Add padding for keeping the aspect ratio: CAM_IMAGE_WIDTH*CAM_IMAGE_WIDTH (BGR) */
-                    cv::vconcat(input_image, padding_frame, input_image);
-                    
-                    /*Copy input data to drpai_buf for DRP-AI Pre-processing Runtime.*/
-                    memcpy( drpai_buf->mem, input_image.data, drpai_buf->size);
+                    /*Add padding for keeping the aspect ratio: CAM_IMAGE_WIDTH*CAM_IMAGE_WIDTH (BGR),
+                      written directly to drpai_buf for DRP-AI Pre-processing Runtime.*/
+                    cv::vconcat(*g_frame, padding_frame, drpai_image);
                     /* Flush buffer */
                     ret = buffer_flush_dmabuf(drpai_buf->idx, drpai_buf->size);
+                    mtx.unlock();
                     if (0 != ret)
                     {
+                        capture_ring.cancel_write(g_frame);
                         goto err;
                     }
-                    mtx.unlock();
                     inference_start.store(1); /* Flag for AI Inference Thread. */
                 }
 
-                if (!img_obj_ready.load())
-                {
-                    mtx.lock();
-                    capture_image = g_frame.clone();
-                    img.set_mat(capture_image);
-                    mtx.unlock();
-                    img_obj_ready.store(1); /* Flag for Img Thread. */
-                }
+                /* Hand the frame to Img Thread. */
+                capture_ring.commit_write(g_frame);
             }
         }
     } /*End of Loop*/
 
 /*Error Processing*/
 err:
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto capture_end;
 
 capture_end:
@@ -913,6 +921,15 @@ void *R_Img_Thread(void *threadid)
     int32_t hdmi_sem_check = 0;
     /*Variable for checking return value*/
     int8_t ret = 0;
+    /*Frame slots taken from capture_ring and display_ring*/
+    cv::Mat *cap_frame = NULL;
+    cv::Mat *out_frame = NULL;
+    /*Results drawn on the overlay, redrawn only when they change*/
+    uint32_t drawn_generation = 0;
+    bool overlay_drawn = false;
+#ifdef DISP_CAM_FRAME_RATE
+    uint32_t drawn_fps = 0;
+#endif /* DISP_CAM_FRAME_RATE */
     
     timespec start_time;
     timespec end_time;
@@ -944,38 +961,56 @@ void *R_Img_Thread(void *threadid)
         {
             goto hdmi_end;
         }
-        /* Check img_obj_ready flag which is set in Capture Thread. */
-        if (img_obj_ready.load())
+        /* Wait for the next frame from Capture Thread, NULL once the ring is closed. */
+        cap_frame = capture_ring.acquire_read();
+        if (NULL == cap_frame)
         {
-            /* Draw bounding box on image. */
-            draw_bounding_box();
-
-            /* Convert output image size. */
-            img.convert_size(CAM_IMAGE_WIDTH, DRPAI_OUT_WIDTH, display_padding);
+            goto hdmi_end;
+        }
+        /* Read the captured frame in place, the slot belongs to this thread until it is released. */
+        img.set_mat(*cap_frame);
 
-            /*Displays AI Inference Results on display.*/
+        /* Redraw the overlay only when the results shown on it changed. */
+        uint32_t generation = result_generation;
+        bool redraw = (!overlay_drawn || generation != drawn_generation);
+#ifdef DISP_CAM_FRAME_RATE
+        redraw = redraw || ((uint32_t)cap_fps != drawn_fps);
+        drawn_fps = (uint32_t)cap_fps;
+#endif /* DISP_CAM_FRAME_RATE */
+        if (redraw)
+        {
+            overlay.begin();
+            /* Draw bounding box on the overlay. */
+            draw_bounding_box();
+            /*Displays AI Inference Results on the overlay.*/
             print_result(&img);
-            
-            proc_image = img.get_mat().clone(); 
+            overlay.publish();
+            drawn_generation = generation;
+            overlay_drawn = true;
+        }
 
-            if (!hdmi_obj_ready.load())
-            {
-                hdmi_obj_ready.store(1); /* Flag for Display Thread. */
-            }
-            img_obj_ready.store(0);
+        /* Convert output image size. */
+        img.convert_size(CAM_IMAGE_WIDTH, DRPAI_OUT_WIDTH, display_padding);
+
+        /* Convert to BGRA directly into a slot of the display ring. */
+        out_frame = display_ring.acquire_write();
+        if (NULL == out_frame)
+        {
+            capture_ring.release_read(cap_frame);
+            goto hdmi_end;
         }
-        usleep(WAIT_TIME); //wait 1 tick time
+        cv::cvtColor(img.get_mat(), *out_frame, cv::COLOR_BGR2BGRA);
+        display_ring.commit_write(out_frame);
+        capture_ring.release_read(cap_frame);
     } /*End Of Loop*/
 
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore To 0*/
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto hdmi_end;
 
 hdmi_end:
-    /*To terminate the loop in Capture Thread.*/
-    img_obj_ready.store(0);
     printf("Img Thread Terminated\n");
     pthread_exit(NULL);
 }
@@ -992,8 +1027,10 @@ void *R_Display_Thread(void *threadid)
     int32_t hdmi_sem_check = 0;
     /*Variable for checking return value*/
     int8_t ret = 0;
+    /*Frame slot taken from display_ring*/
+    cv::Mat *out_frame = NULL;
     /* Initialize waylad */
-    ret = wayland.init(IMAGE_OUTPUT_WIDTH, IMAGE_OUTPUT_HEIGHT, IMAGE_OUTPUT_CHANNEL_BGRA);
+    ret = wayland.init(IMAGE_OUTPUT_WIDTH, IMAGE_OUTPUT_HEIGHT, IMAGE_OUTPUT_CHANNEL_BGRA, true);
     if(0 != ret)
     {
         fprintf(stderr, "[ERROR] Failed to initialize Image for Wayland\n");
@@ -1016,27 +1053,32 @@ void *R_Display_Thread(void *threadid)
         {
             goto hdmi_end;
         }
-        /* Check hdmi_obj_ready flag which is set in Capture Thread. */
-        if (hdmi_obj_ready.load())
+        /* Wait for the newest image from Img Thread, NULL once the ring is closed. */
+        out_frame = display_ring.acquire_latest();
+        if (NULL == out_frame)
         {
-            /*Update Wayland*/
-            display_image = proc_image;
-            cv::cvtColor(display_image, display_image, cv::COLOR_BGR2BGRA);
-            wayland.commit(display_image.data, NULL);
-            hdmi_obj_ready.store(0);
+            goto hdmi_end;
         }
-        usleep(WAIT_TIME); //wait 1 tick timedg
+        /*Upload the regions of the overlay changed by Img Thread, if any*/
+        ret = overlay.sync(&wayland);
+        if (0 != ret)
+        {
+            fprintf(stderr, "[ERROR] Failed to update the overlay texture\n");
+            display_ring.release_read(out_frame);
+            goto err;
+        }
+        /*Update Wayland, the overlay texture is blended over the camera image*/
+        wayland.commit(out_frame->data, NULL);
+        display_ring.release_read(out_frame);
     } /*End Of Loop*/
 
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore To 0*/
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto hdmi_end;
 
 hdmi_end:
-    /*To terminate the loop in Capture Thread.*/
-    hdmi_obj_ready.store(0);
     printf("Display Thread Terminated\n");
     pthread_exit(NULL);
 }
@@ -1089,6 +1131,11 @@ void *R_Kbhit_Thread(void *threadid)
             goto key_hit_end;
         }
 
+        /* Blocks until a key is pressed or termination is requested. */
+        if (!stages.wait_readable(STDIN_FILENO))
+        {
+            continue;
+        }
         c = getchar();
         if (EOF != c)
         {
@@ -1096,17 +1143,17 @@ void *R_Kbhit_Thread(void *threadid)
             printf("[INFO] Key Detected.\n");
             goto err;
         }
-        else
+        else if (feof(stdin))
         {
-            /* When nothing is pressed. */
-            usleep(WAIT_TIME);
+            /* Standard input is closed, only termination ends the thread. */
+            stages.wait_shutdown();
         }
     }
 
 /*Error Processing*/
 err:
     /*Set Termination Request Semaphore to 0*/
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     goto key_hit_end;
 
 key_hit_end:
@@ -1146,13 +1193,13 @@ int8_t R_Main_Process()
         {
             goto main_proc_end;
         }
-        /*Wait for 1 TICK.*/
-        usleep(WAIT_TIME);
+        /*Wait for termination request.*/
+        stages.wait_shutdown();
     }
 
 /*Error Processing*/
 err:
-    sem_trywait(&terminate_req_sem);
+    stages.shutdown();
     main_ret = 1;
     goto main_proc_end;
 /*Main Processing Termination*/
@@ -1340,6 +1387,15 @@ int32_t main(int32_t argc, char * argv[])
         ret_main = ret;
         goto end_close_dmabuf;
     }
+    /*Boxes and text are drawn on the overlay at the display resolution.*/
+    ret = overlay.init(IMAGE_OUTPUT_WIDTH, IMAGE_OUTPUT_HEIGHT);
+    if (0 != ret)
+    {
+        fprintf(stderr, "[ERROR] Failed to initialize the overlay.\n");
+        ret_main = ret;
+        goto end_close_dmabuf;
+    }
+    img.set_overlay(&overlay);
 
     /*Termination Request Semaphore Initialization*/
     /*Initialized value at 1.*/
@@ -1351,6 +1407,15 @@ int32_t main(int32_t argc, char * argv[])
         goto end_threads;
     }
 
+    /*Stages and the events they hand over*/
+    stages.add_stage("capture", {}, {&inference_start});
+    stages.add_stage("inference", {&inference_start}, {});
+    stages.print();
+
+    /*Preallocate the frame slots, capture -> image -> display run at their own rates.*/
+    capture_ring.init([](cv::Mat& m) { m.create(CAM_IMAGE_HEIGHT, CAM_IMAGE_WIDTH, CV_8UC3); });
+    display_ring.init([](cv::Mat& m) { m.create(IMAGE_OUTPUT_HEIGHT, IMAGE_OUTPUT_WIDTH, CV_8UC4); });
+
     /*Create Key Hit Thread*/
     create_thread_key = pthread_create(&kbhit_thread, NULL, R_Kbhit_Thread, NULL);
     if (0 != create_thread_key)
@@ -1363,7 +1428,7 @@ int32_t main(int32_t argc, char * argv[])
     create_thread_ai = pthread_create(&ai_inf_thread, NULL, R_Inf_Thread, NULL);
     if (0 != create_thread_ai)
     {
-        sem_trywait(&terminate_req_sem);
+        stages.shutdown();
         fprintf(stderr, "[ERROR] Failed to create AI Inference Thread.\n");
         ret_main = -1;
         goto end_threads;
@@ -1372,7 +1437,7 @@ int32_t main(int32_t argc, char * argv[])
     create_thread_capture = pthread_create(&capture_thread, NULL, R_Capture_Thread, NULL);
     if (0 != create_thread_capture)
     {
-        sem_trywait(&terminate_req_sem);
+        stages.shutdown();
         fprintf(stderr, "[ERROR] Failed to create Capture Thread.\n");
         ret_main = -1;
         goto end_threads;
@@ -1381,7 +1446,7 @@ int32_t main(int32_t argc, char * argv[])
     create_thread_img = pthread_create(&img_thread, NULL, R_Img_Thread, NULL);
     if(0 != create_thread_img)
     {
-        sem_trywait(&terminate_req_sem);
+        stages.shutdown();
         fprintf(stderr, "[ERROR] Failed to create Image Thread.\n");
         ret_main = -1;
         goto end_threads;
@@ -1391,7 +1456,7 @@ int32_t main(int32_t argc, char * argv[])
     create_thread_hdmi = pthread_create(&hdmi_thread, NULL, R_Display_Thread, NULL);
     if(0 != create_thread_hdmi)
     {
-        sem_trywait(&terminate_req_sem);
+        stages.shutdown();
         fprintf(stderr, "[ERROR] Failed to create Display Thread.\n");
         ret_main = -1;
         goto end_threads;
@@ -1406,6 +1471,9 @@ int32_t main(int32_t argc, char * argv[])
     goto end_threads;
 
 end_threads:
+    /*Wake Img Thread and Display Thread waiting for a frame.*/
+    capture_ring.close();
+    display_ring.close();
     if (0 == create_thread_hdmi)
     {
         ret = wait_join(&hdmi_thread, DISPLAY_THREAD_TIMEOUT);
@@ -1452,6 +1520,10 @@ end_threads:
         }
     }
 
+    printf("[INFO] Capture ring: %llu frames, %llu dropped. Display ring: %llu frames, %llu dropped.\n",
+           (unsigned long long)capture_ring.get_published(), (unsigned long long)capture_ring.get_dropped(),
+           (unsigned long long)display_ring.get_published(), (unsigned long long)display_ring.get_dropped());
+
     /*Delete Terminate Request Semaphore.*/
     if (0 == sem_create)
     {
@@ -0,0 +1,184 @@
+/***********************************************************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only intended for use with Renesas products. No
+* other uses are authorized. This software is owned by Renesas Electronics Corporation and is protected under all
+* applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED. TO THE MAXIMUM
+* EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES
+* SHALL BE LIABLE FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR ANY REASON RELATED TO THIS
+* SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software and to discontinue the availability of
+* this software. By using this software, you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer
+*
+* Copyright (C) 2024 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : overlay_layer.cpp
+* Version      : v3.00
+* Description  : RZ/V2H AI SDK Sample Application for Object Detection
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include "overlay_layer.h"
+#include "wayland.h"
+
+OverlayLayer::OverlayLayer()
+    : width(0), height(0), back(0), generation(0), synced(0)
+{
+}
+
+OverlayLayer::~OverlayLayer()
+{
+}
+
+/*****************************************
+* Function Name : init
+* Description   : Allocates the two transparent canvases
+* Arguments     : w = overlay width, same as the display
+*                 h = overlay height, same as the display
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+uint8_t OverlayLayer::init(uint32_t w, uint32_t h)
+{
+    width = w;
+    height = h;
+    for (Buffer& buffer : buffers)
+    {
+        buffer.canvas = cv::Mat::zeros(h, w, CV_8UC4);
+        buffer.rects.clear();
+        if (buffer.canvas.empty())
+        {
+            return -1;
+        }
+    }
+    back = 0;
+    generation = 0;
+    synced = 0;
+    texture_rects.clear();
+    return 0;
+}
+
+/*****************************************
+* Function Name : begin
+* Description   : Starts a redraw of the overlay by Img Thread.
+*                 Only the rectangles drawn the last time this canvas was used are cleared.
+* Arguments     : -
+* Return value  : -
+******************************************/
+void OverlayLayer::begin()
+{
+    Buffer& buffer = buffers[back];
+    for (const cv::Rect& rect : buffer.rects)
+    {
+        buffer.canvas(rect).setTo(cv::Scalar::all(0));
+    }
+    buffer.rects.clear();
+}
+
+/*****************************************
+* Function Name : canvas
+* Description   : Canvas of the redraw started by begin()
+* Arguments     : -
+* Return value  : canvas to draw on in BGRA, mark() must be called for each region drawn
+******************************************/
+cv::Mat& OverlayLayer::canvas()
+{
+    return buffers[back].canvas;
+}
+
+/*****************************************
+* Function Name : mark
+* Description   : Records a region drawn on the canvas of begin()
+* Arguments     : rect = region drawn, clipped to the overlay
+* Return value  : -
+******************************************/
+void OverlayLayer::mark(const cv::Rect& rect)
+{
+    cv::Rect clipped = rect & cv::Rect(0, 0, width, height);
+    if (0 < clipped.area())
+    {
+        buffers[back].rects.push_back(clipped);
+    }
+}
+
+/*****************************************
+* Function Name : publish
+* Description   : Hands the canvas drawn since begin() to Display Thread
+* Arguments     : -
+* Return value  : -
+******************************************/
+void OverlayLayer::publish()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    back = 1 - back;
+    generation++;
+}
+
+/*****************************************
+* Function Name : merge_rects
+* Description   : Merges the overlapping rectangles, so that no pixel is uploaded twice
+* Arguments     : rects = rectangles, merged in place
+* Return value  : -
+******************************************/
+static void merge_rects(std::vector<cv::Rect>& rects)
+{
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (size_t i = 0; i < rects.size() && !merged; i++)
+        {
+            for (size_t j = i + 1; j < rects.size(); j++)
+            {
+                if (0 < (rects[i] & rects[j]).area())
+                {
+                    rects[i] |= rects[j];
+                    rects.erase(rects.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/*****************************************
+* Function Name : sync
+* Description   : Uploads the published overlay to the overlay texture by Display Thread, if it changed.
+*                 Only the rectangles of the texture content and of the new content are uploaded.
+* Arguments     : wayland = display owning the overlay texture, in the GL context of the calling thread
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+uint8_t OverlayLayer::sync(Wayland* wayland)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (generation == synced)
+    {
+        return 0;
+    }
+    const Buffer& front = buffers[1 - back];
+    /* The old content is overwritten by transparent pixels of the new canvas */
+    std::vector<cv::Rect> rects = texture_rects;
+    rects.insert(rects.end(), front.rects.begin(), front.rects.end());
+    merge_rects(rects);
+    for (const cv::Rect& rect : rects)
+    {
+        /* The texture upload takes packed rows */
+        front.canvas(rect).copyTo(upload_buf);
+        if (0 != wayland->update_overlay(upload_buf.data, rect.x, rect.y, rect.width, rect.height))
+        {
+            return -1;
+        }
+    }
+    texture_rects = front.rects;
+    synced = generation;
+    return 0;
+}
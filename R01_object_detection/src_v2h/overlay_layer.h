@@ -0,0 +1,79 @@
+/***********************************************************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only intended for use with Renesas products. No
+* other uses are authorized. This software is owned by Renesas Electronics Corporation and is protected under all
+* applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED. TO THE MAXIMUM
+* EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES
+* SHALL BE LIABLE FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR ANY REASON RELATED TO THIS
+* SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software and to discontinue the availability of
+* this software. By using this software, you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer
+*
+* Copyright (C) 2024 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : overlay_layer.h
+* Version      : v3.00
+* Description  : RZ/V2H AI SDK Sample Application for Object Detection
+*                Retained BGRA layer of the bounding boxes and text, blended over the camera image by the GPU.
+*                Img Thread redraws it only when the results change, and only the regions drawn before and after
+*                are cleared and uploaded to the overlay texture by Display Thread.
+***********************************************************************************************************************/
+
+#ifndef OVERLAY_LAYER_H
+#define OVERLAY_LAYER_H
+
+#include "define.h"
+#include <mutex>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+class Wayland;
+
+class OverlayLayer
+{
+    public:
+        OverlayLayer();
+        ~OverlayLayer();
+
+        uint8_t init(uint32_t w, uint32_t h);
+
+        /* Img Thread */
+        void begin();
+        cv::Mat& canvas();
+        void mark(const cv::Rect& rect);
+        void publish();
+
+        /* Display Thread */
+        uint8_t sync(Wayland* wayland);
+
+    private:
+        /*****************************************
+        * Buffer : Canvas, transparent outside of the rectangles drawn on it
+        ******************************************/
+        typedef struct
+        {
+            cv::Mat canvas;
+            std::vector<cv::Rect> rects;
+        } Buffer;
+
+        uint32_t width;
+        uint32_t height;
+        Buffer buffers[2];
+        /* Buffer drawn by Img Thread, the other one is published */
+        uint32_t back;
+        uint32_t generation;
+        /* Generation and rectangles of the overlay texture, Display Thread only */
+        uint32_t synced;
+        std::vector<cv::Rect> texture_rects;
+        /* Packed pixels of a rectangle to be uploaded */
+        cv::Mat upload_buf;
+        std::mutex mtx;
+};
+
+#endif
@@ -20,6 +20,7 @@
 #include <iostream>
 #include <chrono>
 #include <fstream>
+#include <vector>
 
 
 struct WaylandGlobals {
@@ -349,6 +350,10 @@ uint8_t Wayland::init(uint32_t w, uint32_t h, uint32_t c, bool overlay)
     if (img_overlay == true){
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        // allocate the overlay texture once, transparent until update_overlay()
+        std::vector<uint8_t> transparent(img_w * img_h * img_c, 0);
+        setupTexture(textures[1], transparent.data());
+        ol_ready = false;
     }
 
     glUniform1i(glGetUniformLocation(sShader.unProgram, "texture"), 0);
@@ -434,10 +439,36 @@ uint8_t Wayland::setupTexture(GLuint texID, uint8_t* src_pixels)
 }
 
 
+/*****************************************
+ * Function Name : update_overlay
+ * Description   : Update a region of the overlay texture allocated by init(overlay = true).
+ *                 The texture keeps its content between the commits.
+ * Arguments     : pixels = BGRA pixels of the region, rows packed
+ *                 x = left of the region
+ *                 y = top of the region
+ *                 w = width of the region
+ *                 h = height of the region
+ * Return value  : 0 if Success
+ *                 not 0 otherwise
+ ******************************************/
+uint8_t Wayland::update_overlay(const uint8_t* pixels, uint32_t x, uint32_t y, uint32_t w, uint32_t h)
+{
+    if (img_overlay == false || img_w < x + w || img_h < y + h)
+    {
+        return -1;
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, textures[1]);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, w, h, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    ol_ready = true;
+    return 0;
+}
+
 /*****************************************
  * Function Name : commit
  * Description   : Commit to update the display image
- * Arguments     : buf_id = buffer id
+ * Arguments     : cam_buffer = camera image in BGRA
+ *                 ol_buffer  = full overlay image in BGRA, NULL to keep the overlay texture
  * Return value  : 0 if Success
  *                 not 0 otherwise
  ******************************************/
@@ -472,7 +503,7 @@ uint8_t Wayland::commit(uint8_t* cam_buffer, uint8_t* ol_buffer)
 
     // render
     render(&sShader, textures[0]);
-    if (ol_buffer != NULL && img_overlay == true) {
+    if ((ol_buffer != NULL || ol_ready == true) && img_overlay == true) {
         render(&sShader, textures[1]);
     }
 #ifdef DEBUG_TIME_FLG
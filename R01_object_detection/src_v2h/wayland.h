@@ -32,6 +32,7 @@ class Wayland
         uint8_t init(uint32_t w, uint32_t h, uint32_t c, bool overlay = false);
         uint8_t exit();
         uint8_t commit(uint8_t* cam_buffer, uint8_t* ol_buffer);
+        uint8_t update_overlay(const uint8_t* pixels, uint32_t x, uint32_t y, uint32_t w, uint32_t h);
 
         struct wl_compositor *compositor = NULL;
         struct wl_shm *shm = NULL;
@@ -41,6 +42,8 @@ class Wayland
         uint32_t img_w;
         uint32_t img_c;
         bool     img_overlay;
+        /* Overlay texture updated by update_overlay() */
+        bool     ol_ready = false;
 
         struct wl_display *display = NULL;
         struct wl_surface *surface;
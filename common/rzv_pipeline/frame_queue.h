@@ -0,0 +1,225 @@
+/***********************************************************************************************************************
+ * Copyright 2024 Renesas Electronics Corporation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ***********************************************************************************************************************/
+/***********************************************************************************************************************
+ * File Name    : frame_queue.h
+ * Version      : 1.0
+ * Description  : Bounded frame queue between the capture thread and the processing thread. Frames are read into a
+ *                pool of preallocated cv::Mat buffers and passed by pointer; when the queue is full the oldest or the
+ *                newest frame is dropped (or the producer waits), so memory and latency stay bounded.
+ ***********************************************************************************************************************/
+#ifndef FRAME_QUEUE_H
+#define FRAME_QUEUE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "opencv2/core.hpp"
+
+/* What push() does when the queue already holds capacity frames */
+enum FrameQueuePolicy
+{
+    FRAME_QUEUE_DROP_OLDEST = 0,    /* discard the oldest queued frame */
+    FRAME_QUEUE_DROP_NEWEST = 1,    /* discard the frame being pushed */
+    FRAME_QUEUE_BLOCK       = 2     /* wait until the consumer pops a frame */
+};
+
+class FrameQueue
+{
+public:
+    /*****************************************
+     * Function Name : FrameQueue
+     * Description   : Creates the queue and its buffer pool. The pool holds capacity queued frames plus the one
+     *                 being filled by the producer and the one held by the consumer.
+     * Arguments     : capacity = maximum number of queued frames, at least 1
+     *                 policy   = behaviour of push() on a full queue
+     ******************************************/
+    FrameQueue(size_t capacity, FrameQueuePolicy policy)
+        : capacity(capacity < 1 ? 1 : capacity), policy(policy), pool(this->capacity + 2),
+          closed(false), enqueued(0), dropped(0), high_water(0)
+    {
+        for (cv::Mat &m : pool)
+        {
+            free_list.push_back(&m);
+        }
+    }
+
+    FrameQueue(const FrameQueue &) = delete;
+    FrameQueue &operator=(const FrameQueue &) = delete;
+
+    /*****************************************
+     * Function Name : allocate
+     * Description   : Preallocates every pool buffer, so that reading a frame of that size does not allocate.
+     * Arguments     : rows, cols, type = frame geometry, e.g. 480, 640, CV_8UC3
+     ******************************************/
+    void allocate(int rows, int cols, int type)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (cv::Mat &m : pool)
+        {
+            m.create(rows, cols, type);
+        }
+    }
+
+    /*****************************************
+     * Function Name : acquire
+     * Description   : Producer: takes a free buffer to read the next frame into.
+     * Return value  : buffer, NULL if the queue is closed
+     ******************************************/
+    cv::Mat *acquire(void)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        /* With FRAME_QUEUE_BLOCK the producer also waits here, after its last push filled the queue */
+        cv_space.wait(lock, [this] { return closed || !free_list.empty(); });
+        if (closed)
+        {
+            return NULL;
+        }
+        cv::Mat *m = free_list.back();
+        free_list.pop_back();
+        return m;
+    }
+
+    /*****************************************
+     * Function Name : cancel
+     * Description   : Producer: gives back a buffer from acquire() without queueing it.
+     * Arguments     : m = buffer
+     ******************************************/
+    void cancel(cv::Mat *m)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        free_list.push_back(m);
+        cv_space.notify_one();
+    }
+
+    /*****************************************
+     * Function Name : push
+     * Description   : Producer: queues a buffer from acquire(), applying the policy when the queue is full.
+     * Arguments     : m = buffer holding the frame
+     ******************************************/
+    void push(cv::Mat *m)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (FRAME_QUEUE_BLOCK == policy)
+        {
+            cv_space.wait(lock, [this] { return closed || queue.size() < capacity; });
+        }
+        if (closed)
+        {
+            free_list.push_back(m);
+            return;
+        }
+        if (queue.size() >= capacity)
+        {
+            dropped++;
+            if (FRAME_QUEUE_DROP_NEWEST == policy)
+            {
+                free_list.push_back(m);
+                return;
+            }
+            free_list.push_back(queue.front());
+            queue.pop_front();
+        }
+        queue.push_back(m);
+        enqueued++;
+        if (queue.size() > high_water)
+        {
+            high_water = queue.size();
+        }
+        cv_frame.notify_one();
+    }
+
+    /*****************************************
+     * Function Name : pop
+     * Description   : Consumer: waits for the oldest queued frame. Queued frames are still returned after close().
+     * Return value  : buffer, to be given back with release(); NULL once the queue is closed and empty
+     ******************************************/
+    cv::Mat *pop(void)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv_frame.wait(lock, [this] { return closed || !queue.empty(); });
+        if (queue.empty())
+        {
+            return NULL;
+        }
+        cv::Mat *m = queue.front();
+        queue.pop_front();
+        cv_space.notify_one();
+        return m;
+    }
+
+    /*****************************************
+     * Function Name : release
+     * Description   : Consumer: gives back a buffer from pop().
+     * Arguments     : m = buffer
+     ******************************************/
+    void release(cv::Mat *m)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        free_list.push_back(m);
+        cv_space.notify_one();
+    }
+
+    /*****************************************
+     * Function Name : close
+     * Description   : Ends the stream: wakes both threads, acquire() returns NULL, pop() drains then returns NULL.
+     ******************************************/
+    void close(void)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+        cv_frame.notify_all();
+        cv_space.notify_all();
+    }
+
+    /* Frames queued by push() */
+    uint64_t get_enqueued(void)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return enqueued;
+    }
+
+    /* Frames discarded by the drop policy */
+    uint64_t get_dropped(void)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return dropped;
+    }
+
+    /* Largest number of frames that were queued at once */
+    size_t get_high_water(void)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return high_water;
+    }
+
+private:
+    const size_t capacity;
+    const FrameQueuePolicy policy;
+    std::vector<cv::Mat> pool;
+    std::vector<cv::Mat *> free_list;
+    std::deque<cv::Mat *> queue;
+    bool closed;
+    uint64_t enqueued;
+    uint64_t dropped;
+    size_t high_water;
+    std::mutex mtx;
+    std::condition_variable cv_frame;
+    std::condition_variable cv_space;
+};
+
+#endif
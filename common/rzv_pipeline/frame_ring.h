@@ -0,0 +1,362 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : frame_ring.h
+* Version      : v1.00
+* Description  : Bounded single-producer / single-consumer ring of preallocated frame slots. The producer fills a slot
+*                in place and publishes it, the consumer gets a reference to the oldest (or newest) published slot and
+*                gives it back when done, so frames move between threads without being copied.
+*                Each slot is FREE -> WRITING -> READY -> READING -> FREE; the transitions are atomic with
+*                acquire/release ordering, the mutex is only taken by a thread that has to sleep.
+*                The producer and the consumer hold at most one slot each at a time.
+***********************************************************************************************************************/
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/* What the producer does when depth frames are already waiting for the consumer */
+enum FrameRingPolicy
+{
+    FRAME_RING_LATEST_WINS = 0, /* overwrite the oldest waiting frame, counted as dropped */
+    FRAME_RING_BLOCKING    = 1  /* wait until the consumer takes a frame */
+};
+
+template <typename T>
+class FrameRing
+{
+    public:
+        /*****************************************
+        * Function Name : FrameRing
+        * Description   : Allocates the slots. depth frames can wait for the consumer, plus one slot held by the
+        *                 producer and one held by the consumer.
+        * Arguments     : depth  = frames that can be published and not yet taken, at least 1
+        *                 policy = producer behaviour when depth frames are waiting
+        ******************************************/
+        FrameRing(uint32_t depth, FrameRingPolicy policy)
+            : depth(depth < 1 ? 1 : depth), policy(policy), slots(this->depth + 2), next_seq(0),
+              ready_count(0), published(0), dropped(0), waiters(0), closed(false)
+        {
+            for (Slot& s : slots)
+            {
+                s.state.store(SLOT_FREE);
+                s.seq.store(0);
+            }
+        }
+
+        FrameRing(const FrameRing&) = delete;
+        FrameRing& operator=(const FrameRing&) = delete;
+
+        /*****************************************
+        * Function Name : init
+        * Description   : Preallocates every slot, e.g. [](cv::Mat& m) { m.create(h, w, CV_8UC3); }
+        * Arguments     : alloc = called once per slot
+        * Return value  : -
+        ******************************************/
+        template <typename F>
+        void init(F alloc)
+        {
+            for (Slot& s : slots)
+            {
+                alloc(s.frame);
+            }
+        }
+
+        /*****************************************
+        * Function Name : acquire_write
+        * Description   : Producer: takes a slot to fill. With FRAME_RING_BLOCKING it waits while the ring is full.
+        * Arguments     : -
+        * Return value  : slot to fill, NULL if the ring is closed
+        ******************************************/
+        T *acquire_write()
+        {
+            while (!closed.load())
+            {
+                if (ready_count.load() < (int32_t)depth)
+                {
+                    /* At most depth - 1 ready and one reading slot: a free slot exists */
+                    for (Slot& s : slots)
+                    {
+                        uint32_t expected = SLOT_FREE;
+                        if (s.state.compare_exchange_strong(expected, SLOT_WRITING, std::memory_order_acquire))
+                        {
+                            return &s.frame;
+                        }
+                    }
+                }
+                else if (FRAME_RING_LATEST_WINS == policy)
+                {
+                    /* Reclaim the oldest frame the consumer has not taken yet */
+                    Slot *oldest = find_ready(true);
+                    if (NULL != oldest)
+                    {
+                        uint32_t expected = SLOT_READY;
+                        if (oldest->state.compare_exchange_strong(expected, SLOT_WRITING, std::memory_order_acquire))
+                        {
+                            ready_count.fetch_sub(1);
+                            dropped.fetch_add(1);
+                            return &oldest->frame;
+                        }
+                    }
+                }
+                else
+                {
+                    wait([this] { return ready_count.load() < (int32_t)depth; });
+                }
+            }
+            return NULL;
+        }
+
+        /*****************************************
+        * Function Name : commit_write
+        * Description   : Producer: publishes a slot returned by acquire_write
+        * Arguments     : frame = slot to publish
+        * Return value  : -
+        ******************************************/
+        void commit_write(T *frame)
+        {
+            Slot *s = slot_of(frame);
+            s->seq.store(next_seq++, std::memory_order_relaxed);
+            ready_count.fetch_add(1);
+            s->state.store(SLOT_READY, std::memory_order_release);
+            published.fetch_add(1);
+            wake();
+        }
+
+        /*****************************************
+        * Function Name : cancel_write
+        * Description   : Producer: gives back a slot returned by acquire_write without publishing it
+        * Arguments     : frame = slot to give back
+        * Return value  : -
+        ******************************************/
+        void cancel_write(T *frame)
+        {
+            slot_of(frame)->state.store(SLOT_FREE, std::memory_order_release);
+        }
+
+        /*****************************************
+        * Function Name : acquire_read
+        * Description   : Consumer: takes the oldest published slot, waiting for one if wait is set
+        * Arguments     : wait = block until a slot is published or the ring is closed
+        * Return value  : slot to read, NULL if there is none or the ring is closed
+        ******************************************/
+        T *acquire_read(bool wait = true)
+        {
+            return take(wait, false);
+        }
+
+        /*****************************************
+        * Function Name : acquire_latest
+        * Description   : Consumer: takes the newest published slot, older ones are freed and counted as dropped
+        * Arguments     : wait = block until a slot is published or the ring is closed
+        * Return value  : slot to read, NULL if there is none or the ring is closed
+        ******************************************/
+        T *acquire_latest(bool wait = true)
+        {
+            return take(wait, true);
+        }
+
+        /*****************************************
+        * Function Name : release_read
+        * Description   : Consumer: gives back a slot returned by acquire_read / acquire_latest
+        * Arguments     : frame = slot to give back
+        * Return value  : -
+        ******************************************/
+        void release_read(T *frame)
+        {
+            slot_of(frame)->state.store(SLOT_FREE, std::memory_order_release);
+            wake();
+        }
+
+        /*****************************************
+        * Function Name : close
+        * Description   : Wakes both sides, acquire calls return NULL from now on
+        * Arguments     : -
+        * Return value  : -
+        ******************************************/
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                closed.store(true);
+            }
+            cv.notify_all();
+        }
+
+        uint32_t get_depth() const
+        {
+            return depth;
+        }
+
+        /* Frames published by the producer */
+        uint64_t get_published() const
+        {
+            return published.load();
+        }
+
+        /* Published frames that were overwritten or skipped before the consumer read them */
+        uint64_t get_dropped() const
+        {
+            return dropped.load();
+        }
+
+    private:
+        enum
+        {
+            SLOT_FREE    = 0,
+            SLOT_WRITING = 1,
+            SLOT_READY   = 2,
+            SLOT_READING = 3
+        };
+
+        struct Slot
+        {
+            std::atomic<uint32_t> state;
+            std::atomic<uint64_t> seq;
+            T frame;
+        };
+
+        Slot *slot_of(T *frame)
+        {
+            for (Slot& s : slots)
+            {
+                if (&s.frame == frame)
+                {
+                    return &s;
+                }
+            }
+            return NULL;
+        }
+
+        /* Ready slot with the lowest (oldest) or highest (newest) sequence number */
+        Slot *find_ready(bool oldest)
+        {
+            Slot *found = NULL;
+            uint64_t found_seq = 0;
+            for (Slot& s : slots)
+            {
+                if (SLOT_READY != s.state.load(std::memory_order_acquire))
+                {
+                    continue;
+                }
+                uint64_t seq = s.seq.load(std::memory_order_relaxed);
+                if (NULL == found || (oldest ? (seq < found_seq) : (seq > found_seq)))
+                {
+                    found = &s;
+                    found_seq = seq;
+                }
+            }
+            return found;
+        }
+
+        T *take(bool block, bool newest)
+        {
+            while (!closed.load())
+            {
+                Slot *s = find_ready(!newest);
+                if (NULL != s)
+                {
+                    uint32_t expected = SLOT_READY;
+                    if (!s->state.compare_exchange_strong(expected, SLOT_READING, std::memory_order_acquire))
+                    {
+                        /* Reclaimed by the producer in the meantime */
+                        continue;
+                    }
+                    ready_count.fetch_sub(1);
+                    if (newest)
+                    {
+                        skip_older(s->seq.load(std::memory_order_relaxed));
+                    }
+                    wake();
+                    return &s->frame;
+                }
+                if (!block)
+                {
+                    return NULL;
+                }
+                wait([this] { return NULL != find_ready(true); });
+            }
+            return NULL;
+        }
+
+        /* Frees the ready slots published before seq */
+        void skip_older(uint64_t seq)
+        {
+            for (Slot& s : slots)
+            {
+                /* Claim the slot first: the producer may reclaim and republish it between a check and a CAS */
+                uint32_t expected = SLOT_READY;
+                if (!s.state.compare_exchange_strong(expected, SLOT_READING, std::memory_order_acquire))
+                {
+                    continue;
+                }
+                if (s.seq.load(std::memory_order_relaxed) < seq)
+                {
+                    ready_count.fetch_sub(1);
+                    dropped.fetch_add(1);
+                    s.state.store(SLOT_FREE, std::memory_order_release);
+                }
+                else
+                {
+                    s.state.store(SLOT_READY, std::memory_order_release);
+                }
+            }
+        }
+
+        /* Sleeps until pred holds or the ring is closed. A waker changes a slot state and then checks waiters,
+           the sleeper registers in waiters and then checks pred: one of the two sees the other. */
+        template <typename Pred>
+        void wait(Pred pred)
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            waiters.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            cv.wait(lock, [&] { return pred() || closed.load(); });
+            waiters.fetch_sub(1);
+        }
+
+        void wake()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (0 < waiters.load())
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                }
+                cv.notify_all();
+            }
+        }
+
+        const uint32_t depth;
+        const FrameRingPolicy policy;
+        std::vector<Slot> slots;
+        /* written by the producer only */
+        uint64_t next_seq;
+        std::atomic<int32_t> ready_count;
+        std::atomic<uint64_t> published;
+        std::atomic<uint64_t> dropped;
+        std::atomic<int32_t> waiters;
+        std::atomic<bool> closed;
+        std::mutex mtx;
+        std::condition_variable cv;
+};
+
+#endif
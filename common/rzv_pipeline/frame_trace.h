@@ -0,0 +1,275 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : frame_trace.h
+* Version      : v1.00
+* Description  : Per-frame latency tracing. Each camera frame gets an ID and CLOCK_MONOTONIC timestamps at the points
+*                it goes through, from the dequeue of the capture buffer (or its kernel capture timestamp, when the
+*                FrameSource gives it) to the display commit. LatencyTracer keeps the last samples of each segment
+*                and prints their p50/p95/p99, and can write one CSV line per inference result shown:
+*                    requeue        : dequeue or capture -> capture thread done with the frame
+*                    wait_inference : dequeue -> pre-process start, the frame waits for the AI Inference Thread
+*                    pre, ai, post  : pre-process, DRP-AI run, post-process
+*                    wait_display   : post-process end -> overlay start of the first frame showing the result
+*                    overlay        : overlay start -> display commit start
+*                    commit         : display commit
+*                    image_total    : dequeue -> display commit end of the camera frame itself
+*                    result_total   : dequeue -> display commit end of the first frame showing its result
+***********************************************************************************************************************/
+
+#ifndef FRAME_TRACE_H
+#define FRAME_TRACE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum TracePoint
+{
+    TRACE_DEQUEUE,
+    TRACE_PRE_START,
+    TRACE_AI_START,
+    TRACE_POST_START,
+    TRACE_POST_END,
+    TRACE_OVERLAY_START,
+    TRACE_COMMIT_START,
+    TRACE_COMMIT_END,
+    TRACE_POINTS
+};
+
+enum TraceSegment
+{
+    SEG_REQUEUE,
+    SEG_WAIT_INFERENCE,
+    SEG_PRE,
+    SEG_AI,
+    SEG_POST,
+    SEG_WAIT_DISPLAY,
+    SEG_OVERLAY,
+    SEG_COMMIT,
+    SEG_IMAGE_TOTAL,
+    SEG_RESULT_TOTAL,
+    TRACE_SEGMENTS
+};
+
+/* ID and timestamps of one camera frame [ms], 0 for the points it did not go through */
+struct FrameTrace
+{
+    uint64_t id = 0;
+    int32_t stream = 0;
+    double t[TRACE_POINTS] = {};
+
+    static double now_ms()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+    }
+
+    void stamp(TracePoint point)
+    {
+        t[point] = now_ms();
+    }
+};
+
+class LatencyTracer
+{
+    public:
+        /* capacity = samples kept per segment for the percentiles */
+        explicit LatencyTracer(size_t capacity = 4096)
+            : capacity(std::max<size_t>(1, capacity)), ids(0), file(NULL)
+        {
+            for (Samples& s : samples)
+            {
+                s.values.assign(this->capacity, 0.0f);
+            }
+        }
+
+        ~LatencyTracer()
+        {
+            close_file();
+        }
+
+        LatencyTracer(const LatencyTracer&) = delete;
+        LatencyTracer& operator=(const LatencyTracer&) = delete;
+
+        /* Starts the trace of a frame captured at capture_ms, 0 if the frame was just dequeued */
+        FrameTrace begin(int32_t stream = 0, double capture_ms = 0)
+        {
+            FrameTrace trace;
+            trace.id = ids++;
+            trace.stream = stream;
+            trace.stamp(TRACE_DEQUEUE);
+            if (0 < capture_ms)
+            {
+                trace.t[TRACE_DEQUEUE] = capture_ms;
+            }
+            return trace;
+        }
+
+        void add(TraceSegment segment, double ms)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            add_locked(segment, ms);
+        }
+
+        /*****************************************
+        * Function Name : record_display
+        * Description   : Records a frame committed to the display and, when it is the first frame showing an
+        *                 inference result, the path of the inferred frame
+        * Arguments     : image  = trace of the displayed frame, stamped up to TRACE_COMMIT_END
+        *                 result = trace of the inferred frame whose result is drawn for the first time, or NULL.
+        *                          Its overlay and commit points are taken from image.
+        * Return value  : -
+        ******************************************/
+        void record_display(const FrameTrace& image, const FrameTrace *result)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            add_locked(SEG_OVERLAY, image.t[TRACE_COMMIT_START] - image.t[TRACE_OVERLAY_START]);
+            add_locked(SEG_COMMIT, image.t[TRACE_COMMIT_END] - image.t[TRACE_COMMIT_START]);
+            add_locked(SEG_IMAGE_TOTAL, image.t[TRACE_COMMIT_END] - image.t[TRACE_DEQUEUE]);
+            if (NULL == result)
+            {
+                return;
+            }
+            FrameTrace r = *result;
+            r.t[TRACE_OVERLAY_START] = image.t[TRACE_OVERLAY_START];
+            r.t[TRACE_COMMIT_START] = image.t[TRACE_COMMIT_START];
+            r.t[TRACE_COMMIT_END] = image.t[TRACE_COMMIT_END];
+            add_locked(SEG_WAIT_INFERENCE, r.t[TRACE_PRE_START] - r.t[TRACE_DEQUEUE]);
+            add_locked(SEG_PRE, r.t[TRACE_AI_START] - r.t[TRACE_PRE_START]);
+            add_locked(SEG_AI, r.t[TRACE_POST_START] - r.t[TRACE_AI_START]);
+            add_locked(SEG_POST, r.t[TRACE_POST_END] - r.t[TRACE_POST_START]);
+            add_locked(SEG_WAIT_DISPLAY, r.t[TRACE_OVERLAY_START] - r.t[TRACE_POST_END]);
+            add_locked(SEG_RESULT_TOTAL, r.t[TRACE_COMMIT_END] - r.t[TRACE_DEQUEUE]);
+            if (NULL != file)
+            {
+                fprintf(file, "%llu,%d,%llu", (unsigned long long)r.id, r.stream, (unsigned long long)image.id);
+                for (int32_t i = 0; i < TRACE_POINTS; i++)
+                {
+                    fprintf(file, ",%.3f", r.t[i]);
+                }
+                fprintf(file, "\n");
+            }
+        }
+
+        /*****************************************
+        * Function Name : open_file
+        * Description   : Writes one CSV line per inference result shown to path: frame ID, stream, ID of the
+        *                 displayed frame and the timestamps of the frame [ms]
+        * Arguments     : path = CSV file
+        * Return value  : 0 if succeeded
+        *                 not 0 otherwise
+        ******************************************/
+        int8_t open_file(const std::string& path)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (NULL != file)
+            {
+                fclose(file);
+            }
+            file = fopen(path.c_str(), "w");
+            if (NULL == file)
+            {
+                fprintf(stderr, "[ERROR] Failed to open trace file %s.\n", path.c_str());
+                return -1;
+            }
+            fprintf(file, "frame,stream,display_frame,dequeue,pre_start,ai_start,post_start,post_end,"
+                          "overlay_start,commit_start,commit_end\n");
+            return 0;
+        }
+
+        void close_file()
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (NULL != file)
+            {
+                fclose(file);
+                file = NULL;
+            }
+        }
+
+        /* Prints the percentiles of each segment over the kept samples, and the maximum since the start */
+        void print() const
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            printf("[INFO] Frame latency [ms], %llu frames, percentiles of the last %zu samples\n",
+                   (unsigned long long)ids.load(), capacity);
+            printf("[INFO]   %-15s %8s %8s %8s %8s %8s\n", "segment", "samples", "p50", "p95", "p99", "max");
+            std::vector<float> sorted;
+            for (int32_t i = 0; i < TRACE_SEGMENTS; i++)
+            {
+                const Samples& s = samples[i];
+                if (0 == s.count)
+                {
+                    continue;
+                }
+                size_t n = (size_t)std::min<uint64_t>(s.count, capacity);
+                sorted.assign(s.values.begin(), s.values.begin() + n);
+                std::sort(sorted.begin(), sorted.end());
+                printf("[INFO]   %-15s %8llu %8.1f %8.1f %8.1f %8.1f\n", segment_name((TraceSegment)i),
+                       (unsigned long long)s.count, percentile(sorted, 50), percentile(sorted, 95),
+                       percentile(sorted, 99), s.max);
+            }
+        }
+
+        static const char *segment_name(TraceSegment segment)
+        {
+            static const char *names[TRACE_SEGMENTS] =
+            {
+                "requeue", "wait_inference", "pre", "ai", "post", "wait_display", "overlay", "commit",
+                "image_total", "result_total"
+            };
+            return names[segment];
+        }
+
+    private:
+        struct Samples
+        {
+            /* ring of the last capacity samples */
+            std::vector<float> values;
+            uint64_t count = 0;
+            double max = 0;
+        };
+
+        void add_locked(TraceSegment segment, double ms)
+        {
+            Samples& s = samples[segment];
+            s.values[s.count % capacity] = (float)ms;
+            s.count++;
+            s.max = std::max(s.max, ms);
+        }
+
+        /* Nearest rank percentile of sorted samples */
+        static double percentile(const std::vector<float>& sorted, int32_t p)
+        {
+            size_t rank = (sorted.size() * p + 99) / 100;
+            return sorted[std::max<size_t>(1, rank) - 1];
+        }
+
+        size_t capacity;
+        std::atomic<uint64_t> ids;
+        Samples samples[TRACE_SEGMENTS];
+        FILE *file;
+        mutable std::mutex mtx;
+};
+
+#endif
@@ -0,0 +1,204 @@
+/***********************************************************************************************************************
+* DISCLAIMER
+* This software is supplied by Renesas Electronics Corporation and is only intended for use with Renesas products. No
+* other uses are authorized. This software is owned by Renesas Electronics Corporation and is protected under all
+* applicable laws, including copyright laws.
+* THIS SOFTWARE IS PROVIDED "AS IS" AND RENESAS MAKES NO WARRANTIES REGARDING
+* THIS SOFTWARE, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING BUT NOT LIMITED TO WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT. ALL SUCH WARRANTIES ARE EXPRESSLY DISCLAIMED. TO THE MAXIMUM
+* EXTENT PERMITTED NOT PROHIBITED BY LAW, NEITHER RENESAS ELECTRONICS CORPORATION NOR ANY OF ITS AFFILIATED COMPANIES
+* SHALL BE LIABLE FOR ANY DIRECT, INDIRECT, SPECIAL, INCIDENTAL OR CONSEQUENTIAL DAMAGES FOR ANY REASON RELATED TO THIS
+* SOFTWARE, EVEN IF RENESAS OR ITS AFFILIATES HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH DAMAGES.
+* Renesas reserves the right, without notice, to make changes to this software and to discontinue the availability of
+* this software. By using this software, you agree to the additional terms and conditions found by accessing the
+* following link:
+* http://www.renesas.com/disclaimer
+*
+* Copyright (C) 2024 Renesas Electronics Corporation. All rights reserved.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : inference_pipeline.h
+* Version      : 1.0
+* Description  : Frame slots passed between the pre-process, DRP-AI inference and post-process stages, so that
+*                frame N+1 is pre-processed while frame N runs on DRP-AI and frame N-1 is post-processed.
+***********************************************************************************************************************/
+
+#pragma once
+#ifndef INFERENCE_PIPELINE_H
+#define INFERENCE_PIPELINE_H
+
+/*****************************************
+* Includes
+******************************************/
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "opencv2/core.hpp"
+
+/* Pipeline depth used when the config.ini file has no [pipeline] section */
+#define PIPELINE_DEFAULT_DEPTH      (1)
+/* Frames in flight with one per stage */
+#define PIPELINE_MAX_DEPTH          (3)
+
+enum PipelineStage
+{
+    PIPELINE_PRE        = 0,
+    PIPELINE_INFERENCE  = 1,
+    PIPELINE_POST       = 2,
+    PIPELINE_STAGE_NUM  = 3
+};
+
+/**
+ * @brief PipelineSlot
+ * @details One frame in flight. The pre-process stage fills it, the inference stage adds the DRP-AI output
+ * @details and the post-process stage displays it before the slot is reused.
+ */
+struct PipelineSlot
+{
+    /* BGR frame converted from the camera image, drawn and displayed by the post-process stage */
+    cv::Mat image;
+    /* DRP-AI TVM input, copied from the pre-processing runtime output buffer */
+    std::vector<float> input;
+    /* DRP-AI TVM output converted to FP32 */
+    std::shared_ptr<float> output;
+    /* false when the detector is skipped on this frame */
+    bool detect;
+    /* pre-process start time [ms], for the inference time shown on the display */
+    long int start_ms;
+    float preproc_time_ms;
+    float inf_time_ms;
+};
+
+class InferencePipeline
+{
+public:
+    /**
+     * @brief init
+     * @details Allocates the slots, all of them are given to the pre-process stage.
+     * @param depth frames in flight, 1 runs the stages one after the other
+     * @param out_size number of floats of the DRP-AI output
+     */
+    void init(int32_t depth, int32_t out_size)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        slots.resize(depth);
+        for (PipelineSlot &slot : slots)
+        {
+            slot.output.reset(new float[out_size], std::default_delete<float[]>());
+            slot.detect = true;
+            queue[PIPELINE_PRE].push_back(&slot);
+        }
+    }
+
+    /**
+     * @brief get
+     * @details Waits for the next slot of a stage, slots come in frame order.
+     * @param stage stage asking for a slot
+     * @return PipelineSlot* slot, NULL once the stage is closed and no slot is left for it
+     */
+    PipelineSlot *get(PipelineStage stage)
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this, stage] { return closed[stage] || !queue[stage].empty(); });
+        /* The pre-process stage stops at once, the other stages finish the frames already in flight */
+        if (queue[stage].empty() || (PIPELINE_PRE == stage && closed[stage]))
+        {
+            return NULL;
+        }
+        PipelineSlot *slot = queue[stage].front();
+        queue[stage].pop_front();
+        return slot;
+    }
+
+    /**
+     * @brief put
+     * @details Hands a slot over to the next stage, the post-process stage gives it back to the pre-process stage.
+     * @param stage stage that is done with the slot
+     * @param slot slot from get()
+     */
+    void put(PipelineStage stage, PipelineSlot *slot)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            queue[(stage + 1) % PIPELINE_STAGE_NUM].push_back(slot);
+        }
+        cv.notify_all();
+    }
+
+    /**
+     * @brief add_time
+     * @details Adds the time a stage spent on one frame to the stage counters.
+     * @param stage stage that processed the frame
+     * @param time_ms processing time [ms]
+     */
+    void add_time(PipelineStage stage, float time_ms)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        busy_ms[stage] += time_ms;
+        frames[stage]++;
+    }
+
+    /**
+     * @brief close
+     * @details Ends a stage input: get() of that stage returns NULL once its queue is empty.
+     * @param stage stage to close
+     */
+    void close(PipelineStage stage)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            closed[stage] = true;
+        }
+        cv.notify_all();
+    }
+
+    /**
+     * @brief close_all
+     * @details Ends every stage, at application exit.
+     */
+    void close_all()
+    {
+        for (int32_t i = 0; i < PIPELINE_STAGE_NUM; i++)
+        {
+            close((PipelineStage)i);
+        }
+    }
+
+    /**
+     * @brief take_stats
+     * @details Average time of a stage since the previous call, the counters are reset.
+     * @param stage stage to read
+     * @param[out] avg_ms average time per frame [ms]
+     * @return int32_t number of frames
+     */
+    int32_t take_stats(PipelineStage stage, float &avg_ms)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        int32_t count = frames[stage];
+        avg_ms = (0 < count) ? (float)(busy_ms[stage] / count) : 0;
+        busy_ms[stage] = 0;
+        frames[stage] = 0;
+        return count;
+    }
+
+    int32_t get_depth()
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return (int32_t)slots.size();
+    }
+
+private:
+    std::vector<PipelineSlot> slots;
+    /* slots waiting for each stage */
+    std::deque<PipelineSlot *> queue[PIPELINE_STAGE_NUM];
+    bool closed[PIPELINE_STAGE_NUM] = {};
+    /* time spent and frames processed by each stage since the last take_stats() */
+    double busy_ms[PIPELINE_STAGE_NUM] = {};
+    int32_t frames[PIPELINE_STAGE_NUM] = {};
+    std::mutex mtx;
+    std::condition_variable cv;
+};
+
+#endif //INFERENCE_PIPELINE_H
@@ -0,0 +1,395 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : multi_pipeline.cpp
+* Version      : v1.00
+* Description  : Capture Thread per camera stream, one AI Inference Thread shared by the streams, and the Main
+*                Thread showing the streams side by side.
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include "opencv2/imgproc.hpp"
+#include "multi_pipeline.h"
+#include "pipeline_utils.h"
+
+MultiPipeline::MultiPipeline(const std::vector<PipelineStream>& streams, Model& model, FrameSink& sink,
+                             StreamPolicy policy, cv::Size display_size, const PipelineConfig& config)
+    : PipelineControl(config), model(model), sink(sink), scheduler((int32_t)streams.size(), policy),
+      display_size(display_size), img_obj_ready(stages, "img_obj_ready"), open_streams(0)
+{
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+        std::unique_ptr<StreamState> state(new StreamState());
+        state->pipeline = this;
+        state->index = (int32_t)i;
+        state->stream = streams[i];
+        scheduler.set_weight((int32_t)i, streams[i].weight);
+        scheduler.set_deadline((int32_t)i, streams[i].deadline_ms);
+        states.push_back(std::move(state));
+    }
+}
+
+void MultiPipeline::shutdown()
+{
+    PipelineControl::shutdown();
+    scheduler.close();
+}
+
+/*****************************************
+* Function Name : R_Inf_Thread
+* Description   : Executes the DRP-AI inference thread shared by the streams
+* Arguments     : pipeline = MultiPipeline object
+* Return value  : -
+******************************************/
+void *MultiPipeline::R_Inf_Thread(void *pipeline)
+{
+    static_cast<MultiPipeline *>(pipeline)->inference_loop();
+    pthread_exit(NULL);
+}
+
+void MultiPipeline::inference_loop()
+{
+    TracedFrame frame;
+    int32_t index = 0;
+    double capture_ms = 0;
+
+    printf("Inference Thread Starting\n");
+
+    /*Inference Loop Start*/
+    while (stages.running())
+    {
+        /*Blocks until a frame of any stream is ready or termination is requested.*/
+        if (!scheduler.pop(index, frame, capture_ms))
+        {
+            break;
+        }
+        StreamState& state = *states[index];
+        FrameTrace& trace = frame.trace;
+
+        trace.stamp(TRACE_PRE_START);
+        if (0 != model.pre_process(frame.image))
+        {
+            fprintf(stderr, "[ERROR] Failed to run Pre-process.\n");
+            shutdown();
+            break;
+        }
+
+        trace.stamp(TRACE_AI_START);
+        if (0 != model.run())
+        {
+            fprintf(stderr, "[ERROR] Failed to get result from memory.\n");
+            shutdown();
+            break;
+        }
+
+        /* The result goes to the post-processor of the stream the frame came from */
+        trace.stamp(TRACE_POST_START);
+        {
+            std::lock_guard<std::mutex> lock(state.result_mtx);
+            int8_t ret = state.stream.post->decode(model.get_output(), model.get_output_size());
+            trace.stamp(TRACE_POST_END);
+            if (0 != ret)
+            {
+                fprintf(stderr, "[ERROR] Failed to run Post-process.\n");
+                shutdown();
+                break;
+            }
+            state.times.pre   = (float)(trace.t[TRACE_AI_START] - trace.t[TRACE_PRE_START]);
+            state.times.ai    = (float)(trace.t[TRACE_POST_START] - trace.t[TRACE_AI_START]);
+            state.times.post  = (float)(trace.t[TRACE_POST_END] - trace.t[TRACE_POST_START]);
+            state.times.total = state.times.pre + state.times.ai + state.times.post;
+            state.result_trace = trace;
+            state.result_shown = false;
+        }
+        scheduler.complete(index, capture_ms);
+    }
+    /*End of Inference Loop*/
+
+    printf("AI Inference Thread Terminated\n");
+}
+
+/*****************************************
+* Function Name : R_Capture_Thread
+* Description   : Executes the capture thread of one stream, hands frames to the scheduler and the Main Thread
+* Arguments     : state = StreamState of the stream
+* Return value  : -
+******************************************/
+void *MultiPipeline::R_Capture_Thread(void *state)
+{
+    StreamState *s = static_cast<StreamState *>(state);
+    s->pipeline->capture_loop(*s);
+    pthread_exit(NULL);
+}
+
+void MultiPipeline::capture_loop(StreamState& state)
+{
+    cv::Mat frame;
+    /* buffer handed to the scheduler, swapped with the slot of the stream so it is reused */
+    TracedFrame input;
+    double capture_ms = 0;
+    int32_t frames_since_detect = config.detect_interval;
+
+    printf("Capture Thread %d Starting\n", state.index);
+
+    if (0 == state.stream.source->open())
+    {
+        while (stages.running())
+        {
+            if (!state.stream.source->read_timed(frame, capture_ms))
+            {
+                printf("[INFO] Stream %d: Video ended or corrupted frame !\n", state.index);
+                break;
+            }
+            FrameTrace trace = tracer.begin(state.index, capture_ms);
+            if (frames_since_detect < config.detect_interval)
+            {
+                frames_since_detect++;
+            }
+            if (!state.display_ready.load())
+            {
+                frame.copyTo(state.display_image);
+                state.display_trace = trace;
+                state.display_ready.store(1);
+                img_obj_ready.store(1); /* Flag for Main Thread. */
+            }
+            /* A frame of the stream still waiting for the AI Inference Thread is replaced */
+            if (frames_since_detect >= config.detect_interval)
+            {
+                frame.copyTo(input.image);
+                input.trace = trace;
+                scheduler.push(state.index, input, trace.t[TRACE_DEQUEUE]);
+                frames_since_detect = 0;
+            }
+            /* The next read gives the capture buffer back to the source */
+            tracer.add(SEG_REQUEUE, FrameTrace::now_ms() - trace.t[TRACE_DEQUEUE]);
+        }
+    }
+
+    /* The application ends with the last stream */
+    if (0 == --open_streams)
+    {
+        shutdown();
+    }
+    printf("Capture Thread %d Terminated\n", state.index);
+}
+
+cv::Rect MultiPipeline::cell(int32_t index) const
+{
+    int32_t n = (int32_t)states.size();
+    int32_t cols = (int32_t)std::ceil(std::sqrt((double)n));
+    int32_t rows = (n + cols - 1) / cols;
+    int32_t w = display_size.width / cols;
+    int32_t h = display_size.height / rows;
+    return cv::Rect((index % cols) * w, (index / cols) * h, w, h);
+}
+
+/*****************************************
+* Function Name : main_loop
+* Description   : Runs the main process loop: draws the last results of each stream on its newest frame and
+*                 displays the streams side by side
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t MultiPipeline::main_loop()
+{
+    if (0 != sink.init())
+    {
+        shutdown();
+        return -1;
+    }
+    canvas = cv::Mat::zeros(display_size.height, display_size.width, CV_8UC3);
+    shown.reserve(states.size());
+
+    printf("Main Loop Starts\n");
+    while (stages.running())
+    {
+        /*Wait for the next frame of any Capture Thread.*/
+        if (!img_obj_ready.wait_set())
+        {
+            break;
+        }
+        /* Cleared first, a frame arriving during the loop below sets it again */
+        img_obj_ready.store(0);
+        shown.clear();
+        for (std::unique_ptr<StreamState>& s : states)
+        {
+            StreamState& state = *s;
+            if (!state.display_ready.load())
+            {
+                continue;
+            }
+            cv::Mat frame = state.display_image;
+            ShownFrame item;
+            item.image = state.display_trace;
+            item.image.stamp(TRACE_OVERLAY_START);
+            {
+                std::lock_guard<std::mutex> lock(state.result_mtx);
+                state.stream.overlay->draw(frame, state.times);
+                item.first_shown = !state.result_shown;
+                state.result_shown = true;
+                item.result = state.result_trace;
+            }
+            double fps = scheduler.get_stats(state.index).fps();
+            cv::Mat roi = canvas(cell(state.index));
+            cv::resize(frame, roi, roi.size());
+            std::string label = "CAM " + std::to_string(state.index) + "  " +
+                                std::to_string((int32_t)std::lround(fps)) + " fps";
+            cv::putText(roi, label, cv::Point(10, roi.rows - 15), cv::FONT_HERSHEY_SIMPLEX, 0.8,
+                        cv::Scalar(0, 255, 255), 2);
+            state.display_ready.store(0);
+            shown.push_back(item);
+        }
+        double commit_start = FrameTrace::now_ms();
+        sink.show(canvas);
+        double commit_end = FrameTrace::now_ms();
+        for (ShownFrame& item : shown)
+        {
+            item.image.t[TRACE_COMMIT_START] = commit_start;
+            item.image.t[TRACE_COMMIT_END] = commit_end;
+            tracer.record_display(item.image, item.first_shown ? &item.result : NULL);
+        }
+    }
+
+    printf("Main Process Terminated\n");
+    return 0;
+}
+
+void MultiPipeline::print_stats() const
+{
+    double aggregate = 0;
+    printf("[INFO] Stream statistics (%s)\n", stream_policy_name(scheduler.get_policy()));
+    for (const std::unique_ptr<StreamState>& s : states)
+    {
+        StreamStats st = scheduler.get_stats(s->index);
+        aggregate += st.fps();
+        printf("[INFO]   stream %d : %6.2f fps, latency mean %6.1f ms max %6.1f ms, wait mean %6.1f ms, "
+               "inferred %llu, dropped %llu, late %llu\n",
+               s->index, st.fps(), st.mean_latency(), st.latency_max, st.mean_wait(),
+               (unsigned long long)st.served, (unsigned long long)st.dropped, (unsigned long long)st.late);
+    }
+    printf("[INFO]   total    : %6.2f fps\n", aggregate);
+}
+
+int8_t MultiPipeline::run()
+{
+    int8_t ret_main = 0;
+    int32_t create_thread_ai = -1;
+    pthread_t ai_inf_thread;
+
+    if (states.empty())
+    {
+        fprintf(stderr, "[ERROR] No camera stream.\n");
+        return -1;
+    }
+    if (0 != model.load())
+    {
+        return -1;
+    }
+
+    /*Stages and the events they hand over, the frames go through the StreamScheduler*/
+    stages.add_stage("capture", {}, {&img_obj_ready});
+    stages.add_stage("inference", {}, {});
+    stages.add_stage("main", {&img_obj_ready}, {});
+    if (0 != init())
+    {
+        return -1;
+    }
+
+    ret_main = start_exit_threads();
+
+    if (0 == ret_main)
+    {
+        create_thread_ai = pthread_create(&ai_inf_thread, NULL, R_Inf_Thread, this);
+        if (0 != create_thread_ai)
+        {
+            fprintf(stderr, "[ERROR] Failed to create AI Inference Thread.\n");
+            ret_main = -1;
+        }
+        else
+        {
+            config.thread_sched.apply(ai_inf_thread, "inference");
+        }
+    }
+
+    /* Counted before any Capture Thread starts, a stream ending early does not end the others */
+    open_streams = (int32_t)states.size();
+    for (std::unique_ptr<StreamState>& s : states)
+    {
+        if (0 != ret_main)
+        {
+            break;
+        }
+        s->create_thread_capture = pthread_create(&s->capture_thread, NULL, R_Capture_Thread, s.get());
+        if (0 != s->create_thread_capture)
+        {
+            fprintf(stderr, "[ERROR] Failed to create Capture Thread %d.\n", s->index);
+            ret_main = -1;
+        }
+        else
+        {
+            config.thread_sched.apply(s->capture_thread, "capture");
+        }
+    }
+
+    /*Main Thread last, the threads created above would inherit its settings*/
+    if (0 == ret_main)
+    {
+        config.thread_sched.apply(pthread_self(), "main");
+    }
+
+    /*Main Processing*/
+    if (0 == ret_main && 0 != main_loop())
+    {
+        fprintf(stderr, "[ERROR] Error during Main Process\n");
+        ret_main = -1;
+    }
+    shutdown();
+
+    for (std::unique_ptr<StreamState>& s : states)
+    {
+        if (0 == s->create_thread_capture && 0 != wait_join(&s->capture_thread, config.capture_timeout))
+        {
+            fprintf(stderr, "[ERROR] Failed to exit Capture Thread %d on time.\n", s->index);
+            ret_main = -1;
+        }
+    }
+    if (0 == create_thread_ai && 0 != wait_join(&ai_inf_thread, config.ai_thread_timeout))
+    {
+        fprintf(stderr, "[ERROR] Failed to exit AI Inference Thread on time.\n");
+        ret_main = -1;
+    }
+    if (0 != join_exit_threads())
+    {
+        ret_main = -1;
+    }
+
+    for (std::unique_ptr<StreamState>& s : states)
+    {
+        s->stream.source->close();
+    }
+    sink.close();
+    print_stats();
+    tracer.print();
+    tracer.close_file();
+    /* The detached exit thread may still be blocked on the mouse device, the semaphore is not destroyed */
+    return ret_main;
+}
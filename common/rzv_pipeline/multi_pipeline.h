@@ -0,0 +1,133 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : multi_pipeline.h
+* Version      : v1.00
+* Description  : Several camera streams on one DRP-AI model. Each stream has its own Capture Thread, post-processor
+*                and overlay; one AI Inference Thread takes the frames of all the streams with a StreamScheduler
+*                policy and gives each result to the post-processor of its stream. The Main Thread shows the streams
+*                side by side on one display:
+*                    std::vector<PipelineStream> streams = { { &camera0, &detector0, &detector0 },
+*                                                            { &camera1, &detector1, &detector1 } };
+*                    MultiPipeline pipeline(streams, model, sink, StreamPolicy::ROUND_ROBIN, cv::Size(1920, 1080),
+*                                           config);
+*                    return pipeline.run();
+***********************************************************************************************************************/
+
+#ifndef MULTI_PIPELINE_H
+#define MULTI_PIPELINE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <pthread.h>
+#include "opencv2/core.hpp"
+#include "pipeline.h"
+#include "pipeline_components.h"
+#include "stream_scheduler.h"
+
+/* One camera stream, its post-processor and overlay keep the results of this stream only */
+struct PipelineStream
+{
+    FrameSource *source;
+    PostProcessor *post;
+    Overlay *overlay;
+    /* share of the inferences with the WEIGHTED policy */
+    int32_t weight = 1;
+    /* wanted capture to inference time with the DEADLINE policy [ms] */
+    double deadline_ms = 100.0;
+};
+
+class MultiPipeline : public PipelineControl
+{
+    public:
+        MultiPipeline(const std::vector<PipelineStream>& streams, Model& model, FrameSink& sink, StreamPolicy policy,
+                      cv::Size display_size, const PipelineConfig& config);
+
+        /*****************************************
+        * Function Name : run
+        * Description   : Loads the model, starts the threads and runs the main process loop until every camera
+        *                 stream ends or termination is requested, then prints the statistics of each stream
+        * Arguments     : -
+        * Return value  : 0 if succeeded
+        *                 not 0 otherwise
+        ******************************************/
+        int8_t run();
+
+        void shutdown() override;
+
+    private:
+        struct StreamState
+        {
+            MultiPipeline *pipeline;
+            int32_t index;
+            PipelineStream stream;
+            pthread_t capture_thread;
+            int32_t create_thread_capture = -1;
+            /* frame of the Main Thread, written by the Capture Thread while display_ready is 0 */
+            cv::Mat display_image;
+            FrameTrace display_trace;
+            std::atomic<uint8_t> display_ready{ 0 };
+            /* serializes PostProcessor::decode and Overlay::draw of the stream, and guards times and the result
+               trace */
+            std::mutex result_mtx;
+            PipelineTimes times = { 0, 0, 0, 0 };
+            /* inferred frame of the last results, result_shown once a displayed frame shows them */
+            FrameTrace result_trace;
+            bool result_shown = true;
+        };
+
+        /* frame handed to the scheduler with its trace */
+        struct TracedFrame
+        {
+            cv::Mat image;
+            FrameTrace trace;
+        };
+
+        /* stream frame drawn on the canvas, recorded once the canvas is committed */
+        struct ShownFrame
+        {
+            FrameTrace image;
+            FrameTrace result;
+            bool first_shown;
+        };
+
+        static void *R_Inf_Thread(void *pipeline);
+        static void *R_Capture_Thread(void *state);
+
+        void inference_loop();
+        void capture_loop(StreamState& state);
+        int8_t main_loop();
+        /* Cell of a stream on the display */
+        cv::Rect cell(int32_t index) const;
+        void print_stats() const;
+
+        std::vector<std::unique_ptr<StreamState>> states;
+        Model& model;
+        FrameSink& sink;
+        StreamScheduler<TracedFrame> scheduler;
+        cv::Size display_size;
+        /* set by a Capture Thread when its display_image is ready */
+        StageEvent img_obj_ready;
+        /* Capture Threads still reading their camera */
+        std::atomic<int32_t> open_streams;
+        cv::Mat canvas;
+        std::vector<ShownFrame> shown;
+};
+
+#endif
@@ -0,0 +1,513 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : pipeline.cpp
+* Version      : v1.00
+* Description  : Capture, AI inference and display threads of the RZ/V2H applications.
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include "pipeline.h"
+#include "pipeline_utils.h"
+/*Double click termination*/
+#include "utils.h"
+
+/* Set by devices::detect_mouse_click */
+bool doubleClick = false;
+
+PipelineControl::PipelineControl(const PipelineConfig& config)
+    : config(config), stages(&terminate_req_sem), create_thread_key(-1)
+{
+    if (1 > this->config.detect_interval)
+    {
+        this->config.detect_interval = 1;
+    }
+}
+
+void PipelineControl::shutdown()
+{
+    stages.shutdown();
+}
+
+/*****************************************
+* Function Name : init
+* Description   : Initializes the termination request semaphore, prints the declared stages and the thread
+*                 settings, locks the memory when mlockall is set and opens the trace file of the configuration
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t PipelineControl::init()
+{
+    /*Termination Request Semaphore Initialization*/
+    /*Initialized value at 1.*/
+    if (0 != sem_init(&terminate_req_sem, 0, 1))
+    {
+        fprintf(stderr, "[ERROR] Failed to Initialize Termination Request Semaphore.\n");
+        return -1;
+    }
+    stages.print();
+
+    config.thread_sched.print();
+    config.thread_sched.lock_memory();
+
+    if (!config.trace_file.empty() && 0 != tracer.open_file(config.trace_file))
+    {
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************
+* Function Name : start_exit_threads
+* Description   : Starts the double click exit thread and the Key Hit Thread of the configuration
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t PipelineControl::start_exit_threads()
+{
+    pthread_t exit_thread;
+
+    if (config.double_click_exit)
+    {
+        /* The exit thread blocks on the mouse device, it is detached instead of joined */
+        if (0 == pthread_create(&exit_thread, NULL, R_exit_Thread, this))
+        {
+            pthread_detach(exit_thread);
+        }
+        else
+        {
+            fprintf(stderr, "[ERROR] Failed to create exit Thread.\n");
+            return -1;
+        }
+    }
+
+    if (config.key_exit)
+    {
+        create_thread_key = pthread_create(&kbhit_thread, NULL, R_Kbhit_Thread, this);
+        if (0 != create_thread_key)
+        {
+            fprintf(stderr, "[ERROR] Failed to create Key Hit Thread.\n");
+            return -1;
+        }
+        config.thread_sched.apply(kbhit_thread, "key");
+    }
+    return 0;
+}
+
+int8_t PipelineControl::join_exit_threads()
+{
+    if (0 == create_thread_key && 0 != wait_join(&kbhit_thread, config.key_thread_timeout))
+    {
+        fprintf(stderr, "[ERROR] Failed to exit Key Hit Thread on time.\n");
+        return -1;
+    }
+    create_thread_key = -1;
+    return 0;
+}
+
+Pipeline::Pipeline(FrameSource& source, Model& model, PostProcessor& post, Overlay& overlay, FrameSink& sink,
+                   const PipelineConfig& config)
+    : PipelineControl(config), source(source), model(model), post(post), overlay(overlay), sink(sink),
+      inference_start(stages, "inference_start"), img_obj_ready(stages, "img_obj_ready"), times({ 0, 0, 0, 0 }),
+      result_shown(true)
+{
+}
+
+/*****************************************
+* Function Name : R_Inf_Thread
+* Description   : Executes the DRP-AI inference thread
+* Arguments     : pipeline = Pipeline object
+* Return value  : -
+******************************************/
+void *Pipeline::R_Inf_Thread(void *pipeline)
+{
+    static_cast<Pipeline *>(pipeline)->inference_loop();
+    pthread_exit(NULL);
+}
+
+void Pipeline::inference_loop()
+{
+    printf("Inference Thread Starting\n");
+
+    /*Inference Loop Start*/
+    while (stages.running())
+    {
+        /*Blocks until image frame from Capture Thread is ready or termination is requested.*/
+        if (!inference_start.wait_set())
+        {
+            break;
+        }
+        FrameTrace trace = input_trace;
+
+        trace.stamp(TRACE_PRE_START);
+        if (0 != model.pre_process(input_image))
+        {
+            fprintf(stderr, "[ERROR] Failed to run Pre-process.\n");
+            shutdown();
+            break;
+        }
+
+        trace.stamp(TRACE_AI_START);
+        if (0 != model.run())
+        {
+            fprintf(stderr, "[ERROR] Failed to get result from memory.\n");
+            shutdown();
+            break;
+        }
+
+        trace.stamp(TRACE_POST_START);
+        {
+            std::lock_guard<std::mutex> lock(result_mtx);
+            int8_t ret = post.decode(model.get_output(), model.get_output_size());
+            trace.stamp(TRACE_POST_END);
+            if (0 != ret)
+            {
+                fprintf(stderr, "[ERROR] Failed to run Post-process.\n");
+                shutdown();
+                break;
+            }
+            times.pre   = (float)(trace.t[TRACE_AI_START] - trace.t[TRACE_PRE_START]);
+            times.ai    = (float)(trace.t[TRACE_POST_START] - trace.t[TRACE_AI_START]);
+            times.post  = (float)(trace.t[TRACE_POST_END] - trace.t[TRACE_POST_START]);
+            times.total = times.pre + times.ai + times.post;
+            if (config.offline)
+            {
+                throughput.add(times, trace.t[TRACE_POST_END]);
+            }
+            result_trace = trace;
+            result_shown = false;
+        }
+        inference_start.store(0);
+    }
+    /*End of Inference Loop*/
+
+    printf("AI Inference Thread Terminated\n");
+}
+
+/*****************************************
+* Function Name : R_Capture_Thread
+* Description   : Executes the capture thread, hands frames to the AI Inference Thread and the Main Thread
+* Arguments     : pipeline = Pipeline object
+* Return value  : -
+******************************************/
+void *Pipeline::R_Capture_Thread(void *pipeline)
+{
+    static_cast<Pipeline *>(pipeline)->capture_loop();
+    pthread_exit(NULL);
+}
+
+void Pipeline::capture_loop()
+{
+    cv::Mat frame;
+    double capture_ms = 0;
+    int32_t frames_since_detect = config.detect_interval;
+
+    printf("Capture Thread Starting\n");
+
+    if (0 != source.open())
+    {
+        shutdown();
+        printf("Capture Thread Terminated\n");
+        return;
+    }
+
+    while (stages.running())
+    {
+        if (!source.read_timed(frame, capture_ms))
+        {
+            printf("[INFO] Video ended or corrupted frame !\n");
+            /* The offline mode ends once the last frame is inferred */
+            if (config.offline)
+            {
+                inference_start.wait_clear();
+            }
+            shutdown();
+            break;
+        }
+        FrameTrace trace = tracer.begin(0, capture_ms);
+        if (config.offline && 0 == throughput.start_ms)
+        {
+            throughput.start_ms = trace.t[TRACE_DEQUEUE];
+        }
+        if (frames_since_detect < config.detect_interval)
+        {
+            frames_since_detect++;
+        }
+        /* The offline mode waits for the AI Inference Thread instead of skipping the frame */
+        if (config.offline && frames_since_detect >= config.detect_interval && !inference_start.wait_clear())
+        {
+            break;
+        }
+        /* copyTo reuses the buffer of the previous frame */
+        if (!inference_start.load() && frames_since_detect >= config.detect_interval)
+        {
+            frame.copyTo(input_image);
+            input_trace = trace;
+            inference_start.store(1); /* Flag for AI Inference Thread. */
+            frames_since_detect = 0;
+        }
+        if (config.display && !img_obj_ready.load())
+        {
+            frame.copyTo(display_image);
+            display_trace = trace;
+            img_obj_ready.store(1); /* Flag for Main Thread. */
+        }
+        /* The next read gives the capture buffer back to the source */
+        tracer.add(SEG_REQUEUE, FrameTrace::now_ms() - trace.t[TRACE_DEQUEUE]);
+    }
+
+    printf("Capture Thread Terminated\n");
+}
+
+/*****************************************
+ * Function Name : R_Kbhit_Thread
+ * Description   : Executes the Keyboard hit thread (checks if enter key is hit)
+ * Arguments     : control = PipelineControl object
+ * Return value  : -
+ ******************************************/
+void *PipelineControl::R_Kbhit_Thread(void *control)
+{
+    static_cast<PipelineControl *>(control)->kbhit_loop();
+    pthread_exit(NULL);
+}
+
+void PipelineControl::kbhit_loop()
+{
+    printf("[INFO] Key Hit Thread Starting\n");
+
+    printf("************************************************\n");
+    printf("* Press ENTER key to quit. *\n");
+    printf("************************************************\n");
+
+    /*Set Standard Input to Non Blocking*/
+    errno = 0;
+    if (-1 == fcntl(0, F_SETFL, O_NONBLOCK))
+    {
+        fprintf(stderr, "[ERROR] Failed to run fctnl(): errno=%d\n", errno);
+        shutdown();
+    }
+
+    while (stages.running())
+    {
+        /* Blocks until a key is pressed or termination is requested. */
+        if (!stages.wait_readable(STDIN_FILENO))
+        {
+            continue;
+        }
+        int32_t c = getchar();
+        if (EOF != c)
+        {
+            /* When key is pressed. */
+            printf("key Detected.\n");
+            shutdown();
+        }
+        else if (feof(stdin))
+        {
+            /* Standard input is closed, only termination ends the thread. */
+            stages.wait_shutdown();
+        }
+    }
+
+    printf("Key Hit Thread Terminated\n");
+}
+
+/*****************************************
+* Function Name : R_exit_Thread
+* Description   : Executes the double click exit thread
+* Arguments     : control = PipelineControl object
+* Return value  : -
+******************************************/
+void *PipelineControl::R_exit_Thread(void *control)
+{
+    static_cast<PipelineControl *>(control)->exit_loop();
+    pthread_exit(NULL);
+}
+
+void PipelineControl::exit_loop()
+{
+    devices dev;
+
+    while (stages.running())
+    {
+        /* Blocks until a double click */
+        if (0 != dev.detect_mouse_click())
+        {
+            break;
+        }
+        if (doubleClick)
+        {
+            shutdown();
+        }
+    }
+    printf("Exit Thread Terminated\n");
+}
+
+/*****************************************
+* Function Name : main_loop
+* Description   : Runs the main process loop: draws the last results on the newest frame and displays it
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t Pipeline::main_loop()
+{
+    if (!config.display)
+    {
+        /* Nothing to show, the Main Thread waits for the end of the stream or the exit */
+        printf("Main Loop Starts without display\n");
+        stages.wait_shutdown();
+        printf("Main Process Terminated\n");
+        return 0;
+    }
+    if (0 != sink.init())
+    {
+        shutdown();
+        return -1;
+    }
+
+    printf("Main Loop Starts\n");
+    while (stages.running())
+    {
+        /*Wait for the next frame from Capture Thread.*/
+        if (!img_obj_ready.wait_set())
+        {
+            break;
+        }
+        cv::Mat frame = display_image;
+        FrameTrace trace = display_trace;
+        FrameTrace result;
+        bool first_shown = false;
+        trace.stamp(TRACE_OVERLAY_START);
+        {
+            std::lock_guard<std::mutex> lock(result_mtx);
+            overlay.draw(frame, times);
+            first_shown = !result_shown;
+            result_shown = true;
+            result = result_trace;
+        }
+        trace.stamp(TRACE_COMMIT_START);
+        sink.show(frame);
+        trace.stamp(TRACE_COMMIT_END);
+        img_obj_ready.store(0);
+        tracer.record_display(trace, first_shown ? &result : NULL);
+    }
+
+    /*To terminate the loop in Capture Thread.*/
+    img_obj_ready.store(0);
+    printf("Main Process Terminated\n");
+    return 0;
+}
+
+int8_t Pipeline::run()
+{
+    int8_t ret_main = 0;
+    int32_t create_thread_ai = -1;
+    int32_t create_thread_capture = -1;
+    pthread_t ai_inf_thread;
+    pthread_t capture_thread;
+
+    if (0 != model.load())
+    {
+        return -1;
+    }
+
+    /*Stages and the events they hand over*/
+    stages.add_stage("capture", {}, {&inference_start, &img_obj_ready});
+    stages.add_stage("inference", {&inference_start}, {});
+    stages.add_stage("main", {&img_obj_ready}, {});
+    if (0 != init())
+    {
+        return -1;
+    }
+
+    ret_main = start_exit_threads();
+
+    if (0 == ret_main)
+    {
+        create_thread_ai = pthread_create(&ai_inf_thread, NULL, R_Inf_Thread, this);
+        if (0 != create_thread_ai)
+        {
+            fprintf(stderr, "[ERROR] Failed to create AI Inference Thread.\n");
+            ret_main = -1;
+        }
+        else
+        {
+            config.thread_sched.apply(ai_inf_thread, "inference");
+        }
+    }
+
+    if (0 == ret_main)
+    {
+        create_thread_capture = pthread_create(&capture_thread, NULL, R_Capture_Thread, this);
+        if (0 != create_thread_capture)
+        {
+            fprintf(stderr, "[ERROR] Failed to create Capture Thread.\n");
+            ret_main = -1;
+        }
+        else
+        {
+            config.thread_sched.apply(capture_thread, "capture");
+        }
+    }
+
+    /*Main Thread last, the threads created above would inherit its settings*/
+    if (0 == ret_main)
+    {
+        config.thread_sched.apply(pthread_self(), "main");
+    }
+
+    /*Main Processing*/
+    if (0 == ret_main && 0 != main_loop())
+    {
+        fprintf(stderr, "[ERROR] Error during Main Process\n");
+        ret_main = -1;
+    }
+    shutdown();
+
+    if (0 == create_thread_capture && 0 != wait_join(&capture_thread, config.capture_timeout))
+    {
+        fprintf(stderr, "[ERROR] Failed to exit Capture Thread on time.\n");
+        ret_main = -1;
+    }
+    if (0 == create_thread_ai && 0 != wait_join(&ai_inf_thread, config.ai_thread_timeout))
+    {
+        fprintf(stderr, "[ERROR] Failed to exit AI Inference Thread on time.\n");
+        ret_main = -1;
+    }
+    if (0 != join_exit_threads())
+    {
+        ret_main = -1;
+    }
+
+    source.close();
+    sink.close();
+    tracer.print();
+    tracer.close_file();
+    if (config.offline)
+    {
+        throughput.print();
+    }
+    /* The detached exit thread may still be blocked on the mouse device, the semaphore is not destroyed */
+    return ret_main;
+}
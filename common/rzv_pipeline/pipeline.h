@@ -0,0 +1,199 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : pipeline.h
+* Version      : v1.00
+* Description  : Capture, AI inference and display threads of the RZ/V2H applications, with the Enter key and
+*                mouse double click exits. The application gives its components and runs the pipeline from main():
+*                    GstSource source(GstSource::usb_camera_pipeline());
+*                    TvmModel model(model_dir, 416, 416, drpai_freq);
+*                    WaylandSink sink(1920, 1080);
+*                    Pipeline pipeline(source, model, detector, detector, sink, config);
+*                    return pipeline.run();
+*                The threads hand frames over with the StageGraph events, frames are copied into buffers that are
+*                reused from one frame to the next.
+*                With PipelineConfig::offline, a video file or image directory is read as fast as the AI Inference
+*                Thread takes its frames, none is skipped, and the throughput is printed at the end:
+*                    ImageDirSource source(image_dir, 2);
+*                    config.offline = true;
+*                    config.display = false;
+***********************************************************************************************************************/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <pthread.h>
+#include <semaphore.h>
+#include "opencv2/core.hpp"
+#include "frame_trace.h"
+#include "pipeline_components.h"
+#include "stage_graph.h"
+#include "thread_sched.h"
+
+struct PipelineConfig
+{
+    /* frames handed to the AI Inference Thread, 1 runs it on every frame.
+       The Main Thread keeps drawing the last results on the frames in between. */
+    int32_t detect_interval = 1;
+    /* Enter key ends the application */
+    bool key_exit = true;
+    /* mouse double click ends the application */
+    bool double_click_exit = true;
+    /* thread exit timeouts [s] */
+    uint32_t capture_timeout = 20;
+    uint32_t ai_thread_timeout = 20;
+    uint32_t key_thread_timeout = 5;
+    /* CPU affinity and scheduling of the capture, inference, key and main threads ([thread] of config.ini) */
+    ThreadSchedConfig thread_sched;
+    /* CSV file of the frame traces, one line per inference result shown, none if empty */
+    std::string trace_file;
+    /* Throughput mode of a file source: the Capture Thread waits for the AI Inference Thread instead of skipping
+       frames, and the frame rate, stage times and DRP-AI utilization are printed at the end */
+    bool offline = false;
+    /* frames are displayed, the offline mode may run without the display */
+    bool display = true;
+};
+
+/* Frame rate and mean stage times of the inferred frames, in the offline mode */
+struct ThroughputStats
+{
+    uint64_t frames = 0;
+    double pre_ms = 0;
+    double ai_ms = 0;
+    double post_ms = 0;
+    /* first frame read and last post-process end, now_ms() clock */
+    double start_ms = 0;
+    double end_ms = 0;
+
+    void add(const PipelineTimes& times, double end)
+    {
+        frames++;
+        pre_ms += times.pre;
+        ai_ms += times.ai;
+        post_ms += times.post;
+        end_ms = end;
+    }
+
+    void print() const
+    {
+        double elapsed = end_ms - start_ms;
+        if (0 == frames || 0 >= elapsed)
+        {
+            printf("[INFO] Throughput: no frame inferred\n");
+            return;
+        }
+        printf("[INFO] Throughput: %llu frames in %.2f s, %.2f FPS\n", (unsigned long long)frames, elapsed / 1000.0,
+               frames * 1000.0 / elapsed);
+        printf("[INFO]   mean pre %.2f ms, ai %.2f ms, post %.2f ms per frame\n", pre_ms / frames, ai_ms / frames,
+               post_ms / frames);
+        printf("[INFO]   DRP-AI utilization %.1f %% (ai time / elapsed time)\n", 100.0 * ai_ms / elapsed);
+    }
+};
+
+/* Termination shared by the pipelines: termination request semaphore, stage graph, Enter key and mouse double click
+   exits, and the frame latency tracer */
+class PipelineControl
+{
+    public:
+        explicit PipelineControl(const PipelineConfig& config);
+        virtual ~PipelineControl() {}
+
+        PipelineControl(const PipelineControl&) = delete;
+        PipelineControl& operator=(const PipelineControl&) = delete;
+
+        /* Requests termination of every thread */
+        virtual void shutdown();
+
+    protected:
+        /* Initializes the termination request semaphore, prints the stages, applies mlockall and opens the trace file,
+           0 if succeeded */
+        int8_t init();
+        /* Starts the exit threads of the configuration, 0 if succeeded */
+        int8_t start_exit_threads();
+        /* Joins the Key Hit Thread, 0 if succeeded */
+        int8_t join_exit_threads();
+
+        PipelineConfig config;
+        sem_t terminate_req_sem;
+        StageGraph stages;
+        LatencyTracer tracer;
+
+    private:
+        static void *R_Kbhit_Thread(void *control);
+        static void *R_exit_Thread(void *control);
+
+        void kbhit_loop();
+        void exit_loop();
+
+        pthread_t kbhit_thread;
+        int32_t create_thread_key;
+};
+
+class Pipeline : public PipelineControl
+{
+    public:
+        Pipeline(FrameSource& source, Model& model, PostProcessor& post, Overlay& overlay, FrameSink& sink,
+                 const PipelineConfig& config);
+
+        /*****************************************
+        * Function Name : run
+        * Description   : Loads the model, starts the threads and runs the main process loop until the camera
+        *                 stream ends or termination is requested
+        * Arguments     : -
+        * Return value  : 0 if succeeded
+        *                 not 0 otherwise
+        ******************************************/
+        int8_t run();
+
+    private:
+        static void *R_Inf_Thread(void *pipeline);
+        static void *R_Capture_Thread(void *pipeline);
+
+        void inference_loop();
+        void capture_loop();
+        int8_t main_loop();
+
+        FrameSource& source;
+        Model& model;
+        PostProcessor& post;
+        Overlay& overlay;
+        FrameSink& sink;
+
+        StageEvent inference_start;
+        StageEvent img_obj_ready;
+
+        /* frame of the AI Inference Thread, written by the Capture Thread while inference_start is 0 */
+        cv::Mat input_image;
+        FrameTrace input_trace;
+        /* frame of the Main Thread, written by the Capture Thread while img_obj_ready is 0 */
+        cv::Mat display_image;
+        FrameTrace display_trace;
+
+        /* serializes PostProcessor::decode and Overlay::draw, and guards times and the result trace */
+        std::mutex result_mtx;
+        PipelineTimes times;
+        /* inferred frame of the last results, result_shown once a displayed frame shows them */
+        FrameTrace result_trace;
+        bool result_shown;
+        /* written by the Capture Thread before the first frame, then by the AI Inference Thread */
+        ThroughputStats throughput;
+};
+
+#endif
@@ -0,0 +1,386 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : pipeline_components.cpp
+* Version      : v1.00
+* Description  : Stock components of the RZ/V2H application pipeline: GStreamer source, DRP-AI TVM model and
+*                Wayland display.
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+#include <tuple>
+#include <dirent.h>
+#include "opencv2/imgcodecs.hpp"
+#include "opencv2/imgproc.hpp"
+#include "pipeline_components.h"
+#include "pipeline_utils.h"
+
+/* DRP-AI memory area offset for model objects */
+#define DRPAI_MEM_OFFSET            (0)
+#define IMAGE_CHANNEL_BGRA          (4)
+
+GstSource::GstSource(const std::string& gstreamer_pipeline)
+    : gstreamer_pipeline(gstreamer_pipeline)
+{
+}
+
+int8_t GstSource::open()
+{
+    std::cout << gstreamer_pipeline << std::endl;
+    cap.open(gstreamer_pipeline, cv::CAP_GSTREAMER);
+    if (!cap.isOpened())
+    {
+        fprintf(stderr, "[ERROR] Error opening video stream or camera !\n");
+        return -1;
+    }
+    return 0;
+}
+
+bool GstSource::read(cv::Mat& frame)
+{
+    cap >> frame;
+    return !frame.empty();
+}
+
+void GstSource::close()
+{
+    cap.release();
+}
+
+std::string GstSource::usb_camera_pipeline()
+{
+    std::string media_port = query_device_status("usb");
+    return camera_pipeline(media_port);
+}
+
+std::string GstSource::camera_pipeline(const std::string& device)
+{
+    return "v4l2src device=" + device + " ! videoconvert ! appsink";
+}
+
+std::string GstSource::video_file_pipeline(const std::string& path, int32_t convert_threads)
+{
+    /* decodebin picks the hardware decoder when there is one, sync=false does not pace the frames */
+    return "filesrc location=" + path + " ! decodebin ! videoconvert n-threads="
+        + std::to_string(std::max(1, convert_threads)) + " ! appsink sync=false";
+}
+
+ImageDirSource::ImageDirSource(const std::string& dir, int32_t decode_threads)
+    : dir(dir), decode_threads(std::max(1, decode_threads)), next_decode(0), next_read(0), stopped(true)
+{
+}
+
+ImageDirSource::~ImageDirSource()
+{
+    close();
+}
+
+/*****************************************
+* Function Name : open
+* Description   : Lists the images of the directory and starts the decode threads
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 if the directory has no image
+******************************************/
+int8_t ImageDirSource::open()
+{
+    close();
+    files.clear();
+    DIR *dp = opendir(dir.c_str());
+    if (NULL == dp)
+    {
+        fprintf(stderr, "[ERROR] Failed to open image directory %s\n", dir.c_str());
+        return -1;
+    }
+    for (dirent *entry = readdir(dp); NULL != entry; entry = readdir(dp))
+    {
+        std::string name = entry->d_name;
+        size_t dot = name.rfind('.');
+        if (std::string::npos == dot)
+        {
+            continue;
+        }
+        std::string ext = name.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+        if ("jpg" == ext || "jpeg" == ext || "png" == ext || "bmp" == ext)
+        {
+            files.push_back(dir + "/" + name);
+        }
+    }
+    closedir(dp);
+    if (files.empty())
+    {
+        fprintf(stderr, "[ERROR] No image in %s\n", dir.c_str());
+        return -1;
+    }
+    std::sort(files.begin(), files.end());
+    printf("[INFO] %zu images in %s, %d decode threads\n", files.size(), dir.c_str(), decode_threads);
+
+    decoded.clear();
+    next_decode = 0;
+    next_read = 0;
+    stopped = false;
+    for (int32_t i = 0; i < decode_threads; i++)
+    {
+        threads.emplace_back(&ImageDirSource::decode_loop, this);
+    }
+    return 0;
+}
+
+void ImageDirSource::decode_loop()
+{
+    /* Each thread decodes at most two images ahead of read() */
+    const size_t ahead = 2 * (size_t)decode_threads;
+    while (true)
+    {
+        size_t index;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this, ahead] {
+                return stopped || next_decode >= files.size() || next_decode < next_read + ahead;
+            });
+            if (stopped || next_decode >= files.size())
+            {
+                return;
+            }
+            index = next_decode++;
+        }
+        cv::Mat image = cv::imread(files[index]);
+        if (image.empty())
+        {
+            fprintf(stderr, "[WARNING] Failed to decode %s\n", files[index].c_str());
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            decoded[index] = image;
+        }
+        cv.notify_all();
+    }
+}
+
+bool ImageDirSource::read(cv::Mat& frame)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    while (next_read < files.size())
+    {
+        cv.wait(lock, [this] { return stopped || decoded.count(next_read); });
+        if (stopped)
+        {
+            return false;
+        }
+        auto it = decoded.find(next_read);
+        frame = it->second;
+        decoded.erase(it);
+        next_read++;
+        cv.notify_all();
+        /* An image that failed to decode is skipped */
+        if (!frame.empty())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ImageDirSource::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopped = true;
+    }
+    cv.notify_all();
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+    threads.clear();
+}
+
+TvmModel::TvmModel(const std::string& model_dir, int32_t in_w, int32_t in_h, int32_t drpai_freq)
+    : model_dir(model_dir), in_w(in_w), in_h(in_h), drpai_freq(drpai_freq)
+{
+}
+
+/*****************************************
+* Function Name : load
+* Description   : Loads the model directory into the DRP-AI memory area and checks the input type
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t TvmModel::load()
+{
+    uint64_t drpaimem_addr_start = get_drpai_start_addr();
+    if (0 == drpaimem_addr_start)
+    {
+        fprintf(stderr, "[ERROR] Failed to get DRP-AI memory area start address.\n");
+        return -1;
+    }
+
+    if (!runtime.LoadModel(model_dir, drpaimem_addr_start + DRPAI_MEM_OFFSET))
+    {
+        fprintf(stderr, "[ERROR] Failed to load model.\n");
+        return -1;
+    }
+
+    InOutDataType input_data_type = runtime.GetInputDataType(0);
+    if (InOutDataType::FLOAT16 == input_data_type)
+    {
+        /*If your model input data type is FP16, use std::vector<uint16_t> for reading input data. */
+        fprintf(stderr, "[ERROR] Input data type : FP16.\n");
+        return -1;
+    }
+    else if (InOutDataType::FLOAT32 != input_data_type)
+    {
+        fprintf(stderr, "[ERROR] Input data type : neither FP32 nor FP16.\n");
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************
+* Function Name : pre_process
+* Description   : Resizes the frame and writes it as normalized RGB planes. The planes are views of one continuous
+*                 buffer, so the colour conversion and the HWC to CHW transpose are a single split, and no buffer
+*                 is allocated after the first frame.
+* Arguments     : frame = BGR frame
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t TvmModel::pre_process(const cv::Mat& frame)
+{
+    if (frame.empty())
+    {
+        return -1;
+    }
+    cv::resize(frame, resized, cv::Size(in_w, in_h));
+    resized.convertTo(normalized, CV_32FC3, 1.0 / 255.0, 0);
+
+    chw.create(3 * in_h, in_w, CV_32FC1);
+    /* B, G, R channels go to the planes 2, 1, 0 */
+    std::vector<cv::Mat> planes = { chw.rowRange(2 * in_h, 3 * in_h), chw.rowRange(in_h, 2 * in_h),
+                                    chw.rowRange(0, in_h) };
+    cv::split(normalized, planes);
+
+    set_input(chw.ptr<float>());
+    return 0;
+}
+
+void TvmModel::set_input(const float *input_data)
+{
+    runtime.SetInput(0, input_data);
+}
+
+int8_t TvmModel::run()
+{
+    runtime.Run(drpai_freq);
+    return get_result();
+}
+
+const float *TvmModel::get_output() const
+{
+    return output.data();
+}
+
+uint32_t TvmModel::get_output_size() const
+{
+    return (uint32_t)output.size();
+}
+
+/*****************************************
+* Function Name : get_result
+* Description   : Get DRP-AI Output from memory via DRP-AI Driver
+* Arguments     : -
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t TvmModel::get_result()
+{
+    int32_t output_num = runtime.GetNumOutput();
+    uint32_t size_count = 0;
+    /*GetOutput loop*/
+    for (int32_t i = 0; i < output_num; i++)
+    {
+        /* output_buffer below is tuple, which is { data type, address of output data, number of elements } */
+        std::tuple<InOutDataType, void*, int64_t> output_buffer = runtime.GetOutput(i);
+        int64_t output_size = std::get<2>(output_buffer);
+        /* Sized on the first frame only */
+        if (output.size() < (size_t)(size_count + output_size))
+        {
+            output.resize(size_count + output_size);
+        }
+
+        if (InOutDataType::FLOAT16 == std::get<0>(output_buffer))
+        {
+            uint16_t* data_ptr = reinterpret_cast<uint16_t*>(std::get<1>(output_buffer));
+            for (int64_t j = 0; j < output_size; j++)
+            {
+                /*FP16 to FP32 conversion*/
+                output[j + size_count] = float16_to_float32(data_ptr[j]);
+            }
+        }
+        else if (InOutDataType::FLOAT32 == std::get<0>(output_buffer))
+        {
+            float* data_ptr = reinterpret_cast<float*>(std::get<1>(output_buffer));
+            std::copy(data_ptr, data_ptr + output_size, output.begin() + size_count);
+        }
+        else
+        {
+            fprintf(stderr, "[ERROR] Output data type : not floating point.\n");
+            return -1;
+        }
+        size_count += output_size;
+    }
+    return 0;
+}
+
+WaylandSink::WaylandSink(uint32_t width, uint32_t height)
+    : width(width), height(height), initialized(false)
+{
+}
+
+int8_t WaylandSink::init()
+{
+    /* wayland Index = 0 */
+    if (0 != wayland.init(0, width, height, IMAGE_CHANNEL_BGRA))
+    {
+        fprintf(stderr, "[ERROR] Failed to initialize Image for Wayland\n");
+        return -1;
+    }
+    initialized = true;
+    return 0;
+}
+
+void WaylandSink::show(const cv::Mat& frame)
+{
+    cv::cvtColor(frame, bgra, cv::COLOR_BGR2BGRA);
+    wayland.commit(bgra.data, NULL);
+}
+
+void WaylandSink::close()
+{
+    if (initialized)
+    {
+        wayland.exit();
+        initialized = false;
+    }
+}
@@ -0,0 +1,224 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : pipeline_components.h
+* Version      : v1.00
+* Description  : Pluggable parts of the RZ/V2H application pipeline.
+*                FrameSource   : gives camera frames and their capture time to the capture thread.
+*                Model         : pre-processes a frame and runs it on DRP-AI, in the inference thread.
+*                PostProcessor : decodes the model output into the application results, in the inference thread.
+*                Overlay       : draws the results and the timings on the displayed frame, in the main thread.
+*                FrameSink     : displays the frame, in the main thread.
+*                The pipeline serializes PostProcessor::decode and Overlay::draw, so an application keeping its
+*                results in one object needs no lock of its own.
+***********************************************************************************************************************/
+
+#ifndef PIPELINE_COMPONENTS_H
+#define PIPELINE_COMPONENTS_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "opencv2/core.hpp"
+#include "opencv2/videoio.hpp"
+#include "frame_trace.h"
+#include "MeraDrpRuntimeWrapper.h"
+#include "wayland.h"
+
+/* Processing times of the last inference [ms] */
+struct PipelineTimes
+{
+    float pre;
+    float ai;
+    float post;
+    float total;
+};
+
+class FrameSource
+{
+    public:
+        virtual ~FrameSource() {}
+        /* 0 if the source is ready, not 0 otherwise */
+        virtual int8_t open() = 0;
+        /* Reads the next BGR frame into frame, false at the end of the stream */
+        virtual bool read(cv::Mat& frame) = 0;
+        /* read() with the capture time of the frame [ms, CLOCK_MONOTONIC]: the time read() returns, unless the source
+           knows when the frame was captured */
+        virtual bool read_timed(cv::Mat& frame, double& capture_ms)
+        {
+            bool ret = read(frame);
+            capture_ms = FrameTrace::now_ms();
+            return ret;
+        }
+        virtual void close() {}
+};
+
+class Model
+{
+    public:
+        virtual ~Model() {}
+        /* Loads the model, 0 if succeeded */
+        virtual int8_t load() = 0;
+        /* Converts a BGR frame into the model input, 0 if succeeded */
+        virtual int8_t pre_process(const cv::Mat& frame) = 0;
+        /* Runs the model on the last input, 0 if succeeded */
+        virtual int8_t run() = 0;
+        /* FP32 output of the last run, all output tensors one after the other */
+        virtual const float *get_output() const = 0;
+        virtual uint32_t get_output_size() const = 0;
+};
+
+class PostProcessor
+{
+    public:
+        virtual ~PostProcessor() {}
+        /* Decodes the model output, 0 if succeeded */
+        virtual int8_t decode(const float *output, uint32_t size) = 0;
+};
+
+class Overlay
+{
+    public:
+        virtual ~Overlay() {}
+        /* Draws on the BGR frame, which may be replaced by a frame of the display size */
+        virtual void draw(cv::Mat& frame, const PipelineTimes& times) = 0;
+};
+
+class FrameSink
+{
+    public:
+        virtual ~FrameSink() {}
+        /* 0 if the sink is ready, not 0 otherwise */
+        virtual int8_t init() = 0;
+        /* Displays a BGR frame */
+        virtual void show(const cv::Mat& frame) = 0;
+        virtual void close() {}
+};
+
+/* GStreamer pipeline read with cv::VideoCapture, e.g. "v4l2src device=/dev/video0 ! videoconvert ! appsink" */
+class GstSource : public FrameSource
+{
+    public:
+        explicit GstSource(const std::string& gstreamer_pipeline);
+        int8_t open() override;
+        bool read(cv::Mat& frame) override;
+        void close() override;
+
+        /*****************************************
+        * Function Name : usb_camera_pipeline
+        * Description   : GStreamer pipeline of the first USB camera listed by v4l2-ctl
+        * Arguments     : -
+        * Return value  : pipeline string
+        ******************************************/
+        static std::string usb_camera_pipeline();
+
+        /* GStreamer pipeline of a V4L2 device, e.g. /dev/video2 */
+        static std::string camera_pipeline(const std::string& device);
+
+        /*****************************************
+        * Function Name : video_file_pipeline
+        * Description   : GStreamer pipeline decoding a video file (MP4, MJPEG, ...) as fast as it is read
+        * Arguments     : path           = video file
+        *                 convert_threads = threads of the colour conversion to BGR
+        * Return value  : pipeline string
+        ******************************************/
+        static std::string video_file_pipeline(const std::string& path, int32_t convert_threads);
+
+    private:
+        std::string gstreamer_pipeline;
+        cv::VideoCapture cap;
+};
+
+/* Images of a directory (jpg, jpeg, png, bmp) in name order, decoded ahead of read() by decode_threads threads */
+class ImageDirSource : public FrameSource
+{
+    public:
+        ImageDirSource(const std::string& dir, int32_t decode_threads);
+        ~ImageDirSource();
+        int8_t open() override;
+        bool read(cv::Mat& frame) override;
+        void close() override;
+
+    private:
+        void decode_loop();
+
+        std::string dir;
+        int32_t decode_threads;
+        std::vector<std::string> files;
+        std::vector<std::thread> threads;
+        /* decoded images by file index, guarded by mtx */
+        std::map<size_t, cv::Mat> decoded;
+        size_t next_decode;
+        size_t next_read;
+        bool stopped;
+        std::mutex mtx;
+        std::condition_variable cv;
+};
+
+/* DRP-AI TVM model with a normalized, RGB, CHW, FP32 input of in_w x in_h */
+class TvmModel : public Model
+{
+    public:
+        TvmModel(const std::string& model_dir, int32_t in_w, int32_t in_h, int32_t drpai_freq);
+        int8_t load() override;
+        /* resize, BGR to RGB, HWC to CHW, x / 255; override for another input format */
+        int8_t pre_process(const cv::Mat& frame) override;
+        int8_t run() override;
+        const float *get_output() const override;
+        uint32_t get_output_size() const override;
+
+    protected:
+        /* Gives the FP32 CHW input to the runtime */
+        void set_input(const float *input);
+
+        MeraDrpRuntimeWrapper runtime;
+        std::string model_dir;
+        int32_t in_w;
+        int32_t in_h;
+        int32_t drpai_freq;
+
+    private:
+        /* Copies the runtime outputs into output, converting FP16 to FP32 */
+        int8_t get_result();
+
+        cv::Mat resized;
+        cv::Mat normalized;
+        cv::Mat chw;
+        std::vector<float> output;
+};
+
+/* Full screen Wayland window, the BGR frame is converted to BGRA */
+class WaylandSink : public FrameSink
+{
+    public:
+        WaylandSink(uint32_t width, uint32_t height);
+        int8_t init() override;
+        void show(const cv::Mat& frame) override;
+        void close() override;
+
+    private:
+        Wayland wayland;
+        uint32_t width;
+        uint32_t height;
+        bool initialized;
+        cv::Mat bgra;
+};
+
+#endif
@@ -0,0 +1,190 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : pipeline_utils.cpp
+* Version      : v1.00
+* Description  : Helpers shared by the RZ/V2H applications.
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/drpai.h>
+#include <builtin_fp16.h>
+#include "pipeline_utils.h"
+
+float float16_to_float32(uint16_t a)
+{
+    return __extendXfYf2__<uint16_t, uint16_t, 10, float, uint32_t, 23>(a);
+}
+
+double timedifference_msec(struct timespec t0, struct timespec t1)
+{
+    return (t1.tv_sec - t0.tv_sec) * 1000.0 + (t1.tv_nsec - t0.tv_nsec) / 1000000.0;
+}
+
+int8_t wait_join(pthread_t *p_join_thread, uint32_t join_time)
+{
+    int8_t ret_err;
+    struct timespec join_timeout;
+    ret_err = clock_gettime(CLOCK_REALTIME, &join_timeout);
+    if ( 0 == ret_err )
+    {
+        join_timeout.tv_sec += join_time;
+        ret_err = pthread_timedjoin_np(*p_join_thread, NULL, &join_timeout);
+    }
+    return ret_err;
+}
+
+void config_read(const std::string& file_name, INI_FORMAT& ini_values)
+{
+    /*Open config.ini file*/
+    std::ifstream ini_file(file_name);
+    std::string line;
+    std::string current_section;
+    /*parsing ini file*/
+    while (std::getline(ini_file, line))
+    {
+        std::string::size_type comment_pos = line.find(";");
+        if (comment_pos != std::string::npos)
+        {
+            line.erase(comment_pos);
+        }
+        line.erase(0, line.find_first_not_of(" \t\r\n"));
+        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+        if (line.empty())
+        {
+            continue;
+        }
+        else if (line[0] == '[')
+        {
+            current_section = line.substr(1, line.size() - 2);
+        }
+        else
+        {
+            std::string::size_type delimiter_pos = line.find("=");
+            std::string key = line.substr(0, delimiter_pos);
+            std::string value = line.substr(delimiter_pos + 1);
+            ini_values[current_section][key] = value;
+        }
+    }
+    return ;
+}
+
+std::vector<std::string> split_list(const std::string& value)
+{
+    std::vector<std::string> items;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+std::vector<std::string> load_label_file(const std::string& label_file_name)
+{
+    std::vector<std::string> list = {};
+    std::vector<std::string> empty = {};
+    std::ifstream infile(label_file_name);
+
+    if (!infile.is_open())
+    {
+        return list;
+    }
+
+    std::string line = "";
+    while (getline(infile,line))
+    {
+        list.push_back(line);
+        if (infile.fail())
+        {
+            return empty;
+        }
+    }
+
+    return list;
+}
+
+std::string query_device_status(const std::string& device_type)
+{
+    std::string media_port = "";
+    /* Linux command to be executed */
+    const char* command = "v4l2-ctl --list-devices";
+    /* Open a pipe to the command and execute it */
+    FILE* pipe = popen(command, "r");
+    if (!pipe)
+    {
+        fprintf(stderr, "[ERROR] Unable to open the pipe.\n");
+        return media_port;
+    }
+    /* Read the command output line by line */
+    char buffer[128];
+    while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+    {
+        std::string response = std::string(buffer);
+        if (response.find(device_type) != std::string::npos)
+        {
+            /* The device node is on the next line */
+            if (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+            {
+                media_port = std::string(buffer);
+            }
+            break;
+        }
+    }
+    pclose(pipe);
+    /* return media port*/
+    return media_port;
+}
+
+uint64_t get_drpai_start_addr()
+{
+    int fd  = 0;
+    int ret = 0;
+    drpai_data_t drpai_data;
+
+    errno = 0;
+
+    fd = open("/dev/drpai0", O_RDWR);
+    if (0 > fd )
+    {
+        fprintf(stderr, "[ERROR] Failed to open DRP-AI Driver : errno=%d\n", errno);
+        return 0;
+    }
+
+    /* Get DRP-AI Memory Area Address via DRP-AI Driver */
+    ret = ioctl(fd , DRPAI_GET_DRPAI_AREA, &drpai_data);
+    close(fd);
+    if (-1 == ret)
+    {
+        fprintf(stderr, "[ERROR] Failed to get DRP-AI Memory Area : errno=%d\n", errno);
+        return 0;
+    }
+
+    return drpai_data.address;
+}
@@ -0,0 +1,104 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : pipeline_utils.h
+* Version      : v1.00
+* Description  : Helpers every RZ/V2H application used to carry in its own main.cpp: config.ini and label file
+*                reading, thread join with timeout, timing, FP16 conversion and device queries.
+***********************************************************************************************************************/
+
+#ifndef PIPELINE_UTILS_H
+#define PIPELINE_UTILS_H
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <pthread.h>
+
+using INI_FORMAT = std::unordered_map<std::string, std::unordered_map<std::string, std::string>>;
+
+/*****************************************
+* Function Name     : float16_to_float32
+* Description       : Function by Edgecortex. Cast uint16_t a into float value.
+* Arguments         : a = uint16_t number
+* Return value      : float = float32 number
+******************************************/
+float float16_to_float32(uint16_t a);
+
+/*****************************************
+* Function Name : timedifference_msec
+* Description   : compute the time differences in ms between two moments
+* Arguments     : t0 = start time
+*                 t1 = stop time
+* Return value  : the time difference in ms
+******************************************/
+double timedifference_msec(struct timespec t0, struct timespec t1);
+
+/*****************************************
+* Function Name : wait_join
+* Description   : waits for a fixed amount of time for the thread to exit
+* Arguments     : p_join_thread = thread that the function waits for to Exit
+*                 join_time = the timeout time for the thread for exiting
+* Return value  : 0 if successful
+*                 not 0 otherwise
+******************************************/
+int8_t wait_join(pthread_t *p_join_thread, uint32_t join_time);
+
+/*****************************************
+* Function Name     : config_read
+* Description       : Read configuration from an ini file, "key=value;" lines grouped by "[section]".
+* Arguments         : file_name  = ini file, e.g. config.ini
+*                     ini_values = [section][key] values read from the file
+* Return value      : -
+******************************************/
+void config_read(const std::string& file_name, INI_FORMAT& ini_values);
+
+/*****************************************
+* Function Name     : split_list
+* Description       : Splits a comma separated config.ini value, e.g. "/dev/video0,/dev/video2"
+* Arguments         : value = config.ini value
+* Return value      : items, empty items are skipped
+******************************************/
+std::vector<std::string> split_list(const std::string& value);
+
+/*****************************************
+* Function Name     : load_label_file
+* Description       : Load label list text file and return the label list that contains the label.
+* Arguments         : label_file_name = filename of label list. must be in txt format
+* Return value      : vector<string> list = list contains labels
+*                     empty if error occurred
+******************************************/
+std::vector<std::string> load_label_file(const std::string& label_file_name);
+
+/*****************************************
+* Function Name : query_device_status
+* Description   : function to check USB device is connectod.
+* Arguments     : device_type = device name printed by v4l2-ctl, e.g. "usb"
+* Return value  : media_port, media port that device is connectod.
+******************************************/
+std::string query_device_status(const std::string& device_type);
+
+/*****************************************
+* Function Name : get_drpai_start_addr
+* Description   : Get DRP-AI Memory Area Address via DRP-AI Driver
+* Arguments     : -
+* Return value  : drpai start address, 0 on failure
+******************************************/
+uint64_t get_drpai_start_addr();
+
+#endif
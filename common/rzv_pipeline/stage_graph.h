@@ -0,0 +1,288 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : stage_graph.h
+* Version      : v1.00
+* Description  : Blocking hand-off between the application threads. Each thread is a stage that declares the events
+*                it reads (inputs) and the events it sets (outputs). A stage sleeps on a condition variable until
+*                its input is set, instead of polling the flag every WAIT_TIME, and one shutdown call wakes every
+*                stage, including a stage blocked on a file descriptor.
+***********************************************************************************************************************/
+
+#ifndef STAGE_GRAPH_H
+#define STAGE_GRAPH_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <errno.h>
+#include <poll.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+class StageEvent;
+
+class StageGraph
+{
+    public:
+        /* terminate_sem : termination request semaphore of the application, initialized at 1 */
+        explicit StageGraph(sem_t *terminate_sem)
+            : terminate_sem(terminate_sem), stop(false), shutdown_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK))
+        {
+        }
+
+        ~StageGraph()
+        {
+            if (0 <= shutdown_fd)
+            {
+                close(shutdown_fd);
+            }
+        }
+
+        StageGraph(const StageGraph&) = delete;
+        StageGraph& operator=(const StageGraph&) = delete;
+
+        /*****************************************
+        * Function Name : add_stage
+        * Description   : Declares a stage with the events it reads and the events it sets
+        * Arguments     : name    = stage name
+        *                 inputs  = events the stage reads
+        *                 outputs = events the stage sets
+        * Return value  : -
+        ******************************************/
+        void add_stage(const std::string& name, std::initializer_list<const StageEvent *> inputs,
+                       std::initializer_list<const StageEvent *> outputs)
+        {
+            stages.push_back({ name, inputs, outputs });
+        }
+
+        /*****************************************
+        * Function Name : print
+        * Description   : Prints the declared stages, and warns about inputs that no stage sets
+        * Arguments     : -
+        * Return value  : -
+        ******************************************/
+        inline void print() const;
+
+        /*****************************************
+        * Function Name : shutdown
+        * Description   : Sets the termination request semaphore to 0 and wakes every stage
+        * Arguments     : -
+        * Return value  : -
+        ******************************************/
+        void shutdown()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                sem_trywait(terminate_sem);
+                stop = true;
+            }
+            cv.notify_all();
+            if (0 <= shutdown_fd)
+            {
+                uint64_t one = 1;
+                ssize_t n = write(shutdown_fd, &one, sizeof(one));
+                (void)n;
+            }
+        }
+
+        /*****************************************
+        * Function Name : running
+        * Description   : Checks the termination request semaphore
+        * Arguments     : -
+        * Return value  : false when termination was requested
+        ******************************************/
+        bool running() const
+        {
+            int32_t value = 0;
+            if (0 != sem_getvalue(terminate_sem, &value))
+            {
+                return false;
+            }
+            return (1 == value);
+        }
+
+        /*****************************************
+        * Function Name : wait_readable
+        * Description   : Blocks until the file descriptor is readable or termination is requested
+        * Arguments     : fd = file descriptor to wait on
+        * Return value  : true if fd is readable, false on termination or poll error
+        ******************************************/
+        bool wait_readable(int fd)
+        {
+            struct pollfd fds[2] = { { fd, POLLIN, 0 }, { shutdown_fd, POLLIN, 0 } };
+            while (running())
+            {
+                /* Without an eventfd the semaphore is checked every 100 ms */
+                int ret = poll(fds, (0 <= shutdown_fd) ? 2 : 1, (0 <= shutdown_fd) ? -1 : 100);
+                if (0 > ret)
+                {
+                    if (EINTR == errno)
+                    {
+                        continue;
+                    }
+                    return false;
+                }
+                if (0 != (fds[1].revents & POLLIN))
+                {
+                    return false;
+                }
+                if (0 != fds[0].revents)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /*****************************************
+        * Function Name : wait_shutdown
+        * Description   : Blocks until termination is requested
+        * Arguments     : -
+        * Return value  : -
+        ******************************************/
+        void wait_shutdown()
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this] { return stop || !running(); });
+        }
+
+    private:
+        friend class StageEvent;
+
+        struct Stage
+        {
+            std::string name;
+            std::vector<const StageEvent *> inputs;
+            std::vector<const StageEvent *> outputs;
+        };
+
+        /* Wakes the stages blocked in wait() after an event was changed under the mutex */
+        void notify()
+        {
+            cv.notify_all();
+        }
+
+        /* Blocks until pred holds. Returns false if termination was requested first. */
+        template <typename Pred>
+        bool wait(Pred pred)
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&] { return pred() || stop || !running(); });
+            return pred();
+        }
+
+        sem_t *terminate_sem;
+        bool stop;
+        int shutdown_fd;
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::vector<Stage> stages;
+};
+
+/* Flag passed from one stage to another. Same load/store interface as the std::atomic<uint8_t> it replaces,
+   a store wakes the stages waiting on the event. */
+class StageEvent
+{
+    public:
+        StageEvent(StageGraph& graph, const char *name, uint8_t init = 0)
+            : graph(graph), name(name), value(init)
+        {
+        }
+
+        StageEvent(const StageEvent&) = delete;
+        StageEvent& operator=(const StageEvent&) = delete;
+
+        uint8_t load() const
+        {
+            return value.load();
+        }
+
+        void store(uint8_t v)
+        {
+            {
+                std::lock_guard<std::mutex> lock(graph.mtx);
+                value.store(v);
+            }
+            graph.notify();
+        }
+
+        /* Blocks until the event is set. Returns false if termination was requested first. */
+        bool wait_set()
+        {
+            return graph.wait([this] { return 0 != value.load(); });
+        }
+
+        /* Blocks until the event is cleared. Returns false if termination was requested first. */
+        bool wait_clear()
+        {
+            return graph.wait([this] { return 0 == value.load(); });
+        }
+
+        const char *get_name() const
+        {
+            return name;
+        }
+
+    private:
+        StageGraph& graph;
+        const char *name;
+        std::atomic<uint8_t> value;
+};
+
+inline void StageGraph::print() const
+{
+    for (const Stage& stage : stages)
+    {
+        std::string in, out;
+        for (const StageEvent *e : stage.inputs)
+        {
+            in += std::string(in.empty() ? "" : ", ") + e->get_name();
+        }
+        for (const StageEvent *e : stage.outputs)
+        {
+            out += std::string(out.empty() ? "" : ", ") + e->get_name();
+        }
+        printf("[INFO] Stage %-10s reads [%s] sets [%s]\n", stage.name.c_str(), in.c_str(), out.c_str());
+    }
+    for (const Stage& stage : stages)
+    {
+        for (const StageEvent *e : stage.inputs)
+        {
+            bool produced = false;
+            for (const Stage& other : stages)
+            {
+                for (const StageEvent *o : other.outputs)
+                {
+                    produced |= (o == e);
+                }
+            }
+            if (!produced)
+            {
+                fprintf(stderr, "[WARNING] Stage %s reads %s which no stage sets.\n",
+                        stage.name.c_str(), e->get_name());
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,352 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : stream_scheduler.h
+* Version      : v1.00
+* Description  : Shares one inference engine between the frames of several camera streams. Each stream has one
+*                waiting frame, a newer frame of the same stream replaces it (the older one is counted as dropped),
+*                and the inference thread takes the next frame with one of the policies:
+*                    ROUND_ROBIN : the streams take turns
+*                    WEIGHTED    : stream i gets weight[i] frames out of sum(weight), smooth weighted round robin
+*                    DEADLINE    : earliest deadline first, the deadline of a stream is the capture time of the
+*                                  first frame it has been waiting with since its last inference, plus the deadline of
+*                                  the stream, so replacing a frame does not push the stream back
+*                Frames are swapped in and out of the slots, so no frame is copied or allocated by the scheduler.
+***********************************************************************************************************************/
+
+#ifndef STREAM_SCHEDULER_H
+#define STREAM_SCHEDULER_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class StreamPolicy
+{
+    ROUND_ROBIN,
+    WEIGHTED,
+    DEADLINE
+};
+
+/* Counters of one stream, times in ms */
+struct StreamStats
+{
+    /* frames given by the capture thread */
+    uint64_t pushed = 0;
+    /* frames replaced by a newer frame before the inference thread took them */
+    uint64_t dropped = 0;
+    /* frames taken by the inference thread */
+    uint64_t served = 0;
+    /* frames taken after the deadline of the stream (DEADLINE policy) */
+    uint64_t late = 0;
+    /* capture to pop */
+    double wait_sum = 0;
+    double wait_max = 0;
+    /* capture to end of post-process, given by complete() */
+    uint64_t completed = 0;
+    double latency_sum = 0;
+    double latency_max = 0;
+    /* first push and last completion, for the per-stream frame rate */
+    double first_ms = 0;
+    double last_ms = 0;
+
+    double fps() const
+    {
+        return (1 < completed && last_ms > first_ms) ? 1000.0 * completed / (last_ms - first_ms) : 0.0;
+    }
+    double mean_latency() const
+    {
+        return (0 < completed) ? latency_sum / completed : 0.0;
+    }
+    double mean_wait() const
+    {
+        return (0 < served) ? wait_sum / served : 0.0;
+    }
+};
+
+template <typename Frame>
+class StreamScheduler
+{
+    public:
+        StreamScheduler(int32_t num_streams, StreamPolicy policy)
+            : policy(policy), slots(std::max(1, num_streams)), last(-1), closed(false)
+        {
+        }
+
+        StreamScheduler(const StreamScheduler&) = delete;
+        StreamScheduler& operator=(const StreamScheduler&) = delete;
+
+        int32_t size() const
+        {
+            return (int32_t)slots.size();
+        }
+
+        StreamPolicy get_policy() const
+        {
+            return policy;
+        }
+
+        /* Share of the stream with the WEIGHTED policy, at least 1 */
+        void set_weight(int32_t stream, int32_t weight)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            slots[stream].weight = std::max(1, weight);
+        }
+
+        /* Wanted capture to inference time of the stream with the DEADLINE policy [ms] */
+        void set_deadline(int32_t stream, double deadline_ms)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            slots[stream].deadline = deadline_ms;
+        }
+
+        /*****************************************
+        * Function Name : push
+        * Description   : Gives the newest frame of a stream. A frame of the stream still waiting is dropped.
+        * Arguments     : stream     = stream index
+        *                 frame      = frame, swapped with the slot: the caller gets back a buffer to reuse
+        *                 capture_ms = capture time of the frame, now_ms() clock
+        * Return value  : false if the scheduler is closed
+        ******************************************/
+        bool push(int32_t stream, Frame& frame, double capture_ms)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (closed)
+                {
+                    return false;
+                }
+                Slot& slot = slots[stream];
+                if (slot.full)
+                {
+                    slot.stats.dropped++;
+                }
+                else
+                {
+                    slot.waiting_since = capture_ms;
+                }
+                if (0 == slot.stats.pushed)
+                {
+                    slot.stats.first_ms = capture_ms;
+                }
+                slot.stats.pushed++;
+                using std::swap;
+                swap(slot.frame, frame);
+                slot.capture_ms = capture_ms;
+                slot.full = true;
+            }
+            cv.notify_one();
+            return true;
+        }
+
+        /*****************************************
+        * Function Name : pop
+        * Description   : Blocks until a frame is waiting and takes the one chosen by the policy
+        * Arguments     : stream     = stream index of the frame
+        *                 frame      = frame, swapped with the slot: the caller's buffer is reused by the stream
+        *                 capture_ms = capture time of the frame
+        * Return value  : false if the scheduler was closed
+        ******************************************/
+        bool pop(int32_t& stream, Frame& frame, double& capture_ms)
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this] { return closed || any_full(); });
+            if (closed)
+            {
+                return false;
+            }
+            stream = pick();
+            Slot& slot = slots[stream];
+            using std::swap;
+            swap(slot.frame, frame);
+            capture_ms = slot.capture_ms;
+            slot.full = false;
+            last = stream;
+
+            double wait = now_ms() - capture_ms;
+            slot.stats.served++;
+            slot.stats.wait_sum += wait;
+            slot.stats.wait_max = std::max(slot.stats.wait_max, wait);
+            if (StreamPolicy::DEADLINE == policy && now_ms() - slot.waiting_since > slot.deadline)
+            {
+                slot.stats.late++;
+            }
+            return true;
+        }
+
+        /* Records the end of the processing of a frame taken by pop() */
+        void complete(int32_t stream, double capture_ms)
+        {
+            double now = now_ms();
+            std::lock_guard<std::mutex> lock(mtx);
+            StreamStats& stats = slots[stream].stats;
+            double latency = now - capture_ms;
+            stats.completed++;
+            stats.latency_sum += latency;
+            stats.latency_max = std::max(stats.latency_max, latency);
+            stats.last_ms = now;
+        }
+
+        /* Wakes the inference thread blocked in pop(), the following pushes and pops fail */
+        void close()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                closed = true;
+            }
+            cv.notify_all();
+        }
+
+        StreamStats get_stats(int32_t stream) const
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            return slots[stream].stats;
+        }
+
+        static double now_ms()
+        {
+            struct timespec t;
+            clock_gettime(CLOCK_MONOTONIC, &t);
+            return t.tv_sec * 1000.0 + t.tv_nsec / 1000000.0;
+        }
+
+    private:
+        struct Slot
+        {
+            Frame frame;
+            double capture_ms = 0;
+            /* capture time of the first frame the stream waits with since its last pop */
+            double waiting_since = 0;
+            bool full = false;
+            int32_t weight = 1;
+            /* smooth weighted round robin credit */
+            int32_t credit = 0;
+            double deadline = 100.0;
+            StreamStats stats;
+        };
+
+        bool any_full() const
+        {
+            for (const Slot& slot : slots)
+            {
+                if (slot.full)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /* Index of the next full slot, called with mtx held and at least one slot full */
+        int32_t pick()
+        {
+            int32_t n = (int32_t)slots.size();
+            int32_t best = -1;
+            if (StreamPolicy::WEIGHTED == policy)
+            {
+                /* Each waiting stream earns its weight, the richest is served and pays the total */
+                int32_t total = 0;
+                for (int32_t i = 0; i < n; i++)
+                {
+                    if (slots[i].full)
+                    {
+                        slots[i].credit += slots[i].weight;
+                        total += slots[i].weight;
+                        if (0 > best || slots[i].credit > slots[best].credit)
+                        {
+                            best = i;
+                        }
+                    }
+                }
+                slots[best].credit -= total;
+                return best;
+            }
+            /* ROUND_ROBIN, and DEADLINE ties, start after the stream served last */
+            for (int32_t k = 1; k <= n; k++)
+            {
+                int32_t i = (last + k) % n;
+                if (!slots[i].full)
+                {
+                    continue;
+                }
+                if (StreamPolicy::ROUND_ROBIN == policy)
+                {
+                    return i;
+                }
+                if (0 > best ||
+                    slots[i].waiting_since + slots[i].deadline < slots[best].waiting_since + slots[best].deadline)
+                {
+                    best = i;
+                }
+            }
+            return best;
+        }
+
+        StreamPolicy policy;
+        std::vector<Slot> slots;
+        int32_t last;
+        bool closed;
+        mutable std::mutex mtx;
+        std::condition_variable cv;
+};
+
+/*****************************************
+* Function Name : parse_stream_policy
+* Description   : Policy of a config.ini value: round_robin, weighted or deadline
+* Arguments     : value = config.ini value
+*                 policy = parsed policy
+* Return value  : false if the value is unknown, policy is unchanged
+******************************************/
+inline bool parse_stream_policy(const std::string& value, StreamPolicy& policy)
+{
+    if ("round_robin" == value || "rr" == value)
+    {
+        policy = StreamPolicy::ROUND_ROBIN;
+    }
+    else if ("weighted" == value)
+    {
+        policy = StreamPolicy::WEIGHTED;
+    }
+    else if ("deadline" == value || "edf" == value)
+    {
+        policy = StreamPolicy::DEADLINE;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+inline const char *stream_policy_name(StreamPolicy policy)
+{
+    switch (policy)
+    {
+        case StreamPolicy::WEIGHTED:
+            return "weighted";
+        case StreamPolicy::DEADLINE:
+            return "deadline";
+        default:
+            return "round_robin";
+    }
+}
+
+#endif
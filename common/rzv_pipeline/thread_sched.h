@@ -0,0 +1,283 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : thread_sched.h
+* Version      : v1.00
+* Description  : CPU affinity, scheduling policy and priority of the application threads, and memory locking, read
+*                from the [thread] section of config.ini:
+*                    <thread>_cpus=2,3;          CPUs the thread may run on, all CPUs when missing
+*                    <thread>_policy=fifo;       other, fifo or rr, other when missing
+*                    <thread>_priority=50;       real-time priority of fifo and rr
+*                    mlockall=1;                 locks the process memory, 0 when missing
+*                The CPUs apply to every policy. Pinning keeps threads that compete under CFS apart, e.g. display
+*                and framerate off the CPU of inference, but a SCHED_OTHER thread pinned to a busy CPU cannot be
+*                moved to an idle one and waits for its time slice there. Give the pinned CPU to that thread alone,
+*                or pin it with fifo or rr; sched_bench reports the frame time jitter of each case.
+*                A setting the process is not permitted to use (no CAP_SYS_NICE, RLIMIT_RTPRIO or RLIMIT_MEMLOCK)
+*                or a CPU that does not exist prints a warning and the thread keeps running with the defaults.
+***********************************************************************************************************************/
+
+#ifndef THREAD_SCHED_H
+#define THREAD_SCHED_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/* Scheduling of one thread */
+struct ThreadSched
+{
+    /* CPUs the thread may run on, empty for all */
+    std::vector<int32_t> cpus;
+    int32_t policy = SCHED_OTHER;
+    int32_t priority = 0;
+};
+
+class ThreadSchedConfig
+{
+    public:
+        /*****************************************
+        * Function Name : read
+        * Description   : Reads the thread settings of the [thread] section of config.ini
+        * Arguments     : section = key and value pairs of the section
+        * Return value  : -
+        ******************************************/
+        void read(const std::unordered_map<std::string, std::string>& section)
+        {
+            for (const auto& kv : section)
+            {
+                const std::string& key = kv.first;
+                if ("mlockall" == key)
+                {
+                    lock = (0 != std::atoi(kv.second.c_str()));
+                    continue;
+                }
+                std::string::size_type pos = key.rfind('_');
+                if (std::string::npos == pos)
+                {
+                    continue;
+                }
+                ThreadSched& sched = threads[key.substr(0, pos)];
+                std::string field = key.substr(pos + 1);
+                if ("cpus" == field)
+                {
+                    sched.cpus = parse_cpus(kv.second);
+                }
+                else if ("policy" == field)
+                {
+                    sched.policy = parse_policy(kv.second);
+                }
+                else if ("priority" == field)
+                {
+                    sched.priority = std::atoi(kv.second.c_str());
+                }
+            }
+        }
+
+        /*****************************************
+        * Function Name : get
+        * Description   : Settings of a thread, the defaults when config.ini has none
+        * Arguments     : name = thread name, e.g. capture
+        * Return value  : thread settings
+        ******************************************/
+        ThreadSched get(const std::string& name) const
+        {
+            auto it = threads.find(name);
+            return (threads.end() == it) ? ThreadSched() : it->second;
+        }
+
+        void set(const std::string& name, const ThreadSched& sched)
+        {
+            threads[name] = sched;
+        }
+
+        bool get_mlockall() const
+        {
+            return lock;
+        }
+
+        /*****************************************
+        * Function Name : apply
+        * Description   : Applies the settings of a thread. A setting that fails is reported and skipped.
+        * Arguments     : thread = thread to set, e.g. pthread_self()
+        *                 name   = thread name in config.ini
+        * Return value  : true if every setting was applied
+        ******************************************/
+        bool apply(pthread_t thread, const std::string& name) const
+        {
+            ThreadSched sched = get(name);
+            bool ok = true;
+
+            if (!sched.cpus.empty())
+            {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                int32_t num_cpu = (int32_t)sysconf(_SC_NPROCESSORS_CONF);
+                int32_t used = 0;
+                for (int32_t cpu : sched.cpus)
+                {
+                    if (0 <= cpu && cpu < num_cpu && cpu < CPU_SETSIZE)
+                    {
+                        CPU_SET(cpu, &set);
+                        used++;
+                    }
+                    else
+                    {
+                        fprintf(stderr, "[WARNING] %s thread: CPU %d does not exist.\n", name.c_str(), cpu);
+                    }
+                }
+                int ret = (0 < used) ? pthread_setaffinity_np(thread, sizeof(set), &set) : EINVAL;
+                if (0 != ret)
+                {
+                    fprintf(stderr, "[WARNING] %s thread: CPU affinity not set (%s), runs on all CPUs.\n",
+                            name.c_str(), strerror(ret));
+                    ok = false;
+                }
+            }
+
+            if (SCHED_OTHER != sched.policy)
+            {
+                struct sched_param param;
+                memset(&param, 0, sizeof(param));
+                param.sched_priority = std::min(std::max(sched.priority, sched_get_priority_min(sched.policy)),
+                                                sched_get_priority_max(sched.policy));
+                int ret = pthread_setschedparam(thread, sched.policy, &param);
+                if (0 != ret)
+                {
+                    fprintf(stderr, "[WARNING] %s thread: %s priority %d not set (%s), keeps SCHED_OTHER.\n",
+                            name.c_str(), policy_name(sched.policy), param.sched_priority, strerror(ret));
+                    ok = false;
+                }
+            }
+            return ok;
+        }
+
+        /*****************************************
+        * Function Name : lock_memory
+        * Description   : Locks the current and future pages of the process when mlockall is set, so that the
+        *                 real-time threads do not take page faults
+        * Arguments     : -
+        * Return value  : true if the memory is locked or mlockall is not set
+        ******************************************/
+        bool lock_memory() const
+        {
+            if (!lock)
+            {
+                return true;
+            }
+            if (0 != mlockall(MCL_CURRENT | MCL_FUTURE))
+            {
+                fprintf(stderr, "[WARNING] mlockall failed (%s), memory is not locked.\n", strerror(errno));
+                return false;
+            }
+            return true;
+        }
+
+        /*****************************************
+        * Function Name : print
+        * Description   : Prints the settings read from config.ini
+        * Arguments     : -
+        * Return value  : -
+        ******************************************/
+        void print() const
+        {
+            for (const auto& kv : threads)
+            {
+                std::string cpus;
+                for (int32_t cpu : kv.second.cpus)
+                {
+                    cpus += (cpus.empty() ? "" : ",") + std::to_string(cpu);
+                }
+                printf("[INFO] Thread %-12s CPUs [%s] %s priority %d\n", kv.first.c_str(),
+                       cpus.empty() ? "all" : cpus.c_str(), policy_name(kv.second.policy), kv.second.priority);
+            }
+            if (lock)
+            {
+                printf("[INFO] Thread memory locked (mlockall)\n");
+            }
+        }
+
+        static const char *policy_name(int32_t policy)
+        {
+            switch (policy)
+            {
+                case SCHED_FIFO:
+                    return "SCHED_FIFO";
+                case SCHED_RR:
+                    return "SCHED_RR";
+                default:
+                    return "SCHED_OTHER";
+            }
+        }
+
+    private:
+        /* "2,3" or "0-3" */
+        static std::vector<int32_t> parse_cpus(const std::string& value)
+        {
+            std::vector<int32_t> cpus;
+            std::stringstream ss(value);
+            std::string item;
+            while (std::getline(ss, item, ','))
+            {
+                if (item.empty())
+                {
+                    continue;
+                }
+                std::string::size_type dash = item.find('-');
+                int32_t first = std::atoi(item.substr(0, dash).c_str());
+                int32_t last = (std::string::npos == dash) ? first : std::atoi(item.substr(dash + 1).c_str());
+                for (int32_t cpu = first; cpu <= last; cpu++)
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+            return cpus;
+        }
+
+        static int32_t parse_policy(std::string value)
+        {
+            std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+            if ("fifo" == value || "sched_fifo" == value)
+            {
+                return SCHED_FIFO;
+            }
+            if ("rr" == value || "sched_rr" == value)
+            {
+                return SCHED_RR;
+            }
+            if ("other" != value && "sched_other" != value)
+            {
+                fprintf(stderr, "[WARNING] Unknown thread policy %s, SCHED_OTHER is used.\n", value.c_str());
+            }
+            return SCHED_OTHER;
+        }
+
+        std::map<std::string, ThreadSched> threads;
+        bool lock = false;
+};
+
+#endif
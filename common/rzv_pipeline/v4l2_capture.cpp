@@ -0,0 +1,685 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : v4l2_capture.cpp
+* Version      : v1.00
+* Description  : V4L2 capture of several camera devices on one epoll thread.
+***********************************************************************************************************************/
+
+/*****************************************
+* Includes
+******************************************/
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include "opencv2/imgproc.hpp"
+#include "frame_trace.h"
+#include "v4l2_capture.h"
+
+/* epoll events handled per wait */
+#define V4L2_EPOLL_EVENTS           (8)
+
+static std::string fourcc_name(uint32_t pixelformat)
+{
+    std::string name(4, ' ');
+    for (int32_t i = 0; i < 4; i++)
+    {
+        name[i] = (char)((pixelformat >> (8 * i)) & 0xFF);
+    }
+    return name;
+}
+
+V4l2Capture::V4l2Capture()
+    : epoll_fd(-1), stop_fd(-1), started(false), stopped(false)
+{
+}
+
+V4l2Capture::~V4l2Capture()
+{
+    stop();
+    for (std::unique_ptr<Device>& dev : devices)
+    {
+        close_device(*dev);
+    }
+}
+
+int V4l2Capture::xioctl(int fd, unsigned long request, void *arg)
+{
+    int r;
+    do
+    {
+        r = ioctl(fd, request, arg);
+    } while (-1 == r && EINTR == errno);
+    return r;
+}
+
+int32_t V4l2Capture::add_device(const V4l2DeviceConfig& config)
+{
+    if (started)
+    {
+        fprintf(stderr, "[ERROR] V4L2 devices must be added before the capture starts.\n");
+        return -1;
+    }
+    std::unique_ptr<Device> dev(new Device());
+    dev->config = config;
+    /* query_device_status gives the device node with its indentation and new line */
+    std::string& name = dev->config.device;
+    name.erase(0, name.find_first_not_of(" \t\r\n"));
+    name.erase(name.find_last_not_of(" \t\r\n") + 1);
+
+    dev->fd = open(name.c_str(), O_RDWR | O_NONBLOCK);
+    if (0 > dev->fd)
+    {
+        fprintf(stderr, "[ERROR] Failed to open %s: errno=%d\n", name.c_str(), errno);
+        return -1;
+    }
+
+    struct v4l2_capability cap;
+    memset(&cap, 0, sizeof(cap));
+    if (-1 == xioctl(dev->fd, VIDIOC_QUERYCAP, &cap))
+    {
+        fprintf(stderr, "[ERROR] %s is not a V4L2 device: errno=%d\n", name.c_str(), errno);
+        close_device(*dev);
+        return -1;
+    }
+    uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps & V4L2_CAP_STREAMING))
+    {
+        fprintf(stderr, "[ERROR] %s does not support video capture streaming.\n", name.c_str());
+        close_device(*dev);
+        return -1;
+    }
+
+    /* Format and size: the driver may adjust them, the adjusted values are kept */
+    struct v4l2_format fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = config.width;
+    fmt.fmt.pix.height = config.height;
+    fmt.fmt.pix.pixelformat = config.pixelformat;
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    if (-1 == xioctl(dev->fd, VIDIOC_S_FMT, &fmt))
+    {
+        fprintf(stderr, "[ERROR] Failed to set the format of %s: errno=%d\n", name.c_str(), errno);
+        close_device(*dev);
+        return -1;
+    }
+    if (fmt.fmt.pix.pixelformat != config.pixelformat)
+    {
+        fprintf(stderr, "[ERROR] %s does not support %s, it gives %s.\n", name.c_str(),
+                fourcc_name(config.pixelformat).c_str(), fourcc_name(fmt.fmt.pix.pixelformat).c_str());
+        close_device(*dev);
+        return -1;
+    }
+    if (fmt.fmt.pix.width != config.width || fmt.fmt.pix.height != config.height)
+    {
+        fprintf(stderr, "[WARNING] %s captures %ux%u instead of %ux%u.\n", name.c_str(),
+                fmt.fmt.pix.width, fmt.fmt.pix.height, config.width, config.height);
+    }
+    dev->config.width = fmt.fmt.pix.width;
+    dev->config.height = fmt.fmt.pix.height;
+    dev->sizeimage = fmt.fmt.pix.sizeimage;
+    /* 2 bytes per pixel, 1.5 for NV12 */
+    uint32_t min_size = dev->config.width * dev->config.height * 2;
+    if (V4L2_PIX_FMT_NV12 == config.pixelformat)
+    {
+        min_size = dev->config.width * dev->config.height * 3 / 2;
+    }
+    dev->sizeimage = std::max(dev->sizeimage, min_size);
+
+    /* Frame rate: the driver setting is kept when it cannot be changed */
+    struct v4l2_streamparm parm;
+    memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (0 < config.fps && 0 == xioctl(dev->fd, VIDIOC_G_PARM, &parm) &&
+        (parm.parm.capture.capability & V4L2_CAP_TIMEPERFRAME))
+    {
+        parm.parm.capture.timeperframe.numerator = 1;
+        parm.parm.capture.timeperframe.denominator = config.fps;
+        if (-1 == xioctl(dev->fd, VIDIOC_S_PARM, &parm))
+        {
+            fprintf(stderr, "[WARNING] Failed to set the frame rate of %s: errno=%d\n", name.c_str(), errno);
+        }
+    }
+    else if (0 < config.fps)
+    {
+        fprintf(stderr, "[WARNING] %s does not support setting the frame rate.\n", name.c_str());
+    }
+    if (0 == xioctl(dev->fd, VIDIOC_G_PARM, &parm) && 0 < parm.parm.capture.timeperframe.numerator)
+    {
+        dev->config.fps = parm.parm.capture.timeperframe.denominator / parm.parm.capture.timeperframe.numerator;
+    }
+
+    if (0 != init_buffers(*dev))
+    {
+        close_device(*dev);
+        return -1;
+    }
+    dev->raw.resize(dev->sizeimage);
+    dev->spare.resize(dev->sizeimage);
+
+    printf("[INFO] %s : %s %ux%u, %u fps, %u buffers\n", name.c_str(), fourcc_name(dev->config.pixelformat).c_str(),
+           dev->config.width, dev->config.height, dev->config.fps, dev->config.buffers);
+    devices.push_back(std::move(dev));
+    return (int32_t)devices.size() - 1;
+}
+
+/*****************************************
+* Function Name : init_buffers
+* Description   : Requests the MMAP buffers of a device, maps and queues them
+* Arguments     : dev = device
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t V4l2Capture::init_buffers(Device& dev)
+{
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = std::max<uint32_t>(2, dev.config.buffers);
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (-1 == xioctl(dev.fd, VIDIOC_REQBUFS, &req) || 2 > req.count)
+    {
+        fprintf(stderr, "[ERROR] Failed to request the buffers of %s: errno=%d\n", dev.config.device.c_str(), errno);
+        return -1;
+    }
+    dev.config.buffers = req.count;
+
+    for (uint32_t i = 0; i < req.count; i++)
+    {
+        struct v4l2_buffer buf;
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (-1 == xioctl(dev.fd, VIDIOC_QUERYBUF, &buf))
+        {
+            fprintf(stderr, "[ERROR] Failed to query buffer %u of %s: errno=%d\n", i, dev.config.device.c_str(), errno);
+            return -1;
+        }
+        void *start = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, dev.fd, buf.m.offset);
+        if (MAP_FAILED == start)
+        {
+            fprintf(stderr, "[ERROR] Failed to map buffer %u of %s: errno=%d\n", i, dev.config.device.c_str(), errno);
+            return -1;
+        }
+        dev.buffers.push_back({ start, buf.length });
+        if (-1 == xioctl(dev.fd, VIDIOC_QBUF, &buf))
+        {
+            fprintf(stderr, "[ERROR] Failed to queue buffer %u of %s: errno=%d\n", i, dev.config.device.c_str(), errno);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void V4l2Capture::close_device(Device& dev)
+{
+    for (Buffer& b : dev.buffers)
+    {
+        munmap(b.start, b.length);
+    }
+    dev.buffers.clear();
+    if (0 <= dev.fd)
+    {
+        close(dev.fd);
+        dev.fd = -1;
+    }
+}
+
+int8_t V4l2Capture::start()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (stopped)
+    {
+        return -1;
+    }
+    if (started)
+    {
+        return 0;
+    }
+    if (devices.empty())
+    {
+        fprintf(stderr, "[ERROR] No V4L2 device to capture.\n");
+        return -1;
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (0 > epoll_fd || 0 > stop_fd)
+    {
+        fprintf(stderr, "[ERROR] Failed to create the epoll instance: errno=%d\n", errno);
+        abort_start(0);
+        return -1;
+    }
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = (uint32_t)devices.size();
+    if (-1 == epoll_ctl(epoll_fd, EPOLL_CTL_ADD, stop_fd, &ev))
+    {
+        fprintf(stderr, "[ERROR] Failed to add the stop event to epoll: errno=%d\n", errno);
+        abort_start(0);
+        return -1;
+    }
+
+    for (size_t i = 0; i < devices.size(); i++)
+    {
+        Device& dev = *devices[i];
+        enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        if (-1 == xioctl(dev.fd, VIDIOC_STREAMON, &type))
+        {
+            fprintf(stderr, "[ERROR] Failed to start streaming on %s: errno=%d\n", dev.config.device.c_str(), errno);
+            abort_start(i);
+            return -1;
+        }
+        ev.events = EPOLLIN;
+        ev.data.u32 = (uint32_t)i;
+        if (-1 == epoll_ctl(epoll_fd, EPOLL_CTL_ADD, dev.fd, &ev))
+        {
+            fprintf(stderr, "[ERROR] Failed to add %s to epoll: errno=%d\n", dev.config.device.c_str(), errno);
+            abort_start(i + 1);
+            return -1;
+        }
+    }
+
+    if (0 != pthread_create(&epoll_thread, NULL, R_Epoll_Thread, this))
+    {
+        fprintf(stderr, "[ERROR] Failed to create V4L2 Capture Thread.\n");
+        abort_start(devices.size());
+        return -1;
+    }
+    started = true;
+    return 0;
+}
+
+/*****************************************
+* Function Name : abort_start
+* Description   : Undoes a failed start() with mtx held: stops streaming on the devices already started, closes
+*                 the epoll instance and every device, and leaves the capture stopped
+* Arguments     : streaming = number of devices, from the first one, on which VIDIOC_STREAMON succeeded
+* Return value  : -
+******************************************/
+void V4l2Capture::abort_start(size_t streaming)
+{
+    for (size_t i = 0; i < streaming; i++)
+    {
+        enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(devices[i]->fd, VIDIOC_STREAMOFF, &type);
+    }
+    if (0 <= epoll_fd)
+    {
+        close(epoll_fd);
+        epoll_fd = -1;
+    }
+    if (0 <= stop_fd)
+    {
+        close(stop_fd);
+        stop_fd = -1;
+    }
+    for (std::unique_ptr<Device>& dev : devices)
+    {
+        close_device(*dev);
+    }
+    stopped = true;
+    close_readers();
+}
+
+void V4l2Capture::close_readers()
+{
+    for (std::unique_ptr<Device>& dev : devices)
+    {
+        {
+            std::lock_guard<std::mutex> lock(dev->mtx);
+            dev->closed = true;
+        }
+        dev->cv.notify_all();
+    }
+}
+
+void V4l2Capture::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (stopped)
+        {
+            return;
+        }
+        stopped = true;
+    }
+    close_readers();
+    if (started)
+    {
+        uint64_t one = 1;
+        if (sizeof(one) != write(stop_fd, &one, sizeof(one)))
+        {
+            fprintf(stderr, "[ERROR] Failed to stop V4L2 Capture Thread: errno=%d\n", errno);
+        }
+        pthread_join(epoll_thread, NULL);
+        for (std::unique_ptr<Device>& dev : devices)
+        {
+            enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            xioctl(dev->fd, VIDIOC_STREAMOFF, &type);
+        }
+        print_stats();
+    }
+    if (0 <= epoll_fd)
+    {
+        close(epoll_fd);
+        epoll_fd = -1;
+    }
+    if (0 <= stop_fd)
+    {
+        close(stop_fd);
+        stop_fd = -1;
+    }
+}
+
+void *V4l2Capture::R_Epoll_Thread(void *capture)
+{
+    static_cast<V4l2Capture *>(capture)->epoll_loop();
+    pthread_exit(NULL);
+}
+
+void V4l2Capture::epoll_loop()
+{
+    struct epoll_event events[V4L2_EPOLL_EVENTS];
+    size_t open_devices = devices.size();
+
+    printf("V4L2 Capture Thread Starting\n");
+    while (0 < open_devices)
+    {
+        int n = epoll_wait(epoll_fd, events, V4L2_EPOLL_EVENTS, -1);
+        if (0 > n)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            fprintf(stderr, "[ERROR] Failed to wait for V4L2 devices: errno=%d\n", errno);
+            break;
+        }
+        bool stop_req = false;
+        for (int i = 0; i < n; i++)
+        {
+            uint32_t index = events[i].data.u32;
+            if (index >= devices.size())
+            {
+                stop_req = true;
+                continue;
+            }
+            Device& dev = *devices[index];
+            if ((events[i].events & (EPOLLERR | EPOLLHUP)) || !dequeue(dev))
+            {
+                fprintf(stderr, "[ERROR] V4L2 device %s failed.\n", dev.config.device.c_str());
+                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, dev.fd, NULL);
+                {
+                    std::lock_guard<std::mutex> lock(dev.mtx);
+                    dev.failed = true;
+                }
+                dev.cv.notify_all();
+                open_devices--;
+            }
+        }
+        if (stop_req)
+        {
+            break;
+        }
+    }
+    /* No more frame, the readers are woken up */
+    for (std::unique_ptr<Device>& dev : devices)
+    {
+        {
+            std::lock_guard<std::mutex> lock(dev->mtx);
+            dev->failed = true;
+        }
+        dev->cv.notify_all();
+    }
+    printf("V4L2 Capture Thread Terminated\n");
+}
+
+/*****************************************
+* Function Name : dequeue
+* Description   : Dequeues the filled buffers of a device, copies each one into the slot of the device with its
+*                 timestamp and sequence number, and queues it back at once
+* Arguments     : dev = device
+* Return value  : false if the device failed
+******************************************/
+bool V4l2Capture::dequeue(Device& dev)
+{
+    while (true)
+    {
+        struct v4l2_buffer buf;
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        if (-1 == xioctl(dev.fd, VIDIOC_DQBUF, &buf))
+        {
+            /* No more filled buffer */
+            return EAGAIN == errno;
+        }
+
+        double timestamp_ms;
+        if (V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC == (buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK))
+        {
+            timestamp_ms = buf.timestamp.tv_sec * 1000.0 + buf.timestamp.tv_usec / 1000.0;
+        }
+        else
+        {
+            timestamp_ms = FrameTrace::now_ms();
+        }
+        uint32_t dropped = 0;
+        if (dev.has_sequence && buf.sequence > dev.last_sequence + 1)
+        {
+            dropped = buf.sequence - dev.last_sequence - 1;
+        }
+        dev.has_sequence = true;
+        dev.last_sequence = buf.sequence;
+
+        {
+            std::lock_guard<std::mutex> lock(dev.mtx);
+            dev.stats.frames++;
+            dev.stats.dropped += dropped;
+            if (buf.flags & V4L2_BUF_FLAG_ERROR)
+            {
+                dev.stats.errors++;
+            }
+            else
+            {
+                if (dev.full)
+                {
+                    dev.stats.replaced++;
+                    /* the drops of the replaced frame are kept */
+                    dropped += dev.info.dropped;
+                }
+                size_t size = std::min<size_t>(buf.bytesused ? buf.bytesused : buf.length, dev.raw.size());
+                memcpy(dev.raw.data(), dev.buffers[buf.index].start, size);
+                dev.info.timestamp_ms = timestamp_ms;
+                dev.info.sequence = buf.sequence;
+                dev.info.dropped = dropped;
+                dev.full = true;
+            }
+        }
+        dev.cv.notify_all();
+
+        if (-1 == xioctl(dev.fd, VIDIOC_QBUF, &buf))
+        {
+            fprintf(stderr, "[ERROR] Failed to queue back a buffer of %s: errno=%d\n", dev.config.device.c_str(), errno);
+            return false;
+        }
+    }
+}
+
+bool V4l2Capture::read(int32_t index, cv::Mat& frame, V4l2FrameInfo& info)
+{
+    Device& dev = *devices[index];
+    {
+        std::unique_lock<std::mutex> lock(dev.mtx);
+        dev.cv.wait(lock, [&] { return dev.full || dev.failed || dev.closed; });
+        if (!dev.full || dev.closed)
+        {
+            return false;
+        }
+        /* The epoll thread fills the other buffer while this one is converted */
+        dev.raw.swap(dev.spare);
+        info = dev.info;
+        dev.full = false;
+    }
+
+    int32_t w = (int32_t)dev.config.width;
+    int32_t h = (int32_t)dev.config.height;
+    switch (dev.config.pixelformat)
+    {
+        case V4L2_PIX_FMT_NV12:
+            cv::cvtColor(cv::Mat(h * 3 / 2, w, CV_8UC1, dev.spare.data()), frame, cv::COLOR_YUV2BGR_NV12);
+            break;
+        case V4L2_PIX_FMT_UYVY:
+            cv::cvtColor(cv::Mat(h, w, CV_8UC2, dev.spare.data()), frame, cv::COLOR_YUV2BGR_UYVY);
+            break;
+        default:
+            cv::cvtColor(cv::Mat(h, w, CV_8UC2, dev.spare.data()), frame, cv::COLOR_YUV2BGR_YUYV);
+            break;
+    }
+    return true;
+}
+
+const V4l2DeviceConfig& V4l2Capture::get_config(int32_t index) const
+{
+    return devices[index]->config;
+}
+
+V4l2DeviceStats V4l2Capture::get_stats(int32_t index) const
+{
+    Device& dev = *devices[index];
+    std::lock_guard<std::mutex> lock(dev.mtx);
+    return dev.stats;
+}
+
+void V4l2Capture::print_stats() const
+{
+    for (size_t i = 0; i < devices.size(); i++)
+    {
+        V4l2DeviceStats st = get_stats((int32_t)i);
+        printf("[INFO] %s : %llu frames, %llu dropped by the driver, %llu replaced before read, %llu errors\n",
+               devices[i]->config.device.c_str(), (unsigned long long)st.frames, (unsigned long long)st.dropped,
+               (unsigned long long)st.replaced, (unsigned long long)st.errors);
+    }
+}
+
+V4l2Source::V4l2Source(V4l2Capture& capture, int32_t index)
+    : capture(capture), index(index)
+{
+}
+
+int8_t V4l2Source::open()
+{
+    return capture.start();
+}
+
+bool V4l2Source::read(cv::Mat& frame)
+{
+    return capture.read(index, frame, info);
+}
+
+bool V4l2Source::read_timed(cv::Mat& frame, double& capture_ms)
+{
+    if (!capture.read(index, frame, info))
+    {
+        return false;
+    }
+    capture_ms = info.timestamp_ms;
+    return true;
+}
+
+void V4l2Source::close()
+{
+    capture.stop();
+}
+
+bool parse_pixelformat(const std::string& value, uint32_t& pixelformat)
+{
+    if ("yuyv" == value)
+    {
+        pixelformat = V4L2_PIX_FMT_YUYV;
+    }
+    else if ("uyvy" == value)
+    {
+        pixelformat = V4L2_PIX_FMT_UYVY;
+    }
+    else if ("nv12" == value)
+    {
+        pixelformat = V4L2_PIX_FMT_NV12;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+int8_t create_camera_sources(const std::vector<std::string>& devices,
+                             const std::unordered_map<std::string, std::string>& section, uint32_t width,
+                             uint32_t height, V4l2Capture& capture, std::vector<std::unique_ptr<FrameSource>>& sources)
+{
+    auto value = [&section](const std::string& key) {
+        auto it = section.find(key);
+        return (section.end() == it) ? std::string() : it->second;
+    };
+
+    if ("v4l2" != value("capture"))
+    {
+        for (const std::string& device : devices)
+        {
+            sources.emplace_back(new GstSource(GstSource::camera_pipeline(device)));
+        }
+        return 0;
+    }
+
+    V4l2DeviceConfig config;
+    config.width = width;
+    config.height = height;
+    if (!value("format").empty() && !parse_pixelformat(value("format"), config.pixelformat))
+    {
+        fprintf(stderr, "[WARNING] Unknown camera format %s, yuyv is used.\n", value("format").c_str());
+    }
+    if (!value("fps").empty())
+    {
+        config.fps = (uint32_t)std::max(0, std::stoi(value("fps")));
+    }
+    if (!value("buffers").empty())
+    {
+        config.buffers = (uint32_t)std::max(2, std::stoi(value("buffers")));
+    }
+    for (const std::string& device : devices)
+    {
+        config.device = device;
+        int32_t index = capture.add_device(config);
+        if (0 > index)
+        {
+            return -1;
+        }
+        sources.emplace_back(new V4l2Source(capture, index));
+    }
+    return 0;
+}
@@ -0,0 +1,220 @@
+/***********************************************************************************************************************
+* Copyright 2024 Renesas Electronics Corporation
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* File Name    : v4l2_capture.h
+* Version      : v1.00
+* Description  : V4L2 capture of several camera devices on one epoll thread. Each device negotiates its format, size,
+*                frame rate and number of MMAP buffers. The epoll thread dequeues every buffer as soon as it is filled,
+*                copies it into the latest frame slot of the device and queues the buffer back, so the driver never
+*                runs out of buffers while the application is busy. Each frame keeps its kernel timestamp
+*                (CLOCK_MONOTONIC) and V4L2 sequence number. Gaps in the sequence count the frames dropped by the
+*                driver, a slot frame replaced before the application read it counts as replaced:
+*                    V4l2Capture capture;
+*                    int32_t cam0 = capture.add_device(V4l2DeviceConfig("/dev/video0"));
+*                    int32_t cam1 = capture.add_device(V4l2DeviceConfig("/dev/video2"));
+*                    V4l2Source source0(capture, cam0), source1(capture, cam1);   FrameSource of each camera
+***********************************************************************************************************************/
+
+#ifndef V4L2_CAPTURE_H
+#define V4L2_CAPTURE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <pthread.h>
+#include <linux/videodev2.h>
+#include "opencv2/core.hpp"
+#include "pipeline_components.h"
+
+struct V4l2DeviceConfig
+{
+    explicit V4l2DeviceConfig(const std::string& device = "") : device(device) {}
+
+    std::string device;
+    uint32_t width = 640;
+    uint32_t height = 480;
+    /* V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_UYVY or V4L2_PIX_FMT_NV12 */
+    uint32_t pixelformat = V4L2_PIX_FMT_YUYV;
+    /* requested frame rate, 0 keeps the driver setting */
+    uint32_t fps = 30;
+    /* MMAP buffers requested from the driver */
+    uint32_t buffers = 4;
+};
+
+/* Capture information of one frame */
+struct V4l2FrameInfo
+{
+    /* kernel timestamp [ms], CLOCK_MONOTONIC */
+    double timestamp_ms = 0;
+    uint32_t sequence = 0;
+    /* frames dropped by the driver just before this one */
+    uint32_t dropped = 0;
+};
+
+/* Counters of one device */
+struct V4l2DeviceStats
+{
+    /* frames dequeued */
+    uint64_t frames = 0;
+    /* frames missing in the sequence numbers */
+    uint64_t dropped = 0;
+    /* frames replaced in the slot before the application read them */
+    uint64_t replaced = 0;
+    /* buffers dequeued with V4L2_BUF_FLAG_ERROR */
+    uint64_t errors = 0;
+};
+
+class V4l2Capture
+{
+    public:
+        V4l2Capture();
+        ~V4l2Capture();
+
+        V4l2Capture(const V4l2Capture&) = delete;
+        V4l2Capture& operator=(const V4l2Capture&) = delete;
+
+        /*****************************************
+        * Function Name : add_device
+        * Description   : Opens a device and negotiates its format, frame rate and buffers, before start()
+        * Arguments     : config = device and wanted settings
+        * Return value  : index of the device, -1 on error
+        ******************************************/
+        int32_t add_device(const V4l2DeviceConfig& config);
+
+        /* Starts streaming on every device and the epoll thread, 0 if succeeded. Nothing is done once started.
+           On failure every device is closed and the capture is stopped. */
+        int8_t start();
+
+        /* Stops the epoll thread and streaming, and prints the counters of the devices. Nothing is done once
+           stopped. */
+        void stop();
+
+        /*****************************************
+        * Function Name : read
+        * Description   : Blocks until a new frame of the device and converts it to BGR
+        * Arguments     : index = device index
+        *                 frame = BGR frame, reused from one call to the next
+        *                 info  = capture information of the frame
+        * Return value  : false if the device failed or the capture is stopped
+        ******************************************/
+        bool read(int32_t index, cv::Mat& frame, V4l2FrameInfo& info);
+
+        /* Negotiated settings of a device */
+        const V4l2DeviceConfig& get_config(int32_t index) const;
+        V4l2DeviceStats get_stats(int32_t index) const;
+        void print_stats() const;
+
+    private:
+        struct Buffer
+        {
+            void *start;
+            size_t length;
+        };
+
+        struct Device
+        {
+            V4l2DeviceConfig config;
+            int fd = -1;
+            std::vector<Buffer> buffers;
+            uint32_t sizeimage = 0;
+            bool has_sequence = false;
+            uint32_t last_sequence = 0;
+            /* guards the slot, the flags and the counters below, so that the cameras do not wait for each other */
+            std::mutex mtx;
+            std::condition_variable cv;
+            /* latest frame slot: raw is written by the epoll thread, spare is converted by read() */
+            std::vector<uint8_t> raw;
+            std::vector<uint8_t> spare;
+            V4l2FrameInfo info;
+            bool full = false;
+            bool failed = false;
+            /* set by stop(), read() returns false even with a frame in the slot */
+            bool closed = false;
+            V4l2DeviceStats stats;
+        };
+
+        static void *R_Epoll_Thread(void *capture);
+        void epoll_loop();
+        /* Dequeues the filled buffers of a device until the driver has none, false if the device failed */
+        bool dequeue(Device& dev);
+        int8_t init_buffers(Device& dev);
+        void close_device(Device& dev);
+        /* Undoes a failed start(): stops streaming on the first streaming devices and closes every device */
+        void abort_start(size_t streaming);
+        /* Wakes up the read() calls, which return false from now on */
+        void close_readers();
+        static int xioctl(int fd, unsigned long request, void *arg);
+
+        std::vector<std::unique_ptr<Device>> devices;
+        int epoll_fd;
+        /* eventfd waking the epoll thread on stop() */
+        int stop_fd;
+        pthread_t epoll_thread;
+        /* guarded by mtx */
+        bool started;
+        bool stopped;
+        std::mutex mtx;
+};
+
+/* One device of a V4l2Capture, its read() gives the kernel timestamp of the frame */
+class V4l2Source : public FrameSource
+{
+    public:
+        V4l2Source(V4l2Capture& capture, int32_t index);
+        /* Starts the capture of every device of the V4l2Capture */
+        int8_t open() override;
+        bool read(cv::Mat& frame) override;
+        bool read_timed(cv::Mat& frame, double& capture_ms) override;
+        /* Stops the capture of every device of the V4l2Capture */
+        void close() override;
+
+    private:
+        V4l2Capture& capture;
+        int32_t index;
+        V4l2FrameInfo info;
+};
+
+/*****************************************
+* Function Name : parse_pixelformat
+* Description   : V4L2 pixel format of a config.ini value: yuyv, uyvy or nv12
+* Arguments     : value = config.ini value
+*                 pixelformat = parsed format
+* Return value  : false if the value is unknown, pixelformat is unchanged
+******************************************/
+bool parse_pixelformat(const std::string& value, uint32_t& pixelformat);
+
+/*****************************************
+* Function Name : create_camera_sources
+* Description   : Creates the FrameSource of each camera device: a GstSource, or with capture=v4l2 in the [camera]
+*                 section of config.ini a V4l2Source of capture, set with the format, fps and buffers keys
+* Arguments     : devices = camera device nodes
+*                 section = [camera] section of config.ini
+*                 width   = capture width
+*                 height  = capture height
+*                 capture = V4L2 capture of the devices, unused with GStreamer
+*                 sources = created sources, one per device
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t create_camera_sources(const std::vector<std::string>& devices,
+                             const std::unordered_map<std::string, std::string>& section, uint32_t width,
+                             uint32_t height, V4l2Capture& capture, std::vector<std::unique_ptr<FrameSource>>& sources);
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * Original Code (C) Copyright Renesas Electronics Corporation 2024
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/***********************************************************************************************************************
+* File Name    : gst_yuv_capture.cpp
+* Version      : 1.0
+* Description  : GStreamer camera capture negotiating raw YUYV or NV12 caps with appsink, without videoconvert.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* Include
+***********************************************************************************************************************/
+#include "gst_yuv_capture.h"
+#include <cstdio>
+#include <gst/app/gstappsink.h>
+#include "opencv2/imgproc.hpp"
+
+/* Time given to the source to negotiate the caps and start streaming */
+#define GST_OPEN_TIMEOUT    (5 * GST_SECOND)
+
+GstYuvCapture::GstYuvCapture()
+    : pipeline(NULL), appsink(NULL), format(YUV_FORMAT_YUYV), sample(NULL), mapped(false)
+{
+}
+
+GstYuvCapture::~GstYuvCapture()
+{
+    close();
+}
+
+/*****************************************
+* Function Name : open
+* Description   : Starts "source ! video/x-raw,format=... ! appsink" and waits for the caps negotiation
+* Arguments     : source = GStreamer source, e.g. "v4l2src device=/dev/video0"
+*                 format = YUV_FORMAT_YUYV or YUV_FORMAT_NV12
+*                 width  = capture width
+*                 height = capture height
+* Return value  : 0 if succeeded
+*                 not 0 otherwise, e.g. the source does not give the format
+******************************************/
+int8_t GstYuvCapture::open(const std::string& source, int32_t format, int32_t width, int32_t height)
+{
+    close();
+    gst_init(NULL, NULL);
+    this->format = format;
+    /* The appsink keeps the newest frames only, a frame late for inference is dropped by GStreamer */
+    std::string description = source + " ! video/x-raw,format=" + ((YUV_FORMAT_NV12 == format) ? "NV12" : "YUY2")
+        + ",width=" + std::to_string(width) + ",height=" + std::to_string(height)
+        + " ! appsink name=yuv_sink max-buffers=2 drop=true sync=false";
+    printf("[INFO] YUV capture pipeline: %s\n", description.c_str());
+
+    GError* error = NULL;
+    pipeline = gst_parse_launch(description.c_str(), &error);
+    if (NULL != error)
+    {
+        fprintf(stderr, "[ERROR] Failed to create the capture pipeline: %s\n", error->message);
+        g_error_free(error);
+        close();
+        return -1;
+    }
+    appsink = gst_bin_get_by_name(GST_BIN(pipeline), "yuv_sink");
+    if (NULL == appsink)
+    {
+        fprintf(stderr, "[ERROR] Failed to get the appsink of the capture pipeline.\n");
+        close();
+        return -1;
+    }
+    if (GST_STATE_CHANGE_FAILURE == gst_element_set_state(pipeline, GST_STATE_PLAYING)
+        || GST_STATE_CHANGE_FAILURE == gst_element_get_state(pipeline, NULL, NULL, GST_OPEN_TIMEOUT))
+    {
+        fprintf(stderr, "[ERROR] Failed to start the capture pipeline.\n");
+        close();
+        return -1;
+    }
+    return 0;
+}
+
+/*****************************************
+* Function Name : read
+* Description   : Blocks until the next frame and maps its buffer. The previous frame is released.
+* Arguments     : image = planes of the mapped buffer, valid until the next read() or close()
+* Return value  : 0 if succeeded
+*                 not 0 at the end of the stream or on error
+******************************************/
+int8_t GstYuvCapture::read(yuv_image_t& image)
+{
+    release();
+    if (NULL == appsink)
+    {
+        return -1;
+    }
+    sample = gst_app_sink_pull_sample(GST_APP_SINK(appsink));
+    if (NULL == sample)
+    {
+        return -1;
+    }
+    GstVideoInfo info;
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
+    if (NULL == buffer || !gst_video_info_from_caps(&info, gst_sample_get_caps(sample)))
+    {
+        fprintf(stderr, "[ERROR] Failed to get the capture frame.\n");
+        return -1;
+    }
+    /* Plane pointers and strides of the camera buffer, taken from its video meta when the driver pads the rows */
+    if (!gst_video_frame_map(&frame, &info, buffer, GST_MAP_READ))
+    {
+        fprintf(stderr, "[ERROR] Failed to map the capture frame.\n");
+        return -1;
+    }
+    mapped = true;
+    image.y = (const uint8_t*)GST_VIDEO_FRAME_PLANE_DATA(&frame, 0);
+    image.y_stride = GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 0);
+    image.uv = (YUV_FORMAT_NV12 == format) ? (const uint8_t*)GST_VIDEO_FRAME_PLANE_DATA(&frame, 1) : NULL;
+    image.uv_stride = (YUV_FORMAT_NV12 == format) ? GST_VIDEO_FRAME_PLANE_STRIDE(&frame, 1) : 0;
+    image.width = GST_VIDEO_FRAME_WIDTH(&frame);
+    image.height = GST_VIDEO_FRAME_HEIGHT(&frame);
+    image.format = format;
+    return 0;
+}
+
+void GstYuvCapture::release()
+{
+    if (mapped)
+    {
+        gst_video_frame_unmap(&frame);
+        mapped = false;
+    }
+    if (NULL != sample)
+    {
+        gst_sample_unref(sample);
+        sample = NULL;
+    }
+}
+
+void GstYuvCapture::close()
+{
+    release();
+    if (NULL != pipeline)
+    {
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+    }
+    if (NULL != appsink)
+    {
+        gst_object_unref(appsink);
+        appsink = NULL;
+    }
+    if (NULL != pipeline)
+    {
+        gst_object_unref(pipeline);
+        pipeline = NULL;
+    }
+}
+
+/*****************************************
+* Function Name : yuv_to_bgr
+* Description   : BGR image of a camera image, for the display
+* Arguments     : image = camera image
+*                 bgr   = BGR image, reused from one call to the next
+* Return value  : -
+******************************************/
+void yuv_to_bgr(const yuv_image_t& image, cv::Mat& bgr)
+{
+    if (YUV_FORMAT_NV12 == image.format)
+    {
+        cv::Mat y(image.height, image.width, CV_8UC1, (void*)image.y, image.y_stride);
+        cv::Mat uv(image.height / 2, image.width / 2, CV_8UC2, (void*)image.uv, image.uv_stride);
+        cv::cvtColorTwoPlane(y, uv, bgr, cv::COLOR_YUV2BGR_NV12);
+    }
+    else
+    {
+        cv::Mat yuyv(image.height, image.width, CV_8UC2, (void*)image.y, image.y_stride);
+        cv::cvtColor(yuyv, bgr, cv::COLOR_YUV2BGR_YUYV);
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * Original Code (C) Copyright Renesas Electronics Corporation 2024
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/***********************************************************************************************************************
+* File Name    : gst_yuv_capture.h
+* Version      : 1.0
+* Description  : GStreamer camera capture negotiating raw YUYV or NV12 caps with appsink, without videoconvert.
+*                Each frame is the mapped GstBuffer of the camera, read in place until the next read().
+***********************************************************************************************************************/
+#pragma once
+
+#ifndef GST_YUV_CAPTURE_H
+#define GST_YUV_CAPTURE_H
+/***********************************************************************************************************************
+* Include
+***********************************************************************************************************************/
+#include <string>
+#include <gst/gst.h>
+#include <gst/video/video.h>
+#include "opencv2/core.hpp"
+#include "yuv_preprocess.h"
+
+/***********************************************************************************************************************
+* Class
+***********************************************************************************************************************/
+class GstYuvCapture
+{
+    public:
+        GstYuvCapture();
+        ~GstYuvCapture();
+
+        GstYuvCapture(const GstYuvCapture&) = delete;
+        GstYuvCapture& operator=(const GstYuvCapture&) = delete;
+
+        /*****************************************
+        * Function Name : open
+        * Description   : Starts "source ! video/x-raw,format=... ! appsink" and waits for the caps negotiation
+        * Arguments     : source = GStreamer source, e.g. "v4l2src device=/dev/video0"
+        *                 format = YUV_FORMAT_YUYV or YUV_FORMAT_NV12
+        *                 width  = capture width
+        *                 height = capture height
+        * Return value  : 0 if succeeded
+        *                 not 0 otherwise, e.g. the source does not give the format
+        ******************************************/
+        int8_t open(const std::string& source, int32_t format, int32_t width, int32_t height);
+
+        /*****************************************
+        * Function Name : read
+        * Description   : Blocks until the next frame and maps its buffer. The previous frame is released.
+        * Arguments     : image = planes of the mapped buffer, valid until the next read() or close()
+        * Return value  : 0 if succeeded
+        *                 not 0 at the end of the stream or on error
+        ******************************************/
+        int8_t read(yuv_image_t& image);
+
+        void close();
+
+    private:
+        void release();
+
+        GstElement* pipeline;
+        GstElement* appsink;
+        int32_t format;
+        GstSample* sample;
+        GstVideoFrame frame;
+        bool mapped;
+};
+
+/*****************************************
+* Function Name : yuv_to_bgr
+* Description   : BGR image of a camera image, for the display
+* Arguments     : image = camera image
+*                 bgr   = BGR image, reused from one call to the next
+* Return value  : -
+******************************************/
+void yuv_to_bgr(const yuv_image_t& image, cv::Mat& bgr);
+
+#endif
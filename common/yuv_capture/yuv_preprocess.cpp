@@ -0,0 +1,161 @@
+/*
+ * Original Code (C) Copyright Renesas Electronics Corporation 2024
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/***********************************************************************************************************************
+* File Name    : yuv_preprocess.cpp
+* Version      : 1.0
+* Description  : Model input of a YUYV or NV12 camera image in one pass: bilinear resize of the region of interest,
+*                BT.601 colour conversion and FP32 scaling.
+***********************************************************************************************************************/
+/***********************************************************************************************************************
+* Include
+***********************************************************************************************************************/
+#include "yuv_preprocess.h"
+#include <algorithm>
+#include <vector>
+
+/*****************************************
+* Function Name : source_coord
+* Description   : Source sample of an output coordinate, as cv::resize INTER_LINEAR
+* Arguments     : dst   = output coordinate
+*                 ratio = source size / output size
+*                 size  = source size
+*                 c0    = first source sample
+*                 c1    = second source sample
+*                 w     = weight of c1
+* Return value  : -
+******************************************/
+static void source_coord(int32_t dst, float ratio, int32_t size, int32_t& c0, int32_t& c1, float& w)
+{
+    float f = (dst + 0.5f) * ratio - 0.5f;
+    if (0.0f > f)
+    {
+        f = 0.0f;
+    }
+    c0 = std::min((int32_t)f, size - 1);
+    c1 = std::min(c0 + 1, size - 1);
+    w = f - c0;
+}
+
+/*****************************************
+* Function Name : clamp255
+* Description   : Saturates a colour value as the 8-bit conversion of cv::cvtColor
+* Arguments     : v = colour value
+* Return value  : v in [0, 255]
+******************************************/
+static inline float clamp255(float v)
+{
+    return std::min(255.0f, std::max(0.0f, v));
+}
+
+/*****************************************
+* Function Name : yuv_preprocess
+* Description   : Writes the model input of the region of interest of a YUYV or NV12 image.
+* Arguments     : image = camera image
+*                 param = size, layout and region of interest of the model input
+*                 out   = out_w * out_h * 3 FP32 values
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t yuv_preprocess(const yuv_image_t& image, const yuv_preproc_param_t& param, float* out)
+{
+    int32_t roi_x = param.roi_x;
+    int32_t roi_y = param.roi_y;
+    int32_t roi_w = param.roi_w;
+    int32_t roi_h = param.roi_h;
+    if (0 >= roi_w || 0 >= roi_h)
+    {
+        roi_x = 0;
+        roi_y = 0;
+        roi_w = image.width;
+        roi_h = image.height;
+    }
+    if (NULL == image.y || 0 > roi_x || 0 > roi_y || image.width < roi_x + roi_w || image.height < roi_y + roi_h
+        || 0 >= param.out_w || 0 >= param.out_h || (YUV_FORMAT_NV12 == image.format && NULL == image.uv))
+    {
+        return -1;
+    }
+    const bool yuyv = (YUV_FORMAT_YUYV == image.format);
+    const int32_t out_w = param.out_w;
+    const int32_t out_h = param.out_h;
+    const int32_t plane = out_w * out_h;
+
+    /* Byte offsets of the samples of each output column in a row */
+    std::vector<int32_t> y0_off(out_w), y1_off(out_w), u_off(out_w);
+    std::vector<float> wx(out_w);
+    float ratio_x = (float)roi_w / out_w;
+    for (int32_t x = 0; x < out_w; x++)
+    {
+        int32_t x0, x1;
+        source_coord(x, ratio_x, roi_w, x0, x1, wx[x]);
+        x0 += roi_x;
+        x1 += roi_x;
+        int32_t xn = (0.5f > wx[x]) ? x0 : x1;
+        y0_off[x] = yuyv ? x0 * 2 : x0;
+        y1_off[x] = yuyv ? x1 * 2 : x1;
+        /* U of the pixel pair, V follows it (2 bytes later in YUYV, 1 byte in NV12) */
+        u_off[x] = yuyv ? (xn >> 1) * 4 + 1 : (xn >> 1) * 2;
+    }
+    const int32_t v_step = yuyv ? 2 : 1;
+
+    float ratio_y = (float)roi_h / out_h;
+    for (int32_t oy = 0; oy < out_h; oy++)
+    {
+        int32_t sy0, sy1;
+        float wy;
+        source_coord(oy, ratio_y, roi_h, sy0, sy1, wy);
+        sy0 += roi_y;
+        sy1 += roi_y;
+        int32_t syn = (0.5f > wy) ? sy0 : sy1;
+        const uint8_t* row0 = image.y + (size_t)sy0 * image.y_stride;
+        const uint8_t* row1 = image.y + (size_t)sy1 * image.y_stride;
+        const uint8_t* chroma = yuyv ? image.y + (size_t)syn * image.y_stride
+                                     : image.uv + (size_t)(syn >> 1) * image.uv_stride;
+        float* dst = out + (size_t)oy * out_w * (param.planar ? 1 : 3);
+        for (int32_t x = 0; x < out_w; x++)
+        {
+            float top = row0[y0_off[x]] + (row0[y1_off[x]] - row0[y0_off[x]]) * wx[x];
+            float bottom = row1[y0_off[x]] + (row1[y1_off[x]] - row1[y0_off[x]]) * wx[x];
+            float luma = 1.164f * (top + (bottom - top) * wy - 16.0f);
+            float u = chroma[u_off[x]] - 128.0f;
+            float v = chroma[u_off[x] + v_step] - 128.0f;
+            float r = clamp255(luma + 1.596f * v) * param.scale;
+            float g = clamp255(luma - 0.813f * v - 0.391f * u) * param.scale;
+            float b = clamp255(luma + 2.018f * u) * param.scale;
+            float c0 = param.rgb ? r : b;
+            float c2 = param.rgb ? b : r;
+            if (param.planar)
+            {
+                dst[x] = c0;
+                dst[x + plane] = g;
+                dst[x + 2 * plane] = c2;
+            }
+            else
+            {
+                dst[x * 3] = c0;
+                dst[x * 3 + 1] = g;
+                dst[x * 3 + 2] = c2;
+            }
+        }
+    }
+    return 0;
+}
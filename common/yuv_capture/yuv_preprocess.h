@@ -0,0 +1,101 @@
+/*
+ * Original Code (C) Copyright Renesas Electronics Corporation 2024
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ *
+ */
+
+/***********************************************************************************************************************
+* File Name    : yuv_preprocess.h
+* Version      : 1.0
+* Description  : Model input of a YUYV or NV12 camera image in one pass: bilinear resize of the region of interest,
+*                BT.601 colour conversion and FP32 scaling. Only the model input pixels are converted, the full
+*                frame is converted to BGR for the display only.
+***********************************************************************************************************************/
+#pragma once
+
+#ifndef YUV_PREPROCESS_H
+#define YUV_PREPROCESS_H
+/***********************************************************************************************************************
+* Include
+***********************************************************************************************************************/
+#include <cstdint>
+
+/***********************************************************************************************************************
+* Macro
+***********************************************************************************************************************/
+/* Packed Y0 U Y1 V, GStreamer YUY2 */
+#define YUV_FORMAT_YUYV     (0)
+/* Y plane followed by an interleaved U V plane of half height */
+#define YUV_FORMAT_NV12     (1)
+
+/***********************************************************************************************************************
+* Struct
+***********************************************************************************************************************/
+/*****************************************
+* yuv_image_t : Camera image, not owned.
+*               uv is the U V plane of NV12 and NULL for YUYV.
+******************************************/
+typedef struct
+{
+    const uint8_t* y;
+    const uint8_t* uv;
+    int32_t y_stride;
+    int32_t uv_stride;
+    int32_t width;
+    int32_t height;
+    int32_t format;
+} yuv_image_t;
+
+/*****************************************
+* yuv_preproc_param_t : Model input of yuv_preprocess.
+*                       roi_w or roi_h of 0 takes the whole image.
+*                       Output values are the 0-255 colour values multiplied by scale.
+******************************************/
+typedef struct
+{
+    int32_t out_w;
+    int32_t out_h;
+    /* R, G, B channel order, B, G, R otherwise */
+    bool rgb;
+    /* CHW layout, HWC otherwise */
+    bool planar;
+    float scale;
+    int32_t roi_x;
+    int32_t roi_y;
+    int32_t roi_w;
+    int32_t roi_h;
+} yuv_preproc_param_t;
+
+/***********************************************************************************************************************
+* Function
+***********************************************************************************************************************/
+/*****************************************
+* Function Name : yuv_preprocess
+* Description   : Writes the model input of the region of interest of a YUYV or NV12 image.
+*                 Luma is resized with the bilinear sampling of cv::resize, chroma is taken from the nearest
+*                 sample.
+* Arguments     : image = camera image
+*                 param = size, layout and region of interest of the model input
+*                 out   = out_w * out_h * 3 FP32 values
+* Return value  : 0 if succeeded
+*                 not 0 otherwise
+******************************************/
+int8_t yuv_preprocess(const yuv_image_t& image, const yuv_preproc_param_t& param, float* out);
+
+#endif